@@ -16,10 +16,33 @@
 #define R7 0xBF27     // Main Pointer (MP) low
 #define R0EXEC 0xBF28 // Execute
 
+// The host mock counts every access instead (tests/test_mock.h)
+#ifdef TEST_MODE
+#include "tests/test_mock.h"
+#else
 #define POKE(addr, value) (*((volatile uint8_t *)(addr)) = (value))
 #define PEEK(address) (*((volatile uint8_t *)(address)))
+#endif
 #define BUSY() while (PEEK(R0) & 0x80) {}
 
+// Frame counters (perf.h) and HUD (hud.h): the 6803 free-running
+// counter at 0x0009, one count per E cycle, and the ring just below
+// the program
+#if defined(PERF) || defined(HUD)
+uint16_t perf_clock(void);
+#endif
+#ifdef HUD
+#define HUD_CLOCK() perf_clock()
+#endif
+#ifdef PERF
+#define PERF_CLOCK() perf_clock()
+#if defined(TEST_MODE)
+#define PERF_RING_ADDR (&mock_ram[0x3600])
+#elif !defined(PERF_RING_ADDR)
+#define PERF_RING_ADDR 0x3600
+#endif
+#endif
+
 // Color codes
 #define black 0
 #define red 1
@@ -67,4 +90,102 @@ extern uint8_t all_key_columns[8];
 #define INPUT_LATERAL_SKIP 20      /* Frames to skip for lateral movement (left/right) */
 #define INPUT_ROTATION_SKIP 35     /* Frames to skip for rotation (CW/CCW) */
 
+/************************************************************/
+/* Direct page (build with -DDIRECT_PAGE)                   */
+/* Constant addresses below 0x100 assemble to direct-mode   */
+/* instructions: 2 bytes and 3 cycles for a load or store,  */
+/* against 3 bytes and 4 cycles extended, or an index       */
+/* register set up for a struct field or a stack local.     */
+/* ld68 -Z 0x90 puts the compiler's own zero-page segment   */
+/* (register variables, runtime temporaries) at 0x90; the   */
+/* game's block starts at DP_BASE, above it. Byte budget:   */
+/*   DP_BASE+0   playfield row offsets  PLAYFIELD_HEIGHT    */
+/*   +22         hot game_state_t fields        8           */
+/*   +30         timeout_ticks                  1           */
+/*   +32         kernel arguments (ASM_KERNELS)  14         */
+/*               total 46 of DP_SIZE (48)                   */
+/* 0xF0-0xFF is left alone.                                 */
+/************************************************************/
+
+#ifdef DIRECT_PAGE
+#ifndef DP_BASE
+#define DP_BASE 0xC0
+#endif
+#define DP_SIZE 48
+
+#ifdef TEST_MODE
+#define DP_ADDR(offset) (&mock_ram[DP_BASE + (offset)])
+#else
+#define DP_ADDR(offset) (DP_BASE + (offset))
+#endif
+
+#define PLAYFIELD_ROWS_ADDR DP_ADDR(0)
+#define GAME_HOT_ADDR DP_ADDR(PLAYFIELD_HEIGHT)
+#define timeout_ticks (*(uint8_t*)DP_ADDR(PLAYFIELD_HEIGHT + 8))
+
+#if PLAYFIELD_HEIGHT + 8 + 1 > 32
+#error "Direct page block over budget"
+#endif
+#if (PLAYFIELD_HEIGHT - 1) * PLAYFIELD_WIDTH > 255
+#error "Playfield row offsets do not fit in a byte"
+#endif
+#endif // DIRECT_PAGE
+
+/************************************************************/
+/* 6803 assembly kernels (build with -DASM_KERNELS)         */
+/* alice_kernels.s replaces the block loops of the piece    */
+/* collision, rotation and place/remove functions. They     */
+/* take their arguments in the direct page instead of on    */
+/* the stack, so they depend on nothing of the compiler's   */
+/* calling convention: tetrice.c stores the arguments and   */
+/* calls a void function, which may clobber A, B and X.     */
+/* The C versions stay in tetrice.c as the reference,       */
+/* checked against the kernels by tests/tetrice_kernels.    */
+/* Argument block at DP_BASE+32, the addresses are fixed in */
+/* the assembly source:                                     */
+/*   +0  playfield address, big-endian                      */
+/*   +2  piece, x, y, rotation                              */
+/*   +6  side flags, rotation direction or cell color       */
+/*   +7  dx, dy                                             */
+/*   +9  result                                             */
+/*   +10 kernel scratch, 4 bytes                            */
+/************************************************************/
+
+#ifdef ASM_KERNELS
+#ifndef DIRECT_PAGE
+#error "ASM_KERNELS needs DIRECT_PAGE: the kernels read the playfield row offsets there"
+#endif
+#if DP_BASE != 0xC0 || PLAYFIELD_WIDTH != 12 || PLAYFIELD_HEIGHT != 22
+#error "alice_kernels.s is assembled for DP_BASE 0xC0 and a 12x22 playfield"
+#endif
+
+typedef struct kernel_args_t {
+    uint8_t* field;
+    uint8_t piece;
+    uint8_t x;
+    uint8_t y;
+    uint8_t rotation;
+    uint8_t side;                   /* Side flags, direction or color */
+    int8_t dx;
+    int8_t dy;
+    uint8_t result;
+    uint8_t scratch[4];
+} kernel_args_t;
+
+#define KERNEL_ARGS_OFFSET 32
+#define KERNEL_ARGS ((kernel_args_t*)DP_ADDR(KERNEL_ARGS_OFFSET))
+
+// Block loop of check_collision: result 1 if a block on one of the
+// side flags ends up outside the playfield or on a filled cell
+void kernel_collision(void);
+
+// check_rotation: result the rotation after turning one way (direction
+// 0) or the other, or the current one if that one does not fit
+void kernel_rotation(void);
+
+// playfield_place_piece and playfield_remove_piece: the piece's cells
+// in the playfield become the color, marked dirty
+void kernel_place(void);
+#endif // ASM_KERNELS
+
 #endif // ALICE_H
@@ -0,0 +1,173 @@
+;
+; alice_kernels.s - 6803 block loops of the piece functions (make ASM=1 DP=1)
+;
+; tetrice.c stores the arguments in the direct page and calls these as
+; void functions (alice.h, ASM_KERNELS); A, B and X are clobbered. The
+; C versions in tetrice.c are the reference, tests/tetrice_kernels runs
+; this file on a 6803 model against them.
+;
+; Direct page, fixed by alice.h with DP_BASE 0xC0:
+;   $C0-$D5  playfield row offsets, 12 cells per row
+;   $E0-$E1  playfield address
+;   $E2      piece          $E3  x            $E4  y
+;   $E5      rotation       $E6  side flags, direction or color
+;   $E7      dx             $E8  dy           $E9  result
+;   $EA      px             $EB  blocks left  $EC-$ED  block pointer
+;
+; A packed block is sides << 4 | y << 2 | x (tetromino.h).
+;
+
+	.export _kernel_collision
+	.export _kernel_rotation
+	.export _kernel_place
+
+	.code
+
+; result = 1 if a block with one of the side flags, moved by dx and dy,
+; is outside the playfield or on a filled cell
+_kernel_collision:
+	ldab $E5
+	bsr shape
+	bsr blocked
+	stab $E9
+	rts
+
+; result = the next rotation (direction 0) or the previous one, or the
+; current rotation if the piece does not fit turned
+_kernel_rotation:
+	ldx #_tetrominos_nb_shapes
+	ldab $E2
+	abx
+	ldaa 0,x		; rotations of the piece
+	ldab $E5
+	tst $E6
+	bne rotation_back
+	incb
+	cba
+	bhi rotation_try	; rotation + 1 < count
+	clrb
+	bra rotation_try
+rotation_back:
+	tstb
+	bne rotation_previous
+	tab
+rotation_previous:
+	decb
+rotation_try:
+	stab $E9
+	bsr shape
+	ldaa #8			; every block, in place
+	staa $E6
+	clra
+	staa $E7
+	staa $E8
+	bsr blocked
+	tstb
+	beq rotation_done
+	ldab $E5		; blocked: keep the current rotation
+	stab $E9
+rotation_done:
+	rts
+
+; Block pointer of the piece in rotation B, 4 blocks to go
+shape:
+	pshb
+	ldx #_tetromino_offsets
+	ldab $E2
+	abx
+	pulb
+	addb 0,x
+	ldaa #4
+	mul			; D = 4 * shape index, under 256
+	addd #_all_tetrominos
+	std $EC
+	ldaa #4
+	staa $EB
+	rts
+
+; B = 1 if a block whose sides match $E6 (bit 3 matches them all) lands
+; outside the playfield or on a filled cell at x + dx, y + dy, else 0
+blocked:
+	ldx $EC
+	ldab 0,x
+	inx
+	stx $EC
+	tba
+	lsra
+	lsra
+	lsra
+	lsra
+	oraa #8
+	anda $E6
+	beq blocked_next
+	tba
+	anda #3
+	adda $E3
+	adda $E7
+	cmpa #12
+	bhs blocked_hit		; also x + dx below 0
+	staa $EA
+	lsrb
+	lsrb
+	andb #3
+	addb $E4
+	addb $E8
+	cmpb #22
+	bhs blocked_hit
+	ldx #$C0
+	abx
+	ldab 0,x
+	ldx $E0
+	abx
+	ldab $EA
+	abx
+	ldab 0,x
+	andb #7
+	bne blocked_hit
+blocked_next:
+	dec $EB
+	bne blocked
+	clrb
+	rts
+blocked_hit:
+	ldab #1
+	rts
+
+; Cells of the piece inside the playfield = color | dirty flag
+_kernel_place:
+	ldab $E5
+	bsr shape
+	ldaa $E6
+	anda #7
+	oraa #$80
+	staa $E6
+place_block:
+	ldx $EC
+	ldab 0,x
+	inx
+	stx $EC
+	tba
+	anda #3
+	adda $E3
+	cmpa #12
+	bhs place_next
+	staa $EA
+	lsrb
+	lsrb
+	andb #3
+	addb $E4
+	cmpb #22
+	bhs place_next
+	ldx #$C0
+	abx
+	ldab 0,x		; row offset
+	ldx $E0
+	abx
+	ldab $EA
+	abx
+	ldaa $E6
+	staa 0,x
+place_next:
+	dec $EB
+	bne place_block
+	rts
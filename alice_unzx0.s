@@ -0,0 +1,198 @@
+;
+; alice_unzx0.s - loader stub of the packed Alice tape image
+;
+; tetrice.k7 loads this stub at ALICE_STUB_ADDR, below the game, with
+; the ZX0 stream of the game right after it, and runs it. The stub
+; moves the stream up so that it ends a few bytes past the end of the
+; game, decompresses it forward to ALICE_ADDR (the output overwrites
+; the stream only once it has been read) and jumps to the game.
+;
+; host/tetrice_pack fills the three words after the first branch.
+; Same stream as host/zx0.c and dzx0_standard (ZX0 v2); tests/tetrice_unzx0
+; runs this file on a 6803 model against them.
+;
+; The copies run the stack pointer over one of the two buffers, so
+; interrupts stay masked until the jump to the game.
+;
+
+	.code
+
+unzx0:
+	bra unzx0_start
+stream_end:
+	.word 0			; end of the stream as loaded
+moved_end:
+	.word 0			; end of the stream once moved
+output:
+	.word 0			; ALICE_ADDR, the game's entry point
+
+unzx0_start:
+	tpa
+	staa flags
+	sei
+	sts stack
+
+; Backwards, the destination is above the source: SP pushes the
+; destination down, X reads the source down
+	lds moved_end
+	des
+	ldx stream_end
+move_byte:
+	dex
+	ldaa 0,x
+	psha
+	cpx #stream
+	bne move_byte
+	sts src
+	lds stack
+
+; X is the stream from here on
+	ldx src
+	inx
+	ldd output
+	std dst
+	ldd #1
+	std offset
+	ldaa #$80
+	staa bits
+	clr flip
+literals:
+	bsr elias
+	stx src
+	jsr copy
+	ldx src
+	bsr getbit
+	bcs new_offset
+	bsr elias		; match from the last offset
+	jsr match
+	bsr getbit
+	bcc literals
+new_offset:
+	inc flip
+	bsr elias		; offset MSB + 1, 256 ends the stream
+	clr flip
+	tsta
+	bne unzx0_done
+	decb
+	tba
+	clrb
+	lsrd			; D = (MSB - 1) * 128
+	std offset
+	ldab 0,x		; 127 - offset LSB, then the first length bit
+	inx
+	stab low
+	lsrb
+	negb
+	addb #128
+	clra
+	addd offset
+	std offset
+	ldaa low
+	lsra
+	ldd #1			; keeps the carry
+	bcs new_length
+	bsr elias_data
+new_length:
+	addd #1
+	bsr match
+	bsr getbit
+	bcs new_offset
+	bra literals
+unzx0_done:
+	ldaa flags
+	tap
+	ldx output
+	jmp 0,x
+
+; D = interlaced Elias gamma value, data bits flipped with flip
+elias:
+	ldd #1
+elias_loop:
+	bsr getbit
+	bcs elias_done
+elias_data:
+	bsr getbit
+	rolb
+	rola
+	eorb flip
+	bra elias_loop
+elias_done:
+	rts
+
+; C = next bit of the stream, bits keeps a marker bit below the rest
+getbit:
+	asl bits
+	bne getbit_done
+	psha
+	ldaa 0,x
+	inx
+	sec
+	rola
+	staa bits
+	pula
+getbit_done:
+	rts
+
+; D bytes from offset bytes back in the output
+match:
+	stx input
+	pshb
+	psha
+	ldd dst
+	subd offset
+	std src
+	pula
+	pulb
+	bsr copy
+	ldx input
+	rts
+
+; D bytes from src to dst, both left past the copy: SP pulls the
+; source, X writes the destination
+copy:
+	tstb
+	beq copy_count
+	inca
+copy_count:
+	staa count
+	sts stack
+	lds src
+	des
+	ldx dst
+copy_byte:
+	pula
+	staa 0,x
+	inx
+	decb
+	bne copy_byte
+	dec count
+	bne copy_byte
+	stx dst
+	ins
+	sts src
+	lds stack
+	rts
+
+src:
+	.word 0
+dst:
+	.word 0
+input:
+	.word 0
+offset:
+	.word 0
+stack:
+	.word 0
+bits:
+	.byte 0
+flip:
+	.byte 0
+low:
+	.byte 0
+count:
+	.byte 0
+flags:
+	.byte 0
+
+; The stream follows the stub
+stream:
@@ -0,0 +1,21 @@
+/* block_patterns.h - PHC-25 Mode 12 block patterns */
+/* 8x8 pixels per tetromino type, MSB is the leftmost pixel.      */
+/* Generated from gfx/blocks.png. Defines the table: included by  */
+/* platform_phc25.c, and by the host framebuffer renderer.        */
+
+#ifndef BLOCK_PATTERNS_H
+#define BLOCK_PATTERNS_H
+
+#include <stdint.h>
+
+static const uint8_t block_patterns[7][8] = {
+    {0xFE, 0xAA, 0xD6, 0xAA, 0xD6, 0xAA, 0xFE, 0x00},  /* I */
+    {0xFE, 0x82, 0x82, 0x92, 0x82, 0x82, 0xFE, 0x00},  /* O */
+    {0xFE, 0x82, 0x86, 0x8E, 0x9E, 0xBE, 0xFE, 0x00},  /* T */
+    {0xFE, 0x82, 0xBA, 0xAA, 0xBA, 0x82, 0xFE, 0x00},  /* S */
+    {0xFE, 0xC6, 0x82, 0x82, 0x82, 0xC6, 0xFE, 0x00},  /* Z */
+    {0xFE, 0xD6, 0x92, 0xFE, 0x92, 0xD6, 0xFE, 0x00},  /* J */
+    {0xFE, 0xAA, 0xEE, 0x82, 0xEE, 0xAA, 0xFE, 0x00}   /* L */
+};
+
+#endif /* BLOCK_PATTERNS_H */
@@ -1,46 +1,13 @@
-; Minimal CRT0 for PHC25 Tetris using z88dk with XOR decoder
+; Minimal CRT0 for PHC25 Tetris using z88dk
+;
+; The tape carries the program ZX0-compressed behind phc25_unzx0.asm,
+; which decompresses it here with interrupts disabled and jumps to it.
 
-        ; Set origin to start of Program Work Area
-        org     $C009
-
-; ================================================================
-; XOR Decoder Stub - THIS SECTION MUST NOT BE ENCODED!
-; ================================================================
-
-        SECTION code_decoder
-
-        DI                              ; Disable interrupts
-
-decoder_start:
-        LD      D, XOR_MASK_VALUE       ; Mask in D
-        LD      HL, encoded_start       ; Start of encoded region
-        LD      BC, ENCODED_LENGTH      ; Length to decode
-
-decode_loop:
-        LD      A, B                    ; Check if done
-        OR      C
-        JR      Z, start                ; Jump to program start when done
-        
-        LD      A, (HL)                 ; Load byte
-        XOR     D                       ; Decode
-        LD      (HL), A                 ; Store back
-        
-        INC     HL                      ; Next byte
-        DEC     BC
-        JR      decode_loop
-
-; Configuration
-XOR_MASK_VALUE  EQU     0x03            ; Set to actual mask after encoding
-ENCODED_LENGTH  EQU     7710            ; Set to actual length after encoding
-
-; ================================================================
-; Main program code - THIS GETS ENCODED
-; ================================================================
+        ; Set origin past the loader stub at the start of the Program Work Area
+        org     $C090                   ; PHC25_ADDR in the Makefile
 
         SECTION code_compiler
 
-encoded_start:                          ; Mark where encoding begins
-
 start:
         call    _main
 
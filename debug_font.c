@@ -120,6 +120,20 @@ void debug_print(uint8_t x, uint8_t y, char* text) {
     }
 }
 
+/* Draw two characters into one byte-aligned VRAM column: four whole */
+/* byte writes, no read-modify-write and no clearing first           */
+void debug_draw_pair(uint8_t column, uint8_t y, char left, char right) {
+    const uint8_t* left_rows = debug_font_4x4[char_to_font_index(left)];
+    const uint8_t* right_rows = debug_font_4x4[char_to_font_index(right)];
+    uint16_t addr = VRAM_START + (y << 5) + column;
+    uint8_t row;
+
+    for (row = 0; row < 4; row++) {
+        POKE(addr, (left_rows[row] << 4) | right_rows[row]);
+        addr += BYTES_PER_ROW;
+    }
+}
+
 /* Debug print number in hex format */
 void debug_print_hex(uint8_t x, uint8_t y, uint8_t value) {
     char hex_str[3];
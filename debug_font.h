@@ -12,6 +12,7 @@ uint8_t char_to_font_index(char c);
 /* Debug print functions */
 void debug_clear_area(uint8_t x, uint8_t y, uint8_t width, uint8_t height);
 void debug_draw_char(uint8_t x, uint8_t y, char c);
+void debug_draw_pair(uint8_t column, uint8_t y, char left, char right);
 void debug_print(uint8_t x, uint8_t y, char* text);
 void debug_print_hex(uint8_t x, uint8_t y, uint8_t value);
 
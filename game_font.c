@@ -1,47 +1,38 @@
 /* game_font.c - Bitmap font rendering for PHC-25 */
 
 #include "game_font.h"
+#ifndef HOST
 #include "phc25.h"
+#include "hud.h"
+#endif
 
-/* Font data: 10 digits (0-9), each 8 bytes (4x8 pixels) */
-/* Bits are packed in upper nibble (bits 7-4), MSB first */
-const uint8_t game_font[10][8] = {
-    { 0x80, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0x80, 0xF0 },  /* '0' */
-    { 0x90, 0xD0, 0xD0, 0xD0, 0xD0, 0xD0, 0x80, 0xF0 },  /* '1' */
-    { 0x80, 0xA0, 0xE0, 0x80, 0xB0, 0xB0, 0x80, 0xF0 },  /* '2' */
-    { 0x80, 0xE0, 0x80, 0xE0, 0xA0, 0xA0, 0x80, 0xF0 },  /* '3' */
-    { 0xA0, 0xA0, 0xA0, 0x80, 0xE0, 0xE0, 0xE0, 0xF0 },  /* '4' */
-    { 0x80, 0xB0, 0x80, 0xE0, 0xA0, 0xA0, 0x80, 0xF0 },  /* '5' */
-    { 0x80, 0xA0, 0xB0, 0x80, 0xA0, 0xA0, 0x80, 0xF0 },  /* '6' */
-    { 0x80, 0xA0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xF0 },  /* '7' */
-    { 0x80, 0xA0, 0xA0, 0x80, 0xA0, 0xA0, 0x80, 0xF0 },  /* '8' */
-    { 0x80, 0xA0, 0xA0, 0x80, 0xE0, 0xA0, 0x80, 0xF0 }   /* '9' */
-};
+/* Font data: 10 digits (0-9), each 8 bytes (4x8 pixels), in the upper */
+/* nibble (bits 7-4) then in the lower one (bits 3-0), MSB first */
+#include "gfx/font.h"
+
+// The host renderer only links the font data
+#ifndef HOST
 
 /* Draw a single digit at pixel position (x, y) */
 void draw_digit(uint8_t x, uint8_t y, uint8_t digit)
 {
     uint8_t row;
     uint16_t vram_addr;
-    uint8_t existing_byte, font_bits;
+    uint8_t keep;
+    const uint8_t* font_bits;
+
+    /* Bit 2 of x picks the nibble: the copy of the font already shifted */
+    /* to it, and the mask of the other nibble to keep */
+    font_bits = game_font[(x >> 2) & 1][digit];
+    keep = (x & 0x04) ? 0xF0 : 0x0F;
 
     /* Draw each row of the 4x8 digit */
+    vram_addr = VRAM_START + (y << 5) + (x >> 3);
     for (row = 0; row < 8; row++) {
-        vram_addr = VRAM_START + ((y + row) << 5) + (x >> 3);
-        existing_byte = PEEK(vram_addr);
-        font_bits = game_font[digit][row];
-
-        /* Check alignment: bit 2 of x determines nibble position */
-        if ((x & 0x04) == 0) {
-            /* Byte-aligned: digit in upper nibble (bits 7-4) */
-            existing_byte = (existing_byte & 0x0F) | font_bits;
-        } else {
-            /* Half-byte aligned: digit in lower nibble (bits 3-0) */
-            existing_byte = (existing_byte & 0xF0) | (font_bits >> 4);
-        }
-
-        POKE(vram_addr, existing_byte);
+        POKE(vram_addr, (PEEK(vram_addr) & keep) | *font_bits++);
+        vram_addr += 32;
     }
+    HUD_BYTES(8);
 }
 
 /* Draw a 3-digit number at pixel position (x, y) with leading zeros */
@@ -62,3 +53,22 @@ void draw_number(uint8_t x, uint8_t y, uint8_t number, uint8_t num_digits, uint8
         digit_x += 4;
     }
 }
+
+/* Draw only the digits of a number that are not on screen yet */
+void update_number(uint8_t x, uint8_t y, uint8_t number, uint8_t num_digits, uint8_t* shown)
+{
+    uint8_t i, digit;
+
+    /* From the last digit, right to left */
+    x += (num_digits - 1) << 2;
+    for (i = num_digits; i-- > 0; x -= 4) {
+        digit = number % 10;
+        number /= 10;
+        if (shown[i] != digit) {
+            draw_digit(x, y, digit);
+            shown[i] = digit;
+        }
+    }
+}
+
+#endif // HOST
@@ -1,5 +1,5 @@
 /* game_font.h - Bitmap font for score/level display */
-/* Generated from digit sprite sheet */
+/* Generated from digit sprite sheet (tools/extract_font.py, gfx/font.h) */
 /* Each digit is 4x8 pixels, stored as 8 bytes */
 /* Bits are packed MSB first (leftmost pixel = bit 7) */
 
@@ -8,9 +8,12 @@
 
 #include <stdint.h>
 
-/* Font data: 10 digits (0-9), each 8 bytes */
-/* Indexed by digit value (0-9) */
-extern const uint8_t game_font[10][8];
+/* Font data: 10 digits (0-9), each 8 bytes, twice */
+/* Indexed by nibble (0 = upper, 1 = lower), then digit value (0-9) */
+extern const uint8_t game_font[2][10][8];
+
+/* Marks a digit of update_number as not on screen */
+#define FONT_DIGIT_UNKNOWN 0xFF
 
 /* Font rendering functions */
 
@@ -23,4 +26,9 @@ void draw_digit(uint8_t x, uint8_t y, uint8_t digit);
  * leading_zeros: 1 = show leading zeros, 0 = suppress them */
 void draw_number(uint8_t x, uint8_t y, uint8_t number, uint8_t num_digits, uint8_t leading_zeros);
 
+/* Same as draw_number with leading zeros, but only draws the digits that
+ * differ from shown[], the num_digits digits on screen, left to right,
+ * then updates it; FONT_DIGIT_UNKNOWN forces a digit to be drawn */
+void update_number(uint8_t x, uint8_t y, uint8_t number, uint8_t num_digits, uint8_t* shown);
+
 #endif /* GAME_FONT_H */
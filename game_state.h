@@ -9,6 +9,9 @@
 #ifdef PHC25
 #include "phc25.h"
 #endif
+#ifdef HOST
+#include "host.h"
+#endif
 
 // Abstract cell type constants - platform agnostic
 #define CELL_EMPTY    0
@@ -38,8 +41,12 @@
     ((cell) = ((content) & CELL_CONTENT_MASK) | CELL_DIRTY_FLAG)
 
 // Game state structure
+// The scalars are read and written every frame. A platform running a
+// single game can move them to faster memory by defining GAME_HOT_ADDR
+// (alice.h with DIRECT_PAGE); code reaches them through GAME_HOT().
 typedef struct game_state_t {
     uint8_t playfield[PLAYFIELD_HEIGHT][PLAYFIELD_WIDTH];
+#ifndef GAME_HOT_ADDR
     uint8_t score;
     uint8_t level;
     uint8_t speed;
@@ -47,6 +54,32 @@ typedef struct game_state_t {
     uint8_t next_piece;
     uint8_t x, y;
     uint8_t rotation;
+#endif
 } game_state_t;
 
+#ifdef GAME_HOT_ADDR
+typedef struct game_hot_t {
+    uint8_t score;
+    uint8_t level;
+    uint8_t speed;
+    uint8_t piece;
+    uint8_t next_piece;
+    uint8_t x, y;
+    uint8_t rotation;
+} game_hot_t;
+
+#define GAME_HOT(state) ((game_hot_t*)GAME_HOT_ADDR)
+#else
+#define GAME_HOT(state) (state)
+#endif
+
+// Cell (x, y). With PLAYFIELD_ROWS_ADDR, a table of row offsets there
+// (filled by playfield_rows_init) replaces the multiply by the width.
+#ifdef PLAYFIELD_ROWS_ADDR
+#define PLAYFIELD_ROWS ((uint8_t*)PLAYFIELD_ROWS_ADDR)
+#define PLAYFIELD_CELL(state, x, y) (((uint8_t*)(state)->playfield)[PLAYFIELD_ROWS[y] + (x)])
+#else
+#define PLAYFIELD_CELL(state, x, y) ((state)->playfield[y][x])
+#endif
+
 #endif // GAME_STATE_H
\ No newline at end of file
@@ -0,0 +1,45 @@
+/* Generated from alice_screen.txt by tools/pack_screen.py */
+/* Runs: R6, R7, length, then R2 and R3 if R6 has ALICE_SCREEN_ATTRIBUTES, */
+/* then length codes; ALICE_SCREEN_END ends them */
+
+#ifndef GFX_ALICE_SCREEN_H
+#define GFX_ALICE_SCREEN_H
+
+#define ALICE_SCREEN_ATTRIBUTES 0x80
+#define ALICE_SCREEN_END 0xFF
+
+static const uint8_t alice_screen[] = {
+    0x92, 0x02, 0x07, 0x00, 0x70, 0x4F, 0x3A, 0x20, 0x4C, 0x45, 0x46, 0x54,
+    0x13, 0x02, 0x08, 0x50, 0x3A, 0x20, 0x52, 0x49, 0x47, 0x48, 0x54, 0x14,
+    0x02, 0x09, 0x5A, 0x3A, 0x20, 0x52, 0x4F, 0x54, 0x41, 0x54, 0x45, 0x15,
+    0x02, 0x0B, 0x41, 0x3A, 0x20, 0x55, 0x4E, 0x52, 0x4F, 0x54, 0x41, 0x54,
+    0x45, 0x16, 0x02, 0x0B, 0x53, 0x50, 0x41, 0x43, 0x45, 0x3A, 0x20, 0x44,
+    0x52, 0x4F, 0x50, 0x80, 0x09, 0x18, 0x01, 0x30, 0x54, 0x65, 0x74, 0x72,
+    0x69, 0x73, 0x20, 0x2B, 0x20, 0x41, 0x6C, 0x69, 0x63, 0x65, 0x20, 0x3D,
+    0x20, 0x54, 0x45, 0x54, 0x52, 0x49, 0x43, 0x45, 0x89, 0x1D, 0x05, 0x01,
+    0x70, 0x53, 0x43, 0x4F, 0x52, 0x45, 0x0C, 0x1D, 0x05, 0x4C, 0x45, 0x56,
+    0x45, 0x4C, 0x0F, 0x1D, 0x04, 0x4E, 0x45, 0x58, 0x54, 0x89, 0x00, 0x0D,
+    0x20, 0x30, 0x6B, 0x41, 0x77, 0x41, 0x6B, 0x41, 0x66, 0x55, 0x55, 0x57,
+    0x41, 0x77, 0x41, 0x0A, 0x00, 0x0D, 0x4A, 0x40, 0x4D, 0x44, 0x4A, 0x40,
+    0x45, 0x45, 0x45, 0x4D, 0x44, 0x4D, 0x44, 0x88, 0x0E, 0x0E, 0x20, 0x50,
+    0x60, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70, 0x70,
+    0x70, 0x50, 0x09, 0x0E, 0x01, 0x6A, 0x09, 0x1B, 0x01, 0x55, 0x0A, 0x0E,
+    0x01, 0x6A, 0x0A, 0x1B, 0x01, 0x55, 0x0B, 0x0E, 0x01, 0x6A, 0x0B, 0x1B,
+    0x01, 0x55, 0x0C, 0x0E, 0x01, 0x6A, 0x0C, 0x1B, 0x01, 0x55, 0x0D, 0x0E,
+    0x01, 0x6A, 0x0D, 0x1B, 0x01, 0x55, 0x0E, 0x0E, 0x01, 0x6A, 0x0E, 0x1B,
+    0x01, 0x55, 0x0F, 0x0E, 0x01, 0x6A, 0x0F, 0x1B, 0x01, 0x55, 0x10, 0x0E,
+    0x01, 0x6A, 0x10, 0x1B, 0x01, 0x55, 0x11, 0x0E, 0x01, 0x6A, 0x11, 0x1B,
+    0x01, 0x55, 0x12, 0x0E, 0x01, 0x6A, 0x12, 0x1B, 0x01, 0x55, 0x13, 0x0E,
+    0x01, 0x6A, 0x13, 0x1B, 0x01, 0x55, 0x14, 0x0E, 0x01, 0x6A, 0x14, 0x1B,
+    0x01, 0x55, 0x15, 0x0E, 0x01, 0x6A, 0x15, 0x1B, 0x01, 0x55, 0x16, 0x0E,
+    0x01, 0x6A, 0x16, 0x1B, 0x01, 0x55, 0x17, 0x0E, 0x01, 0x6A, 0x17, 0x1B,
+    0x01, 0x55, 0x18, 0x0E, 0x01, 0x6A, 0x18, 0x1B, 0x01, 0x55, 0x19, 0x0E,
+    0x01, 0x6A, 0x19, 0x1B, 0x01, 0x55, 0x1A, 0x0E, 0x01, 0x6A, 0x1A, 0x1B,
+    0x01, 0x55, 0x1B, 0x0E, 0x01, 0x6A, 0x1B, 0x1B, 0x01, 0x55, 0x1C, 0x0E,
+    0x01, 0x6A, 0x1C, 0x1B, 0x01, 0x55, 0x1D, 0x0E, 0x01, 0x6A, 0x1D, 0x1B,
+    0x01, 0x55, 0x1E, 0x0E, 0x01, 0x6A, 0x1E, 0x1B, 0x01, 0x55, 0x1F, 0x0E,
+    0x0E, 0x42, 0x43, 0x43, 0x43, 0x43, 0x43, 0x43, 0x43, 0x43, 0x43, 0x43,
+    0x43, 0x43, 0x41, 0xFF
+};
+
+#endif /* GFX_ALICE_SCREEN_H */
@@ -0,0 +1,10 @@
+/* Generated from assets.txt by tools/pack_assets.py */
+
+#ifndef GFX_ASSETS_H
+#define GFX_ASSETS_H
+
+#define ASSET_SCREEN 0
+#define ASSET_GAMEOVER 1
+#define ASSET_COUNT 2
+
+#endif /* GFX_ASSETS_H */
@@ -0,0 +1,36 @@
+/* Generated from the digit sprite sheet by tools/extract_font.py */
+/* Each digit is 4x8 pixels, stored as 8 bytes, MSB = leftmost pixel. */
+/* game_font[0] has them in the upper nibble, game_font[1] in the lower */
+/* one: draw_digit takes game_font[(x >> 2) & 1] and only masks and ORs. */
+
+#ifndef GFX_FONT_H
+#define GFX_FONT_H
+
+const uint8_t game_font[2][10][8] = {
+    {
+        { 0x80, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0x80, 0xF0 },  /* '0' */
+        { 0x90, 0xD0, 0xD0, 0xD0, 0xD0, 0xD0, 0x80, 0xF0 },  /* '1' */
+        { 0x80, 0xA0, 0xE0, 0x80, 0xB0, 0xB0, 0x80, 0xF0 },  /* '2' */
+        { 0x80, 0xE0, 0x80, 0xE0, 0xA0, 0xA0, 0x80, 0xF0 },  /* '3' */
+        { 0xA0, 0xA0, 0xA0, 0x80, 0xE0, 0xE0, 0xE0, 0xF0 },  /* '4' */
+        { 0x80, 0xB0, 0x80, 0xE0, 0xA0, 0xA0, 0x80, 0xF0 },  /* '5' */
+        { 0x80, 0xA0, 0xB0, 0x80, 0xA0, 0xA0, 0x80, 0xF0 },  /* '6' */
+        { 0x80, 0xA0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xF0 },  /* '7' */
+        { 0x80, 0xA0, 0xA0, 0x80, 0xA0, 0xA0, 0x80, 0xF0 },  /* '8' */
+        { 0x80, 0xA0, 0xA0, 0x80, 0xE0, 0xA0, 0x80, 0xF0 }  /* '9' */
+    },
+    {
+        { 0x08, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x08, 0x0F },  /* '0' */
+        { 0x09, 0x0D, 0x0D, 0x0D, 0x0D, 0x0D, 0x08, 0x0F },  /* '1' */
+        { 0x08, 0x0A, 0x0E, 0x08, 0x0B, 0x0B, 0x08, 0x0F },  /* '2' */
+        { 0x08, 0x0E, 0x08, 0x0E, 0x0A, 0x0A, 0x08, 0x0F },  /* '3' */
+        { 0x0A, 0x0A, 0x0A, 0x08, 0x0E, 0x0E, 0x0E, 0x0F },  /* '4' */
+        { 0x08, 0x0B, 0x08, 0x0E, 0x0A, 0x0A, 0x08, 0x0F },  /* '5' */
+        { 0x08, 0x0A, 0x0B, 0x08, 0x0A, 0x0A, 0x08, 0x0F },  /* '6' */
+        { 0x08, 0x0A, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0F },  /* '7' */
+        { 0x08, 0x0A, 0x0A, 0x08, 0x0A, 0x0A, 0x08, 0x0F },  /* '8' */
+        { 0x08, 0x0A, 0x0A, 0x08, 0x0E, 0x0A, 0x08, 0x0F }  /* '9' */
+    }
+};
+
+#endif /* GFX_FONT_H */
@@ -0,0 +1,91 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+/************************************************************/
+/* Host (Linux/macOS) build                                 */
+/* Runs the engine natively for bots, tools and frontends.  */
+/************************************************************/
+
+// Each thread can run its own games
+#define PLATFORM_TLS __thread
+
+// The engine's sleep() is not POSIX sleep(), keep them apart so host
+// tools can include <unistd.h> (system headers go first)
+#define sleep host_sleep
+
+#define POKE(addr, value) (*((volatile uint8_t *)(addr)) = (value))
+#define PEEK(addr) (*((volatile uint8_t *)(addr)))
+
+// Color codes (same numbering as the EF9345 on Alice)
+#define black 0
+#define red 1
+#define green 2
+#define orange 3
+#define blue 4
+#define magenta 5
+#define cyan 6
+#define pink 7
+#define lgreen 10
+#define yellow 11
+#define lmagenta 13
+#define white 15
+
+// Playfield dimensions - default to the PHC-25 geometry, can be
+// overridden from the command line to mirror the Alice (12x22)
+#ifndef PLAYFIELD_WIDTH
+#define PLAYFIELD_WIDTH 10
+#endif
+#ifndef PLAYFIELD_HEIGHT
+#define PLAYFIELD_HEIGHT 22
+#endif
+
+// Display layout configuration (character cells)
+#define PLAYFIELD_START_X 15
+#define PLAYFIELD_START_Y 2
+#define UI_START_X (PLAYFIELD_START_X + PLAYFIELD_WIDTH + 2)
+
+// Piece starting position (playfield coordinates), the PHC-25's as
+// well; the Alice spawns one row higher (-DPIECE_START_Y=0)
+#ifndef PIECE_START_X
+#define PIECE_START_X 5
+#endif
+#ifndef PIECE_START_Y
+#define PIECE_START_Y 1
+#endif
+
+// Derived constants
+#define PLAYFIELD_END_X (PLAYFIELD_START_X + PLAYFIELD_WIDTH - 1)
+
+// Input anti-bounce settings (unused on host, kept for parity)
+#define INPUT_LATERAL_SKIP 0
+#define INPUT_ROTATION_SKIP 0
+
+/************************************************************/
+/* Host random number generator                             */
+/************************************************************/
+
+#include "host/rng.h"
+
+/************************************************************/
+/* Host hooks                                               */
+/* Headless by default: no input, no display. Frontends     */
+/* install their own callbacks.                             */
+/************************************************************/
+
+struct game_state_t;
+
+typedef struct host_display_ops_t {
+    void (*sync_playfield)(struct game_state_t* state);
+    void (*sync_ui)(struct game_state_t* state);
+    void (*preview_piece)(uint8_t piece);
+    void (*clear_screen)(void);
+    void (*draw_borders)(void);
+    void (*game_over)(void);
+} host_display_ops_t;
+
+extern const host_display_ops_t* host_display;
+extern uint8_t (*host_input)(void);
+
+#endif // HOST_H
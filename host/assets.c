@@ -0,0 +1,37 @@
+/* assets.c - The PHC-25 asset bank */
+
+#include <stdio.h>
+
+#include "assets.h"
+
+int assets_load(const char* path, assets_t* assets)
+{
+    FILE* f = fopen(path, "rb");
+    size_t size, offset;
+    uint8_t i;
+
+    if (!f) {
+        fprintf(stderr, "assets: cannot read %s\n", path);
+        return -1;
+    }
+    size = fread(assets->data, 1, sizeof(assets->data), f);
+    fclose(f);
+
+    assets->count = size ? assets->data[0] : 0;
+    offset = 1 + 2 * (size_t)assets->count;
+    if (assets->count == 0 || offset > size) {
+        fprintf(stderr, "assets: %s is not an asset bank\n", path);
+        return -1;
+    }
+    for (i = 0; i < assets->count; i++) {
+        assets->bytes_per_row[i] = assets->data[1 + 2 * i];
+        assets->height[i] = assets->data[2 + 2 * i];
+        assets->bitmap[i] = assets->data + offset;
+        offset += (size_t)assets->bytes_per_row[i] * assets->height[i];
+    }
+    if (offset != size) {
+        fprintf(stderr, "assets: %s holds %zu bytes, its sizes add up to %zu\n", path, size, offset);
+        return -1;
+    }
+    return 0;
+}
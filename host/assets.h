@@ -0,0 +1,26 @@
+/* assets.h - The PHC-25 asset bank                                */
+/* gfx/assets.bin as tools/pack_assets.py writes it from the       */
+/* gfx/assets.txt manifest: the count, the bytes per row and the   */
+/* height of each asset, then their Mode 12 bitmaps in that order. */
+
+#ifndef HOST_ASSETS_H
+#define HOST_ASSETS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ASSETS_MAX 255
+#define ASSETS_FILE_MAX 65536
+
+typedef struct assets_t {
+    uint8_t count;
+    uint8_t bytes_per_row[ASSETS_MAX];
+    uint8_t height[ASSETS_MAX];
+    const uint8_t* bitmap[ASSETS_MAX];
+    uint8_t data[ASSETS_FILE_MAX];  /* The file the bitmaps point into */
+} assets_t;
+
+/* Reads the bank at path, returns 0 or -1 with the reason on stderr */
+int assets_load(const char* path, assets_t* assets);
+
+#endif /* HOST_ASSETS_H */
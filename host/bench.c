@@ -0,0 +1,571 @@
+/* bench.c - Microbenchmarks of the engine kernels on board fixtures */
+/* Each kernel is called in batches over a fixed set of arguments    */
+/* (every piece, rotation and position), after warm-up batches. The   */
+/* batch times give per-call mean and percentiles, plus TSC cycles on */
+/* x86. Replays give end-to-end frames per second. -j writes it all   */
+/* as JSON, one result per line, to diff between commits.             */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC 1
+#endif
+
+#include "engine.h"
+#include "replay.h"
+
+#define BENCH_MAX_FIXTURES 32
+#define BENCH_MAX_REPLAYS 16
+#define BENCH_MAX_ARGS 8192
+#define BENCH_NAME_SIZE 64
+
+typedef struct bench_options_t {
+    const char* fixture_dir;
+    const char* json_path;
+    uint32_t batches;
+    uint32_t batch_calls;
+    uint32_t warmup;
+    uint32_t replay_runs;
+    const char* replays[BENCH_MAX_REPLAYS];
+    uint32_t replay_count;
+} bench_options_t;
+
+typedef struct bench_fixture_t {
+    char name[BENCH_NAME_SIZE];
+    game_state_t state;
+} bench_fixture_t;
+
+/* One call's arguments */
+typedef struct bench_args_t {
+    uint8_t piece, x, y, rotation, extra;
+} bench_args_t;
+
+typedef struct bench_result_t {
+    const char* kernel;
+    const char* fixture;
+    uint64_t calls;
+    double mean_ns, p50_ns, p90_ns, p99_ns, min_ns;
+    double cycles;
+} bench_result_t;
+
+typedef struct bench_t {
+    game_state_t state;             /* Board the kernel works on */
+    game_state_t saved;             /* Restored before kernels that modify it */
+    bench_args_t args[BENCH_MAX_ARGS];
+    uint32_t arg_count;
+    uint32_t next;
+} bench_t;
+
+typedef void (*bench_kernel_t)(bench_t* b);
+
+static bench_fixture_t fixtures[BENCH_MAX_FIXTURES];
+static uint32_t fixture_count = 0;
+static bench_t bench;
+static double* samples;
+static volatile uint32_t sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t cycles_now(void)
+{
+#ifdef BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/************************************************************/
+/* Fixtures                                                 */
+/************************************************************/
+
+static uint8_t cell_from_char(char c)
+{
+    static const char pieces[] = "OITSZJL";
+    const char* p = strchr(pieces, c);
+
+    if (c == '.' || c == '\0')
+        return CELL_EMPTY;
+    if (c == '#' || !p)
+        return CELL_PIECE_1;
+    return (uint8_t)(CELL_PIECE_1 + (p - pieces));
+}
+
+// Rows from the top, lines starting with '#' are comments; fewer rows than the
+// playfield are stacked on the floor, wider rows are cut to the build
+static int load_fixture(const char* path, bench_fixture_t* fixture)
+{
+    char lines[PLAYFIELD_HEIGHT * 2][64];
+    char line[256];
+    uint32_t count = 0, y, x, top;
+    size_t length;
+    FILE* f = fopen(path, "r");
+
+    if (!f)
+        return -1;
+    while (fgets(line, sizeof(line), f)) {
+        length = strcspn(line, "\r\n");
+        line[length] = '\0';
+        if (line[0] == '#' || length == 0)
+            continue;
+        if (count == PLAYFIELD_HEIGHT) {
+            fclose(f);
+            fprintf(stderr, "bench: %s has more than %d rows\n", path, PLAYFIELD_HEIGHT);
+            return -1;
+        }
+        if (length >= sizeof(lines[0]))
+            length = sizeof(lines[0]) - 1;
+        memcpy(lines[count], line, length);
+        lines[count++][length] = '\0';
+    }
+    fclose(f);
+
+    memset(&fixture->state, 0, sizeof(fixture->state));
+    top = PLAYFIELD_HEIGHT - count;
+    for (y = 0; y < count; y++) {
+        length = strlen(lines[y]);
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            fixture->state.playfield[top + y][x] = cell_from_char(x < length ? lines[y][x] : '.');
+    }
+    fixture->state.level = 1;
+    fixture->state.speed = 1;
+    return 0;
+}
+
+static int compare_names(const void* a, const void* b)
+{
+    return strcmp(((const bench_fixture_t*)a)->name, ((const bench_fixture_t*)b)->name);
+}
+
+static int load_fixtures(const char* dir_path)
+{
+    char path[512];
+    struct dirent* entry;
+    size_t length;
+    DIR* dir = opendir(dir_path);
+
+    if (!dir) {
+        fprintf(stderr, "bench: cannot open fixture directory %s\n", dir_path);
+        return -1;
+    }
+    while ((entry = readdir(dir)) && fixture_count < BENCH_MAX_FIXTURES) {
+        length = strlen(entry->d_name);
+        if (length < 5 || length - 4 >= BENCH_NAME_SIZE || strcmp(entry->d_name + length - 4, ".txt"))
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+        if (load_fixture(path, &fixtures[fixture_count])) {
+            closedir(dir);
+            return -1;
+        }
+        memcpy(fixtures[fixture_count].name, entry->d_name, length - 4);
+        fixtures[fixture_count].name[length - 4] = '\0';
+        fixture_count++;
+    }
+    closedir(dir);
+    qsort(fixtures, fixture_count, sizeof(fixtures[0]), compare_names);
+    return fixture_count ? 0 : -1;
+}
+
+/************************************************************/
+/* Arguments                                                */
+/************************************************************/
+
+static void add_args(bench_t* b, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t extra)
+{
+    bench_args_t* a;
+
+    if (b->arg_count == BENCH_MAX_ARGS)
+        return;
+    a = &b->args[b->arg_count++];
+    a->piece = piece;
+    a->x = x;
+    a->y = y;
+    a->rotation = rotation;
+    a->extra = extra;
+}
+
+// Every piece, rotation and position; extra cycles through the variants
+static void args_all_positions(bench_t* b, uint8_t variants)
+{
+    uint8_t piece, rotation, x, y;
+    uint32_t n = 0;
+
+    b->arg_count = 0;
+    b->next = 0;
+    for (piece = 0; piece < NB_PIECES; piece++)
+        for (rotation = 0; rotation < tetrominos_nb_shapes[piece]; rotation++)
+            for (y = 0; y < PLAYFIELD_HEIGHT; y++)
+                for (x = 0; x < PLAYFIELD_WIDTH; x++)
+                    add_args(b, piece, x, y, rotation, (uint8_t)(n++ % variants));
+}
+
+// Positions where the piece lies inside the board, on any cells
+static void args_inside(bench_t* b)
+{
+    packed_tetromino* t;
+    uint8_t piece, rotation, x, y, i, inside;
+
+    b->arg_count = 0;
+    b->next = 0;
+    for (piece = 0; piece < NB_PIECES; piece++)
+        for (rotation = 0; rotation < tetrominos_nb_shapes[piece]; rotation++)
+            for (y = 0; y < PLAYFIELD_HEIGHT; y++)
+                for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+                    t = GET_TETROMINO(piece, rotation);
+                    inside = 1;
+                    for (i = 0; i < 4; i++)
+                        if (x + GET_BLOCK_X((*t)[i]) >= PLAYFIELD_WIDTH || y + GET_BLOCK_Y((*t)[i]) >= PLAYFIELD_HEIGHT)
+                            inside = 0;
+                    if (inside)
+                        add_args(b, piece, x, y, rotation, 0);
+                }
+}
+
+static const bench_args_t* next_args(bench_t* b)
+{
+    const bench_args_t* a = &b->args[b->next];
+
+    if (++b->next == b->arg_count)
+        b->next = 0;
+    return a;
+}
+
+/************************************************************/
+/* Kernels                                                  */
+/************************************************************/
+
+static void kernel_collision(bench_t* b)
+{
+    const bench_args_t* a = next_args(b);
+
+    switch (a->extra) {
+    case 0: sink += collision_left(&b->state, a->piece, a->x, a->y, a->rotation); break;
+    case 1: sink += collision_right(&b->state, a->piece, a->x, a->y, a->rotation); break;
+    default: sink += collision_bottom(&b->state, a->piece, a->x, a->y, a->rotation); break;
+    }
+}
+
+static void kernel_rotation(bench_t* b)
+{
+    const bench_args_t* a = next_args(b);
+
+    sink += check_rotation(&b->state, a->piece, a->x, a->y, a->rotation, a->extra);
+}
+
+static void kernel_restore(bench_t* b)
+{
+    memcpy(b->state.playfield, b->saved.playfield, sizeof(b->state.playfield));
+    sink += b->state.playfield[PLAYFIELD_HEIGHT - 1][0];
+}
+
+static void kernel_full_lines(bench_t* b)
+{
+    memcpy(b->state.playfield, b->saved.playfield, sizeof(b->state.playfield));
+    sink += check_full_lines(&b->state);
+}
+
+static void kernel_place(bench_t* b)
+{
+    const bench_args_t* a = next_args(b);
+
+    playfield_place_piece(&b->state, a->piece, a->x, a->y, a->rotation);
+    sink += b->state.playfield[a->y][a->x];
+}
+
+// saved has every cell dirty: a full repaint
+static void kernel_sync_full(bench_t* b)
+{
+    memcpy(b->state.playfield, b->saved.playfield, sizeof(b->state.playfield));
+    display_sync_playfield(&b->state);
+    sink += b->state.playfield[0][0];
+}
+
+// Nothing dirty: the scan alone
+static void kernel_sync_clean(bench_t* b)
+{
+    display_sync_playfield(&b->state);
+    sink += b->state.playfield[0][0];
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, uint32_t count, double p)
+{
+    uint32_t i = (uint32_t)(p / 100.0 * (count - 1) + 0.5);
+    return sorted[i < count ? i : count - 1];
+}
+
+static void run_kernel(const bench_options_t* options, bench_kernel_t kernel, bench_result_t* r)
+{
+    uint64_t start, cycles, total_cycles = 0;
+    double sum = 0;
+    uint32_t i, j;
+
+    for (i = 0; i < options->warmup; i++)
+        for (j = 0; j < options->batch_calls; j++)
+            kernel(&bench);
+
+    for (i = 0; i < options->batches; i++) {
+        start = now_ns();
+        cycles = cycles_now();
+        for (j = 0; j < options->batch_calls; j++)
+            kernel(&bench);
+        total_cycles += cycles_now() - cycles;
+        samples[i] = (double)(now_ns() - start) / options->batch_calls;
+        sum += samples[i];
+    }
+    qsort(samples, options->batches, sizeof(double), compare_doubles);
+
+    r->calls = (uint64_t)options->batches * options->batch_calls;
+    r->mean_ns = sum / options->batches;
+    r->p50_ns = percentile(samples, options->batches, 50);
+    r->p90_ns = percentile(samples, options->batches, 90);
+    r->p99_ns = percentile(samples, options->batches, 99);
+    r->min_ns = samples[0];
+    r->cycles = (double)total_cycles / r->calls;
+}
+
+/************************************************************/
+/* Replays                                                  */
+/************************************************************/
+
+static const uint8_t* map_replay(const char* path, size_t* size)
+{
+    struct stat st;
+    void* data;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+    *size = (size_t)st.st_size;
+    return data;
+}
+
+// Whole games through game_step and the display hooks, best of the runs
+static int run_replay(const char* path, uint32_t runs, uint32_t* frames, double* best_fps, double* mean_fps)
+{
+    replay_player_t player;
+    input_action_t input;
+    game_state_t state;
+    host_rng_t rng;
+    const uint8_t* data;
+    size_t size = 0;
+    uint64_t start;
+    double fps, sum = 0;
+    uint32_t run, frame;
+
+    data = map_replay(path, &size);
+    if (!data || replay_player_open(&player, data, size) != REPLAY_OK) {
+        fprintf(stderr, "bench: %s is not a replay for this build\n", path);
+        return -1;
+    }
+
+    *best_fps = 0;
+    for (run = 0; run < runs; run++) {
+        replay_player_open(&player, data, size);
+        frame = 0;
+        start = now_ns();
+        display_clear_screen();
+        display_draw_borders();
+        replay_game_start(&state, &rng, player.seed);
+        display_sync_ui(&state);
+        display_preview_piece(state.next_piece);
+        display_sync_playfield(&state);
+        while (replay_player_next(&player, &input)) {
+            frame++;
+            if (game_step(&state, input)) {
+                display_game_over();
+                break;
+            }
+        }
+        fps = frame / ((now_ns() - start) * 1e-9);
+        sum += fps;
+        if (fps > *best_fps)
+            *best_fps = fps;
+        *frames = frame;
+    }
+    host_rng_bind(NULL);
+    *mean_fps = sum / runs;
+    munmap((void*)data, size);
+    return 0;
+}
+
+/************************************************************/
+/* Main                                                     */
+/************************************************************/
+
+static void usage(void)
+{
+    printf("Usage: tetrice_bench [options]\n");
+    printf("  -x DIR      board fixtures, one .txt per board (default host/fixtures)\n");
+    printf("  -b N        timed batches per kernel (default 200)\n");
+    printf("  -c N        calls per batch (default 1024)\n");
+    printf("  -w N        warm-up batches (default 20)\n");
+    printf("  -r FILE     also play this replay end to end (repeatable, up to %d)\n", BENCH_MAX_REPLAYS);
+    printf("  -R N        runs per replay (default 5)\n");
+    printf("  -j FILE     write the results as JSON\n");
+}
+
+int main(int argc, char** argv)
+{
+    static const struct {
+        const char* name;
+        bench_kernel_t kernel;
+    } kernels[] = {
+        { "check_collision", kernel_collision },
+        { "check_rotation", kernel_rotation },
+        { "check_full_lines", kernel_full_lines },
+        { "restore_playfield", kernel_restore },
+        { "playfield_place_piece", kernel_place },
+        { "display_sync_playfield_full", kernel_sync_full },
+        { "display_sync_playfield_clean", kernel_sync_clean },
+    };
+    const uint32_t kernel_count = sizeof(kernels) / sizeof(kernels[0]);
+    bench_options_t options;
+    bench_result_t* results;
+    bench_result_t* r;
+    uint32_t i, k, x, y, n = 0, frames = 0;
+    double best_fps, mean_fps;
+    FILE* json = NULL;
+
+    memset(&options, 0, sizeof(options));
+    options.fixture_dir = "host/fixtures";
+    options.batches = 200;
+    options.batch_calls = 1024;
+    options.warmup = 20;
+    options.replay_runs = 5;
+
+    for (i = 1; (int)i < argc; i++) {
+        const char* value = ((int)i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 'x': options.fixture_dir = value; break;
+        case 'b': options.batches = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'c': options.batch_calls = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'w': options.warmup = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'R': options.replay_runs = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'j': options.json_path = value; break;
+        case 'r':
+            if (options.replay_count < BENCH_MAX_REPLAYS)
+                options.replays[options.replay_count++] = value;
+            break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+    if (!options.batches || !options.batch_calls || !options.replay_runs) {
+        usage();
+        return 1;
+    }
+
+    if (load_fixtures(options.fixture_dir))
+        return 1;
+    samples = malloc(options.batches * sizeof(double));
+    results = calloc((size_t)fixture_count * kernel_count, sizeof(bench_result_t));
+    if (!samples || !results)
+        return 1;
+
+    printf("%dx%d playfield, headless display, %u batches of %u calls%s\n", PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT,
+           options.batches, options.batch_calls,
+#ifdef BENCH_TSC
+           ", cycles are TSC ticks"
+#else
+           ", no cycle counter"
+#endif
+    );
+    printf("%-30s %-16s %9s %9s %9s %9s %9s\n", "kernel", "fixture", "mean ns", "p50", "p90", "p99", "cycles");
+
+    for (k = 0; k < kernel_count; k++) {
+        for (i = 0; i < fixture_count; i++) {
+            bench.state = fixtures[i].state;
+            bench.saved = fixtures[i].state;
+            if (kernels[k].kernel == kernel_sync_full)
+                for (y = 0; y < PLAYFIELD_HEIGHT; y++)
+                    for (x = 0; x < PLAYFIELD_WIDTH; x++)
+                        SET_CELL_DIRTY(bench.saved.playfield[y][x]);
+            if (kernels[k].kernel == kernel_collision)
+                args_all_positions(&bench, 3);
+            else if (kernels[k].kernel == kernel_rotation)
+                args_all_positions(&bench, 2);
+            else
+                args_inside(&bench);
+
+            r = &results[n++];
+            r->kernel = kernels[k].name;
+            r->fixture = fixtures[i].name;
+            run_kernel(&options, kernels[k].kernel, r);
+            printf("%-30s %-16s %9.2f %9.2f %9.2f %9.2f %9.1f\n", r->kernel, r->fixture, r->mean_ns, r->p50_ns,
+                   r->p90_ns, r->p99_ns, r->cycles);
+        }
+    }
+
+    if (options.json_path) {
+        json = fopen(options.json_path, "w");
+        if (!json) {
+            fprintf(stderr, "bench: cannot write %s\n", options.json_path);
+            return 1;
+        }
+        fprintf(json, "{\"playfield\": \"%dx%d\", \"batches\": %u, \"batch_calls\": %u,\n",
+                PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT, options.batches, options.batch_calls);
+        fprintf(json, " \"kernels\": [\n");
+        for (i = 0; i < n; i++) {
+            r = &results[i];
+            fprintf(json, "  {\"kernel\": \"%s\", \"fixture\": \"%s\", \"calls\": %llu, \"mean_ns\": %.3f, "
+                    "\"p50_ns\": %.3f, \"p90_ns\": %.3f, \"p99_ns\": %.3f, \"min_ns\": %.3f, \"cycles\": %.1f}%s\n",
+                    r->kernel, r->fixture, (unsigned long long)r->calls, r->mean_ns, r->p50_ns, r->p90_ns,
+                    r->p99_ns, r->min_ns, r->cycles, i + 1 < n ? "," : "");
+        }
+        fprintf(json, " ],\n \"replays\": [\n");
+    }
+
+    if (options.replay_count)
+        printf("\n%-30s %9s %12s %12s\n", "replay", "frames", "best fps", "mean fps");
+    for (i = 0; i < options.replay_count; i++) {
+        if (run_replay(options.replays[i], options.replay_runs, &frames, &best_fps, &mean_fps))
+            return 1;
+        printf("%-30s %9u %12.0f %12.0f\n", options.replays[i], frames, best_fps, mean_fps);
+        if (json)
+            fprintf(json, "  {\"replay\": \"%s\", \"frames\": %u, \"best_fps\": %.0f, \"mean_fps\": %.0f}%s\n",
+                    options.replays[i], frames, best_fps, mean_fps, i + 1 < options.replay_count ? "," : "");
+    }
+
+    if (json) {
+        fprintf(json, " ]}\n");
+        fclose(json);
+    }
+    free(results);
+    free(samples);
+    return 0;
+}
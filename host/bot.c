@@ -0,0 +1,427 @@
+/* bot.c - Reference beam-search player for soak tests and benchmarks */
+/* Plays whole games through game_step with the engine's own rules, */
+/* then reports search throughput and thread scaling.               */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "engine.h"
+#include "search.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "spectate.h"
+
+/* Inputs one placement can take: rotations, shifts, then gravity */
+#define BOT_MAX_MOVE_INPUTS (4 + PLAYFIELD_WIDTH + PLAYFIELD_HEIGHT)
+
+typedef struct bot_options_t {
+    uint32_t seed;
+    uint32_t games;
+    uint32_t max_pieces;
+    int threads;
+    uint8_t scale;
+    uint32_t tt_megabytes;
+    const char* record_dir;
+    const char* spectate_name;
+    uint32_t fps;
+    search_params_t params;
+} bot_options_t;
+
+typedef struct game_result_t {
+    uint32_t pieces;
+    uint32_t points;        /* Sum of score increments, does not wrap */
+    uint8_t score;
+    uint8_t level;
+    uint8_t game_over;
+    replay_recorder_t* recorder;    /* Optional, records every input */
+    snapshot_ring_t* history;       /* Optional, one snapshot per frame */
+    host_rng_t* rng;                /* The game's generator */
+    uint32_t frames;
+    uint8_t move_inputs[BOT_MAX_MOVE_INPUTS];
+    uint8_t move_length;
+    uint32_t rollbacks;             /* Moves rolled back and replayed */
+    uint32_t rollback_mismatches;   /* Replays that did not end identically */
+    uint64_t frame_ns;              /* Pace frames for spectators, 0 = full speed */
+    uint64_t next_frame_at;
+} game_result_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Hold each frame until its slot so spectators see the game in real time
+static void bot_pace(game_result_t* result)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (!result->next_frame_at)
+        result->next_frame_at = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    result->next_frame_at += result->frame_ns;
+    ts.tv_sec = (time_t)(result->next_frame_at / 1000000000u);
+    ts.tv_nsec = (long)(result->next_frame_at % 1000000000u);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+/************************************************************/
+/* Driving the engine                                       */
+/************************************************************/
+
+// Feed one input to the engine, keeping track of the score
+static uint8_t bot_step(game_state_t* state, input_action_t input, game_result_t* result)
+{
+    uint8_t previous = state->score;
+    uint8_t over;
+
+    if (result->history)
+        snapshot_ring_capture(result->history, state, result->rng, result->frames);
+    if (result->move_length < BOT_MAX_MOVE_INPUTS)
+        result->move_inputs[result->move_length++] = (uint8_t)input;
+    result->frames++;
+    if (result->frame_ns)
+        bot_pace(result);
+
+    over = result->recorder ? replay_recorder_step(result->recorder, state, input)
+                                    : game_step(state, input);
+
+    result->points += (uint8_t)(state->score - previous);
+    return over;
+}
+
+// Turn a placement into inputs, return 1 if the game ended
+static uint8_t bot_play_move(game_state_t* state, const search_move_t* move, game_result_t* result)
+{
+    uint8_t i, old;
+
+    result->move_length = 0;
+    for (i = 0; i < move->rotation; i++) {
+        if (bot_step(state, INPUT_ROTATE_CW, result))
+            return 1;
+    }
+    while (state->x > move->x) {
+        old = state->x;
+        if (bot_step(state, INPUT_MOVE_LEFT, result))
+            return 1;
+        if (state->x == old)
+            break;  // Blocked
+    }
+    while (state->x < move->x) {
+        old = state->x;
+        if (bot_step(state, INPUT_MOVE_RIGHT, result))
+            return 1;
+        if (state->x == old)
+            break;
+    }
+
+    // Let gravity bring it down; any jump other than y+1 means it locked
+    while (1) {
+        old = state->y;
+        if (bot_step(state, INPUT_TIMEOUT, result))
+            return 1;
+        if (state->y != (uint8_t)(old + 1))
+            return 0;
+    }
+}
+
+// Roll the last move back and play it again: the game must end up identical
+static void bot_check_rollback(game_state_t* state, game_result_t* result)
+{
+    game_snapshot_t played, replayed;
+    uint8_t i, n = result->move_length;
+
+    if (n == 0 || n == BOT_MAX_MOVE_INPUTS)
+        return;
+    snapshot_capture(&played, state, result->rng, result->frames);
+
+    // Back to the frame before the first input of the move
+    if (!snapshot_ring_rewind(result->history, n - 1, state, result->rng))
+        return;
+    for (i = 0; i < n; i++) {
+        if (i)
+            snapshot_ring_capture(result->history, state, result->rng, played.frame - n + i);
+        game_step(state, (input_action_t)result->move_inputs[i]);
+    }
+    snapshot_capture(&replayed, state, result->rng, played.frame);
+
+    result->rollbacks++;
+    if (!snapshot_equal(&played, &replayed))
+        result->rollback_mismatches++;
+}
+
+static void save_replay(replay_recorder_t* recorder, const char* dir, const game_state_t* state,
+                        uint32_t seed, uint8_t game_over)
+{
+    char path[4096];
+    uint8_t* data;
+    size_t size;
+
+    snprintf(path, sizeof(path), "%s/seed-%u.trpl", dir, seed);
+    if (replay_recorder_finish(recorder, state, game_over, &data, &size) || replay_write_file(path, data, size))
+        fprintf(stderr, "bot: cannot write %s\n", path);
+    else
+        free(data);
+}
+
+static void play_game(search_t* search, const bot_options_t* options, uint32_t seed, replay_recorder_t* recorder,
+                      snapshot_ring_t* history, game_state_t* state, game_result_t* result)
+{
+    host_rng_t rng;
+    search_move_t move;
+
+    memset(result, 0, sizeof(*result));
+    result->recorder = recorder;
+    result->history = history;
+    result->rng = &rng;
+    result->frame_ns = options->fps ? 1000000000u / options->fps : 0;
+    if (history)
+        snapshot_ring_reset(history);
+    if (recorder)
+        replay_recorder_start(recorder, seed);
+
+    // With several games in flight the feed shows whichever claimed it first
+    spectate_follow(state);
+    replay_game_start(state, &rng, seed);
+
+    while (result->pieces < options->max_pieces) {
+        if (!search_best_move(search, state, &move) || bot_play_move(state, &move, result)) {
+            result->pieces++;
+            result->game_over = 1;
+            break;
+        }
+        result->pieces++;
+        if (history)
+            bot_check_rollback(state, result);
+    }
+
+    if (result->game_over)
+        display_game_over();
+    spectate_unfollow(state);
+
+    result->score = state->score;
+    result->level = state->level;
+    host_rng_bind(NULL);
+}
+
+/************************************************************/
+/* Runs                                                     */
+/************************************************************/
+
+typedef struct run_totals_t {
+    uint64_t nodes;
+    uint64_t steals;
+    uint64_t duplicates;
+    uint64_t eval_mismatches;
+    uint64_t hash_mismatches;
+    uint64_t rollbacks;
+    uint64_t rollback_mismatches;
+    tt_counters_t tt;
+    uint64_t checksum;      /* Folded game results, equal across thread counts */
+    double seconds;
+} run_totals_t;
+
+static int run_games(const bot_options_t* options, int threads, uint8_t verbose, run_totals_t* totals)
+{
+    ws_pool_t* pool;
+    ttable_t* tt = NULL;
+    search_t* search;
+    game_result_t result;
+    game_state_t state;
+    uint32_t g;
+    double start, elapsed;
+    uint64_t nodes_before;
+    replay_recorder_t record, *recorder = NULL;
+    snapshot_ring_t* history = NULL;
+
+    pool = ws_pool_create(threads, options->params.beam_width);
+    if (options->tt_megabytes)
+        tt = tt_create(options->tt_megabytes, threads);
+    search = (pool && (tt || !options->tt_megabytes)) ? search_create(pool, tt, &options->params) : NULL;
+    if (!search) {
+        fprintf(stderr, "bot: out of memory\n");
+        tt_destroy(tt);
+        ws_pool_destroy(pool);
+        return 1;
+    }
+
+    if (options->params.verify && !(history = malloc(sizeof(*history)))) {
+        fprintf(stderr, "bot: out of memory\n");
+        search_destroy(search);
+        tt_destroy(tt);
+        ws_pool_destroy(pool);
+        return 1;
+    }
+
+    if (options->record_dir) {
+        memset(&record, 0, sizeof(record));
+        recorder = &record;
+    }
+
+    memset(totals, 0, sizeof(*totals));
+    for (g = 0; g < options->games; g++) {
+        nodes_before = search_get_stats(search)->nodes;
+        start = now_seconds();
+        play_game(search, options, options->seed + g, recorder, history, &state, &result);
+        elapsed = now_seconds() - start;
+        if (recorder)
+            save_replay(recorder, options->record_dir, &state, options->seed + g, result.game_over);
+        totals->seconds += elapsed;
+        totals->rollbacks += result.rollbacks;
+        totals->rollback_mismatches += result.rollback_mismatches;
+        totals->checksum = totals->checksum * 1000003u + result.pieces * 65599u + result.points;
+
+        if (verbose) {
+            uint64_t nodes = search_get_stats(search)->nodes - nodes_before;
+            printf("game %u: seed %u pieces %u points %u score %u level %u %s, %llu nodes in %.3fs (%.0f nodes/s)\n",
+                   g + 1, options->seed + g, result.pieces, result.points, result.score, result.level,
+                   result.game_over ? "game over" : "piece limit",
+                   (unsigned long long)nodes, elapsed, elapsed > 0 ? nodes / elapsed : 0.0);
+        }
+    }
+
+    totals->nodes = search_get_stats(search)->nodes;
+    totals->steals = atomic_load(&pool->steals);
+    totals->duplicates = search_get_stats(search)->duplicates;
+    totals->eval_mismatches = search_get_stats(search)->eval_mismatches;
+    totals->hash_mismatches = search_get_stats(search)->hash_mismatches;
+    if (tt)
+        tt_get_counters(tt, &totals->tt);
+
+    if (recorder)
+        replay_recorder_free(recorder);
+    free(history);
+    search_destroy(search);
+    tt_destroy(tt);
+    ws_pool_destroy(pool);
+    return 0;
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_bot [options]\n");
+    printf("  -s SEED     first game seed (default 1)\n");
+    printf("  -g GAMES    number of games (default 1)\n");
+    printf("  -p PIECES   piece limit per game (default 1000)\n");
+    printf("  -w WIDTH    beam width (default 32)\n");
+    printf("  -d DEPTH    search depth, 2 = current + next piece (default 2)\n");
+    printf("  -t THREADS  worker threads (default 1)\n");
+    printf("  -m MB       transposition table size, 0 to disable (default 16)\n");
+    printf("  -r DIR      record each game as DIR/seed-N.trpl\n");
+    printf("  -P NAME     publish the game to a shared-memory spectator feed (e.g. %s)\n", SPECTATE_DEFAULT_NAME);
+    printf("  -F FPS      play at most FPS frames per second (default: full speed)\n");
+    printf("  -S          measure scaling from 1 to THREADS threads\n");
+    printf("  -V          check evaluation and Zobrist hashing against the references,\n"
+           "              and replay every move from a rolled back snapshot\n");
+}
+
+int main(int argc, char** argv)
+{
+    bot_options_t options;
+    run_totals_t totals, base;
+    int i, t;
+
+    options.seed = 1;
+    options.games = 1;
+    options.max_pieces = 1000;
+    options.threads = 1;
+    options.scale = 0;
+    options.params.beam_width = 32;
+    options.params.depth = 2;
+    options.tt_megabytes = 16;
+    options.record_dir = NULL;
+    options.spectate_name = NULL;
+    options.fps = 0;
+    options.params.verify = 0;
+
+    for (i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "-S")) {
+            options.scale = 1;
+            continue;
+        }
+        if (!strcmp(arg, "-V")) {
+            options.params.verify = 1;
+            continue;
+        }
+        if (arg[0] != '-' || !value || arg[2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (arg[1]) {
+        case 's': options.seed = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'g': options.games = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'p': options.max_pieces = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'w': options.params.beam_width = (uint16_t)atoi(value); break;
+        case 'd': options.params.depth = (uint8_t)atoi(value); break;
+        case 't': options.threads = atoi(value); break;
+        case 'm': options.tt_megabytes = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'r': options.record_dir = value; break;
+        case 'P': options.spectate_name = value; break;
+        case 'F': options.fps = (uint32_t)strtoul(value, NULL, 0); break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+    if (options.threads < 1)
+        options.threads = 1;
+
+    printf("tetrice bot: %dx%d playfield, beam %u, depth %u, seed %u, %u game(s)\n",
+           PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT, options.params.beam_width, options.params.depth,
+           options.seed, options.games);
+
+    if (options.spectate_name && spectate_open(options.spectate_name, NULL)) {
+        fprintf(stderr, "bot: cannot create spectator feed %s\n", options.spectate_name);
+        return 1;
+    }
+    // Unlink the segment on every exit path
+    atexit(spectate_close);
+
+    if (!options.scale) {
+        if (run_games(&options, options.threads, 1, &totals))
+            return 1;
+        printf("threads %d: %llu nodes in %.3fs, %.0f nodes/s, %llu steals\n",
+               options.threads, (unsigned long long)totals.nodes, totals.seconds,
+               totals.seconds > 0 ? totals.nodes / totals.seconds : 0.0,
+               (unsigned long long)totals.steals);
+        if (options.tt_megabytes) {
+            uint64_t probes = totals.tt.hits + totals.tt.misses;
+            printf("transposition table %u MB: %llu hits, %llu misses (%.1f%% hit rate), %llu stores, %llu replacements, %llu duplicate children\n",
+                   options.tt_megabytes, (unsigned long long)totals.tt.hits, (unsigned long long)totals.tt.misses,
+                   probes ? 100.0 * totals.tt.hits / probes : 0.0, (unsigned long long)totals.tt.stores,
+                   (unsigned long long)totals.tt.replacements, (unsigned long long)totals.duplicates);
+        }
+        if (options.params.verify) {
+            printf("evaluation check: %llu boards, %llu evaluation mismatches, %llu hash mismatches\n",
+                   (unsigned long long)totals.nodes, (unsigned long long)totals.eval_mismatches,
+                   (unsigned long long)totals.hash_mismatches);
+            printf("rollback check: %llu moves rolled back and replayed, %llu mismatches\n",
+                   (unsigned long long)totals.rollbacks, (unsigned long long)totals.rollback_mismatches);
+            return totals.eval_mismatches != 0 || totals.hash_mismatches != 0 || totals.rollback_mismatches != 0;
+        }
+        return 0;
+    }
+
+    // Scaling: identical games on 1..N threads, results must match
+    printf("threads   nodes/s  speedup  efficiency  steals  deterministic\n");
+    for (t = 1; t <= options.threads; t++) {
+        if (run_games(&options, t, t == 1, &totals))
+            return 1;
+        if (t == 1)
+            base = totals;
+        printf("%7d %9.0f %8.2f %10.0f%% %7llu  %s\n", t,
+               totals.seconds > 0 ? totals.nodes / totals.seconds : 0.0,
+               totals.seconds > 0 ? base.seconds / totals.seconds : 0.0,
+               totals.seconds > 0 ? 100.0 * base.seconds / totals.seconds / t : 0.0,
+               (unsigned long long)totals.steals,
+               (totals.checksum == base.checksum && totals.nodes == base.nodes) ? "yes" : "NO");
+    }
+    return 0;
+}
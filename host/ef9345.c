@@ -0,0 +1,224 @@
+/* ef9345.c - Software EF9345 as driven by the Alice */
+
+#include <string.h>
+
+#include "ef9345.h"
+
+#define KRF_INCREMENT 0x01          /* KRF, then move to the next column */
+
+/* Alphanumeric glyphs 0x20-0x7E, 5x7 in the top bits of each row.
+ * The EF9345 character ROM is not reproduced: this is a plain font in
+ * the same 8x10 cells, enough for the game's text. */
+static const uint8_t font_5x7[95][7] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  /*   */
+    {0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x20},  /* ! */
+    {0x50, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00},  /* " */
+    {0x50, 0x50, 0xF8, 0x50, 0xF8, 0x50, 0x50},  /* # */
+    {0x20, 0x78, 0xA0, 0x70, 0x28, 0xF0, 0x20},  /* $ */
+    {0xC0, 0xC8, 0x10, 0x20, 0x40, 0x98, 0x18},  /* % */
+    {0x60, 0x90, 0xA0, 0x40, 0xA8, 0x90, 0x68},  /* & */
+    {0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00},  /* ' */
+    {0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10},  /* ( */
+    {0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40},  /* ) */
+    {0x00, 0x20, 0xA8, 0x70, 0xA8, 0x20, 0x00},  /* star */
+    {0x00, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x00},  /* + */
+    {0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x40},  /* , */
+    {0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00},  /* - */
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60},  /* . */
+    {0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00},  /* slash */
+    {0x70, 0x88, 0x98, 0xA8, 0xC8, 0x88, 0x70},  /* 0 */
+    {0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70},  /* 1 */
+    {0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xF8},  /* 2 */
+    {0xF8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70},  /* 3 */
+    {0x10, 0x30, 0x50, 0x90, 0xF8, 0x10, 0x10},  /* 4 */
+    {0xF8, 0x80, 0xF0, 0x08, 0x08, 0x88, 0x70},  /* 5 */
+    {0x30, 0x40, 0x80, 0xF0, 0x88, 0x88, 0x70},  /* 6 */
+    {0xF8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40},  /* 7 */
+    {0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70},  /* 8 */
+    {0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60},  /* 9 */
+    {0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00},  /* : */
+    {0x00, 0x60, 0x60, 0x00, 0x60, 0x20, 0x40},  /* ; */
+    {0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10},  /* < */
+    {0x00, 0x00, 0xF8, 0x00, 0xF8, 0x00, 0x00},  /* = */
+    {0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40},  /* > */
+    {0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20},  /* ? */
+    {0x70, 0x88, 0x08, 0x68, 0xA8, 0xA8, 0x70},  /* @ */
+    {0x70, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88},  /* A */
+    {0xF0, 0x88, 0x88, 0xF0, 0x88, 0x88, 0xF0},  /* B */
+    {0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70},  /* C */
+    {0xE0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xE0},  /* D */
+    {0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8},  /* E */
+    {0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x80},  /* F */
+    {0x70, 0x88, 0x80, 0xB8, 0x88, 0x88, 0x78},  /* G */
+    {0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88},  /* H */
+    {0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70},  /* I */
+    {0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60},  /* J */
+    {0x88, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x88},  /* K */
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF8},  /* L */
+    {0x88, 0xD8, 0xA8, 0xA8, 0x88, 0x88, 0x88},  /* M */
+    {0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88},  /* N */
+    {0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70},  /* O */
+    {0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80, 0x80},  /* P */
+    {0x70, 0x88, 0x88, 0x88, 0xA8, 0x90, 0x68},  /* Q */
+    {0xF0, 0x88, 0x88, 0xF0, 0xA0, 0x90, 0x88},  /* R */
+    {0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xF0},  /* S */
+    {0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20},  /* T */
+    {0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70},  /* U */
+    {0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20},  /* V */
+    {0x88, 0x88, 0x88, 0xA8, 0xA8, 0xA8, 0x50},  /* W */
+    {0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88},  /* X */
+    {0x88, 0x88, 0x50, 0x20, 0x20, 0x20, 0x20},  /* Y */
+    {0xF8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xF8},  /* Z */
+    {0x70, 0x40, 0x40, 0x40, 0x40, 0x40, 0x70},  /* [ */
+    {0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00},  /* backslash */
+    {0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x70},  /* ] */
+    {0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00},  /* ^ */
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8},  /* _ */
+    {0x40, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00},  /* ` */
+    {0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78},  /* a */
+    {0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0xF0},  /* b */
+    {0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70},  /* c */
+    {0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78},  /* d */
+    {0x00, 0x00, 0x70, 0x88, 0xF8, 0x80, 0x70},  /* e */
+    {0x30, 0x48, 0x40, 0xE0, 0x40, 0x40, 0x40},  /* f */
+    {0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x70},  /* g */
+    {0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0x88},  /* h */
+    {0x20, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70},  /* i */
+    {0x10, 0x00, 0x30, 0x10, 0x10, 0x90, 0x60},  /* j */
+    {0x80, 0x80, 0x90, 0xA0, 0xC0, 0xA0, 0x90},  /* k */
+    {0x60, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70},  /* l */
+    {0x00, 0x00, 0xD0, 0xA8, 0xA8, 0x88, 0x88},  /* m */
+    {0x00, 0x00, 0xB0, 0xC8, 0x88, 0x88, 0x88},  /* n */
+    {0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70},  /* o */
+    {0x00, 0x00, 0xF0, 0x88, 0xF0, 0x80, 0x80},  /* p */
+    {0x00, 0x00, 0x68, 0x98, 0x78, 0x08, 0x08},  /* q */
+    {0x00, 0x00, 0xB0, 0xC8, 0x80, 0x80, 0x80},  /* r */
+    {0x00, 0x00, 0x70, 0x80, 0x70, 0x08, 0xF0},  /* s */
+    {0x40, 0x40, 0xE0, 0x40, 0x40, 0x48, 0x30},  /* t */
+    {0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68},  /* u */
+    {0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20},  /* v */
+    {0x00, 0x00, 0x88, 0x88, 0xA8, 0xA8, 0x50},  /* w */
+    {0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88},  /* x */
+    {0x00, 0x00, 0x88, 0x88, 0x78, 0x08, 0x70},  /* y */
+    {0x00, 0x00, 0xF8, 0x10, 0x20, 0x40, 0xF8},  /* z */
+    {0x10, 0x20, 0x20, 0x40, 0x20, 0x20, 0x10},  /* { */
+    {0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20},  /* | */
+    {0x40, 0x20, 0x20, 0x10, 0x20, 0x20, 0x40},  /* } */
+    {0x00, 0x00, 0x40, 0xA8, 0x10, 0x00, 0x00},  /* ~ */
+
+};
+
+void ef9345_reset(ef9345_t* vdp)
+{
+    memset(vdp, 0, sizeof(*vdp));
+}
+
+static void krf(ef9345_t* vdp, uint8_t increment)
+{
+    uint8_t line = vdp->r[6] & (EF9345_LINES - 1);
+    uint8_t column = vdp->r[7] & 0x3F;
+    ef9345_cell_t* cell;
+
+    if (column < EF9345_COLUMNS) {
+        cell = &vdp->screen[line][column];
+        cell->code = vdp->r[1];
+        cell->attributes = vdp->r[2];
+        cell->colors = vdp->r[3];
+    }
+    if (increment)
+        vdp->r[7] = (uint8_t)((column + 1) % EF9345_COLUMNS);
+}
+
+void ef9345_poke(ef9345_t* vdp, uint16_t address, uint8_t value)
+{
+    uint16_t offset = address - EF9345_REGISTER_BASE;
+
+    if (offset > EF9345_EXECUTE)
+        return;
+    if (offset < EF9345_EXECUTE) {
+        vdp->r[offset] = value;
+        return;
+    }
+
+    vdp->r[0] = value;
+    vdp->commands++;
+    if ((value & 0xFE) == 0)
+        krf(vdp, value & KRF_INCREMENT);
+    else
+        vdp->ignored++;
+}
+
+const ef9345_cell_t* ef9345_cell(const ef9345_t* vdp, uint8_t column, uint8_t row)
+{
+    return &vdp->screen[row ? row + 7 : 0][column];
+}
+
+// Mosaic bits 0-5 are the 2x3 blocks, left to right then top to bottom
+static uint8_t mosaic_row(uint8_t code, uint8_t y)
+{
+    uint8_t pair = y < 3 ? 0 : (y < 7 ? 1 : 2);
+    uint8_t bits = (code >> (pair * 2)) & 3;
+
+    return (uint8_t)((bits & 1 ? 0xF0 : 0) | (bits & 2 ? 0x0F : 0));
+}
+
+static uint8_t glyph_row(uint8_t code, uint8_t y)
+{
+    // The block the game draws its pieces with
+    if (code == 0x7F)
+        return 0xFF;
+    if (code < 0x20 || code > 0x7E || y < 1 || y > 7)
+        return 0;
+    return font_5x7[code - 0x20][y - 1] >> 1;
+}
+
+void ef9345_render(const ef9345_t* vdp, uint8_t* pixels)
+{
+    const ef9345_cell_t* cell;
+    uint8_t row, column, y, x, bits, fg, bg;
+    uint8_t* out;
+
+    for (row = 0; row < EF9345_ROWS; row++) {
+        for (column = 0; column < EF9345_COLUMNS; column++) {
+            cell = ef9345_cell(vdp, column, row);
+            bg = cell->colors & 0x07;
+            fg = (cell->colors >> 4) & 0x07;
+            if (cell->attributes & EF9345_ATTR_BRIGHT)
+                fg |= 0x08;
+
+            for (y = 0; y < EF9345_CELL_HEIGHT; y++) {
+                bits = (cell->attributes & EF9345_ATTR_SEMIGRAPHIC) ? mosaic_row(cell->code, y)
+                                                                    : glyph_row(cell->code, y);
+                out = pixels + ((size_t)row * EF9345_CELL_HEIGHT + y) * EF9345_WIDTH
+                      + (size_t)column * EF9345_CELL_WIDTH;
+                for (x = 0; x < EF9345_CELL_WIDTH; x++)
+                    out[x] = (bits & (0x80 >> x)) ? fg : bg;
+            }
+        }
+    }
+}
+
+void ef9345_palette(uint8_t palette[16][3])
+{
+    // Named after alice.h; 8-15 are the bright variants
+    static const uint8_t colors[16][3] = {
+        { 0x00, 0x00, 0x00 },   /* black */
+        { 0xC0, 0x00, 0x00 },   /* red */
+        { 0x00, 0xC0, 0x00 },   /* green */
+        { 0xE0, 0x80, 0x00 },   /* orange */
+        { 0x00, 0x00, 0xC0 },   /* blue */
+        { 0xC0, 0x00, 0xC0 },   /* magenta */
+        { 0x00, 0xC0, 0xC0 },   /* cyan */
+        { 0xFF, 0x90, 0xC0 },   /* pink */
+        { 0x40, 0x40, 0x40 },
+        { 0xFF, 0x40, 0x40 },
+        { 0x60, 0xFF, 0x60 },   /* lgreen */
+        { 0xFF, 0xFF, 0x40 },   /* yellow */
+        { 0x40, 0x40, 0xFF },
+        { 0xFF, 0x60, 0xFF },   /* lmagenta */
+        { 0x60, 0xFF, 0xFF },
+        { 0xFF, 0xFF, 0xFF }    /* white */
+    };
+
+    memcpy(palette, colors, sizeof(colors));
+}
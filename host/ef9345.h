@@ -0,0 +1,54 @@
+/* ef9345.h - Software EF9345 as driven by the Alice */
+/* Models the registers at R0..R7 (0xBF20-0xBF27, R0 with execute */
+/* at 0xBF28) and the 40x25 character and attribute screen. Only   */
+/* KRF, the character write used by platform_alice.c, is executed. */
+/* Row 0 is the service row, screen rows 1-24 are lines 8-31.      */
+
+#ifndef HOST_EF9345_H
+#define HOST_EF9345_H
+
+#include <stdint.h>
+
+#define EF9345_COLUMNS 40
+#define EF9345_ROWS 25
+#define EF9345_LINES 32             /* Addressable by R6 */
+#define EF9345_CELL_WIDTH 8
+#define EF9345_CELL_HEIGHT 10
+#define EF9345_WIDTH (EF9345_COLUMNS * EF9345_CELL_WIDTH)
+#define EF9345_HEIGHT (EF9345_ROWS * EF9345_CELL_HEIGHT)
+
+#define EF9345_REGISTER_BASE 0xBF20
+#define EF9345_EXECUTE 0x08         /* Offset of R0 with execute */
+
+/* R2 bits used by the Alice code */
+#define EF9345_ATTR_BRIGHT 0x01     /* Colours 8-15 */
+#define EF9345_ATTR_SEMIGRAPHIC 0x20 /* 2x3 mosaic set */
+
+typedef struct ef9345_cell_t {
+    uint8_t code;               /* R1 */
+    uint8_t attributes;         /* R2 */
+    uint8_t colors;             /* R3: background | foreground << 4 */
+} ef9345_cell_t;
+
+typedef struct ef9345_t {
+    uint8_t r[8];
+    ef9345_cell_t screen[EF9345_LINES][EF9345_COLUMNS];
+    uint32_t commands;          /* Executed */
+    uint32_t ignored;           /* Commands other than KRF */
+} ef9345_t;
+
+void ef9345_reset(ef9345_t* vdp);
+
+/* A write as seen on the bus, address in 0xBF20-0xBF28 */
+void ef9345_poke(ef9345_t* vdp, uint16_t address, uint8_t value);
+
+/* Cell shown at a screen position */
+const ef9345_cell_t* ef9345_cell(const ef9345_t* vdp, uint8_t column, uint8_t row);
+
+/* One palette index (0-15) per pixel of the 320x250 screen */
+void ef9345_render(const ef9345_t* vdp, uint8_t* pixels);
+
+/* RGB for the colour numbers of alice.h */
+void ef9345_palette(uint8_t palette[16][3]);
+
+#endif /* HOST_EF9345_H */
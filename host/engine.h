@@ -0,0 +1,33 @@
+/* engine.h - tetrice.c rules as seen by the host tools */
+
+#ifndef HOST_ENGINE_H
+#define HOST_ENGINE_H
+
+#include <stdint.h>
+
+#include "../platform.h"
+#include "../game_state.h"
+#include "../tetromino_format.h"
+
+/* Playfield operations */
+void playfield_set_cell(game_state_t* state, uint8_t x, uint8_t y, uint8_t color);
+uint8_t playfield_get_cell(game_state_t* state, uint8_t x, uint8_t y);
+uint8_t playfield_is_empty_cell(game_state_t* state, uint8_t x, uint8_t y);
+void playfield_clear(game_state_t* state);
+void playfield_place_piece(game_state_t* state, unsigned char piece, unsigned char x, unsigned char y, unsigned char rotation);
+void playfield_remove_piece(game_state_t* state, unsigned char piece, unsigned char x, unsigned char y, unsigned char rotation);
+
+/* Collision and rules */
+uint8_t check_collision(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t side_flag, int8_t dx, int8_t dy);
+uint8_t collision_left(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation);
+uint8_t collision_right(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation);
+uint8_t collision_bottom(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation);
+uint8_t check_rotation(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t direction);
+uint8_t check_full_lines(game_state_t* state);
+
+/* Game lifecycle */
+void init_game_state(game_state_t* state);
+void game_start(game_state_t* state);
+uint8_t game_step(game_state_t* state, input_action_t input);
+
+#endif /* HOST_ENGINE_H */
@@ -0,0 +1,317 @@
+/* eval.c - Board evaluation features over occupancy bitboards */
+
+#include <string.h>
+
+#include "eval.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Heuristic weights (x100), after Yiyuan Lee's tuned four-feature player
+#define WEIGHT_HEIGHT     (-51)
+#define WEIGHT_HOLES      (-36)
+#define WEIGHT_BUMPINESS  (-18)
+
+/************************************************************/
+/* Board conversion                                         */
+/************************************************************/
+
+void eval_board_from_state(const game_state_t* state, eval_board_t* board)
+{
+    uint8_t y;
+
+#if defined(__SSE2__) && PLAYFIELD_WIDTH >= 8
+    // One 16-byte load per row: the tail of the last row reads into the
+    // score/level/... bytes that follow the playfield, never outside it
+    const __m128i content = _mm_set1_epi8(CELL_CONTENT_MASK);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i row, empty;
+
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        row = _mm_loadu_si128((const __m128i*)state->playfield[y]);
+        empty = _mm_cmpeq_epi8(_mm_and_si128(row, content), zero);
+        board->rows[y] = (uint16_t)~_mm_movemask_epi8(empty) & EVAL_FULL_ROW;
+    }
+#else
+    uint8_t x;
+    uint16_t mask;
+
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        mask = 0;
+        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+            if (GET_CELL_CONTENT(state->playfield[y][x]) != CELL_EMPTY)
+                mask |= (uint16_t)(1u << x);
+        }
+        board->rows[y] = mask;
+    }
+#endif
+}
+
+/************************************************************/
+/* Shared column features                                   */
+/************************************************************/
+
+// Bumpiness and wells only need the heights
+static void column_features(eval_features_t* f)
+{
+    uint8_t x, left, right, floor_level;
+    uint16_t aggregate = 0, bumpiness = 0, wells = 0;
+    uint8_t max_height = 0, max_well = 0;
+
+    for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+        aggregate += f->heights[x];
+        if (f->heights[x] > max_height)
+            max_height = f->heights[x];
+        if (x > 0)
+            bumpiness += (f->heights[x] > f->heights[x - 1]) ? f->heights[x] - f->heights[x - 1]
+                                                             : f->heights[x - 1] - f->heights[x];
+
+        left = (x > 0) ? f->heights[x - 1] : PLAYFIELD_HEIGHT;
+        right = (x < PLAYFIELD_WIDTH - 1) ? f->heights[x + 1] : PLAYFIELD_HEIGHT;
+        floor_level = (left < right) ? left : right;
+        if (floor_level > f->heights[x]) {
+            wells += floor_level - f->heights[x];
+            if (floor_level - f->heights[x] > max_well)
+                max_well = floor_level - f->heights[x];
+        }
+    }
+
+    f->aggregate_height = aggregate;
+    f->max_height = max_height;
+    f->bumpiness = bumpiness;
+    f->well_depth = wells;
+    f->max_well = max_well;
+}
+
+/************************************************************/
+/* Scalar reference                                         */
+/************************************************************/
+
+void eval_features_reference(const game_state_t* state, eval_features_t* f)
+{
+    uint8_t x, y, seen, cell, previous;
+
+    memset(f, 0, sizeof(*f));
+
+    for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+        seen = 0;
+        previous = 0;   // Above the top is empty
+        for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+            cell = GET_CELL_CONTENT(state->playfield[y][x]) != CELL_EMPTY;
+            if (cell) {
+                if (!seen)
+                    f->heights[x] = PLAYFIELD_HEIGHT - y;
+                seen = 1;
+            } else if (seen) {
+                f->holes++;
+            }
+            if (cell != previous)
+                f->column_transitions++;
+            previous = cell;
+        }
+        if (!previous)  // The floor is filled
+            f->column_transitions++;
+    }
+
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        previous = 1;   // Left wall
+        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+            cell = GET_CELL_CONTENT(state->playfield[y][x]) != CELL_EMPTY;
+            if (cell != previous)
+                f->row_transitions++;
+            previous = cell;
+        }
+        if (!previous)  // Right wall
+            f->row_transitions++;
+    }
+
+    column_features(f);
+}
+
+/************************************************************/
+/* Single board: bit tricks                                 */
+/************************************************************/
+
+// In-place 32x32 bit-matrix transpose, bit c of a[r] <-> bit r of a[c]
+static void transpose32(uint32_t a[32])
+{
+    uint32_t m = 0x0000FFFFu, t;
+    int j, k;
+
+    for (j = 16; j != 0; j >>= 1, m ^= m << j) {
+        for (k = 0; k < 32; k = (k + j + 1) & ~j) {
+            t = ((a[k] >> j) ^ a[k + j]) & m;
+            a[k] ^= t << j;
+            a[k + j] ^= t;
+        }
+    }
+}
+
+static uint16_t row_transitions(uint16_t r)
+{
+    // Inner neighbours, then the two walls
+    return (uint16_t)(__builtin_popcount((r ^ (r >> 1)) & (EVAL_FULL_ROW >> 1)) +
+                      (~r & 1) + ((~r >> (PLAYFIELD_WIDTH - 1)) & 1));
+}
+
+void eval_features(const eval_board_t* board, eval_features_t* f)
+{
+    uint32_t columns[32];
+    uint16_t covered = 0, r;
+    uint16_t holes = 0, rt = 0, ct;
+    uint8_t x, y;
+
+    memset(columns, 0, sizeof(columns));
+
+    ct = (uint16_t)__builtin_popcount(board->rows[0]);
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        r = board->rows[y];
+        holes += (uint16_t)__builtin_popcount(covered & ~r);
+        covered |= r;
+        rt += row_transitions(r);
+        if (y > 0)
+            ct += (uint16_t)__builtin_popcount(r ^ board->rows[y - 1]);
+        columns[y] = r;
+    }
+    ct += (uint16_t)__builtin_popcount(~board->rows[PLAYFIELD_HEIGHT - 1] & EVAL_FULL_ROW);
+
+    // Column x as a word: its height is given by the topmost set bit
+    transpose32(columns);
+    for (x = 0; x < PLAYFIELD_WIDTH; x++)
+        f->heights[x] = columns[x] ? (uint8_t)(PLAYFIELD_HEIGHT - __builtin_ctz(columns[x])) : 0;
+
+    f->holes = holes;
+    f->row_transitions = rt;
+    f->column_transitions = ct;
+    column_features(f);
+}
+
+/************************************************************/
+/* Batch: one board per 16-bit SIMD lane                    */
+/************************************************************/
+
+// 256-bit lanes when AVX2 is enabled, SSE2/NEON-sized otherwise
+#ifdef __AVX2__
+#define EVAL_LANES 16
+#else
+#define EVAL_LANES 8
+#endif
+
+typedef uint16_t eval_vec_t __attribute__((vector_size(EVAL_LANES * sizeof(uint16_t))));
+
+static inline eval_vec_t vec_popcount(eval_vec_t v)
+{
+    v = v - ((v >> 1) & 0x5555);
+    v = (v & 0x3333) + ((v >> 2) & 0x3333);
+    v = (v + (v >> 4)) & 0x0F0F;
+    return (v + (v >> 8)) & 0x001F;
+}
+
+static inline eval_vec_t vec_max(eval_vec_t a, eval_vec_t b)
+{
+    eval_vec_t m = (eval_vec_t)(a > b);
+    return (a & m) | (b & ~m);
+}
+
+static inline eval_vec_t vec_min(eval_vec_t a, eval_vec_t b)
+{
+    eval_vec_t m = (eval_vec_t)(a < b);
+    return (a & m) | (b & ~m);
+}
+
+static void batch_group(const eval_board_t* boards, size_t count, eval_features_t* out)
+{
+    eval_vec_t rows[PLAYFIELD_HEIGHT];
+    eval_vec_t heights[PLAYFIELD_WIDTH];
+    eval_vec_t covered, holes, rt, ct, r, aggregate, max_height, bumpiness, wells, max_well;
+    eval_vec_t left, right, well;
+    size_t lane;
+    uint8_t x, y;
+
+    // Transpose the group into row-major lanes, idle lanes stay empty
+    memset(rows, 0, sizeof(rows));
+    for (lane = 0; lane < count; lane++) {
+        for (y = 0; y < PLAYFIELD_HEIGHT; y++)
+            rows[y][lane] = boards[lane].rows[y];
+    }
+
+    covered = holes = rt = (eval_vec_t){0};
+    ct = vec_popcount(rows[0]);
+    for (x = 0; x < PLAYFIELD_WIDTH; x++)
+        heights[x] = (eval_vec_t){0};
+
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        r = rows[y];
+        holes += vec_popcount(covered & ~r);
+        covered |= r;
+        // A column counts toward its height from its first block down
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            heights[x] += (covered >> x) & 1;
+        rt += vec_popcount((r ^ (r >> 1)) & (EVAL_FULL_ROW >> 1)) +
+              (~r & 1) + ((~r >> (PLAYFIELD_WIDTH - 1)) & 1);
+        if (y > 0)
+            ct += vec_popcount(r ^ rows[y - 1]);
+    }
+    ct += vec_popcount(~rows[PLAYFIELD_HEIGHT - 1] & EVAL_FULL_ROW);
+
+    aggregate = max_height = bumpiness = wells = max_well = (eval_vec_t){0};
+    for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+        aggregate += heights[x];
+        max_height = vec_max(max_height, heights[x]);
+        if (x > 0)
+            bumpiness += vec_max(heights[x], heights[x - 1]) - vec_min(heights[x], heights[x - 1]);
+
+        left = (x > 0) ? heights[x - 1] : (eval_vec_t){0} + PLAYFIELD_HEIGHT;
+        right = (x < PLAYFIELD_WIDTH - 1) ? heights[x + 1] : (eval_vec_t){0} + PLAYFIELD_HEIGHT;
+        well = vec_max(vec_min(left, right), heights[x]) - heights[x];
+        wells += well;
+        max_well = vec_max(max_well, well);
+    }
+
+    for (lane = 0; lane < count; lane++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            out[lane].heights[x] = (uint8_t)heights[x][lane];
+        out[lane].aggregate_height = aggregate[lane];
+        out[lane].max_height = (uint8_t)max_height[lane];
+        out[lane].holes = holes[lane];
+        out[lane].bumpiness = bumpiness[lane];
+        out[lane].well_depth = wells[lane];
+        out[lane].max_well = (uint8_t)max_well[lane];
+        out[lane].row_transitions = rt[lane];
+        out[lane].column_transitions = ct[lane];
+    }
+}
+
+void eval_features_batch(const eval_board_t* boards, size_t count, eval_features_t* features)
+{
+    size_t i, n;
+
+    for (i = 0; i < count; i += EVAL_LANES) {
+        n = (count - i < EVAL_LANES) ? count - i : EVAL_LANES;
+        batch_group(boards + i, n, features + i);
+    }
+}
+
+/************************************************************/
+/* Scoring                                                  */
+/************************************************************/
+
+uint8_t eval_features_equal(const eval_features_t* a, const eval_features_t* b)
+{
+    return memcmp(a->heights, b->heights, sizeof(a->heights)) == 0 &&
+           a->aggregate_height == b->aggregate_height &&
+           a->max_height == b->max_height &&
+           a->holes == b->holes &&
+           a->bumpiness == b->bumpiness &&
+           a->well_depth == b->well_depth &&
+           a->max_well == b->max_well &&
+           a->row_transitions == b->row_transitions &&
+           a->column_transitions == b->column_transitions;
+}
+
+int32_t eval_score(const eval_features_t* f)
+{
+    return WEIGHT_HEIGHT * f->aggregate_height + WEIGHT_HOLES * f->holes +
+           WEIGHT_BUMPINESS * f->bumpiness;
+}
@@ -0,0 +1,55 @@
+/* eval.h - Board evaluation features over occupancy bitboards */
+/* A board is one mask per row, bit x set when column x is    */
+/* occupied. Features are computed with popcounts, a prefix-OR */
+/* down the columns and a bit-matrix transpose; the batch path */
+/* puts one board per SIMD lane.                               */
+
+#ifndef HOST_EVAL_H
+#define HOST_EVAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "engine.h"
+
+#if PLAYFIELD_WIDTH > 16 || PLAYFIELD_HEIGHT > 32
+#error "eval bitboards hold at most 16 columns and 32 rows"
+#endif
+
+#define EVAL_FULL_ROW ((uint16_t)((1u << PLAYFIELD_WIDTH) - 1))
+
+typedef struct eval_board_t {
+    uint16_t rows[PLAYFIELD_HEIGHT];    /* Row 0 is the top row */
+} eval_board_t;
+
+typedef struct eval_features_t {
+    uint8_t heights[PLAYFIELD_WIDTH];   /* Column heights, 0 = empty column */
+    uint16_t aggregate_height;          /* Sum of column heights */
+    uint8_t max_height;
+    uint16_t holes;                     /* Empty cells with a block above */
+    uint16_t bumpiness;                 /* Sum of |h[x] - h[x+1]| */
+    uint16_t well_depth;                /* Sum of well depths, walls count as full */
+    uint8_t max_well;
+    uint16_t row_transitions;           /* Filled/empty changes along rows, walls filled */
+    uint16_t column_transitions;        /* Filled/empty changes down columns, floor filled */
+} eval_features_t;
+
+/* Build the occupancy masks of a playfield */
+void eval_board_from_state(const game_state_t* state, eval_board_t* board);
+
+/* Features of one board, bit tricks on the row masks */
+void eval_features(const eval_board_t* board, eval_features_t* features);
+
+/* Features of count boards, several boards per SIMD operation */
+void eval_features_batch(const eval_board_t* boards, size_t count, eval_features_t* features);
+
+/* Cell-by-cell reference, the definition the fast paths must match */
+void eval_features_reference(const game_state_t* state, eval_features_t* features);
+
+/* Compare two feature sets, return 1 when identical */
+uint8_t eval_features_equal(const eval_features_t* a, const eval_features_t* b);
+
+/* Heuristic value of a board, higher is better */
+int32_t eval_score(const eval_features_t* features);
+
+#endif /* HOST_EVAL_H */
@@ -0,0 +1,79 @@
+/* histogram.c - Fixed-size log-linear histogram for latencies */
+
+#include <string.h>
+
+#include "histogram.h"
+
+#define SUB_COUNT (1u << HISTOGRAM_SUB_BITS)
+
+static uint32_t bucket_index(uint64_t value)
+{
+    uint32_t e;
+
+    if (value < SUB_COUNT)
+        return (uint32_t)value;
+    e = 63 - (uint32_t)__builtin_clzll(value);
+    return ((e - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+         + (uint32_t)((value >> (e - HISTOGRAM_SUB_BITS)) & (SUB_COUNT - 1));
+}
+
+// Largest value that lands in bucket i
+static uint64_t bucket_limit(uint32_t i)
+{
+    uint32_t e;
+
+    if (i < SUB_COUNT)
+        return i;
+    e = (i >> HISTOGRAM_SUB_BITS) + HISTOGRAM_SUB_BITS - 1;
+    return (((uint64_t)(SUB_COUNT + (i & (SUB_COUNT - 1))) + 1) << (e - HISTOGRAM_SUB_BITS)) - 1;
+}
+
+void histogram_reset(histogram_t* h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+void histogram_add(histogram_t* h, uint64_t value)
+{
+    h->counts[bucket_index(value)]++;
+    h->total++;
+    h->sum += value;
+    if (value > h->max)
+        h->max = value;
+}
+
+void histogram_merge(histogram_t* dst, const histogram_t* src)
+{
+    uint32_t i;
+
+    for (i = 0; i < HISTOGRAM_BUCKETS; i++)
+        dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    dst->sum += src->sum;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+uint64_t histogram_percentile(const histogram_t* h, double percentile)
+{
+    uint64_t rank, seen = 0;
+    uint32_t i;
+
+    if (h->total == 0)
+        return 0;
+    rank = (uint64_t)(percentile / 100.0 * (double)h->total + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank)
+            return bucket_limit(i) < h->max ? bucket_limit(i) : h->max;
+    }
+    return h->max;
+}
+
+double histogram_mean(const histogram_t* h)
+{
+    return h->total ? (double)h->sum / (double)h->total : 0.0;
+}
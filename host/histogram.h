@@ -0,0 +1,29 @@
+/* histogram.h - Fixed-size log-linear histogram for latencies */
+/* Values below 16 get their own bucket, larger ones 16 buckets */
+/* per power of two (about 6% resolution). No allocation, so it  */
+/* can be updated from hot loops and merged across threads.      */
+
+#ifndef HOST_HISTOGRAM_H
+#define HOST_HISTOGRAM_H
+
+#include <stdint.h>
+
+#define HISTOGRAM_SUB_BITS 4
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+typedef struct histogram_t {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+} histogram_t;
+
+void histogram_reset(histogram_t* h);
+void histogram_add(histogram_t* h, uint64_t value);
+void histogram_merge(histogram_t* dst, const histogram_t* src);
+
+/* Upper bound of the bucket holding the given percentile (0-100) */
+uint64_t histogram_percentile(const histogram_t* h, double percentile);
+double histogram_mean(const histogram_t* h);
+
+#endif /* HOST_HISTOGRAM_H */
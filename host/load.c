@@ -0,0 +1,303 @@
+/* load.c - Client stand-in and load generator for tetrice_server */
+/* Opens many connections spread over a few threads, each with   */
+/* its own epoll loop, and sends scripted random inputs at a set  */
+/* rate. With -v and one client it prints every update instead.   */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "server.h"
+#include "net.h"
+#include "histogram.h"
+
+#define LOAD_TICK_HZ 100
+#define LOAD_MAX_EVENTS 256
+
+typedef struct load_client_t {
+    int fd;
+    uint32_t countdown;         /* Ticks until the next input */
+    uint32_t rng;
+    uint64_t sent_at;           /* Time of the oldest unanswered input, 0 if none */
+    uint8_t partial[SERVER_PACKET_SIZE];
+    uint8_t partial_length;
+} load_client_t;
+
+typedef struct load_options_t {
+    const char* path;
+    uint16_t port;
+    uint32_t clients;
+    int threads;
+    uint32_t rate;              /* Inputs per second per client */
+    uint32_t duration;
+    uint8_t verbose;
+} load_options_t;
+
+typedef struct load_thread_t {
+    pthread_t thread;
+    const load_options_t* options;
+    load_client_t* clients;
+    uint32_t count;
+    int epoll_fd;
+    int timer_fd;
+    uint32_t connected;
+    uint64_t inputs;
+    uint64_t packets;
+    uint64_t games_over;
+    uint64_t bytes_in;
+    uint32_t disconnects;
+    histogram_t response_ns;    /* Input sent to next update received */
+} load_thread_t;
+
+static uint8_t tag_timer;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_random(uint32_t* s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static void print_packet(const uint8_t* p)
+{
+    printf("frame %6u  score %3u  level %3u  piece %u  next %u%s\n", server_packet_frame(p), p[4], p[5],
+           p[6] & 0x0F, p[6] >> 4, (p[7] & SERVER_FLAG_GAME_OVER) ? "  GAME OVER" : "");
+}
+
+static void client_receive(load_thread_t* t, load_client_t* c)
+{
+    uint8_t buffer[512];
+    ssize_t n, i;
+
+    n = read(c->fd, buffer, sizeof(buffer));
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        epoll_ctl(t->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+        close(c->fd);
+        c->fd = -1;
+        t->disconnects++;
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        c->partial[c->partial_length++] = buffer[i];
+        if (c->partial_length < SERVER_PACKET_SIZE)
+            continue;
+        c->partial_length = 0;
+        t->packets++;
+        if (c->partial[7] & SERVER_FLAG_GAME_OVER)
+            t->games_over++;
+        if (t->options->verbose)
+            print_packet(c->partial);
+    }
+    if (n > 0) {
+        t->bytes_in += (uint64_t)n;
+        if (c->sent_at) {
+            histogram_add(&t->response_ns, now_ns() - c->sent_at);
+            c->sent_at = 0;
+        }
+    }
+}
+
+static void client_tick(load_thread_t* t, load_client_t* c, uint32_t period)
+{
+    uint8_t input;
+
+    if (c->fd < 0 || --c->countdown > 0)
+        return;
+    c->countdown = period;
+
+    input = (uint8_t)(INPUT_MOVE_LEFT + next_random(&c->rng) % (INPUT_DROP - INPUT_MOVE_LEFT + 1));
+    if (write(c->fd, &input, 1) == 1) {
+        t->inputs++;
+        if (!c->sent_at)
+            c->sent_at = now_ns();
+    }
+}
+
+static void* load_main(void* arg)
+{
+    load_thread_t* t = arg;
+    struct epoll_event events[LOAD_MAX_EVENTS];
+    uint64_t expirations, deadline;
+    uint32_t period = LOAD_TICK_HZ / (t->options->rate ? t->options->rate : 1);
+    uint32_t i;
+    int n, k;
+
+    if (period < 1)
+        period = 1;
+
+    // Connect everything first, then play for the whole duration
+    for (i = 0; i < t->count; i++) {
+        load_client_t* c = &t->clients[i];
+        struct epoll_event ev;
+
+        c->fd = net_connect(t->options->path, t->options->port);
+        if (c->fd < 0)
+            continue;
+        net_set_nonblocking(c->fd);
+        c->rng = 0x2545F491u ^ (uint32_t)(c - t->clients) * 0x9E3779B9u ^ (uint32_t)t->epoll_fd;
+        if (!c->rng)
+            c->rng = 1;
+        c->countdown = 1 + next_random(&c->rng) % period;    // Spread the inputs over the period
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        epoll_ctl(t->epoll_fd, EPOLL_CTL_ADD, c->fd, &ev);
+        t->connected++;
+    }
+
+    deadline = now_ns() + t->options->duration * 1000000000ull;
+    while (now_ns() < deadline) {
+        n = epoll_wait(t->epoll_fd, events, LOAD_MAX_EVENTS, 100);
+        for (k = 0; k < n; k++) {
+            if (events[k].data.ptr == &tag_timer) {
+                if (read(t->timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    for (i = 0; i < t->count; i++)
+                        client_tick(t, &t->clients[i], period);
+                }
+            } else {
+                load_client_t* c = events[k].data.ptr;
+                if (c->fd >= 0)
+                    client_receive(t, c);
+            }
+        }
+    }
+
+    for (i = 0; i < t->count; i++) {
+        if (t->clients[i].fd >= 0)
+            close(t->clients[i].fd);
+    }
+    return NULL;
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_load [options]\n");
+    printf("  -u PATH     Unix-domain socket (default %s)\n", SERVER_DEFAULT_PATH);
+    printf("  -p PORT     TCP port on 127.0.0.1 instead\n");
+    printf("  -c N        concurrent clients, one game each (default 100)\n");
+    printf("  -t N        client threads (default 1)\n");
+    printf("  -r N        inputs per second per client (default 4)\n");
+    printf("  -d SECONDS  run time (default 10)\n");
+    printf("  -v          print every update (client stand-in, use with -c 1)\n");
+}
+
+int main(int argc, char** argv)
+{
+    load_options_t options;
+    load_thread_t* threads;
+    load_client_t* clients;
+    histogram_t response_ns;
+    uint64_t inputs = 0, packets = 0, games_over = 0, bytes_in = 0, start;
+    uint32_t connected = 0, disconnects = 0, first = 0;
+    struct itimerspec period;
+    struct epoll_event ev;
+    double elapsed;
+    int i;
+
+    options.path = SERVER_DEFAULT_PATH;
+    options.port = 0;
+    options.clients = 100;
+    options.threads = 1;
+    options.rate = 4;
+    options.duration = 10;
+    options.verbose = 0;
+
+    for (i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!strcmp(argv[i], "-v")) {
+            options.verbose = 1;
+            continue;
+        }
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 'u': options.path = value; break;
+        case 'p': options.port = (uint16_t)atoi(value); options.path = NULL; break;
+        case 'c': options.clients = (uint32_t)strtoul(value, NULL, 0); break;
+        case 't': options.threads = atoi(value); break;
+        case 'r': options.rate = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'd': options.duration = (uint32_t)strtoul(value, NULL, 0); break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+    if (options.threads < 1)
+        options.threads = 1;
+
+    net_raise_fd_limit();
+    threads = calloc((size_t)options.threads, sizeof(load_thread_t));
+    clients = calloc(options.clients ? options.clients : 1, sizeof(load_client_t));
+    if (!threads || !clients)
+        return 1;
+
+    period.it_interval.tv_sec = 0;
+    period.it_interval.tv_nsec = 1000000000 / LOAD_TICK_HZ;
+    period.it_value = period.it_interval;
+
+    start = now_ns();
+    for (i = 0; i < options.threads; i++) {
+        load_thread_t* t = &threads[i];
+        uint32_t count = options.clients / options.threads + ((uint32_t)i < options.clients % options.threads);
+
+        t->options = &options;
+        t->clients = &clients[first];
+        t->count = count;
+        first += count;
+        histogram_reset(&t->response_ns);
+        t->epoll_fd = epoll_create1(0);
+        t->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        timerfd_settime(t->timer_fd, 0, &period, NULL);
+        ev.events = EPOLLIN;
+        ev.data.ptr = &tag_timer;
+        epoll_ctl(t->epoll_fd, EPOLL_CTL_ADD, t->timer_fd, &ev);
+        pthread_create(&t->thread, NULL, load_main, t);
+    }
+
+    histogram_reset(&response_ns);
+    for (i = 0; i < options.threads; i++) {
+        load_thread_t* t = &threads[i];
+
+        pthread_join(t->thread, NULL);
+        close(t->epoll_fd);
+        close(t->timer_fd);
+        connected += t->connected;
+        disconnects += t->disconnects;
+        inputs += t->inputs;
+        packets += t->packets;
+        games_over += t->games_over;
+        bytes_in += t->bytes_in;
+        histogram_merge(&response_ns, &t->response_ns);
+    }
+    elapsed = (now_ns() - start) * 1e-9;
+
+    printf("clients: %u connected of %u, %u disconnected by the server\n", connected, options.clients, disconnects);
+    printf("sent %llu inputs (%.0f/s), received %llu updates (%.0f/s, %llu bytes), %llu games over\n",
+           (unsigned long long)inputs, inputs / elapsed, (unsigned long long)packets, packets / elapsed,
+           (unsigned long long)bytes_in, (unsigned long long)games_over);
+    printf("input to next update: mean %.2fms p50 %.2fms p99 %.2fms max %.2fms\n",
+           histogram_mean(&response_ns) / 1e6, histogram_percentile(&response_ns, 50) / 1e6,
+           histogram_percentile(&response_ns, 99) / 1e6, response_ns.max / 1e6);
+
+    free(clients);
+    free(threads);
+    return connected == options.clients ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+/* mc6847.c - Software MC6847 in the PHC-25's Mode 12 */
+
+#include <string.h>
+
+#include "mc6847.h"
+
+// 16 pixels per step: two VRAM bytes, each spread over eight lanes
+typedef uint8_t mc6847_vec_t __attribute__((vector_size(16)));
+
+void mc6847_render(const mc6847_t* vdg, uint8_t* pixels)
+{
+    const mc6847_vec_t bits = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+    mc6847_vec_t v, set;
+    uint16_t i;
+    uint8_t a, b;
+
+    for (i = 0; i < MC6847_VRAM_SIZE; i += 2) {
+        a = vdg->vram[i];
+        b = vdg->vram[i + 1];
+        v = (mc6847_vec_t){ a, a, a, a, a, a, a, a, b, b, b, b, b, b, b, b };
+        // Lanes are 0xFF where the bit is set, keep the low bit as the index
+        set = (mc6847_vec_t)((v & bits) != 0) & 1;
+        memcpy(pixels + (size_t)i * 8, &set, sizeof(set));
+    }
+}
+
+void mc6847_palette(const mc6847_t* vdg, uint8_t palette[16][3])
+{
+    // Graphics mode colours, from the MC6847 datasheet chroma table
+    static const uint8_t colors[2][2][3] = {
+        { { 0x00, 0x00, 0x00 }, { 0x30, 0xD2, 0x00 } },    /* Black, green */
+        { { 0x00, 0x00, 0x00 }, { 0xE2, 0xDB, 0xBC } }     /* Black, buff */
+    };
+
+    memset(palette, 0, 16 * 3);
+    memcpy(palette, colors[vdg->css & 1], sizeof(colors[0]));
+}
@@ -0,0 +1,27 @@
+/* mc6847.h - Software MC6847 in the PHC-25's Mode 12 */
+/* 256x192, one bit per pixel, 32 bytes per line, MSB on the left. */
+/* The VRAM is laid out as at VRAM_START on the machine, so code   */
+/* that POKEs VRAM_START + offset writes vram[offset] here.         */
+
+#ifndef HOST_MC6847_H
+#define HOST_MC6847_H
+
+#include <stdint.h>
+
+#define MC6847_WIDTH 256
+#define MC6847_HEIGHT 192
+#define MC6847_BYTES_PER_ROW 32
+#define MC6847_VRAM_SIZE (MC6847_BYTES_PER_ROW * MC6847_HEIGHT)
+
+typedef struct mc6847_t {
+    uint8_t vram[MC6847_VRAM_SIZE];
+    uint8_t css;                /* Colour set: 0 black/green, 1 black/buff */
+} mc6847_t;
+
+/* One palette index per pixel, 0 for a clear bit, 1 for a set one */
+void mc6847_render(const mc6847_t* vdg, uint8_t* pixels);
+
+/* RGB of indices 0 and 1 for the current colour set */
+void mc6847_palette(const mc6847_t* vdg, uint8_t palette[16][3]);
+
+#endif /* HOST_MC6847_H */
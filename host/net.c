@@ -0,0 +1,107 @@
+/* net.c - Socket helpers for the host tools */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "net.h"
+
+typedef union net_address_t {
+    struct sockaddr any;
+    struct sockaddr_un un;
+    struct sockaddr_in in;
+} net_address_t;
+
+static int net_address(net_address_t* address, const char* path, uint16_t port, socklen_t* length)
+{
+    memset(address, 0, sizeof(*address));
+    if (path) {
+        if (strlen(path) >= sizeof(address->un.sun_path))
+            return -1;
+        address->un.sun_family = AF_UNIX;
+        strcpy(address->un.sun_path, path);
+        *length = sizeof(address->un);
+    } else {
+        address->in.sin_family = AF_INET;
+        address->in.sin_port = htons(port);
+        address->in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        *length = sizeof(address->in);
+    }
+    return 0;
+}
+
+int net_listen(const char* path, uint16_t port, int backlog)
+{
+    net_address_t address;
+    socklen_t length;
+    int fd, one = 1;
+
+    if (net_address(&address, path, port, &length))
+        return -1;
+    fd = socket(address.any.sa_family, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    if (path)
+        unlink(path);
+    else
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    if (bind(fd, &address.any, length) || listen(fd, backlog) || net_set_nonblocking(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int net_connect(const char* path, uint16_t port)
+{
+    net_address_t address;
+    socklen_t length;
+    int fd;
+
+    if (net_address(&address, path, port, &length))
+        return -1;
+    fd = socket(address.any.sa_family, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, &address.any, length)) {
+        close(fd);
+        return -1;
+    }
+    if (!path)
+        net_set_nodelay(fd);
+    return fd;
+}
+
+int net_set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+
+    if (flags < 0)
+        return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+void net_set_nodelay(int fd)
+{
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+void net_raise_fd_limit(void)
+{
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
@@ -0,0 +1,24 @@
+/* net.h - Socket helpers for the host tools */
+/* Endpoints are a Unix-domain socket path, or when the path is */
+/* NULL a TCP port on the loopback interface.                   */
+
+#ifndef HOST_NET_H
+#define HOST_NET_H
+
+#include <stdint.h>
+
+/* Listening socket, non-blocking, -1 on error */
+int net_listen(const char* path, uint16_t port, int backlog);
+
+/* Connected socket, blocking, -1 on error */
+int net_connect(const char* path, uint16_t port);
+
+int net_set_nonblocking(int fd);
+
+/* Low latency for small writes (no-op on Unix-domain sockets) */
+void net_set_nodelay(int fd);
+
+/* Thousands of games need thousands of descriptors */
+void net_raise_fd_limit(void);
+
+#endif /* HOST_NET_H */
@@ -0,0 +1,234 @@
+/* pack.c - Self-extracting tape images */
+/* Takes the linked game and the linked alice_unzx0.s stub (ld68 -b  */
+/* images, file offset = address), compresses the game with ZX0 and  */
+/* writes the image the tape loads at the stub address, as another   */
+/* ld68 -b style file for mc10-tapeify. Prints the sizes and the    */
+/* estimated load times of the raw and the packed tape.             */
+/* With -p, the same for the PHC-25: z88dk binaries that start at   */
+/* their origin and the phc25_unzx0.asm stub, for bin_to_phc.       */
+/* With -a, the PHC-25 UI asset block that phc25_lib.asm links into */
+/* the program, from the asset bank of tools/pack_assets.py, each   */
+/* bitmap compressed.                                                */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tape.h"
+#include "zx0.h"
+
+#define PACK_CLOCK 894886           /* Alice 6803 E clock, Hz */
+#define PACK_CYCLES_PER_BYTE 70     /* Decompression, about, from tests/tetrice_unzx0 */
+#define PACK_PHC25_CLOCK 3579545    /* PHC-25 Z80 clock, Hz */
+#define PACK_PHC25_CYCLES_PER_BYTE 70 /* Decompression, about, from tests/tetrice_unzx0_phc25 */
+#define PACK_PHC25_SCRATCH 0xE000   /* Page 2, where bitmaps narrower than the screen are decompressed */
+#define PACK_PHC25_SCRATCH_END 0xF800 /* End of screen page 2 */
+#define PACK_PHC25_BYTES_PER_ROW 32
+
+static uint8_t game_file[65536];
+static uint8_t stub_file[65536];
+static uint8_t image[65536];
+
+// The bytes of an ld68 -b image from address on, into buffer at
+// address; a binary that starts at address if origin is set
+static long read_image(const char* path, uint16_t address, uint8_t* buffer, int origin)
+{
+    FILE* f = fopen(path, "rb");
+    size_t size;
+
+    if (!f) {
+        fprintf(stderr, "tetrice_pack: cannot read %s\n", path);
+        return -1;
+    }
+    if (origin) {
+        size = fread(buffer + address, 1, 65536 - address, f);
+        fclose(f);
+        if (size == 0) {
+            fprintf(stderr, "tetrice_pack: %s is empty\n", path);
+            return -1;
+        }
+        return (long)size;
+    }
+    size = fread(buffer, 1, 65536, f);
+    fclose(f);
+    if (size <= address) {
+        fprintf(stderr, "tetrice_pack: %s ends before %u\n", path, address);
+        return -1;
+    }
+    return (long)(size - address);
+}
+
+// Writes image from start on, to the end of the packed image
+static int write_image(const char* path, size_t start, size_t end)
+{
+    FILE* f = fopen(path, "wb");
+
+    if (!f || fwrite(image + start, 1, end - start, f) != end - start) {
+        fprintf(stderr, "tetrice_pack: cannot write %s\n", path);
+        if (f)
+            fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+// The PHC-25 image, and its size against the raw one; there is no
+// model of its tape format. Neither the program nor the stream moved
+// up for unpacking may reach the page 2 scratch.
+static int pack_phc25(uint16_t game_addr, long game_size, uint16_t stub_addr, long stub_size, const char* output)
+{
+    tape_layout_t layout;
+    const char* error;
+    long size;
+
+    size = tape_pack_phc25(game_file + game_addr, (size_t)game_size, game_addr, stub_file + stub_addr,
+                           (size_t)stub_size, stub_addr, image + stub_addr, sizeof(image) - stub_addr, &layout,
+                           &error);
+    if (size < 0) {
+        fprintf(stderr, "tetrice_pack: %s\n", error);
+        return 1;
+    }
+    if (layout.ram_end > PACK_PHC25_SCRATCH) {
+        fprintf(stderr, "tetrice_pack: the load uses RAM up to %u, past the page 2 scratch at %u\n",
+                layout.ram_end - 1, PACK_PHC25_SCRATCH);
+        return 1;
+    }
+    if (write_image(output, stub_addr, stub_addr + (size_t)size))
+        return 1;
+
+    printf("game    %5ld bytes at %u, ZX0 stream %u bytes (%.1f%%), XOR mask 0x%02X\n", game_size, game_addr,
+           layout.stream_size, 100.0 * layout.stream_size / game_size, layout.mask);
+    printf("stub    %5ld bytes at %u, stream moved to %u, RAM used up to %u\n", stub_size, stub_addr,
+           layout.moved_addr, layout.ram_end - 1);
+    printf("tape    raw %5ld bytes, packed %5ld bytes (%.1f%%) + %.2f s to unpack\n", game_size, size,
+           100.0 * size / game_size, (double)game_size * PACK_PHC25_CYCLES_PER_BYTE / PACK_PHC25_CLOCK);
+    return 0;
+}
+
+// What the bank would take as one set of deduplicated 8x8 tiles and a
+// map per asset, both compressed, against the compressed bitmaps
+static void tile_report(const assets_t* assets, long bitmaps)
+{
+    static uint8_t tiles[ASSETS_FILE_MAX], maps[ASSETS_FILE_MAX], packed[ASSETS_FILE_MAX];
+    uint32_t count = 0, unique = 0, map_size = 0, t;
+    long bank, map;
+    uint8_t i, column, row, line;
+
+    for (i = 0; i < assets->count; i++) {
+        if (assets->height[i] & 7)
+            continue;
+        for (row = 0; row < assets->height[i]; row += 8) {
+            for (column = 0; column < assets->bytes_per_row[i]; column++) {
+                uint8_t tile[8];
+
+                for (line = 0; line < 8; line++)
+                    tile[line] = assets->bitmap[i][(row + line) * assets->bytes_per_row[i] + column];
+                for (t = 0; t < unique && memcmp(tiles + 8 * t, tile, 8); t++)
+                    ;
+                if (t == unique)
+                    memcpy(tiles + 8 * unique++, tile, 8);
+                maps[map_size++] = (uint8_t)t;
+                maps[map_size++] = (uint8_t)(t >> 8);
+                count++;
+            }
+        }
+    }
+    if (count == 0)
+        return;
+    bank = zx0_compress(tiles, 8 * unique, packed, sizeof(packed));
+    map = zx0_compress(maps, map_size, packed, sizeof(packed));
+    printf("tiles   %u 8x8 tiles, %u unique: ZX0 bank %ld + maps %ld bytes, against %ld for the bitmaps\n", count,
+           unique, bank, map, bitmaps);
+}
+
+// The asset block from the asset bank at path
+static int pack_assets(const char* output, const char* path)
+{
+    static assets_t assets;
+    const char* error;
+    long size, bitmaps = 0;
+    uint8_t i;
+
+    if (assets_load(path, &assets))
+        return 1;
+
+    // Full-width bitmaps are decompressed straight to the screen
+    for (i = 0; i < assets.count; i++) {
+        size = (long)assets.bytes_per_row[i] * assets.height[i];
+        if (assets.bytes_per_row[i] != PACK_PHC25_BYTES_PER_ROW &&
+            PACK_PHC25_SCRATCH + size > PACK_PHC25_SCRATCH_END) {
+            fprintf(stderr, "tetrice_pack: asset %u, %ld bytes, does not fit in the page 2 scratch\n", i, size);
+            return 1;
+        }
+    }
+
+    size = tape_pack_assets(&assets, image, sizeof(image), &error);
+    if (size < 0) {
+        fprintf(stderr, "tetrice_pack: %s\n", error);
+        return 1;
+    }
+    if (write_image(output, 0, (size_t)size))
+        return 1;
+
+    printf("asset   %8s %6s %6s\n", "size", "bytes", "ZX0");
+    for (i = 0; i < assets.count; i++) {
+        const uint8_t* entry = image + TAPE_ASSETS_ENTRY * i;
+        uint16_t start = (uint16_t)(entry[0] | entry[1] << 8);
+        uint16_t end = i + 1 < assets.count ? (uint16_t)(entry[4] | entry[5] << 8) : (uint16_t)size;
+
+        printf("%5u   %4ux%-3u %6u %6u\n", i, 8 * assets.bytes_per_row[i], assets.height[i],
+               assets.bytes_per_row[i] * assets.height[i], end - start);
+        bitmaps += end - start;
+    }
+    printf("assets  %u ZX0 streams, block %ld bytes\n", assets.count, size);
+    tile_report(&assets, bitmaps);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    tape_layout_t layout;
+    const char* error;
+    uint16_t game_addr, stub_addr;
+    long game_size, stub_size, size;
+    double raw_seconds, packed_seconds, unpack_seconds;
+    int phc25 = argc > 1 && !strcmp(argv[1], "-p");
+
+    if (argc == 4 && !strcmp(argv[1], "-a"))
+        return pack_assets(argv[2], argv[3]);
+    if (argc != 6 + phc25) {
+        printf("Usage: tetrice_pack [-p] GAME GAME_ADDR STUB STUB_ADDR OUTPUT\n");
+        printf("       tetrice_pack -a OUTPUT ASSET_BANK\n");
+        return 1;
+    }
+    argv += phc25;
+    game_addr = (uint16_t)strtoul(argv[2], NULL, 0);
+    stub_addr = (uint16_t)strtoul(argv[4], NULL, 0);
+    game_size = read_image(argv[1], game_addr, game_file, phc25);
+    stub_size = read_image(argv[3], stub_addr, stub_file, phc25);
+    if (game_size < 0 || stub_size < 0)
+        return 1;
+    if (phc25)
+        return pack_phc25(game_addr, game_size, stub_addr, stub_size, argv[5]);
+
+    size = tape_pack(game_file + game_addr, (size_t)game_size, game_addr, stub_file + stub_addr, (size_t)stub_size,
+                     stub_addr, image + stub_addr, sizeof(image) - stub_addr, &layout, &error);
+    if (size < 0) {
+        fprintf(stderr, "tetrice_pack: %s\n", error);
+        return 1;
+    }
+    if (write_image(argv[5], 0, stub_addr + (size_t)size))
+        return 1;
+
+    raw_seconds = tape_load_seconds(game_file + game_addr, (size_t)game_size);
+    packed_seconds = tape_load_seconds(image + stub_addr, (size_t)size);
+    unpack_seconds = (double)game_size * PACK_CYCLES_PER_BYTE / PACK_CLOCK;
+    printf("game    %5ld bytes at %u, ZX0 stream %u bytes (%.1f%%)\n", game_size, game_addr, layout.stream_size,
+           100.0 * layout.stream_size / game_size);
+    printf("stub    %5ld bytes at %u, stream moved to %u, RAM used up to %u\n", stub_size, stub_addr,
+           layout.moved_addr, layout.ram_end - 1);
+    printf("tape    raw %5ld bytes %5.1f s, packed %5ld bytes %5.1f s + %.1f s to unpack (%+.1f s)\n", game_size,
+           raw_seconds, size, packed_seconds, unpack_seconds, packed_seconds + unpack_seconds - raw_seconds);
+    return 0;
+}
@@ -0,0 +1,258 @@
+/* play.c - Play or watch a game in the terminal */
+/* Keyboard games run at a fixed frame rate: each frame takes the  */
+/* oldest key from the input thread, then applies gravity when it  */
+/* is due, like the server. -r plays a recorded replay back. Every */
+/* frame is captured in a snapshot ring, the rewind key goes back  */
+/* -k frames. On exit the paint cost and the key-to-screen latency */
+/* are reported on stderr.                                         */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "term.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "spectate.h"
+#include "histogram.h"
+
+typedef struct play_options_t {
+    uint32_t seed;
+    uint32_t fps;
+    uint32_t rewind_frames;
+    const char* replay_path;
+    const char* spectate_name;
+} play_options_t;
+
+static game_state_t state;
+static host_rng_t rng;
+static snapshot_ring_t history;
+/* Replay position at each frame of the ring, to rewind playback too */
+static replay_player_t players[SNAPSHOT_RING_FRAMES];
+
+static histogram_t frame_bytes;
+static histogram_t key_latency;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static const uint8_t* map_replay(const char* path, size_t* size)
+{
+    struct stat st;
+    void* data;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+    *size = (size_t)st.st_size;
+    return data;
+}
+
+static void repaint(void)
+{
+    term_invalidate(&state);
+    display_sync_ui(&state);
+    display_preview_piece(state.next_piece);
+    display_sync_playfield(&state);
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_play [options]\n");
+    printf("  -s SEED     game seed (default: from the clock)\n");
+    printf("  -f FPS      frames per second, 0 for as fast as possible (default 60)\n");
+    printf("  -k FRAMES   frames undone by the rewind key (default 60, at most %d)\n", SNAPSHOT_RING_FRAMES - 1);
+    printf("  -r FILE     play a recorded replay back instead of the keyboard\n");
+    printf("  -P NAME     also publish the game to a shared-memory spectator feed\n");
+    printf("Keys: O/P or arrows move, Z/up rotates, A rotates back, space/down drops,\n");
+    printf("      R or backspace rewinds, Q quits\n");
+}
+
+int main(int argc, char** argv)
+{
+    play_options_t options;
+    replay_player_t player;
+    spsc_event_t key;
+    term_stats_t stats;
+    input_action_t input;
+    const uint8_t* replay = NULL;
+    size_t replay_size = 0, bytes;
+    uint64_t start, next_frame, frame_ns, key_stamp;
+    uint32_t frame = 0, painted = 0, full_repaint;
+    uint8_t over = 0, keyboard, rewind;
+    double elapsed;
+    int i;
+
+    options.seed = (uint32_t)time(NULL);
+    options.fps = 60;
+    options.rewind_frames = 60;
+    options.replay_path = NULL;
+    options.spectate_name = NULL;
+
+    for (i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 's': options.seed = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'f': options.fps = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'k': options.rewind_frames = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'r': options.replay_path = value; break;
+        case 'P': options.spectate_name = value; break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+    if (options.rewind_frames >= SNAPSHOT_RING_FRAMES)
+        options.rewind_frames = SNAPSHOT_RING_FRAMES - 1;
+
+    memset(&player, 0, sizeof(player));
+    if (options.replay_path) {
+        replay = map_replay(options.replay_path, &replay_size);
+        if (!replay) {
+            fprintf(stderr, "play: cannot read %s\n", options.replay_path);
+            return 1;
+        }
+        if (replay_player_open(&player, replay, replay_size) != REPLAY_OK) {
+            fprintf(stderr, "play: %s is not a replay for this build\n", options.replay_path);
+            return 1;
+        }
+        options.seed = player.seed;
+    }
+
+    keyboard = isatty(STDIN_FILENO);
+    if (term_open(1)) {
+        fprintf(stderr, "play: cannot set up the terminal\n");
+        return 1;
+    }
+    host_display = &term_ops;
+    if (options.spectate_name && spectate_open(options.spectate_name, &term_ops)) {
+        term_close();
+        fprintf(stderr, "play: cannot create spectator feed %s\n", options.spectate_name);
+        return 1;
+    }
+    spectate_follow(&state);
+
+    histogram_reset(&frame_bytes);
+    histogram_reset(&key_latency);
+    snapshot_ring_reset(&history);
+
+    replay_game_start(&state, &rng, options.seed);
+    snapshot_ring_capture(&history, &state, &rng, frame);
+    players[0] = player;
+    repaint();
+    full_repaint = (uint32_t)term_flush();
+
+    frame_ns = options.fps ? 1000000000u / options.fps : 0;
+    start = now_ns();
+    next_frame = start;
+
+    while (1) {
+        key_stamp = 0;
+        rewind = 0;
+
+        if (term_poll_key(&key)) {
+            key_stamp = key.stamp_ns;
+            if (key.value == TERM_KEY_QUIT)
+                break;
+            rewind = key.value == TERM_KEY_REWIND;
+        }
+
+        if (rewind) {
+            // Back to the frame rewind_frames ago, or the oldest one held
+            uint32_t back = options.rewind_frames < history.count ? options.rewind_frames : history.count - 1;
+
+            if (snapshot_ring_rewind(&history, back, &state, &rng)) {
+                frame = snapshot_ring_peek(&history, 0)->frame;
+                player = players[frame & (SNAPSHOT_RING_FRAMES - 1)];
+                over = 0;
+                repaint();
+            }
+        } else if (!over) {
+            if (replay) {
+                if (!replay_player_next(&player, &input))
+                    break;
+                over = game_step(&state, input);
+            } else {
+                // The key first, then gravity when it is due
+                if (key_stamp)
+                    over = game_step(&state, (input_action_t)key.value);
+                if (timeout_ticks > 0)
+                    timeout_ticks--;
+                if (!over && timeout_ticks == 0)
+                    over = game_step(&state, INPUT_TIMEOUT);
+            }
+            frame++;
+            snapshot_ring_capture(&history, &state, &rng, frame);
+            players[frame & (SNAPSHOT_RING_FRAMES - 1)] = player;
+            if (over)
+                display_game_over();
+        }
+
+        bytes = term_flush();
+        if (bytes) {
+            painted++;
+            histogram_add(&frame_bytes, bytes);
+        }
+        if (key_stamp)
+            histogram_add(&key_latency, now_ns() - key_stamp);
+
+        // Nobody can rewind or quit a finished game without a keyboard
+        if (over && !keyboard)
+            break;
+
+        if (frame_ns) {
+            struct timespec ts;
+
+            next_frame += frame_ns;
+            ts.tv_sec = (time_t)(next_frame / 1000000000u);
+            ts.tv_nsec = (long)(next_frame % 1000000000u);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+    }
+    elapsed = (now_ns() - start) * 1e-9;
+
+    spectate_close();
+    term_close();
+    term_get_stats(&stats);
+    host_rng_bind(NULL);
+
+    fprintf(stderr, "%u frames in %.1fs, score %u, level %u%s\n", frame, elapsed, state.score, state.level,
+            over ? ", game over" : "");
+    fprintf(stderr, "paint: %llu bytes in %llu writes, full repaint %u bytes, %u frames painted: "
+            "%.1f bytes mean, p50 %llu, p99 %llu, max %llu\n",
+            (unsigned long long)stats.bytes, (unsigned long long)stats.writes, full_repaint, painted,
+            histogram_mean(&frame_bytes), (unsigned long long)histogram_percentile(&frame_bytes, 50),
+            (unsigned long long)histogram_percentile(&frame_bytes, 99), (unsigned long long)frame_bytes.max);
+    if (keyboard)
+        fprintf(stderr, "input to paint: %llu keys (%llu dropped), p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                (unsigned long long)stats.keys, (unsigned long long)stats.keys_dropped,
+                histogram_percentile(&key_latency, 50) * 1e-6, histogram_percentile(&key_latency, 99) * 1e-6,
+                key_latency.max * 1e-6);
+
+    if (replay)
+        munmap((void*)replay, replay_size);
+    return 0;
+}
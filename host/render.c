@@ -0,0 +1,241 @@
+/* render.c - Replays rendered as the PHC-25 or the Alice shows them */
+/* Plays a replay through the machine's own display code (linked    */
+/* against the test mock, see render.h) and writes every frame's    */
+/* screen to stdout as Y4M (pipe it to an encoder) or as            */
+/* concatenated PNGs. -f none only renders, to measure how many     */
+/* times faster than the machine's 60 fps it runs.                  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+// The machines' sleep() is not POSIX sleep(), as in host.h
+#define sleep posix_sleep
+#include <unistd.h>
+#undef sleep
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "render.h"
+#include "replay.h"
+#include "zobrist.h"
+#include "video.h"
+
+#define RENDER_FPS 60
+
+typedef struct render_options_t {
+    const char* format;
+    const char* replay_path;
+    const char* gfx_dir;
+    uint32_t every;
+} render_options_t;
+
+static game_state_t state;
+static host_rng_t rng;
+static host_rng_t* bound;
+static uint8_t* pixels;
+static video_writer_t video;
+static uint64_t render_ns;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/************************************************************/
+/* The replay's generator in place of the machine's         */
+/************************************************************/
+
+void host_rng_bind(host_rng_t* generator)
+{
+    bound = generator;
+}
+
+uint8_t platform_random()
+{
+    return host_rng_next(bound);
+}
+
+static const uint8_t* map_replay(const char* path, size_t* size)
+{
+    struct stat st;
+    void* data;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+    *size = (size_t)st.st_size;
+    return data;
+}
+
+// Chip memory to palette indices, then out through the writer
+static int emit_frame(void)
+{
+    uint64_t start = now_ns();
+
+    render_screen(pixels);
+    if (video_frame(&video, pixels))
+        return -1;
+    render_ns += now_ns() - start;
+    return 0;
+}
+
+// The recorded ending, as replay_verify checks it: the machine's
+// engine must reach it or the frames show a game nobody played
+static uint8_t same_ending(const replay_player_t* player, uint8_t over)
+{
+    const uint8_t* trailer = player->data + player->end;
+    uint64_t hash = 0;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        hash |= (uint64_t)trailer[3 + i] << (8 * i);
+    return player->frame == player->frames && over == trailer[2] && GAME_HOT(&state)->score == trailer[0]
+        && GAME_HOT(&state)->level == trailer[1] && zobrist_compute(&state) == hash;
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_render_%s -r FILE [options] > output\n", render_machine);
+    printf("  -r FILE     replay to render, recorded with this machine's rules\n");
+    printf("  -f FORMAT   y4m, png (concatenated) or none (default y4m)\n");
+    printf("  -e N        write every Nth frame (default 1)\n");
+    printf("  -g DIR      PHC-25 UI bitmaps (default gfx)\n");
+}
+
+int main(int argc, char** argv)
+{
+    render_options_t options;
+    replay_player_t player;
+    replay_status_t status;
+    input_action_t input;
+    video_format_t format;
+    uint8_t palette[16][3];
+    const uint8_t* replay;
+    size_t replay_size = 0;
+    uint16_t width, height;
+    uint64_t start;
+    uint32_t frame = 0;
+    uint8_t over = 0;
+    double elapsed;
+    int i;
+
+    options.format = "y4m";
+    options.replay_path = NULL;
+    options.gfx_dir = "gfx";
+    options.every = 1;
+
+    for (i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 'r': options.replay_path = value; break;
+        case 'f': options.format = value; break;
+        case 'e': options.every = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'g': options.gfx_dir = value; break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+    if (!strcmp(options.format, "y4m"))
+        format = VIDEO_Y4M;
+    else if (!strcmp(options.format, "png"))
+        format = VIDEO_PNG;
+    else if (!strcmp(options.format, "none"))
+        format = VIDEO_NONE;
+    else {
+        usage();
+        return 1;
+    }
+    if (!options.replay_path) {
+        usage();
+        return 1;
+    }
+    if (options.every == 0)
+        options.every = 1;
+    if (format != VIDEO_NONE && isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "render: refusing to write video to a terminal\n");
+        return 1;
+    }
+
+    replay = map_replay(options.replay_path, &replay_size);
+    if (!replay) {
+        fprintf(stderr, "render: cannot read %s\n", options.replay_path);
+        return 1;
+    }
+    status = replay_player_open(&player, replay, replay_size);
+    if (status != REPLAY_OK) {
+        fprintf(stderr, "render: %s: %s (the %s playfield is %ux%u)\n", options.replay_path,
+                replay_status_string(status), render_machine, PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT);
+        return 1;
+    }
+
+    if (render_open(options.gfx_dir, &width, &height, palette))
+        return 1;
+    pixels = malloc((size_t)width * height);
+    if (!pixels || video_open(&video, STDOUT_FILENO, format, width, height, RENDER_FPS, (const uint8_t(*)[3])palette)) {
+        fprintf(stderr, "render: cannot set up the %ux%u output\n", width, height);
+        return 1;
+    }
+
+    // The same sequence as main() and gameloop() on the machines
+    start = now_ns();
+    display_clear_screen();
+    display_draw_borders();
+    replay_game_start(&state, &rng, player.seed);
+    display_sync_ui(&state);
+    display_preview_piece(GAME_HOT(&state)->next_piece);
+    display_sync_playfield(&state);
+    if (emit_frame())
+        goto write_error;
+
+    while (!over && replay_player_next(&player, &input)) {
+        over = game_step(&state, input);
+        frame++;
+        if (over)
+            display_game_over();
+        if ((frame % options.every == 0 || over) && emit_frame())
+            goto write_error;
+    }
+    elapsed = (now_ns() - start) * 1e-9;
+    host_rng_bind(NULL);
+
+    fprintf(stderr, "%s: %u frames, %llu written, score %u, level %u%s\n", render_machine, frame,
+            (unsigned long long)video.frames, GAME_HOT(&state)->score, GAME_HOT(&state)->level,
+            over ? ", game over" : "");
+    fprintf(stderr, "%.3fs, %.0f frames/s, %.1fx real time at %d fps; rendering and encoding %.1f us/frame, "
+            "%.1f MB out\n", elapsed, elapsed > 0 ? frame / elapsed : 0.0,
+            elapsed > 0 ? frame / elapsed / RENDER_FPS : 0.0, RENDER_FPS,
+            video.frames ? render_ns * 1e-3 / video.frames : 0.0, video.bytes / 1e6);
+
+    video_close(&video);
+    free(pixels);
+    if (!same_ending(&player, over)) {
+        fprintf(stderr, "render: %s diverges from its recording on the %s engine\n", options.replay_path,
+                render_machine);
+        return 1;
+    }
+    munmap((void*)replay, replay_size);
+    return 0;
+
+write_error:
+    fprintf(stderr, "render: write failed after %llu frames\n", (unsigned long long)video.frames);
+    return 1;
+}
@@ -0,0 +1,22 @@
+/* render.h - What the PHC-25 or the Alice shows, in software */
+/* tetrice_render_phc25 and tetrice_render_alice link the machine's */
+/* own display code (platform_phc25.c, platform_alice.c) against    */
+/* the test mock; render_phc25.c and render_alice.c turn the mock's */
+/* screen memory into pixels through a software video chip.         */
+
+#ifndef HOST_RENDER_H
+#define HOST_RENDER_H
+
+#include <stdint.h>
+
+/* Machine name for messages */
+extern const char render_machine[];
+
+/* Clear the machine, load the UI bitmaps of gfx_dir where it needs
+ * them, give the frame size and palette; returns 0 on success */
+int render_open(const char* gfx_dir, uint16_t* width, uint16_t* height, uint8_t palette[16][3]);
+
+/* One palette index per pixel of the screen as it stands */
+void render_screen(uint8_t* pixels);
+
+#endif /* HOST_RENDER_H */
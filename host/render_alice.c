@@ -0,0 +1,25 @@
+/* render_alice.c - The Alice screen through the mock's EF9345 */
+/* platform_alice.c drives the software EF9345 register by register */
+/* (gfx/alice_screen.h replayed by display_draw_borders included),  */
+/* so a frame is just that chip's page.                              */
+
+#include "render.h"
+#include "ef9345.h"
+#include "../platform.h"
+
+const char render_machine[] = "alice";
+
+int render_open(const char* gfx_dir, uint16_t* width, uint16_t* height, uint8_t palette[16][3])
+{
+    if (mock_open(1, gfx_dir))
+        return -1;
+    *width = EF9345_WIDTH;
+    *height = EF9345_HEIGHT;
+    ef9345_palette(palette);
+    return 0;
+}
+
+void render_screen(uint8_t* pixels)
+{
+    ef9345_render(mock_vdp(), pixels);
+}
@@ -0,0 +1,30 @@
+/* render_phc25.c - The PHC-25 screen through a software MC6847 */
+/* platform_phc25.c POKEs Mode 12 VRAM into the mock; each frame   */
+/* is that page in the colour set init_graphics_mode12() selects.  */
+
+#include <string.h>
+
+#include "render.h"
+#include "mc6847.h"
+#include "../platform.h"
+
+const char render_machine[] = "phc25";
+
+static mc6847_t vdg;
+
+int render_open(const char* gfx_dir, uint16_t* width, uint16_t* height, uint8_t palette[16][3])
+{
+    if (mock_open(1, gfx_dir))
+        return -1;
+    vdg.css = MODE12_CSS != 0;
+    *width = MC6847_WIDTH;
+    *height = MC6847_HEIGHT;
+    mc6847_palette(&vdg, palette);
+    return 0;
+}
+
+void render_screen(uint8_t* pixels)
+{
+    memcpy(vdg.vram, MOCK_RAM(VRAM_START), sizeof(vdg.vram));
+    mc6847_render(&vdg, pixels);
+}
@@ -0,0 +1,12 @@
+/* render_platform.c - The machine's display code for the renderer */
+/* The pieces come from the replay's generator (render.c), so the  */
+/* platform's own platform_random is renamed out of the way.       */
+
+#define platform_random machine_random
+
+#ifdef PHC25
+#include "../platform_phc25.c"
+#endif
+#ifdef ALICE
+#include "../platform_alice.c"
+#endif
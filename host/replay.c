@@ -0,0 +1,312 @@
+/* replay.c - Deterministic replay format */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+#include "zobrist.h"
+
+#define RUN_SHORT_MAX 31
+
+/************************************************************/
+/* Byte helpers                                             */
+/************************************************************/
+
+static int buffer_reserve(replay_recorder_t* rec, size_t extra)
+{
+    size_t capacity = rec->capacity ? rec->capacity : 256;
+    uint8_t* data;
+
+    if (rec->size + extra <= rec->capacity)
+        return 0;
+    while (capacity < rec->size + extra)
+        capacity *= 2;
+    data = realloc(rec->data, capacity);
+    if (!data)
+        return -1;
+    rec->data = data;
+    rec->capacity = capacity;
+    return 0;
+}
+
+static size_t put_varint(uint8_t* out, uint32_t value)
+{
+    size_t n = 0;
+
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+// Returns 0 when the input ends inside the varint
+static size_t get_varint(const uint8_t* in, size_t available, uint32_t* value)
+{
+    uint32_t v = 0;
+    size_t n = 0;
+    uint8_t shift = 0;
+
+    while (n < available && shift < 35) {
+        v |= (uint32_t)(in[n] & 0x7F) << shift;
+        if (!(in[n++] & 0x80)) {
+            *value = v;
+            return n;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+static void put_u32(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32(const uint8_t* in)
+{
+    return in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+/************************************************************/
+/* Recording                                                */
+/************************************************************/
+
+void replay_game_start(game_state_t* state, host_rng_t* rng, uint32_t seed)
+{
+    host_rng_seed(rng, seed);
+    host_rng_bind(rng);
+    game_start(state);
+}
+
+void replay_recorder_start(replay_recorder_t* rec, uint32_t seed)
+{
+    rec->size = 0;
+    rec->seed = seed;
+    rec->frames = 0;
+    rec->run = 0;
+    rec->run_input = INPUT_NONE;
+    rec->error = 0;
+}
+
+static int flush_run(replay_recorder_t* rec)
+{
+    if (rec->run == 0)
+        return 0;
+    if (buffer_reserve(rec, 6))
+        return -1;
+
+    if (rec->run <= RUN_SHORT_MAX) {
+        rec->data[rec->size++] = (uint8_t)(rec->run_input | (rec->run << 3));
+    } else {
+        rec->data[rec->size++] = rec->run_input;
+        rec->size += put_varint(&rec->data[rec->size], rec->run);
+    }
+    rec->run = 0;
+    return 0;
+}
+
+uint8_t replay_recorder_step(replay_recorder_t* rec, game_state_t* state, input_action_t input)
+{
+    // A run that cannot be stored would be folded into the next one:
+    // the game goes on, but the replay is lost
+    if (rec->run && (uint8_t)input != rec->run_input && flush_run(rec)) {
+        rec->error = 1;
+        rec->run = 0;
+    }
+    rec->run_input = (uint8_t)input;
+    rec->run++;
+    rec->frames++;
+
+    return game_step(state, input);
+}
+
+int replay_recorder_finish(replay_recorder_t* rec, const game_state_t* state, uint8_t game_over,
+                           uint8_t** data, size_t* size)
+{
+    uint8_t* out;
+    uint64_t hash;
+    size_t n;
+    int i;
+
+    if (rec->error || flush_run(rec))
+        return -1;
+
+    out = malloc(REPLAY_HEADER_SIZE + 5 + rec->size + REPLAY_TRAILER_SIZE);
+    if (!out)
+        return -1;
+
+    memcpy(out, REPLAY_MAGIC, 4);
+    out[4] = REPLAY_FORMAT_VERSION;
+    out[5] = REPLAY_ENGINE_VERSION;
+    out[6] = PLAYFIELD_WIDTH;
+    out[7] = PLAYFIELD_HEIGHT;
+    put_u32(&out[8], rec->seed);
+    n = REPLAY_HEADER_SIZE;
+    n += put_varint(&out[n], rec->frames);
+
+    memcpy(&out[n], rec->data, rec->size);
+    n += rec->size;
+
+    out[n++] = state->score;
+    out[n++] = state->level;
+    out[n++] = game_over ? 1 : 0;
+    hash = zobrist_compute(state);
+    for (i = 0; i < 8; i++)
+        out[n++] = (uint8_t)(hash >> (8 * i));
+
+    *data = out;
+    *size = n;
+    return 0;
+}
+
+void replay_recorder_free(replay_recorder_t* rec)
+{
+    free(rec->data);
+    rec->data = NULL;
+    rec->size = rec->capacity = 0;
+}
+
+int replay_write_file(const char* path, const uint8_t* data, size_t size)
+{
+    FILE* f = fopen(path, "wb");
+    int ok;
+
+    if (!f)
+        return -1;
+    ok = fwrite(data, 1, size, f) == size;
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+/************************************************************/
+/* Verification                                             */
+/************************************************************/
+
+replay_status_t replay_player_open(replay_player_t* player, const uint8_t* data, size_t size)
+{
+    size_t n;
+
+    memset(player, 0, sizeof(*player));
+
+    if (size < REPLAY_HEADER_SIZE + 1 + REPLAY_TRAILER_SIZE || memcmp(data, REPLAY_MAGIC, 4) != 0)
+        return REPLAY_BAD_HEADER;
+    if (data[4] != REPLAY_FORMAT_VERSION || data[5] != REPLAY_ENGINE_VERSION)
+        return REPLAY_BAD_VERSION;
+    if (data[6] != PLAYFIELD_WIDTH || data[7] != PLAYFIELD_HEIGHT)
+        return REPLAY_BAD_GEOMETRY;
+
+    player->seed = get_u32(&data[8]);
+    n = get_varint(&data[REPLAY_HEADER_SIZE], size - REPLAY_HEADER_SIZE - REPLAY_TRAILER_SIZE, &player->frames);
+    if (!n)
+        return REPLAY_TRUNCATED;
+    player->data = data;
+    player->pos = REPLAY_HEADER_SIZE + n;
+    player->end = size - REPLAY_TRAILER_SIZE;
+    return REPLAY_OK;
+}
+
+uint8_t replay_player_next(replay_player_t* player, input_action_t* input)
+{
+    const uint8_t* data = player->data;
+    uint8_t token;
+    size_t n;
+
+    while (player->run == 0) {
+        if (player->frame >= player->frames || player->pos >= player->end)
+            return 0;
+        token = data[player->pos++];
+        player->input = token & 0x07;
+        player->run = token >> 3;
+        if (player->run == 0) {
+            n = get_varint(&data[player->pos], player->end - player->pos, &player->run);
+            if (!n)
+                return 0;
+            player->pos += n;
+        }
+        if (player->input > INPUT_TIMEOUT || player->run > player->frames - player->frame) {
+            player->run = 0;
+            return 0;
+        }
+    }
+
+    player->run--;
+    player->frame++;
+    *input = (input_action_t)player->input;
+    return 1;
+}
+
+replay_status_t replay_verify(const uint8_t* data, size_t size, replay_result_t* result)
+{
+    replay_player_t player;
+    replay_status_t status;
+    game_state_t state;
+    host_rng_t rng;
+    input_action_t input;
+    const uint8_t* trailer;
+    uint64_t hash = 0;
+    uint8_t over = 0;
+    int i;
+
+    memset(result, 0, sizeof(*result));
+
+    status = replay_player_open(&player, data, size);
+    if (status != REPLAY_OK)
+        return status;
+    result->seed = player.seed;
+    result->frames = player.frames;
+    trailer = data + player.end;
+
+    replay_game_start(&state, &rng, player.seed);
+
+    while (replay_player_next(&player, &input)) {
+        if (over) {
+            host_rng_bind(NULL);
+            return REPLAY_EARLY_GAME_OVER;
+        }
+        over = game_step(&state, input);
+    }
+    host_rng_bind(NULL);
+
+    if (player.frame != player.frames || player.pos != player.end)
+        return REPLAY_TRUNCATED;
+
+    result->score = state.score;
+    result->level = state.level;
+    result->game_over = over;
+    result->hash = zobrist_compute(&state);
+
+    for (i = 0; i < 8; i++)
+        hash |= (uint64_t)trailer[3 + i] << (8 * i);
+
+    if (over != trailer[2])
+        return REPLAY_GAME_OVER_MISMATCH;
+    if (state.score != trailer[0])
+        return REPLAY_SCORE_MISMATCH;
+    if (state.level != trailer[1])
+        return REPLAY_LEVEL_MISMATCH;
+    if (result->hash != hash)
+        return REPLAY_HASH_MISMATCH;
+    return REPLAY_OK;
+}
+
+const char* replay_status_string(replay_status_t status)
+{
+    switch (status) {
+    case REPLAY_OK:                 return "ok";
+    case REPLAY_BAD_HEADER:         return "not a replay";
+    case REPLAY_BAD_VERSION:        return "unsupported format or engine version";
+    case REPLAY_BAD_GEOMETRY:       return "playfield geometry differs from this build";
+    case REPLAY_TRUNCATED:          return "truncated or corrupt input stream";
+    case REPLAY_EARLY_GAME_OVER:    return "game over before the last frame";
+    case REPLAY_GAME_OVER_MISMATCH: return "game over flag differs";
+    case REPLAY_SCORE_MISMATCH:     return "final score differs";
+    case REPLAY_LEVEL_MISMATCH:     return "final level differs";
+    case REPLAY_HASH_MISMATCH:      return "final board hash differs";
+    default:                        return "unknown error";
+    }
+}
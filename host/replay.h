@@ -0,0 +1,104 @@
+/* replay.h - Deterministic replay format */
+/*                                                               */
+/* A game is its seed plus the input fed to game_step each frame. */
+/*                                                               */
+/*   0  "TRPL"                                                   */
+/*   4  format version, engine version                           */
+/*   6  playfield width, height                                  */
+/*   8  seed (u32 little endian)                                 */
+/*  12  frame count (varint)                                     */
+/*      runs: token = input (bits 0-2) | length (bits 3-7),      */
+/*            length 0 = varint length follows                   */
+/*      trailer: score, level, game over flag,                   */
+/*               Zobrist hash of the final state (u64 LE)        */
+
+#ifndef HOST_REPLAY_H
+#define HOST_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "engine.h"
+#include "rng.h"
+
+#define REPLAY_MAGIC "TRPL"
+#define REPLAY_FORMAT_VERSION 1
+
+/* Bump whenever the rules, the RNG or game_start change behaviour */
+#define REPLAY_ENGINE_VERSION 2
+
+#define REPLAY_HEADER_SIZE 12
+#define REPLAY_TRAILER_SIZE 11
+
+typedef enum {
+    REPLAY_OK = 0,
+    REPLAY_BAD_HEADER,
+    REPLAY_BAD_VERSION,
+    REPLAY_BAD_GEOMETRY,
+    REPLAY_TRUNCATED,
+    REPLAY_EARLY_GAME_OVER,     /* Game ended before the last frame */
+    REPLAY_GAME_OVER_MISMATCH,  /* Recorded and replayed endings differ */
+    REPLAY_SCORE_MISMATCH,
+    REPLAY_LEVEL_MISMATCH,
+    REPLAY_HASH_MISMATCH
+} replay_status_t;
+
+typedef struct replay_recorder_t {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    uint32_t seed;
+    uint32_t frames;
+    uint32_t run;               /* Length of the pending run */
+    uint8_t run_input;
+    uint8_t error;              /* A run could not be stored: finish fails */
+} replay_recorder_t;
+
+/* Walks the recorded inputs one frame at a time */
+typedef struct replay_player_t {
+    const uint8_t* data;
+    size_t pos;
+    size_t end;                 /* Start of the trailer */
+    uint32_t seed;
+    uint32_t frames;
+    uint32_t frame;             /* Inputs returned so far */
+    uint32_t run;               /* Left in the current run */
+    uint8_t input;
+} replay_player_t;
+
+typedef struct replay_result_t {
+    uint32_t seed;
+    uint32_t frames;
+    uint8_t score;
+    uint8_t level;
+    uint8_t game_over;
+    uint64_t hash;
+} replay_result_t;
+
+/* Canonical start of a recorded game: seeds and binds rng, then game_start */
+void replay_game_start(game_state_t* state, host_rng_t* rng, uint32_t seed);
+
+/* Recording: start after replay_game_start, step instead of game_step */
+void replay_recorder_start(replay_recorder_t* rec, uint32_t seed);
+uint8_t replay_recorder_step(replay_recorder_t* rec, game_state_t* state, input_action_t input);
+
+/* Encode the finished game, *data is malloc'ed and owned by the caller.
+ * Returns -1 if any step ran out of memory, the inputs being incomplete */
+int replay_recorder_finish(replay_recorder_t* rec, const game_state_t* state, uint8_t game_over,
+                           uint8_t** data, size_t* size);
+void replay_recorder_free(replay_recorder_t* rec);
+
+int replay_write_file(const char* path, const uint8_t* data, size_t size);
+
+/* Playback: check the header, then replay_game_start with player->seed
+ * and feed each input to game_step. next returns 0 after the last frame
+ * or on a corrupt run (frame < frames). The player is a plain struct,
+ * copy it to seek back. */
+replay_status_t replay_player_open(replay_player_t* player, const uint8_t* data, size_t size);
+uint8_t replay_player_next(replay_player_t* player, input_action_t* input);
+
+/* Re-run a replay headlessly and compare the outcome with its trailer */
+replay_status_t replay_verify(const uint8_t* data, size_t size, replay_result_t* result);
+const char* replay_status_string(replay_status_t status);
+
+#endif /* HOST_REPLAY_H */
@@ -0,0 +1,19 @@
+/* rng.c - Host random number generator */
+
+#include "rng.h"
+
+void host_rng_seed(host_rng_t* rng, uint32_t seed)
+{
+    // xorshift32 must never hold a zero state
+    rng->state = seed ? seed : 0x2545F491u;
+}
+
+uint8_t host_rng_next(host_rng_t* rng)
+{
+    uint32_t s = rng->state;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    rng->state = s;
+    return (uint8_t)(s >> 24);
+}
@@ -0,0 +1,19 @@
+/* rng.h - Host random number generator */
+/* Each game owns its generator; platform_random() draws from the */
+/* one bound to the calling thread (platform_host.c, or render.c  */
+/* when the machines' display code runs a replay).                */
+
+#ifndef HOST_RNG_H
+#define HOST_RNG_H
+
+#include <stdint.h>
+
+typedef struct host_rng_t {
+    uint32_t state;
+} host_rng_t;
+
+void host_rng_seed(host_rng_t* rng, uint32_t seed);
+uint8_t host_rng_next(host_rng_t* rng);
+void host_rng_bind(host_rng_t* rng);
+
+#endif /* HOST_RNG_H */
@@ -0,0 +1,169 @@
+/* rollback.c - Rollback netcode session for one versus peer */
+
+#include <string.h>
+#include <time.h>
+
+#include "rollback.h"
+
+#define SLOT(frame) ((frame) & (ROLLBACK_WINDOW - 1))
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void put_u32(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32(const uint8_t* in)
+{
+    return in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void rollback_init(rollback_session_t* session, uint8_t local, uint8_t input_delay, uint32_t seed)
+{
+    uint32_t f;
+
+    memset(session, 0, sizeof(*session));
+    session->local = local;
+    session->input_delay = input_delay < ROLLBACK_MAX_PREDICTION ? input_delay : ROLLBACK_MAX_PREDICTION - 1;
+    versus_init(&session->state, seed);
+
+    // The first input_delay frames have no local input
+    for (f = 0; f < session->input_delay; f++)
+        session->local_inputs[SLOT(f)] = INPUT_NONE;
+    session->local_next = session->input_delay;
+    session->rollback_from = ROLLBACK_NONE;
+
+    histogram_reset(&session->stats.depth);
+    histogram_reset(&session->stats.rollback_ns);
+    histogram_reset(&session->stats.advance_ns);
+}
+
+uint32_t rollback_add_local_input(rollback_session_t* session, uint8_t input)
+{
+    uint32_t frame = session->state.frame + session->input_delay;
+
+    // Stalled ticks do not queue more than one input per frame
+    if (frame < session->local_next)
+        return session->local_next - 1;
+    session->local_inputs[SLOT(frame)] = input;
+    session->local_next = frame + 1;
+    return frame;
+}
+
+// Restore the oldest corrected frame and simulate back up to the present
+uint8_t rollback_settle(rollback_session_t* session)
+{
+    uint32_t from = session->rollback_from;
+    uint32_t to = session->state.frame;
+    uint32_t f;
+    uint64_t start = now_ns();
+
+    if (from == ROLLBACK_NONE)
+        return 0;
+    session->rollback_from = ROLLBACK_NONE;
+    session->state = session->history[SLOT(from)];
+    for (f = from; f < to; f++) {
+        session->history[SLOT(f)] = session->state;
+        versus_step(&session->state, session->inputs[SLOT(f)]);
+    }
+
+    session->stats.rollbacks++;
+    session->stats.resimulated += to - from;
+    histogram_add(&session->stats.depth, to - from);
+    histogram_add(&session->stats.rollback_ns, now_ns() - start);
+    return 1;
+}
+
+uint8_t rollback_advance(rollback_session_t* session)
+{
+    uint32_t frame = session->state.frame;
+    uint8_t remote = 1 - session->local;
+    uint8_t* inputs;
+    uint64_t start = now_ns();
+
+    rollback_settle(session);
+
+    // Too far ahead of the peer, or of what it can still resend to us
+    if (frame - session->remote_confirmed >= ROLLBACK_MAX_PREDICTION || frame >= session->local_next
+        || session->local_next - session->peer_confirmed >= ROLLBACK_WINDOW) {
+        session->stats.stalls++;
+        return 0;
+    }
+
+    inputs = session->inputs[SLOT(frame)];
+    inputs[session->local] = session->local_inputs[SLOT(frame)];
+    // Prediction: most frames carry no input, taps are rare
+    if (frame >= session->remote_confirmed)
+        inputs[remote] = INPUT_NONE;
+
+    session->history[SLOT(frame)] = session->state;
+    versus_step(&session->state, inputs);
+
+    session->stats.frames++;
+    histogram_add(&session->stats.advance_ns, now_ns() - start);
+    return 1;
+}
+
+size_t rollback_write_packet(rollback_session_t* session, uint8_t* out)
+{
+    uint32_t first = session->peer_confirmed;
+    uint32_t count = session->local_next - first;
+    uint32_t i;
+
+    if (count > ROLLBACK_PACKET_INPUTS)
+        count = ROLLBACK_PACKET_INPUTS;
+
+    out[0] = 'T';
+    out[1] = 'V';
+    put_u32(&out[2], session->remote_confirmed);
+    put_u32(&out[6], first);
+    out[10] = (uint8_t)count;
+    for (i = 0; i < count; i++)
+        out[ROLLBACK_PACKET_HEADER + i] = session->local_inputs[SLOT(first + i)];
+    return ROLLBACK_PACKET_HEADER + count;
+}
+
+uint8_t rollback_read_packet(rollback_session_t* session, const uint8_t* in, size_t length)
+{
+    uint32_t ack, first, count, f;
+    uint8_t remote = 1 - session->local;
+    uint8_t input, *slot;
+
+    if (length < ROLLBACK_PACKET_HEADER || in[0] != 'T' || in[1] != 'V')
+        return 0;
+    ack = get_u32(&in[2]);
+    first = get_u32(&in[6]);
+    count = in[10];
+    if (length != ROLLBACK_PACKET_HEADER + count)
+        return 0;
+
+    if (ack > session->peer_confirmed && ack <= session->local_next)
+        session->peer_confirmed = ack;
+
+    // Only extend the confirmed range: older inputs are known, later ones will be resent
+    for (f = session->remote_confirmed; f < first + count && f >= first; f++) {
+        if (f >= session->state.frame + ROLLBACK_MAX_PREDICTION)
+            break;
+        input = in[ROLLBACK_PACKET_HEADER + (f - first)];
+        slot = &session->inputs[SLOT(f)][remote];
+
+        if (f < session->state.frame && *slot != input) {
+            // Simulated with a wrong guess
+            session->stats.mispredictions++;
+            if (session->rollback_from == ROLLBACK_NONE || f < session->rollback_from)
+                session->rollback_from = f;
+        }
+        *slot = input;
+        session->remote_confirmed = f + 1;
+    }
+    return 1;
+}
@@ -0,0 +1,81 @@
+/* rollback.h - Rollback netcode session for one versus peer */
+/* Each peer simulates both players every frame. The local input */
+/* is known (after an optional input delay), the remote one is    */
+/* predicted until it arrives. When a confirmed remote input      */
+/* differs from the prediction the session restores the state     */
+/* saved at that frame and re-simulates up to the present.        */
+/*                                                                */
+/* Wire packet, one per frame, carrying every local input the     */
+/* peer has not acknowledged yet (so lost packets heal):          */
+/*   0  "TV"                                                      */
+/*   2  ack: remote inputs held for every frame below (u32 LE)    */
+/*   6  first frame of the inputs (u32 LE)                        */
+/*  10  input count, then one input_action_t byte per frame       */
+
+#ifndef HOST_ROLLBACK_H
+#define HOST_ROLLBACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "versus.h"
+#include "histogram.h"
+
+/* Saved frames, a power of two. A peer never predicts more than
+ * half of it ahead of the last confirmed remote input. */
+#define ROLLBACK_WINDOW 128
+#define ROLLBACK_MAX_PREDICTION (ROLLBACK_WINDOW / 2)
+
+#define ROLLBACK_PACKET_HEADER 11
+#define ROLLBACK_PACKET_INPUTS 64
+#define ROLLBACK_PACKET_MAX (ROLLBACK_PACKET_HEADER + ROLLBACK_PACKET_INPUTS)
+
+typedef struct rollback_stats_t {
+    uint64_t frames;            /* Frames advanced */
+    uint64_t rollbacks;
+    uint64_t resimulated;       /* Frames simulated again */
+    uint64_t mispredictions;    /* Remote inputs that differed from the prediction */
+    uint64_t stalls;            /* Ticks spent waiting for the remote side */
+    histogram_t depth;          /* Frames rolled back, per rollback */
+    histogram_t rollback_ns;    /* Restore plus re-simulation, per rollback */
+    histogram_t advance_ns;     /* Whole rollback_advance, per advanced frame */
+} rollback_stats_t;
+
+typedef struct rollback_session_t {
+    uint8_t local;              /* Player index of this peer */
+    uint8_t input_delay;        /* Frames between a local input and its use */
+    versus_state_t state;       /* At the start of frame state.frame */
+
+    /* Indexed by frame % ROLLBACK_WINDOW */
+    versus_state_t history[ROLLBACK_WINDOW];            /* State at the start of the frame */
+    uint8_t inputs[ROLLBACK_WINDOW][VERSUS_PLAYERS];    /* Inputs the frame was simulated with */
+    uint8_t local_inputs[ROLLBACK_WINDOW];
+
+    uint32_t local_next;        /* First frame without a local input */
+    uint32_t remote_confirmed;  /* Remote inputs known for every frame below */
+    uint32_t peer_confirmed;    /* Local inputs the peer acknowledged */
+    uint32_t rollback_from;     /* Oldest corrected frame, ROLLBACK_NONE if none */
+    rollback_stats_t stats;
+} rollback_session_t;
+
+#define ROLLBACK_NONE 0xFFFFFFFFu
+
+void rollback_init(rollback_session_t* session, uint8_t local, uint8_t input_delay, uint32_t seed);
+
+/* Queue this tick's local input, it applies input_delay frames from now.
+ * Returns the frame it was assigned to. */
+uint32_t rollback_add_local_input(rollback_session_t* session, uint8_t input);
+
+/* Apply a pending rollback without advancing, returns 1 if there was one */
+uint8_t rollback_settle(rollback_session_t* session);
+
+/* Roll back if needed, then simulate one frame. Returns 0 on a stall. */
+uint8_t rollback_advance(rollback_session_t* session);
+
+/* Build the packet for the peer, return its length */
+size_t rollback_write_packet(rollback_session_t* session, uint8_t* out);
+
+/* Take a packet from the peer, returns 0 if it is malformed */
+uint8_t rollback_read_packet(rollback_session_t* session, const uint8_t* in, size_t length);
+
+#endif /* HOST_ROLLBACK_H */
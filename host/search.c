@@ -0,0 +1,357 @@
+/* search.c - Beam search over piece placements */
+/* Node expansion runs on the work-stealing pool. Every beam  */
+/* node writes its children to its own slots and the layer is */
+/* ranked by (value, slot), so the chosen move never depends  */
+/* on how jobs were scheduled.                                */
+/* Search is copy-make: each child is its parent's state with */
+/* one piece placed, and a layer keeps all of them until it   */
+/* is ranked. Nothing is played and then undone, so there is  */
+/* nothing to roll back, and snapshot.h is not used here.     */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "search.h"
+#include "eval.h"
+
+// Reward per point scored, on the same scale as eval_score()
+#define WEIGHT_LINES      100
+
+// Keep per-worker counters on separate cache lines
+#define WORKER_STRIDE 8
+
+typedef struct rank_entry_t {
+    int32_t value;
+    uint32_t slot;
+} rank_entry_t;
+
+struct search_t {
+    ws_pool_t* pool;
+    search_params_t params;
+    search_node_t* beam;        /* Current layer, beam_width nodes */
+    search_node_t* children;    /* beam_width * SEARCH_MAX_CHILDREN slots */
+    uint16_t* child_counts;     /* Children written per beam node */
+    rank_entry_t* order;        /* Ranking scratch */
+    uint64_t* worker_nodes;     /* Per-worker node counters */
+    uint32_t beam_size;
+    uint8_t layer_piece;        /* Piece for this layer, NB_PIECES = all */
+    uint8_t layer_is_root;      /* Children record themselves as root move */
+    uint8_t layer_depth;
+    ttable_t* tt;               /* Shared evaluation cache, may be NULL */
+    uint64_t* seen;             /* Board hashes already in the next beam */
+    uint32_t seen_mask;
+    _Atomic uint64_t eval_mismatches;
+    _Atomic uint64_t hash_mismatches;
+    search_stats_t stats;
+};
+
+/************************************************************/
+/* Placement helpers                                        */
+/************************************************************/
+
+uint8_t search_piece_fits(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation)
+{
+    packed_tetromino* tetromino = GET_TETROMINO(piece, rotation);
+    uint8_t i, px, py;
+
+    for (i = 0; i < 4; i++) {
+        px = x + GET_BLOCK_X((*tetromino)[i]);
+        py = y + GET_BLOCK_Y((*tetromino)[i]);
+        if (px >= PLAYFIELD_WIDTH || py >= PLAYFIELD_HEIGHT || !playfield_is_empty_cell(state, px, py))
+            return 0;
+    }
+    return 1;
+}
+
+uint8_t search_drop_y(game_state_t* state, uint8_t piece, uint8_t x, uint8_t rotation)
+{
+    uint8_t y = PIECE_START_Y;
+
+    while (!collision_bottom(state, piece, x, y, rotation))
+        y++;
+    return y;
+}
+
+/************************************************************/
+/* Expansion                                                */
+/************************************************************/
+
+static uint16_t expand_piece(const search_node_t* parent, uint8_t piece,
+                             uint8_t is_root, search_node_t* out)
+{
+    game_state_t scratch;
+    uint16_t n = 0;
+    uint8_t rotation, x, y, points;
+
+    memcpy(&scratch, &parent->state, sizeof(scratch));
+
+    for (rotation = 0; rotation < tetrominos_nb_shapes[piece]; rotation++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+            if (!search_piece_fits(&scratch, piece, x, PIECE_START_Y, rotation))
+                continue;
+
+            y = search_drop_y(&scratch, piece, x, rotation);
+
+            memcpy(&out[n].state, &parent->state, sizeof(game_state_t));
+            memcpy(&out[n].zobrist, &parent->zobrist, sizeof(zobrist_t));
+            zobrist_place_piece(&out[n].zobrist, &out[n].state, piece, x, y, rotation);
+            points = zobrist_check_full_lines(&out[n].zobrist, &out[n].state);
+
+            out[n].reward = parent->reward + WEIGHT_LINES * points;
+            if (is_root) {
+                out[n].root.rotation = rotation;
+                out[n].root.x = x;
+                out[n].root.y = y;
+            } else {
+                out[n].root = parent->root;
+            }
+            n++;
+        }
+    }
+
+    return n;
+}
+
+// Score a job's children: boards already in the table are not evaluated
+// again, the others go through one SIMD batch
+static void evaluate_children(search_t* search, search_node_t* children, uint16_t n, int worker)
+{
+    eval_board_t boards[SEARCH_MAX_CHILDREN];
+    eval_features_t features[SEARCH_MAX_CHILDREN];
+    uint16_t misses[SEARCH_MAX_CHILDREN];
+    eval_features_t check;
+    int32_t score;
+    uint16_t i, m = 0;
+
+    for (i = 0; i < n; i++) {
+        if (search->tt && tt_probe(search->tt, children[i].zobrist.board, worker, &score))
+            children[i].value = children[i].reward + score;
+        else
+            misses[m++] = i;
+    }
+    if (m == 0)
+        return;
+
+    for (i = 0; i < m; i++)
+        eval_board_from_state(&children[misses[i]].state, &boards[i]);
+
+    eval_features_batch(boards, m, features);
+
+    for (i = 0; i < m; i++) {
+        search_node_t* child = &children[misses[i]];
+
+        score = eval_score(&features[i]);
+        child->value = child->reward + score;
+        if (search->tt)
+            tt_store(search->tt, child->zobrist.board, worker, score, search->layer_depth);
+
+        if (search->params.verify) {
+            // Both fast paths must agree with the cell-by-cell definition
+            eval_features_reference(&child->state, &check);
+            if (!eval_features_equal(&check, &features[i]))
+                atomic_fetch_add(&search->eval_mismatches, 1);
+            eval_features(&boards[i], &features[i]);
+            if (!eval_features_equal(&check, &features[i]))
+                atomic_fetch_add(&search->eval_mismatches, 1);
+        }
+    }
+
+    if (search->params.verify) {
+        // The incremental hash must match a full rehash
+        for (i = 0; i < n; i++) {
+            if (zobrist_hash(&children[i].zobrist) != zobrist_compute(&children[i].state))
+                atomic_fetch_add(&search->hash_mismatches, 1);
+        }
+    }
+}
+
+static void expand_job(void* ctx, int32_t job, int worker)
+{
+    search_t* search = ctx;
+    const search_node_t* parent = &search->beam[job];
+    search_node_t* out = &search->children[(size_t)job * SEARCH_MAX_CHILDREN];
+    uint16_t n = 0;
+    uint8_t piece;
+
+    if (search->layer_piece < NB_PIECES) {
+        n = expand_piece(parent, search->layer_piece, search->layer_is_root, out);
+    } else {
+        for (piece = 0; piece < NB_PIECES; piece++)
+            n += expand_piece(parent, piece, 0, out + n);
+    }
+
+    evaluate_children(search, out, n, worker);
+
+    search->child_counts[job] = n;
+    search->worker_nodes[worker * WORKER_STRIDE] += n;
+}
+
+/************************************************************/
+/* Ranking                                                  */
+/************************************************************/
+
+static int rank_compare(const void* a, const void* b)
+{
+    const rank_entry_t* ra = a;
+    const rank_entry_t* rb = b;
+
+    // Best value first, slot index breaks ties
+    if (ra->value != rb->value)
+        return ra->value > rb->value ? -1 : 1;
+    return ra->slot < rb->slot ? -1 : (ra->slot > rb->slot);
+}
+
+// Add a board hash to the beam set, return 0 if it was already there
+static uint8_t beam_insert(search_t* search, uint64_t hash)
+{
+    uint32_t slot;
+
+    hash |= 1;  // 0 marks a free slot
+    for (slot = (uint32_t)hash & search->seen_mask; search->seen[slot]; slot = (slot + 1) & search->seen_mask) {
+        if (search->seen[slot] == hash)
+            return 0;
+    }
+    search->seen[slot] = hash;
+    return 1;
+}
+
+// Keep the best beam_width distinct children as the next layer, return its size
+static uint32_t select_beam(search_t* search)
+{
+    uint32_t i, k, n = 0, kept = 0;
+
+    for (i = 0; i < search->beam_size; i++) {
+        for (k = 0; k < search->child_counts[i]; k++) {
+            search->order[n].slot = i * SEARCH_MAX_CHILDREN + k;
+            search->order[n].value = search->children[search->order[n].slot].value;
+            n++;
+        }
+    }
+
+    qsort(search->order, n, sizeof(rank_entry_t), rank_compare);
+
+    // Identical boards reached by different paths only keep their best copy
+    memset(search->seen, 0, (search->seen_mask + 1) * sizeof(uint64_t));
+    for (i = 0; i < n && kept < search->params.beam_width; i++) {
+        const search_node_t* child = &search->children[search->order[i].slot];
+
+        if (!beam_insert(search, child->zobrist.board)) {
+            search->stats.duplicates++;
+            continue;
+        }
+        memcpy(&search->beam[kept++], child, sizeof(search_node_t));
+    }
+
+    return kept;
+}
+
+/************************************************************/
+/* Public API                                               */
+/************************************************************/
+
+search_t* search_create(ws_pool_t* pool, ttable_t* tt, const search_params_t* params)
+{
+    search_t* search = calloc(1, sizeof(*search));
+    size_t width;
+    uint32_t seen_size = 1;
+
+    if (!search)
+        return NULL;
+
+    search->pool = pool;
+    search->tt = tt;
+    search->params = *params;
+    if (search->params.beam_width < 1)
+        search->params.beam_width = 1;
+    if (search->params.depth < 1)
+        search->params.depth = 1;
+    if (search->params.depth > SEARCH_MAX_DEPTH)
+        search->params.depth = SEARCH_MAX_DEPTH;
+
+    width = search->params.beam_width;
+    search->beam = calloc(width, sizeof(search_node_t));
+    search->children = calloc(width * SEARCH_MAX_CHILDREN, sizeof(search_node_t));
+    search->child_counts = calloc(width, sizeof(uint16_t));
+    search->order = calloc(width * SEARCH_MAX_CHILDREN, sizeof(rank_entry_t));
+    search->worker_nodes = calloc((size_t)pool->nthreads * WORKER_STRIDE, sizeof(uint64_t));
+
+    while (seen_size < 2 * width)
+        seen_size <<= 1;
+    search->seen = calloc(seen_size, sizeof(uint64_t));
+    search->seen_mask = seen_size - 1;
+
+    if (!search->beam || !search->children || !search->child_counts ||
+        !search->order || !search->worker_nodes || !search->seen) {
+        search_destroy(search);
+        return NULL;
+    }
+    return search;
+}
+
+void search_destroy(search_t* search)
+{
+    if (!search)
+        return;
+    free(search->seen);
+    free(search->worker_nodes);
+    free(search->order);
+    free(search->child_counts);
+    free(search->children);
+    free(search->beam);
+    free(search);
+}
+
+uint8_t search_best_move(search_t* search, const game_state_t* state, search_move_t* move)
+{
+    uint8_t depth;
+    int i;
+
+    // Root: the board without the falling piece
+    memset(&search->beam[0], 0, sizeof(search_node_t));
+    memcpy(&search->beam[0].state, state, sizeof(game_state_t));
+    playfield_remove_piece(&search->beam[0].state, state->piece, state->x, state->y, state->rotation);
+    zobrist_reset(&search->beam[0].zobrist, &search->beam[0].state);
+    search->beam_size = 1;
+
+    if (search->tt)
+        tt_new_generation(search->tt);
+
+    for (depth = 0; depth < search->params.depth; depth++) {
+        if (depth == 0)
+            search->layer_piece = state->piece;
+        else if (depth == 1)
+            search->layer_piece = state->next_piece;
+        else
+            search->layer_piece = NB_PIECES;
+        search->layer_is_root = (depth == 0);
+        search->layer_depth = depth;
+
+        if (ws_pool_run(search->pool, (int32_t)search->beam_size, expand_job, search))
+            return 0;  // The pool was made for a narrower beam
+
+        i = (int)select_beam(search);
+        if (i == 0)
+            break;  // Every path dies here: keep the best shallower layer
+        search->beam_size = (uint32_t)i;
+    }
+
+    for (i = 0; i < search->pool->nthreads; i++) {
+        search->stats.nodes += search->worker_nodes[i * WORKER_STRIDE];
+        search->worker_nodes[i * WORKER_STRIDE] = 0;
+    }
+    search->stats.searches++;
+    search->stats.eval_mismatches = atomic_load(&search->eval_mismatches);
+    search->stats.hash_mismatches = atomic_load(&search->hash_mismatches);
+
+    if (depth == 0)
+        return 0;
+
+    *move = search->beam[0].root;
+    move->value = search->beam[0].value;
+    return 1;
+}
+
+const search_stats_t* search_get_stats(const search_t* search)
+{
+    return &search->stats;
+}
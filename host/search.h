@@ -0,0 +1,68 @@
+/* search.h - Beam search over piece placements */
+
+#ifndef HOST_SEARCH_H
+#define HOST_SEARCH_H
+
+#include <stdint.h>
+
+#include "engine.h"
+#include "work_steal.h"
+#include "zobrist.h"
+#include "ttable.h"
+
+/* Upper bound on placements of one piece (rotations x columns) */
+#define SEARCH_MAX_PLACEMENTS (4 * PLAYFIELD_WIDTH)
+
+/* Layers past the preview branch on every piece type */
+#define SEARCH_MAX_CHILDREN (SEARCH_MAX_PLACEMENTS * NB_PIECES)
+
+#define SEARCH_MAX_DEPTH 8
+
+typedef struct search_params_t {
+    uint16_t beam_width;    /* Nodes kept per layer */
+    uint8_t depth;          /* 1 = current piece, 2 = + next_piece, 3+ = any piece */
+    uint8_t verify;         /* Check fast evaluation and hashing against the references */
+} search_params_t;
+
+/* A placement: rotation and column, dropped straight from the top */
+typedef struct search_move_t {
+    uint8_t rotation;
+    uint8_t x;
+    uint8_t y;              /* Landing row */
+    int32_t value;          /* Value of the best leaf reached from it */
+} search_move_t;
+
+typedef struct search_node_t {
+    game_state_t state;     /* Board without a falling piece */
+    int32_t reward;         /* Line-clear reward accumulated on the path */
+    int32_t value;          /* reward + heuristic of the board */
+    search_move_t root;     /* First move on the path */
+    zobrist_t zobrist;      /* Hash of state, kept up to date incrementally */
+} search_node_t;
+
+typedef struct search_stats_t {
+    uint64_t nodes;         /* Children generated and evaluated */
+    uint64_t searches;
+    uint64_t duplicates;        /* Children dropped as already in the beam */
+    uint64_t eval_mismatches;   /* Only counted with verify */
+    uint64_t hash_mismatches;   /* Only counted with verify */
+} search_stats_t;
+
+typedef struct search_t search_t;
+
+/* tt is an optional evaluation cache shared by all workers and searches */
+search_t* search_create(ws_pool_t* pool, ttable_t* tt, const search_params_t* params);
+void search_destroy(search_t* search);
+
+/* Pick the best move for the falling piece of state. The piece may be
+ * placed in the playfield (as game_step leaves it) or not. Returns 0
+ * when no placement is possible, or when the pool cannot hold the beam. */
+uint8_t search_best_move(search_t* search, const game_state_t* state, search_move_t* move);
+
+const search_stats_t* search_get_stats(const search_t* search);
+
+/* Placement helpers shared with the other host tools */
+uint8_t search_piece_fits(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation);
+uint8_t search_drop_y(game_state_t* state, uint8_t piece, uint8_t x, uint8_t rotation);
+
+#endif /* HOST_SEARCH_H */
@@ -0,0 +1,631 @@
+/* server.c - Local tournament server */
+/* Hosts thousands of headless games driven by socket clients.   */
+/* The main thread accepts connections and hands each one to a   */
+/* shard; a shard is one thread pinned to a core with its own     */
+/* epoll loop, game pool and frame timer, and is the only owner   */
+/* of its games. Nothing is allocated once the shards run.        */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+#include "server.h"
+#include "net.h"
+#include "histogram.h"
+
+#define SHARD_MAX_EVENTS 256
+#define SHARD_READ_SIZE 64
+#define GAME_OUT_BUFFER 64      /* Packets waiting for a slow client */
+#define MAX_CATCH_UP_TICKS 4    /* Late frames replayed at once, the rest are skipped */
+
+typedef struct server_game_t {
+    game_state_t state;
+    host_rng_t rng;
+    uint8_t timeout_ticks;      /* Gravity countdown, swapped in around game_step */
+    uint8_t in_head;
+    uint8_t in_count;
+    uint8_t inputs[SERVER_INPUT_QUEUE];
+    uint8_t out[GAME_OUT_BUFFER];
+    uint16_t out_length;
+    uint32_t frame;
+    uint32_t active_index;      /* Position in shard->active */
+    int fd;
+} server_game_t;
+
+typedef struct shard_counters_t {
+    uint64_t ticks;
+    uint64_t late_ticks;        /* Timer expirations beyond the first */
+    uint64_t skipped_ticks;     /* Frames dropped after falling too far behind */
+    uint64_t frames;            /* Game frames advanced */
+    uint64_t steps;             /* game_step calls */
+    uint64_t games_started;
+    uint64_t games_over;
+    uint64_t inputs;
+    uint64_t inputs_dropped;    /* Input queue full */
+    uint64_t packets;
+    uint64_t packets_dropped;   /* Output buffer full */
+    uint64_t bytes_out;
+    uint32_t peak_games;
+} shard_counters_t;
+
+typedef struct server_shard_t {
+    int id;
+    int epoll_fd;
+    int timer_fd;
+    int mailbox[2];             /* Accepted descriptors from the main thread */
+    pthread_t thread;
+
+    server_game_t* games;
+    uint32_t capacity;
+    uint32_t* free_slots;
+    uint32_t free_count;
+    uint32_t* closed_slots;     /* Closed in this epoll batch, freed after it */
+    uint32_t closed_count;
+    uint32_t* active;           /* Dense list of slots being played */
+    uint32_t active_count;
+    _Atomic uint32_t assigned;  /* Games handed to this shard and not yet closed */
+
+    uint32_t next_seed;
+    histogram_t tick_ns;
+    shard_counters_t counters;
+    struct epoll_event events[SHARD_MAX_EVENTS];
+} server_shard_t;
+
+typedef struct server_options_t {
+    const char* path;
+    uint16_t port;
+    int shards;
+    uint32_t max_games;
+    uint32_t fps;
+    uint32_t seed;
+    uint32_t duration;
+} server_options_t;
+
+static volatile sig_atomic_t server_stop = 0;
+static atomic_int shards_quit = 0;
+
+// Tags for the non-game descriptors of a shard
+static uint8_t tag_timer, tag_mailbox;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    server_stop = 1;
+}
+
+/************************************************************/
+/* Games                                                    */
+/************************************************************/
+
+static void game_begin(server_shard_t* shard, server_game_t* g)
+{
+    host_rng_seed(&g->rng, shard->next_seed);
+    shard->next_seed += (uint32_t)0x9E3779B9u;
+    host_rng_bind(&g->rng);
+    game_start(&g->state);
+    g->timeout_ticks = timeout_ticks;
+    shard->counters.games_started++;
+}
+
+static void game_open(server_shard_t* shard, int fd)
+{
+    struct epoll_event ev;
+    server_game_t* g;
+    uint32_t slot;
+
+    if (shard->free_count == 0) {
+        close(fd);
+        atomic_fetch_sub(&shard->assigned, 1);
+        return;
+    }
+    slot = shard->free_slots[--shard->free_count];
+    g = &shard->games[slot];
+    g->fd = fd;
+    g->frame = 0;
+    g->in_head = g->in_count = 0;
+    g->out_length = 0;
+    g->active_index = shard->active_count;
+    shard->active[shard->active_count++] = slot;
+    if (shard->active_count > shard->counters.peak_games)
+        shard->counters.peak_games = shard->active_count;
+
+    game_begin(shard, g);
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = g;
+    epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+static void game_close(server_shard_t* shard, server_game_t* g)
+{
+    uint32_t slot = (uint32_t)(g - shard->games);
+    uint32_t last = shard->active[--shard->active_count];
+
+    epoll_ctl(shard->epoll_fd, EPOLL_CTL_DEL, g->fd, NULL);
+    close(g->fd);
+    g->fd = -1;
+
+    // Keep the active list dense: move the last game into the hole
+    shard->active[g->active_index] = last;
+    shard->games[last].active_index = g->active_index;
+    shard->closed_slots[shard->closed_count++] = slot;
+    atomic_fetch_sub(&shard->assigned, 1);
+}
+
+// Events of a closed descriptor can still be pending in the batch; a
+// slot reused by game_open before the batch ends would get them
+static void shard_release_closed(server_shard_t* shard)
+{
+    while (shard->closed_count)
+        shard->free_slots[shard->free_count++] = shard->closed_slots[--shard->closed_count];
+}
+
+static void game_flush(server_shard_t* shard, server_game_t* g)
+{
+    struct epoll_event ev;
+    ssize_t n;
+
+    n = write(g->fd, g->out, g->out_length);
+    if (n > 0) {
+        shard->counters.bytes_out += (uint64_t)n;
+        memmove(g->out, g->out + n, g->out_length - (size_t)n);
+        g->out_length -= (uint16_t)n;
+    }
+    if (g->out_length == 0) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = g;
+        epoll_ctl(shard->epoll_fd, EPOLL_CTL_MOD, g->fd, &ev);
+    }
+}
+
+static void game_send(server_shard_t* shard, server_game_t* g, uint8_t flags)
+{
+    struct epoll_event ev;
+    uint8_t packet[SERVER_PACKET_SIZE];
+    size_t offset = 0;
+    ssize_t n;
+
+    server_packet_encode(packet, g->frame, &g->state, flags);
+    shard->counters.packets++;
+
+    // Fast path: nothing queued, write straight to the socket
+    if (g->out_length == 0) {
+        n = write(g->fd, packet, sizeof(packet));
+        if (n == (ssize_t)sizeof(packet)) {
+            shard->counters.bytes_out += sizeof(packet);
+            return;
+        }
+        if (n > 0) {
+            shard->counters.bytes_out += (uint64_t)n;
+            offset = (size_t)n;
+        }
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.ptr = g;
+        epoll_ctl(shard->epoll_fd, EPOLL_CTL_MOD, g->fd, &ev);
+    }
+
+    if (g->out_length + sizeof(packet) - offset > sizeof(g->out)) {
+        shard->counters.packets_dropped++;
+        return;
+    }
+    memcpy(g->out + g->out_length, packet + offset, sizeof(packet) - offset);
+    g->out_length += (uint16_t)(sizeof(packet) - offset);
+}
+
+// Returns 0 when the client is gone
+static uint8_t game_read(server_shard_t* shard, server_game_t* g)
+{
+    uint8_t buffer[SHARD_READ_SIZE];
+    ssize_t n, i;
+
+    n = read(g->fd, buffer, sizeof(buffer));
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+        return 0;
+
+    for (i = 0; i < n; i++) {
+        if (buffer[i] < INPUT_MOVE_LEFT || buffer[i] > INPUT_DROP)
+            continue;
+        shard->counters.inputs++;
+        if (g->in_count == SERVER_INPUT_QUEUE) {
+            shard->counters.inputs_dropped++;
+            continue;
+        }
+        g->inputs[(g->in_head + g->in_count++) % SERVER_INPUT_QUEUE] = buffer[i];
+    }
+    return 1;
+}
+
+// One frame: gravity first, else the oldest queued input
+static void game_frame(server_shard_t* shard, server_game_t* g)
+{
+    input_action_t input;
+    uint8_t over;
+
+    g->frame++;
+    if (g->timeout_ticks > 0)
+        g->timeout_ticks--;
+
+    if (g->timeout_ticks == 0) {
+        input = INPUT_TIMEOUT;
+    } else if (g->in_count) {
+        input = (input_action_t)g->inputs[g->in_head];
+        g->in_head = (g->in_head + 1) % SERVER_INPUT_QUEUE;
+        g->in_count--;
+    } else {
+        return;
+    }
+
+    timeout_ticks = g->timeout_ticks;
+    host_rng_bind(&g->rng);
+    over = game_step(&g->state, input);
+    g->timeout_ticks = timeout_ticks;
+    shard->counters.steps++;
+
+    if (over) {
+        shard->counters.games_over++;
+        game_send(shard, g, SERVER_FLAG_GAME_OVER);
+        game_begin(shard, g);
+        return;
+    }
+    game_send(shard, g, 0);
+}
+
+/************************************************************/
+/* Shards                                                   */
+/************************************************************/
+
+static void shard_tick(server_shard_t* shard, uint64_t expirations)
+{
+    uint64_t start = now_ns();
+    uint64_t t;
+    uint32_t i;
+
+    shard->counters.ticks++;
+    if (expirations > 1)
+        shard->counters.late_ticks += expirations - 1;
+    if (expirations > MAX_CATCH_UP_TICKS) {
+        shard->counters.skipped_ticks += expirations - MAX_CATCH_UP_TICKS;
+        expirations = MAX_CATCH_UP_TICKS;
+    }
+
+    for (t = 0; t < expirations; t++) {
+        for (i = 0; i < shard->active_count; i++)
+            game_frame(shard, &shard->games[shard->active[i]]);
+        shard->counters.frames += shard->active_count;
+    }
+    host_rng_bind(NULL);
+
+    histogram_add(&shard->tick_ns, now_ns() - start);
+}
+
+static void* shard_main(void* arg)
+{
+    server_shard_t* shard = arg;
+    uint64_t expirations;
+    int fds[16];
+    int n, i, k;
+
+    while (!atomic_load_explicit(&shards_quit, memory_order_relaxed)) {
+        n = epoll_wait(shard->epoll_fd, shard->events, SHARD_MAX_EVENTS, 100);
+        for (i = 0; i < n; i++) {
+            struct epoll_event* ev = &shard->events[i];
+
+            if (ev->data.ptr == &tag_timer) {
+                if (read(shard->timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+                    shard_tick(shard, expirations);
+            } else if (ev->data.ptr == &tag_mailbox) {
+                ssize_t bytes = read(shard->mailbox[0], fds, sizeof(fds));
+                for (k = 0; k < (int)(bytes / (ssize_t)sizeof(int)); k++)
+                    game_open(shard, fds[k]);
+            } else {
+                server_game_t* g = ev->data.ptr;
+
+                // A game closed earlier in this batch may still have events;
+                // its slot stays closed until shard_release_closed
+                if (g->fd < 0)
+                    continue;
+                if ((ev->events & (EPOLLHUP | EPOLLERR)) || ((ev->events & EPOLLIN) && !game_read(shard, g))) {
+                    game_close(shard, g);
+                    continue;
+                }
+                if ((ev->events & EPOLLOUT) && g->out_length)
+                    game_flush(shard, g);
+            }
+        }
+        shard_release_closed(shard);
+    }
+
+    while (shard->active_count)
+        game_close(shard, &shard->games[shard->active[0]]);
+    return NULL;
+}
+
+static int shard_init(server_shard_t* shard, int id, uint32_t capacity, const server_options_t* options)
+{
+    struct itimerspec period;
+    struct epoll_event ev;
+    uint64_t interval = 1000000000u / options->fps;
+    uint32_t i;
+
+    memset(shard, 0, sizeof(*shard));
+    shard->id = id;
+    shard->capacity = capacity;
+    shard->next_seed = options->seed + (uint32_t)id;
+    histogram_reset(&shard->tick_ns);
+
+    // The whole pool up front: nothing is allocated while games run
+    shard->games = calloc(capacity, sizeof(server_game_t));
+    shard->free_slots = malloc(capacity * sizeof(uint32_t));
+    shard->closed_slots = malloc(capacity * sizeof(uint32_t));
+    shard->active = malloc(capacity * sizeof(uint32_t));
+    if (!shard->games || !shard->free_slots || !shard->closed_slots || !shard->active)
+        return -1;
+    for (i = 0; i < capacity; i++) {
+        shard->games[i].fd = -1;
+        shard->free_slots[i] = capacity - 1 - i;
+    }
+    shard->free_count = capacity;
+
+    shard->epoll_fd = epoll_create1(0);
+    shard->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (shard->epoll_fd < 0 || shard->timer_fd < 0 || pipe(shard->mailbox))
+        return -1;
+    net_set_nonblocking(shard->mailbox[0]);
+
+    period.it_interval.tv_sec = (time_t)(interval / 1000000000u);
+    period.it_interval.tv_nsec = (long)(interval % 1000000000u);
+    period.it_value = period.it_interval;
+    timerfd_settime(shard->timer_fd, 0, &period, NULL);
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = &tag_timer;
+    epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, shard->timer_fd, &ev);
+    ev.data.ptr = &tag_mailbox;
+    epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, shard->mailbox[0], &ev);
+    return 0;
+}
+
+static void shard_free(server_shard_t* shard)
+{
+    close(shard->epoll_fd);
+    close(shard->timer_fd);
+    close(shard->mailbox[0]);
+    close(shard->mailbox[1]);
+    free(shard->games);
+    free(shard->free_slots);
+    free(shard->closed_slots);
+    free(shard->active);
+}
+
+static void shard_pin(server_shard_t* shard)
+{
+    cpu_set_t set;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    CPU_ZERO(&set);
+    CPU_SET(shard->id % (cpus > 0 ? cpus : 1), &set);
+    pthread_setaffinity_np(shard->thread, sizeof(set), &set);
+}
+
+/************************************************************/
+/* Accepting                                                */
+/************************************************************/
+
+// Hand a connection to the least loaded shard with room left
+static uint8_t dispatch(server_shard_t* shards, int nshards, int fd)
+{
+    uint32_t load, best_load = 0xFFFFFFFFu;
+    int i, best = -1;
+
+    for (i = 0; i < nshards; i++) {
+        load = atomic_load_explicit(&shards[i].assigned, memory_order_relaxed);
+        if (load < shards[i].capacity && load < best_load) {
+            best = i;
+            best_load = load;
+        }
+    }
+    if (best < 0)
+        return 0;
+
+    atomic_fetch_add(&shards[best].assigned, 1);
+    if (write(shards[best].mailbox[1], &fd, sizeof(fd)) != sizeof(fd)) {
+        atomic_fetch_sub(&shards[best].assigned, 1);
+        return 0;
+    }
+    return 1;
+}
+
+static void accept_loop(int listen_fd, server_shard_t* shards, int nshards, const server_options_t* options,
+                        uint64_t* accepted, uint64_t* rejected)
+{
+    struct pollfd pfd;
+    uint64_t deadline = options->duration ? now_ns() + options->duration * 1000000000ull : 0;
+    int fd;
+
+    pfd.fd = listen_fd;
+    pfd.events = POLLIN;
+    while (!server_stop && (!deadline || now_ns() < deadline)) {
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+        while ((fd = accept(listen_fd, NULL, NULL)) >= 0) {
+            net_set_nonblocking(fd);
+            if (!options->path)
+                net_set_nodelay(fd);
+            if (dispatch(shards, nshards, fd)) {
+                (*accepted)++;
+            } else {
+                close(fd);
+                (*rejected)++;
+            }
+        }
+    }
+}
+
+/************************************************************/
+/* Main                                                     */
+/************************************************************/
+
+static void usage(void)
+{
+    printf("Usage: tetrice_server [options]\n");
+    printf("  -u PATH     Unix-domain socket (default %s)\n", SERVER_DEFAULT_PATH);
+    printf("  -p PORT     TCP port on 127.0.0.1 instead\n");
+    printf("  -t N        shards, one thread and event loop each (default: online CPUs)\n");
+    printf("  -g N        game pool size over all shards (default 16384)\n");
+    printf("  -f FPS      frame tick of every game (default %d)\n", SERVER_DEFAULT_FPS);
+    printf("  -s SEED     first seed (default 1)\n");
+    printf("  -d SECONDS  stop after this long (default: until interrupted)\n");
+}
+
+int main(int argc, char** argv)
+{
+    server_options_t options;
+    server_shard_t* shards;
+    shard_counters_t total;
+    histogram_t tick_ns;
+    uint64_t accepted = 0, rejected = 0, start, elapsed_ns;
+    double elapsed;
+    int listen_fd, i;
+
+    options.path = SERVER_DEFAULT_PATH;
+    options.port = 0;
+    options.shards = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    options.max_games = 16384;
+    options.fps = SERVER_DEFAULT_FPS;
+    options.seed = 1;
+    options.duration = 0;
+
+    for (i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 'u': options.path = value; break;
+        case 'p': options.port = (uint16_t)atoi(value); options.path = NULL; break;
+        case 't': options.shards = atoi(value); break;
+        case 'g': options.max_games = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'f': options.fps = (uint32_t)strtoul(value, NULL, 0); break;
+        case 's': options.seed = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'd': options.duration = (uint32_t)strtoul(value, NULL, 0); break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+    if (options.shards < 1)
+        options.shards = 1;
+    if (options.fps < 1)
+        options.fps = 1;
+
+    net_raise_fd_limit();
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    listen_fd = net_listen(options.path, options.port, 4096);
+    if (listen_fd < 0) {
+        fprintf(stderr, "server: cannot listen on %s\n", options.path ? options.path : "the TCP port");
+        return 1;
+    }
+
+    shards = calloc((size_t)options.shards, sizeof(server_shard_t));
+    if (!shards)
+        return 1;
+    for (i = 0; i < options.shards; i++) {
+        if (shard_init(&shards[i], i, (options.max_games + options.shards - 1) / options.shards, &options)) {
+            fprintf(stderr, "server: cannot set up shard %d\n", i);
+            return 1;
+        }
+    }
+
+    printf("tetrice server: %dx%d playfield, %d shard(s), %u games max, %u fps, listening on %s",
+           PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT, options.shards, options.max_games, options.fps,
+           options.path ? options.path : "127.0.0.1");
+    if (!options.path)
+        printf(":%u", options.port);
+    printf("\n");
+    fflush(stdout);
+
+    start = now_ns();
+    for (i = 0; i < options.shards; i++) {
+        pthread_create(&shards[i].thread, NULL, shard_main, &shards[i]);
+        shard_pin(&shards[i]);
+    }
+
+    accept_loop(listen_fd, shards, options.shards, &options, &accepted, &rejected);
+
+    atomic_store(&shards_quit, 1);
+    for (i = 0; i < options.shards; i++)
+        pthread_join(shards[i].thread, NULL);
+    elapsed_ns = now_ns() - start;
+    elapsed = elapsed_ns * 1e-9;
+    close(listen_fd);
+    if (options.path)
+        unlink(options.path);
+
+    // Report per shard, then merged
+    memset(&total, 0, sizeof(total));
+    histogram_reset(&tick_ns);
+    for (i = 0; i < options.shards; i++) {
+        shard_counters_t* c = &shards[i].counters;
+
+        printf("shard %d: peak %u games, %llu frames, %llu steps, tick p50 %.1fus p99 %.1fus max %.1fus, %llu late ticks\n",
+               i, c->peak_games, (unsigned long long)c->frames, (unsigned long long)c->steps,
+               histogram_percentile(&shards[i].tick_ns, 50) / 1e3, histogram_percentile(&shards[i].tick_ns, 99) / 1e3,
+               shards[i].tick_ns.max / 1e3, (unsigned long long)c->late_ticks);
+        histogram_merge(&tick_ns, &shards[i].tick_ns);
+        total.frames += c->frames;
+        total.steps += c->steps;
+        total.late_ticks += c->late_ticks;
+        total.skipped_ticks += c->skipped_ticks;
+        total.games_started += c->games_started;
+        total.games_over += c->games_over;
+        total.inputs += c->inputs;
+        total.inputs_dropped += c->inputs_dropped;
+        total.packets += c->packets;
+        total.packets_dropped += c->packets_dropped;
+        total.bytes_out += c->bytes_out;
+        total.peak_games += c->peak_games;
+        shard_free(&shards[i]);
+    }
+    free(shards);
+
+    printf("connections: %llu accepted, %llu rejected (pool full), peak %u concurrent games\n",
+           (unsigned long long)accepted, (unsigned long long)rejected, total.peak_games);
+    printf("games: %llu started, %llu over; inputs: %llu, %llu dropped (queue full)\n",
+           (unsigned long long)total.games_started, (unsigned long long)total.games_over,
+           (unsigned long long)total.inputs, (unsigned long long)total.inputs_dropped);
+    printf("frames: %llu in %.1fs, %.0f frames/s, %.0f steps/s\n",
+           (unsigned long long)total.frames, elapsed, elapsed > 0 ? total.frames / elapsed : 0.0,
+           elapsed > 0 ? total.steps / elapsed : 0.0);
+    printf("ticks: p50 %.1fus p99 %.1fus max %.1fus (budget %.1fus), %llu late, %llu skipped\n",
+           histogram_percentile(&tick_ns, 50) / 1e3, histogram_percentile(&tick_ns, 99) / 1e3, tick_ns.max / 1e3,
+           1e6 / options.fps, (unsigned long long)total.late_ticks, (unsigned long long)total.skipped_ticks);
+    printf("output: %llu packets, %llu bytes, %llu dropped (client too slow)\n",
+           (unsigned long long)total.packets, (unsigned long long)total.bytes_out,
+           (unsigned long long)total.packets_dropped);
+    return 0;
+}
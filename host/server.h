@@ -0,0 +1,46 @@
+/* server.h - Tournament server wire protocol */
+/*                                                                */
+/* Client to server: one byte per input, an input_action_t from   */
+/* INPUT_MOVE_LEFT to INPUT_DROP. Up to SERVER_INPUT_QUEUE inputs */
+/* wait for the game, one is consumed per frame.                  */
+/*                                                                */
+/* Server to client: one SERVER_PACKET_SIZE packet each time the  */
+/* game steps (an input or gravity):                              */
+/*   0  frame number of the game (u32 little endian)              */
+/*   4  score, level                                              */
+/*   6  piece | next_piece << 4                                   */
+/*   7  flags (SERVER_FLAG_*)                                     */
+
+#ifndef HOST_SERVER_H
+#define HOST_SERVER_H
+
+#include <stdint.h>
+
+#include "engine.h"
+
+#define SERVER_DEFAULT_PATH "/tmp/tetrice.sock"
+#define SERVER_DEFAULT_FPS 60
+
+#define SERVER_INPUT_QUEUE 8
+#define SERVER_PACKET_SIZE 8
+
+#define SERVER_FLAG_GAME_OVER 0x01  /* Last packet of a game, the next one starts over */
+
+static inline void server_packet_encode(uint8_t* out, uint32_t frame, const game_state_t* state, uint8_t flags)
+{
+    out[0] = (uint8_t)frame;
+    out[1] = (uint8_t)(frame >> 8);
+    out[2] = (uint8_t)(frame >> 16);
+    out[3] = (uint8_t)(frame >> 24);
+    out[4] = state->score;
+    out[5] = state->level;
+    out[6] = (uint8_t)(state->piece | (state->next_piece << 4));
+    out[7] = flags;
+}
+
+static inline uint32_t server_packet_frame(const uint8_t* in)
+{
+    return in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+#endif /* HOST_SERVER_H */
@@ -0,0 +1,40 @@
+/* snapshot.c - Save, restore and rewind a running game */
+
+#include <string.h>
+
+#include "snapshot.h"
+
+uint8_t snapshot_equal(const game_snapshot_t* a, const game_snapshot_t* b)
+{
+    return memcmp(&a->state, &b->state, sizeof(game_state_t)) == 0
+        && a->rng.state == b->rng.state
+        && a->frame == b->frame
+        && a->timeout_ticks == b->timeout_ticks;
+}
+
+void snapshot_ring_reset(snapshot_ring_t* ring)
+{
+    ring->head = 0;
+    ring->count = 0;
+}
+
+const game_snapshot_t* snapshot_ring_peek(const snapshot_ring_t* ring, uint32_t back)
+{
+    if (back >= ring->count)
+        return NULL;
+    return &ring->slots[(ring->head - 1 - back) & (SNAPSHOT_RING_FRAMES - 1)];
+}
+
+uint8_t snapshot_ring_rewind(snapshot_ring_t* ring, uint32_t back, game_state_t* state, host_rng_t* rng)
+{
+    const game_snapshot_t* snap = snapshot_ring_peek(ring, back);
+
+    if (!snap)
+        return 0;
+    snapshot_restore(snap, state, rng);
+
+    // The restored snapshot stays the latest one
+    ring->head = (ring->head - back) & (SNAPSHOT_RING_FRAMES - 1);
+    ring->count -= back;
+    return 1;
+}
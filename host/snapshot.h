@@ -0,0 +1,71 @@
+/* snapshot.h - Save, restore and rewind a running game */
+/* A snapshot is everything game_step depends on: the state, the  */
+/* game's RNG and the gravity timer that schedules INPUT_TIMEOUT. */
+/* It is a plain struct, so capture and restore are one copy.     */
+
+#ifndef HOST_SNAPSHOT_H
+#define HOST_SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "engine.h"
+
+/* Frames kept by a ring, a power of two */
+#ifndef SNAPSHOT_RING_FRAMES
+#define SNAPSHOT_RING_FRAMES 256
+#endif
+
+typedef struct game_snapshot_t {
+    game_state_t state;
+    host_rng_t rng;
+    uint32_t frame;             /* Caller's frame number */
+    uint8_t timeout_ticks;      /* Input scheduler */
+} game_snapshot_t;
+
+/* Last SNAPSHOT_RING_FRAMES snapshots, oldest overwritten first */
+typedef struct snapshot_ring_t {
+    game_snapshot_t slots[SNAPSHOT_RING_FRAMES];
+    uint32_t head;              /* Slot of the next capture */
+    uint32_t count;             /* Valid snapshots, at most SNAPSHOT_RING_FRAMES */
+} snapshot_ring_t;
+
+static inline void snapshot_capture(game_snapshot_t* snap, const game_state_t* state,
+                                    const host_rng_t* rng, uint32_t frame)
+{
+    snap->state = *state;
+    snap->rng = *rng;
+    snap->frame = frame;
+    snap->timeout_ticks = timeout_ticks;
+}
+
+/* rng must be the generator bound to the calling thread */
+static inline void snapshot_restore(const game_snapshot_t* snap, game_state_t* state, host_rng_t* rng)
+{
+    *state = snap->state;
+    *rng = snap->rng;
+    timeout_ticks = snap->timeout_ticks;
+}
+
+/* Field by field, padding bytes are not part of a snapshot */
+uint8_t snapshot_equal(const game_snapshot_t* a, const game_snapshot_t* b);
+
+void snapshot_ring_reset(snapshot_ring_t* ring);
+
+/* O(1): copy the current game into the next slot */
+static inline void snapshot_ring_capture(snapshot_ring_t* ring, const game_state_t* state,
+                                         const host_rng_t* rng, uint32_t frame)
+{
+    snapshot_capture(&ring->slots[ring->head], state, rng, frame);
+    ring->head = (ring->head + 1) & (SNAPSHOT_RING_FRAMES - 1);
+    if (ring->count < SNAPSHOT_RING_FRAMES)
+        ring->count++;
+}
+
+/* Snapshot captured back captures ago (0 = latest), NULL if already overwritten */
+const game_snapshot_t* snapshot_ring_peek(const snapshot_ring_t* ring, uint32_t back);
+
+/* Restore the snapshot back captures ago and forget everything newer,
+ * so the next capture follows it. Returns 0 if it is no longer held. */
+uint8_t snapshot_ring_rewind(snapshot_ring_t* ring, uint32_t back, game_state_t* state, host_rng_t* rng);
+
+#endif /* HOST_SNAPSHOT_H */
@@ -0,0 +1,273 @@
+/* spectate.c - Shared-memory spectator feed */
+
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "spectate.h"
+
+/* dirty_rows holds one bit per row */
+typedef char spectate_rows_fit[(PLAYFIELD_HEIGHT <= 32) ? 1 : -1];
+
+static spectate_shm_t* feed = NULL;
+static char feed_name[256];
+static const host_display_ops_t* feed_inner = NULL;
+/* Search threads step their own states, only this one is published */
+static _Atomic(game_state_t*) feed_followed = NULL;
+static PLATFORM_TLS uint8_t feed_following = 0;
+static uint8_t feed_full = 0;
+static uint8_t feed_game_over = 0;
+
+/************************************************************/
+/* Writer                                                   */
+/************************************************************/
+
+static void write_begin(void)
+{
+    uint32_t s = atomic_load_explicit(&feed->sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&feed->sequence, s + 1, memory_order_relaxed);
+    // Frame stores must not become visible before the odd sequence
+    atomic_thread_fence(memory_order_release);
+}
+
+static void write_end(void)
+{
+    uint32_t s = atomic_load_explicit(&feed->sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&feed->sequence, s + 1, memory_order_release);
+}
+
+void spectate_publish(game_state_t* state)
+{
+    spectate_frame_t* f;
+    uint32_t rows = 0;
+    uint8_t x, y, dirty;
+
+    if (!feed || state != atomic_load_explicit(&feed_followed, memory_order_relaxed))
+        return;
+    f = &feed->frame;
+
+    write_begin();
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        dirty = feed_full ? CELL_DIRTY_FLAG : 0;
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            dirty |= state->playfield[y][x];
+        if (!(dirty & CELL_DIRTY_FLAG))
+            continue;
+        rows |= 1u << y;
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            f->playfield[y][x] = GET_CELL_CONTENT(state->playfield[y][x]);
+    }
+    f->frame++;
+    f->dirty_rows = rows;
+    f->score = state->score;
+    f->level = state->level;
+    f->piece = state->piece;
+    f->next_piece = state->next_piece;
+    f->x = state->x;
+    f->y = state->y;
+    f->rotation = state->rotation;
+    f->game_over = feed_game_over;
+    write_end();
+    feed_full = 0;
+}
+
+uint8_t spectate_follow(game_state_t* state)
+{
+    game_state_t* expected = NULL;
+
+    if (!feed || !atomic_compare_exchange_strong(&feed_followed, &expected, state))
+        return 0;
+    feed_following = 1;
+    feed_game_over = 0;
+    feed_full = 1;
+    if (feed->frame.frame) {
+        write_begin();
+        feed->frame.game++;
+        write_end();
+    }
+    return 1;
+}
+
+void spectate_unfollow(game_state_t* state)
+{
+    game_state_t* expected = state;
+
+    if (feed_following && atomic_compare_exchange_strong(&feed_followed, &expected, NULL))
+        feed_following = 0;
+}
+
+static void feed_sync_playfield(game_state_t* state)
+{
+    uint8_t x, y;
+
+    spectate_publish(state);
+    if (feed_inner && feed_inner->sync_playfield) {
+        feed_inner->sync_playfield(state);
+        return;
+    }
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            CLEAR_CELL_DIRTY(state->playfield[y][x]);
+    }
+}
+
+static void feed_sync_ui(game_state_t* state)
+{
+    if (feed_inner && feed_inner->sync_ui)
+        feed_inner->sync_ui(state);
+}
+
+static void feed_preview_piece(uint8_t piece)
+{
+    if (feed_inner && feed_inner->preview_piece)
+        feed_inner->preview_piece(piece);
+}
+
+static void feed_clear_screen(void)
+{
+    if (feed_inner && feed_inner->clear_screen)
+        feed_inner->clear_screen();
+}
+
+static void feed_draw_borders(void)
+{
+    if (feed_inner && feed_inner->draw_borders)
+        feed_inner->draw_borders();
+}
+
+// One more frame carrying the flag, from the thread playing the followed game
+static void feed_game_over_hook(void)
+{
+    if (feed_following) {
+        feed_game_over = 1;
+        spectate_publish(atomic_load(&feed_followed));
+    }
+    if (feed_inner && feed_inner->game_over)
+        feed_inner->game_over();
+}
+
+static const host_display_ops_t feed_ops = {
+    feed_sync_playfield,
+    feed_sync_ui,
+    feed_preview_piece,
+    feed_clear_screen,
+    feed_draw_borders,
+    feed_game_over_hook
+};
+
+int spectate_open(const char* name, const host_display_ops_t* inner)
+{
+    int fd;
+
+    if (strlen(name) >= sizeof(feed_name))
+        return -1;
+    fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return -1;
+    if (ftruncate(fd, sizeof(spectate_shm_t))) {
+        close(fd);
+        return -1;
+    }
+    feed = mmap(NULL, sizeof(spectate_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (feed == MAP_FAILED) {
+        feed = NULL;
+        return -1;
+    }
+
+    write_begin();
+    memset(&feed->frame, 0, sizeof(feed->frame));
+    feed->magic = SPECTATE_MAGIC;
+    feed->version = SPECTATE_VERSION;
+    feed->width = PLAYFIELD_WIDTH;
+    feed->height = PLAYFIELD_HEIGHT;
+    write_end();
+    atomic_store(&feed->writer_alive, 1);
+
+    strcpy(feed_name, name);
+    feed_inner = inner;
+    host_display = &feed_ops;
+    return 0;
+}
+
+void spectate_close(void)
+{
+    if (!feed)
+        return;
+    host_display = feed_inner;
+    atomic_store(&feed->writer_alive, 0);
+    munmap(feed, sizeof(spectate_shm_t));
+    shm_unlink(feed_name);
+    feed = NULL;
+    atomic_store(&feed_followed, NULL);
+}
+
+/************************************************************/
+/* Reader                                                   */
+/************************************************************/
+
+const spectate_shm_t* spectate_attach(const char* name)
+{
+    const spectate_shm_t* shm;
+    int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0)
+        return NULL;
+    shm = mmap(NULL, sizeof(spectate_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED)
+        return NULL;
+    if (shm->magic != SPECTATE_MAGIC || shm->version != SPECTATE_VERSION
+        || shm->width != PLAYFIELD_WIDTH || shm->height != PLAYFIELD_HEIGHT) {
+        munmap((void*)shm, sizeof(spectate_shm_t));
+        return NULL;
+    }
+    return shm;
+}
+
+void spectate_detach(const spectate_shm_t* shm)
+{
+    munmap((void*)shm, sizeof(spectate_shm_t));
+}
+
+uint32_t spectate_read(const spectate_shm_t* shm, spectate_frame_t* out, uint8_t previous_valid)
+{
+    uint32_t s1, s2, rows, retries = 0, last = out->frame;
+    uint8_t y;
+
+    while (1) {
+        s1 = atomic_load_explicit((_Atomic uint32_t*)&shm->sequence, memory_order_acquire);
+        if (s1 & 1) {
+            // The writer may have been preempted mid-frame, let it finish
+            retries++;
+            sched_yield();
+            continue;
+        }
+
+        if (previous_valid && shm->frame.frame == last + 1) {
+            // Header, then only the rows this frame rewrote
+            rows = shm->frame.dirty_rows;
+            memcpy(out, &shm->frame, offsetof(spectate_frame_t, playfield));
+            for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+                if (rows & (1u << y))
+                    memcpy(out->playfield[y], shm->frame.playfield[y], PLAYFIELD_WIDTH);
+            }
+        } else {
+            memcpy(out, &shm->frame, sizeof(*out));
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit((_Atomic uint32_t*)&shm->sequence, memory_order_relaxed);
+        if (s1 == s2)
+            return retries;
+
+        // Torn: some rows may be from a later frame, start over in full
+        retries++;
+        previous_valid = 0;
+    }
+}
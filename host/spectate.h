@@ -0,0 +1,80 @@
+/* spectate.h - Shared-memory spectator feed */
+/* The game thread publishes every frame into a POSIX shared      */
+/* memory segment under a seqlock: the sequence is odd while the  */
+/* writer updates the frame, readers copy and retry if it moved.  */
+/* The writer never waits for readers and makes no syscall per    */
+/* frame. Only the rows with dirty cells are rewritten; their     */
+/* mask is published so a reader that saw the previous frame can  */
+/* copy just those rows.                                          */
+
+#ifndef HOST_SPECTATE_H
+#define HOST_SPECTATE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "engine.h"
+
+#define SPECTATE_MAGIC 0x43505354u  /* "TSPC" */
+#define SPECTATE_VERSION 1
+#define SPECTATE_DEFAULT_NAME "/tetrice-spectate"
+
+typedef struct spectate_frame_t {
+    uint32_t frame;             /* Published frames since the feed opened */
+    uint32_t game;              /* Games started */
+    uint32_t dirty_rows;        /* Rows rewritten by this frame, bit y = row y */
+    uint8_t score;
+    uint8_t level;
+    uint8_t piece;
+    uint8_t next_piece;
+    uint8_t x, y;
+    uint8_t rotation;
+    uint8_t game_over;
+    uint8_t playfield[PLAYFIELD_HEIGHT][PLAYFIELD_WIDTH];   /* Cell contents, no dirty flag */
+} spectate_frame_t;
+
+typedef struct spectate_shm_t {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t width;
+    uint8_t height;
+    _Atomic uint32_t writer_alive;
+    _Atomic uint32_t sequence;  /* Odd while the frame is being written */
+    uint8_t pad[48];            /* Keep the frame off the header's cache line */
+    spectate_frame_t frame;
+} spectate_shm_t;
+
+/************************************************************/
+/* Writer                                                   */
+/************************************************************/
+
+/* Create the segment and install the feed as the host display. Calls
+ * are forwarded to inner (may be NULL), which then owns the dirty
+ * flags. Returns 0 on success. */
+int spectate_open(const char* name, const host_display_ops_t* inner);
+void spectate_close(void);
+
+/* Choose the game to publish. The feed follows one state at a time:
+ * returns 0 if another game holds it. The first frame after a follow
+ * carries every row. */
+uint8_t spectate_follow(game_state_t* state);
+void spectate_unfollow(game_state_t* state);
+
+/* Publish state as the next frame if it is the followed one, normally
+ * called by display_sync_playfield */
+void spectate_publish(game_state_t* state);
+
+/************************************************************/
+/* Reader                                                   */
+/************************************************************/
+
+/* Map a feed read-only, NULL if there is none */
+const spectate_shm_t* spectate_attach(const char* name);
+void spectate_detach(const spectate_shm_t* shm);
+
+/* Consistent copy of the current frame. With previous holding the
+ * frame before it, only the dirty rows are copied. Returns the number
+ * of torn reads retried. */
+uint32_t spectate_read(const spectate_shm_t* shm, spectate_frame_t* out, uint8_t previous_valid);
+
+#endif /* HOST_SPECTATE_H */
@@ -0,0 +1,56 @@
+/* spsc.h - Lock-free single-producer single-consumer event queue */
+/* One thread pushes, one other thread pops. Each side owns its     */
+/* index and only reads the other's, so a push or a pop is a plain */
+/* copy plus one release store, with no lock and no system call.   */
+
+#ifndef HOST_SPSC_H
+#define HOST_SPSC_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Slots, a power of two */
+#define SPSC_CAPACITY 256
+
+typedef struct spsc_event_t {
+    uint64_t stamp_ns;          /* When the producer saw it */
+    uint8_t value;
+} spsc_event_t;
+
+typedef struct spsc_queue_t {
+    _Alignas(64) _Atomic uint32_t head;     /* Next slot to pop, written by the consumer */
+    _Alignas(64) _Atomic uint32_t tail;     /* Next slot to push, written by the producer */
+    _Alignas(64) spsc_event_t slots[SPSC_CAPACITY];
+} spsc_queue_t;
+
+static inline void spsc_init(spsc_queue_t* q)
+{
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+}
+
+/* Producer side, returns 0 when the queue is full */
+static inline uint8_t spsc_push(spsc_queue_t* q, const spsc_event_t* event)
+{
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    if (tail - atomic_load_explicit(&q->head, memory_order_acquire) == SPSC_CAPACITY)
+        return 0;
+    q->slots[tail & (SPSC_CAPACITY - 1)] = *event;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+/* Consumer side, returns 0 when the queue is empty */
+static inline uint8_t spsc_pop(spsc_queue_t* q, spsc_event_t* event)
+{
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    if (head == atomic_load_explicit(&q->tail, memory_order_acquire))
+        return 0;
+    *event = q->slots[head & (SPSC_CAPACITY - 1)];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return 1;
+}
+
+#endif /* HOST_SPSC_H */
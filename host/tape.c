@@ -0,0 +1,218 @@
+/* tape.c - Packed tape images */
+
+#include <string.h>
+
+#include "tape.h"
+#include "zx0.h"
+
+/* MC-10 cassette: a 1 bit is one cycle at 2400 Hz, a 0 bit one at
+ * 1200 Hz; blocks are 0x55 0x3C, type, length, data, checksum, 0x55 */
+#define TAPE_BIT_1 (1.0 / 2400)
+#define TAPE_BIT_0 (1.0 / 1200)
+#define TAPE_LEADER 128             /* 0x55 bytes before each block group */
+#define TAPE_NAME_SIZE 15           /* Name, type, flags, exec and load addresses */
+#define TAPE_GAP 0.5                /* Motor pause after the name block, seconds */
+#define TAPE_BLOCK 255
+
+static double byte_seconds(uint8_t value)
+{
+    double seconds = 0;
+    int bit;
+
+    for (bit = 0; bit < 8; bit++)
+        seconds += (value >> bit) & 1 ? TAPE_BIT_1 : TAPE_BIT_0;
+    return seconds;
+}
+
+static double block_seconds(uint8_t type, const uint8_t* data, size_t size)
+{
+    double seconds = byte_seconds(0x55) + byte_seconds(0x3C) + byte_seconds(type) + byte_seconds((uint8_t)size);
+    uint8_t checksum = (uint8_t)(type + size);
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        seconds += byte_seconds(data[i]);
+        checksum += data[i];
+    }
+    return seconds + byte_seconds(checksum) + byte_seconds(0x55);
+}
+
+double tape_load_seconds(const uint8_t* data, size_t size)
+{
+    static const uint8_t name[TAPE_NAME_SIZE] = { 'T', 'E', 'T', 'R', 'I', 'C', 'E', ' ', 2 };
+    double seconds = 2 * TAPE_LEADER * byte_seconds(0x55) + TAPE_GAP;
+    size_t pos, length;
+
+    seconds += block_seconds(0, name, sizeof(name));
+    for (pos = 0; pos < size; pos += length) {
+        length = size - pos < TAPE_BLOCK ? size - pos : TAPE_BLOCK;
+        seconds += block_seconds(1, data + pos, length);
+    }
+    return seconds + block_seconds(0xFF, NULL, 0);
+}
+
+// Compresses the game behind a stub of stub_size bytes and fills the
+// layout; the caller checks the stub header and fills it
+static long pack_stream(const uint8_t* game, size_t game_size, uint16_t game_addr, size_t stub_size,
+                        uint16_t stub_addr, uint8_t* image, size_t capacity, tape_layout_t* layout, const char** error)
+{
+    static uint8_t check[65536];
+    long stream_size, unpacked, ahead;
+    uint32_t moved_addr, moved_end;
+
+    if ((uint32_t)stub_addr + stub_size > game_addr) {
+        *error = "the stub overlaps the game";
+        return -1;
+    }
+    if (game_size == 0 || (uint32_t)game_addr + game_size > 0x10000) {
+        *error = "the game is empty or past the end of memory";
+        return -1;
+    }
+    if (capacity < stub_size) {
+        *error = "no room for the stub";
+        return -1;
+    }
+
+    stream_size = zx0_compress(game, game_size, image + stub_size, capacity - stub_size);
+    if (stream_size < 0) {
+        *error = "ZX0 compression failed";
+        return -1;
+    }
+    unpacked = zx0_decompress_ahead(image + stub_size, (size_t)stream_size, check, sizeof(check), &ahead);
+    if (unpacked != (long)game_size || memcmp(check, game, game_size)) {
+        *error = "the ZX0 stream does not decompress back to the game";
+        return -1;
+    }
+
+    // Decompressed in place, the stream must start ahead bytes into the
+    // game; the move copies it backwards, so it can only go up
+    moved_addr = game_addr + (ahead > 0 ? (uint32_t)ahead : 0);
+    moved_end = moved_addr + (uint32_t)stream_size;
+    if (moved_end > 0x10000) {
+        *error = "the moved stream runs past the end of memory";
+        return -1;
+    }
+
+    layout->game_addr = game_addr;
+    layout->game_size = (uint16_t)game_size;
+    layout->stub_addr = stub_addr;
+    layout->stub_size = (uint16_t)stub_size;
+    layout->stream_addr = (uint16_t)(stub_addr + stub_size);
+    layout->stream_size = (uint16_t)stream_size;
+    layout->moved_addr = (uint16_t)moved_addr;
+    layout->ram_end = moved_end > (uint32_t)game_addr + game_size ? moved_end : (uint32_t)game_addr + game_size;
+    layout->mask = 0;
+    return (long)stub_size + stream_size;
+}
+
+long tape_pack(const uint8_t* game, size_t game_size, uint16_t game_addr, const uint8_t* stub, size_t stub_size,
+               uint16_t stub_addr, uint8_t* image, size_t capacity, tape_layout_t* layout, const char** error)
+{
+    uint32_t stream_end, moved_end;
+    long size;
+
+    if (stub_size <= TAPE_STUB_HEADER || stub[0] != 0x20 || stub[1] < TAPE_STUB_HEADER - 2 || stub[1] > 127) {
+        *error = "the stub does not start with a branch over its header";
+        return -1;
+    }
+    size = pack_stream(game, game_size, game_addr, stub_size, stub_addr, image, capacity, layout, error);
+    if (size < 0)
+        return -1;
+
+    stream_end = (uint32_t)layout->stream_addr + layout->stream_size;
+    moved_end = (uint32_t)layout->moved_addr + layout->stream_size;
+    memcpy(image, stub, stub_size);
+    image[2] = (uint8_t)(stream_end >> 8);
+    image[3] = (uint8_t)stream_end;
+    image[4] = (uint8_t)(moved_end >> 8);
+    image[5] = (uint8_t)moved_end;
+    image[6] = (uint8_t)(game_addr >> 8);
+    image[7] = (uint8_t)game_addr;
+    return size;
+}
+
+// Two zero bytes in a row, counting the bytes from start to end XORed
+// with mask
+static int zero_pair(const uint8_t* image, size_t size, size_t start, size_t end, uint8_t mask)
+{
+    uint8_t previous = 1;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        uint8_t value = i < start || i >= end ? image[i] : (uint8_t)(image[i] ^ mask);
+
+        if (value == 0 && previous == 0)
+            return 1;
+        previous = value;
+    }
+    return 0;
+}
+
+long tape_pack_phc25(const uint8_t* game, size_t game_size, uint16_t game_addr, const uint8_t* stub,
+                     size_t stub_size, uint16_t stub_addr, uint8_t* image, size_t capacity, tape_layout_t* layout,
+                     const char** error)
+{
+    uint32_t moved_end;
+    long size, i;
+    int mask;
+
+    if (stub_size <= TAPE_PHC25_STUB_HEADER || stub[0] != 0x18 || stub[1] < TAPE_PHC25_STUB_HEADER - 2 ||
+        stub[1] > 127) {
+        *error = "the stub does not start with a jump over its header";
+        return -1;
+    }
+    size = pack_stream(game, game_size, game_addr, stub_size, stub_addr, image, capacity, layout, error);
+    if (size < 0)
+        return -1;
+
+    moved_end = (uint32_t)layout->moved_addr + layout->stream_size;
+    memcpy(image, stub, stub_size);
+    image[2] = (uint8_t)layout->stream_size;
+    image[3] = (uint8_t)(layout->stream_size >> 8);
+    image[4] = (uint8_t)moved_end;
+    image[5] = (uint8_t)(moved_end >> 8);
+    image[6] = (uint8_t)game_addr;
+    image[7] = (uint8_t)(game_addr >> 8);
+
+    // The mask is part of the image it is checked on
+    for (mask = 0; mask < 256; mask++) {
+        image[8] = (uint8_t)mask;
+        if (!zero_pair(image, (size_t)size, stub_size, (size_t)size, (uint8_t)mask))
+            break;
+    }
+    if (mask == 256) {
+        *error = "no mask keeps two zero bytes in a row off the tape";
+        return -1;
+    }
+    for (i = (long)stub_size; i < size; i++)
+        image[i] ^= (uint8_t)mask;
+    layout->mask = (uint8_t)mask;
+    return size;
+}
+
+long tape_pack_assets(const assets_t* assets, uint8_t* image, size_t capacity, const char** error)
+{
+    size_t size = TAPE_ASSETS_ENTRY * (size_t)assets->count, i;
+    uint8_t* entry;
+    long stream;
+
+    if (assets->count == 0 || size > capacity) {
+        *error = "the assets do not fit";
+        return -1;
+    }
+    for (i = 0; i < assets->count; i++) {
+        entry = image + TAPE_ASSETS_ENTRY * i;
+        stream = zx0_compress(assets->bitmap[i], (size_t)assets->bytes_per_row[i] * assets->height[i],
+                              image + size, capacity - size);
+        if (stream < 0 || size + stream > 0xFFFF) {
+            *error = "the assets do not fit";
+            return -1;
+        }
+        entry[0] = (uint8_t)size;
+        entry[1] = (uint8_t)(size >> 8);
+        entry[2] = assets->bytes_per_row[i];
+        entry[3] = assets->height[i];
+        size += (size_t)stream;
+    }
+    return (long)size;
+}
@@ -0,0 +1,62 @@
+/* tape.h - Packed tape images */
+/* The game image compressed with ZX0 behind a loader stub        */
+/* (alice_unzx0.s, phc25_unzx0.asm), laid out the way the stub     */
+/* expects it, the PHC-25 UI asset block linked into the program, */
+/* and the load time of an image on the MC-10/Alice cassette format. */
+
+#ifndef HOST_TAPE_H
+#define HOST_TAPE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "assets.h"
+
+/* The stub starts with a branch over three words the packer fills */
+#define TAPE_STUB_HEADER 8
+
+/* The PHC-25 stub: JR, three little-endian words and the XOR mask */
+#define TAPE_PHC25_STUB_HEADER 9
+
+/* The PHC-25 asset block, linked into the program by phc25_lib.asm:
+ * per asset the little-endian offset of its ZX0 stream from the start
+ * of the block, its bytes per row and its height, then the streams
+ * (platform_phc25.c reads it). The program image is masked as a whole
+ * by tape_pack_phc25, so the block is not */
+#define TAPE_ASSETS_ENTRY 4
+
+typedef struct tape_layout_t {
+    uint16_t game_addr;
+    uint16_t game_size;
+    uint16_t stub_addr;
+    uint16_t stub_size;
+    uint16_t stream_addr;           /* As loaded, right after the stub */
+    uint16_t stream_size;
+    uint16_t moved_addr;            /* Where the stub moves it before decompressing */
+    uint32_t ram_end;               /* First address the load does not touch */
+    uint8_t mask;                   /* PHC-25: XOR of the stream on tape */
+} tape_layout_t;
+
+/* Compresses the game and writes the image loaded at stub_addr into
+ * image: the stub with its header filled, then the stream. Returns
+ * the image size, or -1 with *error set */
+long tape_pack(const uint8_t* game, size_t game_size, uint16_t game_addr, const uint8_t* stub, size_t stub_size,
+               uint16_t stub_addr, uint8_t* image, size_t capacity, tape_layout_t* layout, const char** error);
+
+/* Same for the PHC-25 stub, whose header holds the stream size, the
+ * moved end, the game address and a mask: the stream goes on tape
+ * XORed with the first mask that leaves no two zero bytes in a row in
+ * the whole image, which the tape format cannot hold */
+long tape_pack_phc25(const uint8_t* game, size_t game_size, uint16_t game_addr, const uint8_t* stub,
+                     size_t stub_size, uint16_t stub_addr, uint8_t* image, size_t capacity, tape_layout_t* layout,
+                     const char** error);
+
+/* Compresses each bitmap of the asset bank and lays the streams out
+ * as the asset block. Returns the block size, or -1 with *error set */
+long tape_pack_assets(const assets_t* assets, uint8_t* image, size_t capacity, const char** error);
+
+/* Seconds to load size bytes with CLOADM: the leaders, the name
+ * block and its gap, then 255-byte data blocks */
+double tape_load_seconds(const uint8_t* data, size_t size);
+
+#endif /* HOST_TAPE_H */
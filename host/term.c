@@ -0,0 +1,447 @@
+/* term.c - ANSI terminal frontend */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "term.h"
+
+#define TERM_BUFFER_SIZE 65536
+#define TERM_UNKNOWN 0xFF
+
+extern char tetrominos_colors[];
+
+static char out[TERM_BUFFER_SIZE];
+static size_t out_length = 0;
+
+/* What the terminal currently shows, to skip redundant escapes */
+static int cursor_row = -1, cursor_column = -1;
+static uint8_t current_fg = TERM_UNKNOWN, current_bg = TERM_UNKNOWN;
+static int shown_score = -1, shown_level = -1;
+static uint8_t shown_preview[4][4];
+
+static term_stats_t stats;
+
+static spsc_queue_t keys;
+static pthread_t input_thread;
+static _Atomic uint8_t input_running = 0;
+static struct termios saved_termios;
+static uint8_t raw_mode = 0;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/************************************************************/
+/* Output buffer                                            */
+/************************************************************/
+
+size_t term_flush(void)
+{
+    size_t done = 0, length = out_length;
+    ssize_t n;
+
+    if (!length)
+        return 0;
+    while (done < length) {
+        n = write(STDOUT_FILENO, out + done, length - done);
+        if (n <= 0)
+            break;
+        done += (size_t)n;
+    }
+    out_length = 0;
+    stats.writes++;
+    stats.bytes += length;
+    return length;
+}
+
+static void out_bytes(const char* data, size_t length)
+{
+    // Only a full-screen repaint of a huge playfield gets here
+    if (out_length + length > sizeof(out))
+        term_flush();
+    memcpy(out + out_length, data, length);
+    out_length += length;
+}
+
+static void out_string(const char* text)
+{
+    size_t length = strlen(text);
+
+    out_bytes(text, length);
+    cursor_column += (int)length;
+}
+
+// EF9345 colour numbers to the xterm 256-colour palette
+static uint8_t ansi_color(uint8_t color)
+{
+    switch (color) {
+    case red: return 196;
+    case green: return 46;
+    case orange: return 208;
+    case blue: return 21;
+    case magenta: return 201;
+    case cyan: return 51;
+    case pink: return 213;
+    case lgreen: return 120;
+    case yellow: return 226;
+    case lmagenta: return 219;
+    case white: return 15;
+    default: return 0;
+    }
+}
+
+static void out_colors(uint8_t fg, uint8_t bg)
+{
+    char sequence[32];
+    int n;
+
+    if (fg == current_fg && bg == current_bg)
+        return;
+    if (fg == current_fg)
+        n = sprintf(sequence, "\x1b[48;5;%um", ansi_color(bg));
+    else if (bg == current_bg)
+        n = sprintf(sequence, "\x1b[38;5;%um", ansi_color(fg));
+    else
+        n = sprintf(sequence, "\x1b[38;5;%u;48;5;%um", ansi_color(fg), ansi_color(bg));
+    out_bytes(sequence, (size_t)n);
+    current_fg = fg;
+    current_bg = bg;
+}
+
+// Move to a character cell, with the shortest sequence that gets there
+static void out_move(uint8_t cell_x, uint8_t cell_y)
+{
+    char sequence[32];
+    int row = cell_y + 1;
+    int column = cell_x * TERM_COLUMNS_PER_CELL + 1;
+    int n;
+
+    if (row == cursor_row && column == cursor_column)
+        return;
+    if (row == cursor_row && column > cursor_column)
+        n = sprintf(sequence, "\x1b[%dC", column - cursor_column);
+    else
+        n = sprintf(sequence, "\x1b[%d;%dH", row, column);
+    out_bytes(sequence, (size_t)n);
+    cursor_row = row;
+    cursor_column = column;
+}
+
+static void out_text(uint8_t cell_x, uint8_t cell_y, uint8_t fg, const char* text)
+{
+    out_move(cell_x, cell_y);
+    out_colors(fg, black);
+    out_string(text);
+}
+
+static void out_block(uint8_t color)
+{
+    // The foreground does not show on a block, keep whatever is set
+    out_colors(current_fg != TERM_UNKNOWN ? current_fg : white, color);
+    out_bytes("  ", TERM_COLUMNS_PER_CELL);
+    cursor_column += TERM_COLUMNS_PER_CELL;
+}
+
+static uint8_t cell_color(uint8_t cell)
+{
+    uint8_t content = GET_CELL_CONTENT(cell);
+
+    return content != CELL_EMPTY ? (uint8_t)tetrominos_colors[content - CELL_PIECE_1] : black;
+}
+
+/************************************************************/
+/* Display hooks                                            */
+/************************************************************/
+
+static void term_sync_playfield(game_state_t* state)
+{
+    uint8_t* row;
+    uint8_t x, y;
+
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        row = state->playfield[y];
+        x = 0;
+        while (x < PLAYFIELD_WIDTH) {
+            if (!GET_CELL_DIRTY(row[x])) {
+                x++;
+                continue;
+            }
+
+            // One move per run; a clean cell in the current colour between
+            // two dirty ones is repainted, cheaper than moving past it
+            out_move(PLAYFIELD_START_X + x, PLAYFIELD_START_Y + y);
+            while (x < PLAYFIELD_WIDTH) {
+                if (GET_CELL_DIRTY(row[x])) {
+                    out_block(cell_color(row[x]));
+                    CLEAR_CELL_DIRTY(row[x]);
+                } else if (x + 1 < PLAYFIELD_WIDTH && GET_CELL_DIRTY(row[x + 1])
+                           && cell_color(row[x]) == current_bg) {
+                    out_block(current_bg);
+                } else {
+                    break;
+                }
+                x++;
+            }
+        }
+    }
+}
+
+/* Convert int to a three char string with leading zeros */
+static void int_to_string(uint8_t value, char* str)
+{
+    str[0] = '0' + (value / 100);
+    str[1] = '0' + ((value % 100) / 10);
+    str[2] = '0' + (value % 10);
+    str[3] = '\0';
+}
+
+static void term_sync_ui(game_state_t* state)
+{
+    char print_str[4];
+
+    if (state->score != shown_score) {
+        int_to_string(state->score, print_str);
+        out_text(UI_START_X, 3, white, print_str);
+        shown_score = state->score;
+    }
+    if (state->level != shown_level) {
+        int_to_string(state->level, print_str);
+        out_text(UI_START_X, 6, white, print_str);
+        shown_level = state->level;
+    }
+}
+
+static void term_preview_piece(uint8_t piece)
+{
+    packed_tetromino* tetromino = GET_TETROMINO(piece, 0);
+    uint8_t grid[4][4];
+    uint8_t i, px, py;
+
+    memset(grid, black, sizeof(grid));
+    for (i = 0; i < 4; i++)
+        grid[GET_BLOCK_Y((*tetromino)[i])][GET_BLOCK_X((*tetromino)[i])] = (uint8_t)tetrominos_colors[piece];
+
+    // Only the cells that differ from the previous piece
+    for (py = 0; py < 4; py++) {
+        for (px = 0; px < 4; px++) {
+            if (grid[py][px] == shown_preview[py][px])
+                continue;
+            out_move(UI_START_X + px, 9 + py);
+            out_block(grid[py][px]);
+            shown_preview[py][px] = grid[py][px];
+        }
+    }
+}
+
+static void term_clear_screen(void)
+{
+    out_bytes("\x1b[0m\x1b[2J", 8);
+    cursor_row = cursor_column = -1;
+    current_fg = current_bg = TERM_UNKNOWN;
+    out_colors(white, black);
+
+    // Everything on screen is gone
+    shown_score = shown_level = -1;
+    memset(shown_preview, black, sizeof(shown_preview));
+}
+
+static void term_draw_borders(void)
+{
+    uint8_t x, y;
+
+    out_text(9, 0, yellow, "Tetris + Alice = TETRICE");
+
+    out_text(1, 11, pink, "O/LEFT:  LEFT");
+    out_text(1, 12, pink, "P/RIGHT: RIGHT");
+    out_text(1, 13, pink, "Z/UP:    ROTATE");
+    out_text(1, 14, pink, "A:       UNROTATE");
+    out_text(1, 15, pink, "SPACE/DOWN: DROP");
+    out_text(1, 17, pink, "R: REWIND  Q: QUIT");
+
+    for (y = PLAYFIELD_START_Y; y < PLAYFIELD_START_Y + PLAYFIELD_HEIGHT; y++) {
+        out_move(PLAYFIELD_START_X - 1, y);
+        out_block(magenta);
+        out_move(PLAYFIELD_END_X + 1, y);
+        out_block(magenta);
+    }
+    out_move(PLAYFIELD_START_X - 1, PLAYFIELD_START_Y + PLAYFIELD_HEIGHT);
+    for (x = 0; x < PLAYFIELD_WIDTH + 2; x++)
+        out_block(magenta);
+
+    out_text(UI_START_X, 2, white, "SCORE");
+    out_text(UI_START_X, 5, white, "LEVEL");
+    out_text(UI_START_X, 8, white, "NEXT");
+}
+
+static void term_game_over(void)
+{
+    out_text(PLAYFIELD_START_X + 1, 10, white, "GAME  OVER");
+}
+
+const host_display_ops_t term_ops = {
+    term_sync_playfield,
+    term_sync_ui,
+    term_preview_piece,
+    term_clear_screen,
+    term_draw_borders,
+    term_game_over
+};
+
+void term_invalidate(game_state_t* state)
+{
+    uint8_t x, y;
+
+    term_clear_screen();
+    term_draw_borders();
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            SET_CELL_DIRTY(state->playfield[y][x]);
+    }
+}
+
+void term_get_stats(term_stats_t* out_stats)
+{
+    *out_stats = stats;
+}
+
+/************************************************************/
+/* Keyboard                                                 */
+/************************************************************/
+
+static void push_key(uint8_t value, uint64_t stamp)
+{
+    spsc_event_t event;
+
+    event.stamp_ns = stamp;
+    event.value = value;
+    if (spsc_push(&keys, &event))
+        stats.keys++;
+    else
+        stats.keys_dropped++;
+}
+
+// Raw bytes to keys, arrows arrive as ESC [ A..D
+static void *input_main(void* arg)
+{
+    struct pollfd pfd;
+    uint8_t buffer[64], escape = 0, c;
+    uint64_t stamp;
+    ssize_t n, i;
+
+    (void)arg;
+    pfd.fd = STDIN_FILENO;
+    pfd.events = POLLIN;
+
+    while (atomic_load_explicit(&input_running, memory_order_relaxed)) {
+        // Wake up now and then to notice term_close
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+        n = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (n <= 0)
+            break;
+        stamp = now_ns();
+
+        for (i = 0; i < n; i++) {
+            c = buffer[i];
+            if (escape == 1) {
+                escape = 0;
+                if (c == '[') {
+                    escape = 2;
+                    continue;
+                }
+                // A lone ESC: the byte is a key of its own
+            }
+            if (escape == 2) {
+                escape = 0;
+                switch (c) {
+                case 'A': push_key(INPUT_ROTATE_CW, stamp); break;
+                case 'B': push_key(INPUT_DROP, stamp); break;
+                case 'C': push_key(INPUT_MOVE_RIGHT, stamp); break;
+                case 'D': push_key(INPUT_MOVE_LEFT, stamp); break;
+                default: break;
+                }
+                continue;
+            }
+            switch (c) {
+            case 0x1b: escape = 1; break;
+            case 'o': case 'O': push_key(INPUT_MOVE_LEFT, stamp); break;
+            case 'p': case 'P': push_key(INPUT_MOVE_RIGHT, stamp); break;
+            case 'z': case 'Z': push_key(INPUT_ROTATE_CW, stamp); break;
+            case 'a': case 'A': push_key(INPUT_ROTATE_CCW, stamp); break;
+            case ' ': push_key(INPUT_DROP, stamp); break;
+            case 'r': case 'R': case 0x7f: push_key(TERM_KEY_REWIND, stamp); break;
+            case 'q': case 'Q': case 0x03: push_key(TERM_KEY_QUIT, stamp); break;
+            default: break;
+            }
+        }
+    }
+    return NULL;
+}
+
+uint8_t term_poll_key(spsc_event_t* event)
+{
+    return spsc_pop(&keys, event);
+}
+
+int term_open(uint8_t keyboard)
+{
+    struct termios raw;
+
+    memset(&stats, 0, sizeof(stats));
+    spsc_init(&keys);
+    out_length = 0;
+
+    if (keyboard && isatty(STDIN_FILENO)) {
+        if (tcgetattr(STDIN_FILENO, &saved_termios))
+            return -1;
+        // No echo, no line buffering, no signals: every key comes through
+        raw = saved_termios;
+        raw.c_iflag &= ~(ICRNL | IXON);
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw))
+            return -1;
+        raw_mode = 1;
+
+        atomic_store(&input_running, 1);
+        if (pthread_create(&input_thread, NULL, input_main, NULL)) {
+            atomic_store(&input_running, 0);
+            tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios);
+            raw_mode = 0;
+            return -1;
+        }
+    }
+
+    // Hide the cursor while playing
+    out_bytes("\x1b[?25l", 6);
+    return 0;
+}
+
+void term_close(void)
+{
+    char sequence[32];
+    int n;
+
+    if (atomic_load(&input_running)) {
+        atomic_store(&input_running, 0);
+        pthread_join(input_thread, NULL);
+    }
+    if (raw_mode) {
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios);
+        raw_mode = 0;
+    }
+
+    // Leave the cursor below the board
+    n = sprintf(sequence, "\x1b[0m\x1b[%d;1H\x1b[?25h\n", PLAYFIELD_START_Y + PLAYFIELD_HEIGHT + 2);
+    out_bytes(sequence, (size_t)n);
+    term_flush();
+}
@@ -0,0 +1,55 @@
+/* term.h - ANSI terminal frontend */
+/* Implements the display hooks on an ANSI/VT100 terminal. Only    */
+/* dirty playfield cells, changed digits and changed preview cells */
+/* are painted: one cursor move per run of cells, colour changes   */
+/* only when the colour does, all appended to one buffer that goes */
+/* out with a single write() per frame. The keyboard is read in    */
+/* raw mode by its own thread and handed over through an SPSC      */
+/* queue, stamped so the latency to the next paint can be measured.*/
+
+#ifndef HOST_TERM_H
+#define HOST_TERM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "engine.h"
+#include "spsc.h"
+
+/* Keys beyond the game inputs */
+#define TERM_KEY_REWIND (INPUT_TIMEOUT + 1)
+#define TERM_KEY_QUIT   (INPUT_TIMEOUT + 2)
+
+/* Character cells are two terminal columns wide */
+#define TERM_COLUMNS_PER_CELL 2
+
+typedef struct term_stats_t {
+    uint64_t writes;
+    uint64_t bytes;
+    uint64_t keys;
+    uint64_t keys_dropped;      /* Queue was full */
+} term_stats_t;
+
+extern const host_display_ops_t term_ops;
+
+/* Take over the terminal on stdout; with keyboard set and a terminal
+ * on stdin, switch it to raw mode and start the input thread.
+ * Returns 0 on success. */
+int term_open(uint8_t keyboard);
+void term_close(void);
+
+/* Next key from the input thread, 0 if none */
+uint8_t term_poll_key(spsc_event_t* event);
+
+/* Send everything painted since the last flush in one write(),
+ * returns the number of bytes */
+size_t term_flush(void);
+
+/* Forget what is on screen: clear it, draw the borders and mark every
+ * cell dirty so the next sync paints everything */
+void term_invalidate(game_state_t* state);
+
+/* Key counters are the input thread's, read them after term_close */
+void term_get_stats(term_stats_t* stats);
+
+#endif /* HOST_TERM_H */
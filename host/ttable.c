@@ -0,0 +1,131 @@
+/* ttable.c - Shared lock-free transposition table */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ttable.h"
+
+// data layout: bits 0-31 value, 32-39 depth, 40-47 generation, 63 valid
+#define TT_VALID        (1ull << 63)
+#define TT_VALUE(d)     ((int32_t)(uint32_t)(d))
+#define TT_DEPTH(d)     ((uint8_t)((d) >> 32))
+#define TT_GENERATION(d) ((uint8_t)((d) >> 40))
+#define TT_PACK(value, depth, generation) \
+    (TT_VALID | ((uint64_t)(generation) << 40) | ((uint64_t)(depth) << 32) | (uint32_t)(value))
+
+ttable_t* tt_create(size_t megabytes, int nworkers)
+{
+    ttable_t* tt;
+    uint64_t buckets = 1;
+    size_t budget = megabytes << 20;
+    size_t bucket_bytes = TT_BUCKET_ENTRIES * sizeof(tt_entry_t);
+
+    if (budget < bucket_bytes)
+        return NULL;
+    while ((buckets << 1) * bucket_bytes <= budget)
+        buckets <<= 1;
+
+    tt = calloc(1, sizeof(*tt));
+    if (!tt)
+        return NULL;
+
+    tt->bytes = buckets * bucket_bytes;
+    tt->bucket_mask = buckets - 1;
+    tt->nworkers = nworkers < 1 ? 1 : nworkers;
+    tt->entries = aligned_alloc(64, tt->bytes);
+    tt->counters = calloc((size_t)tt->nworkers, sizeof(tt_counters_t));
+    if (!tt->entries || !tt->counters) {
+        tt_destroy(tt);
+        return NULL;
+    }
+
+    tt_clear(tt);
+    return tt;
+}
+
+void tt_destroy(ttable_t* tt)
+{
+    if (!tt)
+        return;
+    free(tt->counters);
+    free(tt->entries);
+    free(tt);
+}
+
+void tt_clear(ttable_t* tt)
+{
+    memset(tt->entries, 0, tt->bytes);
+    memset(tt->counters, 0, (size_t)tt->nworkers * sizeof(tt_counters_t));
+    tt->generation = 0;
+}
+
+void tt_new_generation(ttable_t* tt)
+{
+    tt->generation++;
+}
+
+uint8_t tt_probe(ttable_t* tt, uint64_t key, int worker, int32_t* value)
+{
+    tt_entry_t* bucket = &tt->entries[(key & tt->bucket_mask) * TT_BUCKET_ENTRIES];
+    uint64_t data, check;
+    int i;
+
+    for (i = 0; i < TT_BUCKET_ENTRIES; i++) {
+        data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+        check = atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+        if ((data & TT_VALID) && (check ^ data) == key) {
+            *value = TT_VALUE(data);
+            tt->counters[worker].hits++;
+            return 1;
+        }
+    }
+
+    tt->counters[worker].misses++;
+    return 0;
+}
+
+void tt_store(ttable_t* tt, uint64_t key, int worker, int32_t value, uint8_t depth)
+{
+    tt_entry_t* bucket = &tt->entries[(key & tt->bucket_mask) * TT_BUCKET_ENTRIES];
+    uint64_t data, check, fresh;
+    int i, victim = -1, victim_rank = 0x7FFFFFFF, rank;
+
+    for (i = 0; i < TT_BUCKET_ENTRIES; i++) {
+        data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+        check = atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+
+        if (!(data & TT_VALID) || (check ^ data) == key) {
+            victim = i;
+            victim_rank = -1;
+            break;
+        }
+
+        // Older generations go first, then shallower entries
+        rank = (TT_GENERATION(data) == tt->generation ? 256 : 0) + TT_DEPTH(data);
+        if (rank < victim_rank) {
+            victim = i;
+            victim_rank = rank;
+        }
+    }
+
+    if (victim_rank >= 0)
+        tt->counters[worker].replacements++;
+    tt->counters[worker].stores++;
+
+    fresh = TT_PACK(value, depth, tt->generation);
+    atomic_store_explicit(&bucket[victim].data, fresh, memory_order_relaxed);
+    atomic_store_explicit(&bucket[victim].check, key ^ fresh, memory_order_relaxed);
+}
+
+void tt_get_counters(const ttable_t* tt, tt_counters_t* total)
+{
+    int i;
+
+    memset(total, 0, sizeof(*total));
+    for (i = 0; i < tt->nworkers; i++) {
+        total->hits += tt->counters[i].hits;
+        total->misses += tt->counters[i].misses;
+        total->stores += tt->counters[i].stores;
+        total->replacements += tt->counters[i].replacements;
+    }
+}
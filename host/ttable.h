@@ -0,0 +1,57 @@
+/* ttable.h - Shared lock-free transposition table */
+/* Four 16-byte entries per 64-byte bucket. An entry stores  */
+/* key ^ data next to data, so a torn write from a racing     */
+/* thread fails the key check instead of returning garbage.   */
+/*                                                            */
+/* Replacement: same key first, then an empty slot, then the  */
+/* slot from the oldest generation, shallowest depth first.   */
+
+#ifndef HOST_TTABLE_H
+#define HOST_TTABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define TT_BUCKET_ENTRIES 4
+
+typedef struct tt_entry_t {
+    _Atomic uint64_t check;     /* key ^ data */
+    _Atomic uint64_t data;      /* value, depth, generation, valid bit */
+} tt_entry_t;
+
+typedef struct tt_counters_t {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t replacements;      /* Stores that evicted another key */
+    uint64_t pad[4];            /* One cache line per worker */
+} tt_counters_t;
+
+typedef struct ttable_t {
+    tt_entry_t* entries;
+    uint64_t bucket_mask;
+    size_t bytes;
+    uint8_t generation;
+    int nworkers;
+    tt_counters_t* counters;    /* Per worker, summed by tt_get_counters */
+} ttable_t;
+
+/* Create a table using at most megabytes of memory (rounded down to a
+ * power of two number of buckets), with counters for nworkers threads */
+ttable_t* tt_create(size_t megabytes, int nworkers);
+void tt_destroy(ttable_t* tt);
+void tt_clear(ttable_t* tt);
+
+/* Age existing entries so the next search prefers to replace them */
+void tt_new_generation(ttable_t* tt);
+
+/* Look key up, return 1 and fill value on a hit */
+uint8_t tt_probe(ttable_t* tt, uint64_t key, int worker, int32_t* value);
+
+/* Store a value, depth ranks entries within a generation */
+void tt_store(ttable_t* tt, uint64_t key, int worker, int32_t value, uint8_t depth);
+
+void tt_get_counters(const ttable_t* tt, tt_counters_t* total);
+
+#endif /* HOST_TTABLE_H */
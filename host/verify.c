@@ -0,0 +1,219 @@
+/* verify.c - Headless replay verifier */
+/* Re-runs every replay given on the command line (files or   */
+/* directories of *.trpl) at full speed across all cores and   */
+/* checks the final score, level and board hash.               */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "replay.h"
+#include "work_steal.h"
+
+#define REPLAY_IO_ERROR (-1)
+
+typedef struct verify_job_t {
+    char* path;
+    int status;                 /* replay_status_t or REPLAY_IO_ERROR */
+    replay_result_t result;
+} verify_job_t;
+
+typedef struct verify_list_t {
+    verify_job_t* jobs;
+    int32_t count;
+    int32_t capacity;
+} verify_list_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/************************************************************/
+/* Collecting replays                                       */
+/************************************************************/
+
+static int list_add(verify_list_t* list, const char* dir, const char* name)
+{
+    verify_job_t* jobs;
+    size_t length;
+
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 256;
+        jobs = realloc(list->jobs, (size_t)list->capacity * sizeof(*jobs));
+        if (!jobs)
+            return -1;
+        list->jobs = jobs;
+    }
+
+    length = (dir ? strlen(dir) + 1 : 0) + strlen(name) + 1;
+    list->jobs[list->count].path = malloc(length);
+    if (!list->jobs[list->count].path)
+        return -1;
+    if (dir)
+        snprintf(list->jobs[list->count].path, length, "%s/%s", dir, name);
+    else
+        snprintf(list->jobs[list->count].path, length, "%s", name);
+    list->count++;
+    return 0;
+}
+
+static int has_replay_suffix(const char* name)
+{
+    size_t length = strlen(name);
+    return length > 5 && !strcmp(name + length - 5, ".trpl");
+}
+
+static int compare_jobs(const void* a, const void* b)
+{
+    return strcmp(((const verify_job_t*)a)->path, ((const verify_job_t*)b)->path);
+}
+
+static int list_collect(verify_list_t* list, const char* path)
+{
+    struct stat st;
+    struct dirent* entry;
+    DIR* dir;
+    int32_t first = list->count;
+
+    if (stat(path, &st)) {
+        fprintf(stderr, "verify: cannot stat %s\n", path);
+        return -1;
+    }
+    if (!S_ISDIR(st.st_mode))
+        return list_add(list, NULL, path);
+
+    dir = opendir(path);
+    if (!dir) {
+        fprintf(stderr, "verify: cannot open %s\n", path);
+        return -1;
+    }
+    while ((entry = readdir(dir)) != NULL) {
+        if (has_replay_suffix(entry->d_name) && list_add(list, path, entry->d_name)) {
+            closedir(dir);
+            return -1;
+        }
+    }
+    closedir(dir);
+
+    // Directory order is arbitrary, report in name order
+    qsort(&list->jobs[first], (size_t)(list->count - first), sizeof(verify_job_t), compare_jobs);
+    return 0;
+}
+
+/************************************************************/
+/* Verification                                             */
+/************************************************************/
+
+static void verify_job(void* ctx, int32_t job, int worker)
+{
+    verify_job_t* v = &((verify_list_t*)ctx)->jobs[job];
+    struct stat st;
+    void* data;
+    int fd;
+
+    (void)worker;
+    v->status = REPLAY_IO_ERROR;
+
+    fd = open(v->path, O_RDONLY);
+    if (fd < 0)
+        return;
+    if (fstat(fd, &st) || st.st_size == 0) {
+        close(fd);
+        return;
+    }
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return;
+
+    v->status = replay_verify(data, (size_t)st.st_size, &v->result);
+    munmap(data, (size_t)st.st_size);
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_verify [options] FILE|DIR...\n");
+    printf("  -t N        worker threads (default: online CPUs)\n");
+    printf("  -q          only print the summary\n");
+}
+
+int main(int argc, char** argv)
+{
+    verify_list_t list;
+    ws_pool_t* pool;
+    uint64_t frames = 0;
+    int32_t i, ok = 0;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint8_t quiet = 0;
+    double start, elapsed;
+
+    memset(&list, 0, sizeof(list));
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-q")) {
+            quiet = 1;
+        } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 1;
+        } else if (list_collect(&list, argv[i])) {
+            return 1;
+        }
+    }
+    if (list.count == 0) {
+        usage();
+        return 1;
+    }
+    if (threads < 1)
+        threads = 1;
+
+    pool = ws_pool_create(threads, list.count);
+    if (!pool) {
+        fprintf(stderr, "verify: out of memory\n");
+        return 1;
+    }
+
+    start = now_seconds();
+    if (ws_pool_run(pool, list.count, verify_job, &list)) {
+        fprintf(stderr, "verify: too many replays for the pool\n");
+        ws_pool_destroy(pool);
+        return 1;
+    }
+    elapsed = now_seconds() - start;
+
+    for (i = 0; i < list.count; i++) {
+        verify_job_t* v = &list.jobs[i];
+
+        if (v->status == REPLAY_OK) {
+            ok++;
+            frames += v->result.frames;
+        } else if (v->status == REPLAY_IO_ERROR) {
+            printf("%s: cannot read\n", v->path);
+        } else {
+            printf("%s: %s\n", v->path, replay_status_string((replay_status_t)v->status));
+        }
+        if (!quiet && v->status == REPLAY_OK)
+            printf("%s: ok, seed %u, %u frames, score %u, level %u%s\n", v->path, v->result.seed,
+                   v->result.frames, v->result.score, v->result.level,
+                   v->result.game_over ? ", game over" : "");
+    }
+
+    printf("%d replay(s): %d ok, %d failed, %llu frames in %.3fs on %d thread(s), %.0f frames/s, %.0f replays/s\n",
+           list.count, ok, list.count - ok, (unsigned long long)frames, elapsed, threads,
+           elapsed > 0 ? frames / elapsed : 0.0, elapsed > 0 ? list.count / elapsed : 0.0);
+
+    ws_pool_destroy(pool);
+    for (i = 0; i < list.count; i++)
+        free(list.jobs[i].path);
+    free(list.jobs);
+    return ok != list.count;
+}
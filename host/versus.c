@@ -0,0 +1,181 @@
+/* versus.c - Two-player versus rules on top of tetrice.c */
+
+#include <string.h>
+
+#include "versus.h"
+
+/************************************************************/
+/* Garbage                                                  */
+/************************************************************/
+
+// check_full_lines scores 1, 3, 5, 8 points for 1 to 4 lines
+static uint8_t garbage_for_points(uint8_t points)
+{
+    switch (points) {
+    case 3:  return 1;
+    case 5:  return 2;
+    case 8:  return 4;
+    default: return 0;
+    }
+}
+
+static uint8_t piece_fits(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation)
+{
+    packed_tetromino* tetromino = GET_TETROMINO(piece, rotation);
+    uint8_t i, px, py;
+
+    for (i = 0; i < 4; i++) {
+        px = x + GET_BLOCK_X((*tetromino)[i]);
+        py = y + GET_BLOCK_Y((*tetromino)[i]);
+        if (px >= PLAYFIELD_WIDTH || py >= PLAYFIELD_HEIGHT || !playfield_is_empty_cell(state, px, py))
+            return 0;
+    }
+    return 1;
+}
+
+// Push the pending rows in from the bottom, return 1 if the player tops out
+static uint8_t apply_garbage(versus_state_t* vs, versus_player_t* player)
+{
+    game_state_t* state = &player->state;
+    uint8_t n = player->pending_garbage;
+    uint8_t x, y, hole, topped = 0;
+
+    player->pending_garbage = 0;
+    playfield_remove_piece(state, state->piece, state->x, state->y, state->rotation);
+
+    // Anything in the rows pushed off the top ends the game
+    for (y = 0; y < n && y < PLAYFIELD_HEIGHT; y++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+            if (!playfield_is_empty_cell(state, x, y))
+                topped = 1;
+        }
+    }
+
+    hole = host_rng_next(&vs->match_rng) % PLAYFIELD_WIDTH;
+    for (y = 0; y + n < PLAYFIELD_HEIGHT; y++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            playfield_set_cell(state, x, y, playfield_get_cell(state, x, y + n));
+    }
+    for (; y < PLAYFIELD_HEIGHT; y++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            playfield_set_cell(state, x, y, x == hole ? CELL_EMPTY : VERSUS_GARBAGE_CELL);
+    }
+
+    // The falling piece rides up with the stack if it has to
+    while (!piece_fits(state, state->piece, state->x, state->y, state->rotation) && state->y > 0)
+        state->y--;
+    if (!piece_fits(state, state->piece, state->x, state->y, state->rotation))
+        topped = 1;
+
+    playfield_place_piece(state, state->piece, state->x, state->y, state->rotation);
+    return topped;
+}
+
+/************************************************************/
+/* Frames                                                   */
+/************************************************************/
+
+static void start_match(versus_state_t* vs)
+{
+    uint32_t seed = host_rng_next(&vs->match_rng);
+    uint8_t p;
+
+    // Both players get the same piece sequence
+    seed = (seed << 24) ^ ((uint32_t)host_rng_next(&vs->match_rng) << 16)
+         ^ ((uint32_t)host_rng_next(&vs->match_rng) << 8) ^ host_rng_next(&vs->match_rng);
+    for (p = 0; p < VERSUS_PLAYERS; p++) {
+        versus_player_t* player = &vs->players[p];
+
+        host_rng_seed(&player->rng, seed);
+        host_rng_bind(&player->rng);
+        game_start(&player->state);
+        player->timeout_ticks = timeout_ticks;
+        player->pending_garbage = 0;
+        player->over = 0;
+        player->lines_sent = 0;
+    }
+    host_rng_bind(NULL);
+}
+
+void versus_init(versus_state_t* vs, uint32_t seed)
+{
+    memset(vs, 0, sizeof(*vs));
+    host_rng_seed(&vs->match_rng, seed);
+    start_match(vs);
+}
+
+// One game_step, adding any garbage it earns to *sent
+static uint8_t player_step(versus_player_t* player, input_action_t input, uint8_t* sent)
+{
+    uint8_t score = player->state.score;
+    uint8_t over = game_step(&player->state, input);
+
+    *sent += garbage_for_points((uint8_t)(player->state.score - score));
+    return over;
+}
+
+// The frame's input first, then gravity when the countdown runs out
+static void player_frame(versus_state_t* vs, versus_player_t* player, uint8_t input, uint8_t* sent)
+{
+    host_rng_bind(&player->rng);
+    timeout_ticks = player->timeout_ticks;
+
+    if (player->pending_garbage && apply_garbage(vs, player)) {
+        player->over = 1;
+        return;
+    }
+    if (input >= INPUT_MOVE_LEFT && input <= INPUT_DROP && player_step(player, (input_action_t)input, sent)) {
+        player->over = 1;
+        return;
+    }
+    if (timeout_ticks > 0)
+        timeout_ticks--;
+    if (timeout_ticks == 0 && player_step(player, INPUT_TIMEOUT, sent))
+        player->over = 1;
+    player->timeout_ticks = timeout_ticks;
+}
+
+void versus_step(versus_state_t* vs, const uint8_t inputs[VERSUS_PLAYERS])
+{
+    uint8_t sent[VERSUS_PLAYERS] = { 0, 0 };
+    uint8_t p, pending;
+
+    for (p = 0; p < VERSUS_PLAYERS; p++)
+        player_frame(vs, &vs->players[p], inputs[p], &sent[p]);
+    host_rng_bind(NULL);
+
+    for (p = 0; p < VERSUS_PLAYERS; p++) {
+        versus_player_t* other = &vs->players[1 - p];
+
+        vs->players[p].lines_sent += sent[p];
+        pending = other->pending_garbage + sent[p];
+        other->pending_garbage = pending > VERSUS_MAX_PENDING ? VERSUS_MAX_PENDING : pending;
+    }
+    vs->frame++;
+
+    if (vs->players[0].over || vs->players[1].over) {
+        // Both topping out on the same frame is a draw
+        if (!vs->players[0].over)
+            vs->wins[0]++;
+        else if (!vs->players[1].over)
+            vs->wins[1]++;
+        vs->match++;
+        start_match(vs);
+    }
+}
+
+uint8_t versus_equal(const versus_state_t* a, const versus_state_t* b)
+{
+    uint8_t p;
+
+    for (p = 0; p < VERSUS_PLAYERS; p++) {
+        const versus_player_t* pa = &a->players[p];
+        const versus_player_t* pb = &b->players[p];
+
+        if (memcmp(&pa->state, &pb->state, sizeof(game_state_t)) != 0 || pa->rng.state != pb->rng.state
+            || pa->timeout_ticks != pb->timeout_ticks || pa->pending_garbage != pb->pending_garbage
+            || pa->over != pb->over || pa->lines_sent != pb->lines_sent || a->wins[p] != b->wins[p])
+            return 0;
+    }
+    return a->match_rng.state == b->match_rng.state && a->frame == b->frame && a->match == b->match;
+}
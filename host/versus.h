@@ -0,0 +1,47 @@
+/* versus.h - Two-player versus rules on top of tetrice.c */
+/* Both games advance one frame per versus_step. Clearing n >= 2 */
+/* lines at once sends garbage to the other side (n - 1 rows,     */
+/* 4 for a tetris), applied at the start of its next frame as     */
+/* rows pushed up from the bottom with one hole.                  */
+/*                                                                */
+/* versus_state_t is plain data: copying it is a snapshot, and a  */
+/* frame only depends on the state and the two inputs, so peers   */
+/* that agree on the inputs agree on the state.                   */
+
+#ifndef HOST_VERSUS_H
+#define HOST_VERSUS_H
+
+#include <stdint.h>
+
+#include "engine.h"
+
+#define VERSUS_PLAYERS 2
+#define VERSUS_GARBAGE_CELL CELL_PIECE_5
+#define VERSUS_MAX_PENDING PLAYFIELD_HEIGHT
+
+typedef struct versus_player_t {
+    game_state_t state;
+    host_rng_t rng;
+    uint8_t timeout_ticks;      /* Gravity countdown, swapped in around game_step */
+    uint8_t pending_garbage;    /* Rows received, applied next frame */
+    uint8_t over;
+    uint32_t lines_sent;
+} versus_player_t;
+
+typedef struct versus_state_t {
+    versus_player_t players[VERSUS_PLAYERS];
+    host_rng_t match_rng;       /* Garbage holes and the seeds of the next match */
+    uint32_t frame;             /* Frames since the session started */
+    uint32_t match;             /* Matches finished */
+    uint8_t wins[VERSUS_PLAYERS];
+} versus_state_t;
+
+void versus_init(versus_state_t* vs, uint32_t seed);
+
+/* Advance both games by one frame; a finished match restarts */
+void versus_step(versus_state_t* vs, const uint8_t inputs[VERSUS_PLAYERS]);
+
+/* Field by field, padding bytes are not part of the state */
+uint8_t versus_equal(const versus_state_t* a, const versus_state_t* b);
+
+#endif /* HOST_VERSUS_H */
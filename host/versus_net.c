@@ -0,0 +1,315 @@
+/* versus_net.c - Loopback harness for rollback versus over UDP */
+/* Two peers in one process, each with its own UDP socket on      */
+/* 127.0.0.1, play scripted inputs frame by frame. Packets go      */
+/* through an impaired link (latency, jitter, loss) before being   */
+/* sent, time is virtual so runs are fast and repeatable. At the   */
+/* end both peers must match a plain lockstep run of the inputs.   */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "rollback.h"
+
+#define FRAME_NS (1000000000ull / 60)
+#define LINK_QUEUE 1024
+
+typedef struct link_packet_t {
+    uint64_t deliver_at;
+    uint16_t length;
+    uint8_t data[ROLLBACK_PACKET_MAX];
+} link_packet_t;
+
+/* One direction: packets wait here until their delivery time */
+typedef struct link_t {
+    link_packet_t queue[LINK_QUEUE];
+    uint32_t count;
+    uint64_t sent;
+    uint64_t lost;
+    uint64_t delivered;
+    uint64_t overflow;
+} link_t;
+
+typedef struct versus_options_t {
+    uint32_t frames;
+    uint32_t latency_ms;        /* One way */
+    uint32_t jitter_ms;         /* Plus or minus */
+    uint32_t loss_percent;
+    uint8_t input_delay;
+    uint32_t rate;              /* Inputs per second per player */
+    uint32_t seed;
+} versus_options_t;
+
+typedef struct peer_t {
+    rollback_session_t session;
+    int fd;
+    link_t link;                /* Outgoing */
+    uint32_t rng;               /* Scripted player */
+} peer_t;
+
+static uint32_t next_random(uint32_t* s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+/************************************************************/
+/* Impaired link                                            */
+/************************************************************/
+
+static uint32_t link_rng = 0x1234567u;
+
+static void link_send(link_t* link, const versus_options_t* options, uint64_t now,
+                      const uint8_t* data, size_t length)
+{
+    link_packet_t* p;
+    int64_t delay = (int64_t)options->latency_ms * 1000000;
+
+    link->sent++;
+    if (next_random(&link_rng) % 100 < options->loss_percent) {
+        link->lost++;
+        return;
+    }
+    if (link->count == LINK_QUEUE) {
+        link->overflow++;
+        return;
+    }
+    if (options->jitter_ms)
+        delay += (int64_t)(next_random(&link_rng) % (2 * options->jitter_ms * 1000 + 1)) * 1000
+               - (int64_t)options->jitter_ms * 1000000;
+    if (delay < 0)
+        delay = 0;
+
+    p = &link->queue[link->count++];
+    p->deliver_at = now + (uint64_t)delay;
+    p->length = (uint16_t)length;
+    memcpy(p->data, data, length);
+}
+
+// Send every packet that is due, in any order: jitter reorders them
+static void link_deliver(link_t* link, int fd, uint64_t now)
+{
+    uint32_t i = 0;
+
+    while (i < link->count) {
+        link_packet_t* p = &link->queue[i];
+
+        if (p->deliver_at > now) {
+            i++;
+            continue;
+        }
+        if (send(fd, p->data, p->length, 0) == (ssize_t)p->length)
+            link->delivered++;
+        *p = link->queue[--link->count];
+    }
+}
+
+/************************************************************/
+/* Peers                                                    */
+/************************************************************/
+
+static int peer_socket(struct sockaddr_in* address)
+{
+    socklen_t length = sizeof(*address);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0)
+        return -1;
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)address, sizeof(*address))
+        || getsockname(fd, (struct sockaddr*)address, &length)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void peer_receive(peer_t* peer)
+{
+    uint8_t buffer[ROLLBACK_PACKET_MAX + 16];
+    ssize_t n;
+
+    while ((n = recv(peer->fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+        rollback_read_packet(&peer->session, buffer, (size_t)n);
+}
+
+static uint8_t scripted_input(peer_t* peer, uint32_t rate)
+{
+    if (next_random(&peer->rng) % 60 >= rate)
+        return INPUT_NONE;
+    return (uint8_t)(INPUT_MOVE_LEFT + next_random(&peer->rng) % (INPUT_DROP - INPUT_MOVE_LEFT + 1));
+}
+
+// Lockstep reference: the inputs each peer actually used, no network
+static uint8_t check_reference(const peer_t* peer, uint8_t* const truth[VERSUS_PLAYERS], uint32_t seed)
+{
+    versus_state_t reference;
+    uint8_t inputs[VERSUS_PLAYERS];
+    uint32_t f;
+
+    versus_init(&reference, seed);
+    for (f = 0; f < peer->session.state.frame; f++) {
+        inputs[0] = truth[0][f];
+        inputs[1] = truth[1][f];
+        versus_step(&reference, inputs);
+    }
+    return versus_equal(&reference, &peer->session.state);
+}
+
+static void report_peer(int i, const peer_t* peer, uint8_t matches)
+{
+    const rollback_stats_t* s = &peer->session.stats;
+
+    printf("peer %d: %llu frames, %llu stalls, %llu mispredictions, %llu rollbacks (%.1f%% of frames)\n", i,
+           (unsigned long long)s->frames, (unsigned long long)s->stalls, (unsigned long long)s->mispredictions,
+           (unsigned long long)s->rollbacks, s->frames ? 100.0 * s->rollbacks / s->frames : 0.0);
+    printf("  rollback depth: mean %.1f p50 %llu p99 %llu max %llu frames\n", histogram_mean(&s->depth),
+           (unsigned long long)histogram_percentile(&s->depth, 50),
+           (unsigned long long)histogram_percentile(&s->depth, 99), (unsigned long long)s->depth.max);
+    printf("  re-simulation: %llu frames (%.2f per frame), %.0fns per re-simulated frame, rollback p99 %.1fus max %.1fus\n",
+           (unsigned long long)s->resimulated, s->frames ? (double)s->resimulated / s->frames : 0.0,
+           s->resimulated ? (double)s->rollback_ns.sum / s->resimulated : 0.0,
+           histogram_percentile(&s->rollback_ns, 99) / 1e3, s->rollback_ns.max / 1e3);
+    printf("  frame cost: mean %.1fus p99 %.1fus max %.1fus; packets %llu sent, %llu lost, %llu delivered\n",
+           histogram_mean(&s->advance_ns) / 1e3, histogram_percentile(&s->advance_ns, 99) / 1e3,
+           s->advance_ns.max / 1e3, (unsigned long long)peer->link.sent, (unsigned long long)peer->link.lost,
+           (unsigned long long)peer->link.delivered);
+    printf("  state at frame %u matches lockstep: %s\n", peer->session.state.frame, matches ? "yes" : "NO");
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_versus [options]\n");
+    printf("  -f N        frames to play (default 3600, one minute)\n");
+    printf("  -l MS       one-way latency (default 50)\n");
+    printf("  -j MS       jitter, plus or minus (default 10)\n");
+    printf("  -L PERCENT  packet loss (default 5)\n");
+    printf("  -D N        local input delay in frames (default 0)\n");
+    printf("  -r N        inputs per second per player (default 6)\n");
+    printf("  -s SEED     match seed (default 1)\n");
+}
+
+int main(int argc, char** argv)
+{
+    versus_options_t options;
+    static peer_t peers[VERSUS_PLAYERS];
+    struct sockaddr_in addresses[VERSUS_PLAYERS];
+    uint8_t* truth[VERSUS_PLAYERS];
+    uint8_t packet[ROLLBACK_PACKET_MAX];
+    uint32_t tick, total, frame;
+    uint64_t now;
+    uint8_t ok = 1, matches;
+    int i;
+
+    options.frames = 3600;
+    options.latency_ms = 50;
+    options.jitter_ms = 10;
+    options.loss_percent = 5;
+    options.input_delay = 0;
+    options.rate = 6;
+    options.seed = 1;
+
+    for (i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 'f': options.frames = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'l': options.latency_ms = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'j': options.jitter_ms = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'L': options.loss_percent = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'D': options.input_delay = (uint8_t)atoi(value); break;
+        case 'r': options.rate = (uint32_t)strtoul(value, NULL, 0); break;
+        case 's': options.seed = (uint32_t)strtoul(value, NULL, 0); break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+
+    // Headroom for the drain phase and stalled ticks
+    total = options.frames * 2 + 60 * 60;
+    for (i = 0; i < VERSUS_PLAYERS; i++) {
+        truth[i] = calloc(total + ROLLBACK_WINDOW, 1);
+        peers[i].fd = peer_socket(&addresses[i]);
+        if (!truth[i] || peers[i].fd < 0) {
+            fprintf(stderr, "versus: cannot set up peer %d\n", i);
+            return 1;
+        }
+        rollback_init(&peers[i].session, (uint8_t)i, options.input_delay, options.seed);
+        peers[i].rng = 0x9E3779B9u * (uint32_t)(i + 1) ^ options.seed;
+    }
+    for (i = 0; i < VERSUS_PLAYERS; i++) {
+        if (connect(peers[i].fd, (struct sockaddr*)&addresses[1 - i], sizeof(addresses[1 - i]))) {
+            fprintf(stderr, "versus: cannot connect peer %d\n", i);
+            return 1;
+        }
+    }
+
+    printf("tetrice versus: %u frames, latency %ums +/- %ums, %u%% loss, input delay %u, %u inputs/s\n",
+           options.frames, options.latency_ms, options.jitter_ms, options.loss_percent,
+           options.input_delay, options.rate);
+
+    // Play, then keep exchanging packets without loss until both peers
+    // hold every input of the frames they simulated
+    for (tick = 0; tick < total; tick++) {
+        uint8_t playing = tick < options.frames;
+
+        now = tick * FRAME_NS;
+        if (!playing) {
+            options.loss_percent = 0;
+            if (peers[0].session.remote_confirmed >= options.frames
+                && peers[1].session.remote_confirmed >= options.frames
+                && peers[0].session.state.frame == options.frames
+                && peers[1].session.state.frame == options.frames
+                && peers[0].session.rollback_from == ROLLBACK_NONE
+                && peers[1].session.rollback_from == ROLLBACK_NONE)
+                break;
+        }
+
+        for (i = 0; i < VERSUS_PLAYERS; i++) {
+            peer_t* peer = &peers[i];
+
+            peer_receive(peer);
+            if (peer->session.state.frame < options.frames) {
+                frame = rollback_add_local_input(&peer->session, playing ? scripted_input(peer, options.rate) : INPUT_NONE);
+                truth[i][frame] = peer->session.local_inputs[frame & (ROLLBACK_WINDOW - 1)];
+                rollback_advance(&peer->session);
+            } else {
+                rollback_settle(&peer->session);
+            }
+            link_send(&peer->link, &options, now, packet, rollback_write_packet(&peer->session, packet));
+        }
+        for (i = 0; i < VERSUS_PLAYERS; i++)
+            link_deliver(&peers[i].link, peers[i].fd, now);
+    }
+
+    for (i = 0; i < VERSUS_PLAYERS; i++) {
+        matches = check_reference(&peers[i], truth, options.seed);
+        ok &= matches;
+        report_peer(i, &peers[i], matches);
+    }
+    printf("matches: %u finished, wins %u - %u, peers %s\n", peers[0].session.state.match,
+           peers[0].session.state.wins[0], peers[0].session.state.wins[1],
+           versus_equal(&peers[0].session.state, &peers[1].session.state) ? "in sync" : "DESYNCED");
+    ok &= versus_equal(&peers[0].session.state, &peers[1].session.state);
+
+    for (i = 0; i < VERSUS_PLAYERS; i++) {
+        close(peers[i].fd);
+        free(truth[i]);
+    }
+    return ok ? 0 : 1;
+}
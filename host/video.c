@@ -0,0 +1,324 @@
+/* video.c - Indexed frames to Y4M or PNG streams */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "video.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define VIDEO_X86 1
+#endif
+
+#define PNG_STORED_BLOCK 65535
+
+/************************************************************/
+/* Palette expansion                                        */
+/************************************************************/
+
+static void expand_scalar(const uint8_t* pixels, size_t count, const uint8_t lut[3][16],
+                          uint8_t* plane0, uint8_t* plane1, uint8_t* plane2)
+{
+    size_t i;
+    uint8_t p;
+
+    for (i = 0; i < count; i++) {
+        p = pixels[i] & 15;
+        plane0[i] = lut[0][p];
+        plane1[i] = lut[1][p];
+        plane2[i] = lut[2][p];
+    }
+}
+
+#ifdef VIDEO_X86
+// PSHUFB is a 16-entry table lookup on 16 bytes at once
+__attribute__((target("ssse3")))
+static void expand_ssse3(const uint8_t* pixels, size_t count, const uint8_t lut[3][16],
+                         uint8_t* plane0, uint8_t* plane1, uint8_t* plane2)
+{
+    const __m128i t0 = _mm_loadu_si128((const __m128i*)lut[0]);
+    const __m128i t1 = _mm_loadu_si128((const __m128i*)lut[1]);
+    const __m128i t2 = _mm_loadu_si128((const __m128i*)lut[2]);
+    const __m128i low = _mm_set1_epi8(15);
+    __m128i index;
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        index = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pixels + i)), low);
+        _mm_storeu_si128((__m128i*)(plane0 + i), _mm_shuffle_epi8(t0, index));
+        _mm_storeu_si128((__m128i*)(plane1 + i), _mm_shuffle_epi8(t1, index));
+        _mm_storeu_si128((__m128i*)(plane2 + i), _mm_shuffle_epi8(t2, index));
+    }
+    expand_scalar(pixels + i, count - i, lut, plane0 + i, plane1 + i, plane2 + i);
+}
+#endif
+
+void video_expand(const uint8_t* pixels, size_t count, const uint8_t lut[3][16],
+                  uint8_t* plane0, uint8_t* plane1, uint8_t* plane2)
+{
+#ifdef VIDEO_X86
+    static int ssse3 = -1;
+
+    if (ssse3 < 0)
+        ssse3 = __builtin_cpu_supports("ssse3");
+    if (ssse3) {
+        expand_ssse3(pixels, count, lut, plane0, plane1, plane2);
+        return;
+    }
+#endif
+    expand_scalar(pixels, count, lut, plane0, plane1, plane2);
+}
+
+/************************************************************/
+/* Output                                                   */
+/************************************************************/
+
+static int write_all(int fd, const uint8_t* data, size_t size)
+{
+    ssize_t n;
+
+    while (size) {
+        n = write(fd, data, size);
+        if (n <= 0)
+            return -1;
+        data += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static uint8_t clamp(int value)
+{
+    return (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+// BT.601 studio range, what Y4M consumers expect by default
+static void palette_to_ycbcr(const uint8_t palette[16][3], uint8_t lut[3][16])
+{
+    int i, r, g, b;
+
+    for (i = 0; i < 16; i++) {
+        r = palette[i][0];
+        g = palette[i][1];
+        b = palette[i][2];
+        lut[0][i] = clamp(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        lut[1][i] = clamp(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+        lut[2][i] = clamp(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+    }
+}
+
+static uint32_t crc_table[256];
+
+static void crc_init(void)
+{
+    uint32_t c, n, k;
+
+    for (n = 0; n < 256; n++) {
+        c = n;
+        for (k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t* data, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static uint8_t* put_u32_be(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+    return out + 4;
+}
+
+// Length, type, data, CRC of type and data
+static uint8_t* png_chunk(uint8_t* out, const char* type, const uint8_t* data, size_t size)
+{
+    uint8_t* start;
+
+    out = put_u32_be(out, (uint32_t)size);
+    start = out;
+    memcpy(out, type, 4);
+    if (size)
+        memmove(out + 4, data, size);
+    out += 4 + size;
+    return put_u32_be(out, crc_update(0xFFFFFFFFu, start, 4 + size) ^ 0xFFFFFFFFu);
+}
+
+static size_t png_raw_size(const video_writer_t* video)
+{
+    return (size_t)video->height * (1 + (size_t)video->width * 3);
+}
+
+static size_t png_max_size(const video_writer_t* video)
+{
+    size_t raw = png_raw_size(video);
+
+    // Signature, IHDR, IDAT with zlib header, stored block headers and Adler-32, IEND
+    return 8 + 25 + 12 + 2 + (raw / PNG_STORED_BLOCK + 1) * 5 + raw + 4 + 12;
+}
+
+// Adler-32 of the zlib stream, reduced once per 5552 bytes as zlib does
+static uint32_t adler32(const uint8_t* data, size_t size)
+{
+    uint32_t a = 1, b = 0;
+    size_t run;
+
+    while (size) {
+        run = size < 5552 ? size : 5552;
+        size -= run;
+        while (run--) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Deflate without compression: frames stay simple to produce and exact
+static size_t png_encode(video_writer_t* video)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    size_t plane = (size_t)video->width * video->height;
+    size_t raw_size = png_raw_size(video), block, done, i, x, y;
+    const uint8_t* r = video->planes;
+    const uint8_t* g = r + plane;
+    const uint8_t* b = g + plane;
+    uint8_t* out = video->buffer;
+    uint8_t* raw = video->raw;
+    uint8_t* idat;
+    uint8_t ihdr[13];
+
+    // Rows are a filter type 0 then interleaved RGB
+    for (y = 0; y < video->height; y++) {
+        *raw++ = 0;
+        for (x = 0; x < video->width; x++) {
+            raw[0] = *r++;
+            raw[1] = *g++;
+            raw[2] = *b++;
+            raw += 3;
+        }
+    }
+    raw = video->raw;
+
+    memcpy(out, signature, 8);
+    out += 8;
+    put_u32_be(ihdr, video->width);
+    put_u32_be(ihdr + 4, video->height);
+    ihdr[8] = 8;                /* Bit depth */
+    ihdr[9] = 2;                /* RGB */
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+    out = png_chunk(out, "IHDR", ihdr, sizeof(ihdr));
+
+    // The IDAT payload is built 8 bytes in, past its length and type
+    idat = out + 8;
+    idat[0] = 0x78;             /* zlib, 32K window, no dictionary */
+    idat[1] = 0x01;
+    i = 2;
+    for (done = 0; done < raw_size; done += block) {
+        block = raw_size - done < PNG_STORED_BLOCK ? raw_size - done : PNG_STORED_BLOCK;
+        idat[i] = done + block == raw_size;
+        idat[i + 1] = (uint8_t)block;
+        idat[i + 2] = (uint8_t)(block >> 8);
+        idat[i + 3] = (uint8_t)~block;
+        idat[i + 4] = (uint8_t)(~block >> 8);
+        memcpy(idat + i + 5, raw + done, block);
+        i += 5 + block;
+    }
+    put_u32_be(idat + i, adler32(raw, raw_size));
+    i += 4;
+
+    out = png_chunk(out, "IDAT", idat, i);
+    out = png_chunk(out, "IEND", NULL, 0);
+    return (size_t)(out - video->buffer);
+}
+
+int video_open(video_writer_t* video, int fd, video_format_t format, uint16_t width, uint16_t height,
+               uint16_t fps, const uint8_t palette[16][3])
+{
+    char header[96];
+    int n, i;
+
+    memset(video, 0, sizeof(*video));
+    video->fd = fd;
+    video->format = format;
+    video->width = width;
+    video->height = height;
+    video->fps = fps ? fps : 60;
+
+    if (format == VIDEO_Y4M) {
+        palette_to_ycbcr(palette, video->lut);
+        video->buffer_size = 6 + (size_t)width * height * 3;
+    } else {
+        for (i = 0; i < 16; i++) {
+            video->lut[0][i] = palette[i][0];
+            video->lut[1][i] = palette[i][1];
+            video->lut[2][i] = palette[i][2];
+        }
+        crc_init();
+        video->buffer_size = png_max_size(video);
+        video->raw = malloc(png_raw_size(video));
+        if (!video->raw)
+            return -1;
+    }
+    video->planes = malloc((size_t)width * height * 3);
+    video->buffer = malloc(video->buffer_size);
+    if (!video->planes || !video->buffer) {
+        video_close(video);
+        return -1;
+    }
+
+    if (format == VIDEO_Y4M) {
+        n = snprintf(header, sizeof(header), "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", width, height, video->fps);
+        if (write_all(fd, (const uint8_t*)header, (size_t)n))
+            return -1;
+        video->bytes += (uint64_t)n;
+    }
+    return 0;
+}
+
+int video_frame(video_writer_t* video, const uint8_t* pixels)
+{
+    size_t plane = (size_t)video->width * video->height;
+    size_t size;
+
+    if (video->format == VIDEO_Y4M) {
+        // The planes go straight after the frame marker
+        memcpy(video->buffer, "FRAME\n", 6);
+        video_expand(pixels, plane, (const uint8_t(*)[16])video->lut, video->buffer + 6,
+                     video->buffer + 6 + plane, video->buffer + 6 + 2 * plane);
+        size = 6 + 3 * plane;
+    } else {
+        video_expand(pixels, plane, (const uint8_t(*)[16])video->lut, video->planes,
+                     video->planes + plane, video->planes + 2 * plane);
+        size = video->format == VIDEO_PNG ? png_encode(video) : 0;
+    }
+
+    video->frames++;
+    video->bytes += size;
+    if (size && write_all(video->fd, video->buffer, size))
+        return -1;
+    return 0;
+}
+
+void video_close(video_writer_t* video)
+{
+    free(video->planes);
+    free(video->buffer);
+    free(video->raw);
+    video->planes = NULL;
+    video->buffer = NULL;
+    video->raw = NULL;
+}
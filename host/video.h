@@ -0,0 +1,43 @@
+/* video.h - Indexed frames to Y4M or PNG streams */
+/* Renderers produce one palette index (0-15) per pixel. A frame  */
+/* is expanded into three planes through 16-entry lookup tables,  */
+/* 16 pixels per byte shuffle, then written with a single write():*/
+/* Y4M (4:4:4, BT.601) for encoders, or a sequence of RGB PNGs.   */
+
+#ifndef HOST_VIDEO_H
+#define HOST_VIDEO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    VIDEO_Y4M = 0,
+    VIDEO_PNG,
+    VIDEO_NONE                  /* Expand, but write nothing (benchmarks) */
+} video_format_t;
+
+typedef struct video_writer_t {
+    int fd;
+    video_format_t format;
+    uint16_t width;
+    uint16_t height;
+    uint16_t fps;
+    uint8_t lut[3][16];         /* Palette per output plane: Y, Cb, Cr or R, G, B */
+    uint8_t* planes;            /* Three width x height planes */
+    uint8_t* raw;               /* PNG scanlines before zlib framing */
+    uint8_t* buffer;            /* Encoded frame */
+    size_t buffer_size;
+    uint64_t frames;
+    uint64_t bytes;
+} video_writer_t;
+
+int video_open(video_writer_t* video, int fd, video_format_t format, uint16_t width, uint16_t height,
+               uint16_t fps, const uint8_t palette[16][3]);
+int video_frame(video_writer_t* video, const uint8_t* pixels);
+void video_close(video_writer_t* video);
+
+/* Look every index up in the three tables, SIMD where available */
+void video_expand(const uint8_t* pixels, size_t count, const uint8_t lut[3][16],
+                  uint8_t* plane0, uint8_t* plane1, uint8_t* plane2);
+
+#endif /* HOST_VIDEO_H */
@@ -0,0 +1,135 @@
+/* watch.c - Spectator for the shared-memory feed */
+/* Maps a feed read-only, follows it at a fixed polling interval */
+/* and reports how many published frames it saw or missed.        */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "spectate.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void draw_frame(const spectate_frame_t* f)
+{
+    static const char cells[] = ".OITSZJL";
+    uint8_t x, y;
+
+    printf("game %u frame %u  score %u  level %u  next %u%s\n", f->game + 1, f->frame, f->score, f->level,
+           f->next_piece, f->game_over ? "  GAME OVER" : "");
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        putchar('|');
+        for (x = 0; x < PLAYFIELD_WIDTH; x++)
+            putchar(cells[f->playfield[y][x] & 7]);
+        printf("|\n");
+    }
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_watch [options]\n");
+    printf("  -n NAME     shared memory name (default %s)\n", SPECTATE_DEFAULT_NAME);
+    printf("  -i US       polling interval in microseconds, 0 to spin (default 1000)\n");
+    printf("  -d SECONDS  stop after this long (default: when the writer closes)\n");
+    printf("  -v          draw the board once per second\n");
+}
+
+int main(int argc, char** argv)
+{
+    const spectate_shm_t* shm;
+    spectate_frame_t frame;
+    struct timespec pause;
+    const char* name = SPECTATE_DEFAULT_NAME;
+    uint64_t seen = 0, dropped = 0, retries = 0, incremental = 0, rows = 0, reads = 0;
+    uint64_t start, deadline = 0, next_draw;
+    uint32_t interval_us = 1000, last = 0, y;
+    uint8_t verbose = 0, have_previous = 0, incremental_read;
+    double elapsed;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!strcmp(argv[i], "-v")) {
+            verbose = 1;
+            continue;
+        }
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 'n': name = value; break;
+        case 'i': interval_us = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'd': deadline = strtoull(value, NULL, 0) * 1000000000ull; break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+
+    shm = spectate_attach(name);
+    if (!shm) {
+        fprintf(stderr, "watch: no feed %s for a %dx%d playfield\n", name, PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT);
+        return 1;
+    }
+
+    memset(&frame, 0, sizeof(frame));
+    pause.tv_sec = interval_us / 1000000;
+    pause.tv_nsec = (long)(interval_us % 1000000) * 1000;
+    start = now_ns();
+    next_draw = start;
+    if (deadline)
+        deadline += start;
+
+    while (!deadline || now_ns() < deadline) {
+        uint8_t alive = atomic_load_explicit((_Atomic uint32_t*)&shm->writer_alive, memory_order_acquire) != 0;
+
+        incremental_read = have_previous;
+        retries += spectate_read(shm, &frame, have_previous);
+        reads++;
+
+        if (frame.frame != last) {
+            // A frame right after the previous one only needed its dirty rows
+            if (incremental_read && frame.frame == last + 1) {
+                incremental++;
+                for (y = 0; y < PLAYFIELD_HEIGHT; y++)
+                    rows += (frame.dirty_rows >> y) & 1;
+            }
+            if (have_previous && frame.frame > last + 1)
+                dropped += frame.frame - last - 1;
+            seen++;
+            last = frame.frame;
+            have_previous = 1;
+        }
+
+        if (verbose && now_ns() >= next_draw) {
+            draw_frame(&frame);
+            next_draw += 1000000000u;
+        }
+        if (!alive)
+            break;
+        if (interval_us)
+            nanosleep(&pause, NULL);
+    }
+    elapsed = (now_ns() - start) * 1e-9;
+
+    if (verbose)
+        draw_frame(&frame);
+    printf("watched %.1fs: %llu frames seen, %llu dropped (%.1f%%), %llu polls, %llu torn reads retried\n", elapsed,
+           (unsigned long long)seen, (unsigned long long)dropped,
+           seen + dropped ? 100.0 * dropped / (seen + dropped) : 0.0, (unsigned long long)reads,
+           (unsigned long long)retries);
+    printf("incremental copies: %llu of %llu frames, %.1f rows per frame\n", (unsigned long long)incremental,
+           (unsigned long long)seen, incremental ? (double)rows / incremental : 0.0);
+
+    spectate_detach(shm);
+    return 0;
+}
@@ -0,0 +1,242 @@
+/* work_steal.c - Work-stealing thread pool for the host tools */
+
+#include <stdlib.h>
+#include <sched.h>
+
+#include "work_steal.h"
+
+/************************************************************/
+/* Chase-Lev deque                                          */
+/************************************************************/
+
+static void deque_init(ws_deque_t* d, int32_t capacity)
+{
+    int64_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    d->buffer = calloc((size_t)size, sizeof(*d->buffer));
+    d->mask = size - 1;
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+}
+
+// Owner only
+static void deque_push(ws_deque_t* d, int32_t job)
+{
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    atomic_store_explicit(&d->buffer[b & d->mask], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+}
+
+// Owner only
+static int32_t deque_pop(ws_deque_t* d)
+{
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    int64_t t;
+    int32_t job;
+
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {
+        // Already empty
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return WS_EMPTY;
+    }
+
+    job = atomic_load_explicit(&d->buffer[b & d->mask], memory_order_relaxed);
+    if (t == b) {
+        // Last job: race against thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                memory_order_seq_cst, memory_order_relaxed))
+            job = WS_EMPTY;
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+// Any thread
+static int32_t deque_steal(ws_deque_t* d)
+{
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    int64_t b;
+    int32_t job;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b)
+        return WS_EMPTY;
+
+    job = atomic_load_explicit(&d->buffer[t & d->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+            memory_order_seq_cst, memory_order_relaxed))
+        return WS_EMPTY;
+    return job;
+}
+
+/************************************************************/
+/* Pool                                                     */
+/************************************************************/
+
+static void pool_work(ws_pool_t* pool, int worker)
+{
+    ws_deque_t* own = &pool->deques[worker];
+    int32_t job;
+    int i;
+
+    while (atomic_load_explicit(&pool->remaining, memory_order_acquire) > 0) {
+        job = deque_pop(own);
+
+        // Own deque is dry, try the other workers in turn
+        for (i = 1; job == WS_EMPTY && i < pool->nthreads; i++) {
+            job = deque_steal(&pool->deques[(worker + i) % pool->nthreads]);
+            if (job != WS_EMPTY)
+                atomic_fetch_add_explicit(&pool->steals, 1, memory_order_relaxed);
+        }
+
+        if (job == WS_EMPTY) {
+            sched_yield();
+            continue;
+        }
+
+        pool->fn(pool->ctx, job, worker);
+        atomic_fetch_sub_explicit(&pool->remaining, 1, memory_order_release);
+    }
+}
+
+struct worker_arg {
+    ws_pool_t* pool;
+    int worker;
+};
+
+static void* pool_thread(void* arg)
+{
+    struct worker_arg* wa = arg;
+    ws_pool_t* pool = wa->pool;
+    int worker = wa->worker;
+    uint32_t seen = 0;
+
+    free(wa);
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->quit && pool->generation == seen)
+            pthread_cond_wait(&pool->start_cv, &pool->lock);
+        if (pool->quit) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool_work(pool, worker);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->done_cv);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+ws_pool_t* ws_pool_create(int nthreads, int32_t max_jobs)
+{
+    ws_pool_t* pool;
+    int i;
+
+    if (nthreads < 1)
+        nthreads = 1;
+
+    pool = calloc(1, sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    pool->nthreads = nthreads;
+    pool->max_jobs = max_jobs;
+    pool->threads = calloc((size_t)nthreads, sizeof(*pool->threads));
+    pool->deques = calloc((size_t)nthreads, sizeof(*pool->deques));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start_cv, NULL);
+    pthread_cond_init(&pool->done_cv, NULL);
+    atomic_init(&pool->remaining, 0);
+    atomic_init(&pool->steals, 0);
+
+    for (i = 0; i < nthreads; i++)
+        deque_init(&pool->deques[i], max_jobs);
+
+    // Worker 0 is the thread calling ws_pool_run
+    for (i = 1; i < nthreads; i++) {
+        struct worker_arg* wa = malloc(sizeof(*wa));
+        wa->pool = pool;
+        wa->worker = i;
+        pthread_create(&pool->threads[i], NULL, pool_thread, wa);
+    }
+
+    return pool;
+}
+
+void ws_pool_destroy(ws_pool_t* pool)
+{
+    int i;
+
+    if (!pool)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->start_cv);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 1; i < pool->nthreads; i++)
+        pthread_join(pool->threads[i], NULL);
+    for (i = 0; i < pool->nthreads; i++)
+        free(pool->deques[i].buffer);
+
+    pthread_cond_destroy(&pool->done_cv);
+    pthread_cond_destroy(&pool->start_cv);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->deques);
+    free(pool->threads);
+    free(pool);
+}
+
+int ws_pool_run(ws_pool_t* pool, int32_t njobs, ws_job_fn fn, void* ctx)
+{
+    int32_t j;
+    int i;
+
+    if (njobs <= 0)
+        return 0;
+    // deque_push wraps around: past its capacity it would overwrite jobs
+    if ((njobs + pool->nthreads - 1) / pool->nthreads > pool->max_jobs)
+        return -1;
+
+    // Deal jobs round-robin; helpers are parked so the deques are ours
+    for (i = 0; i < pool->nthreads; i++) {
+        atomic_store_explicit(&pool->deques[i].top, 0, memory_order_relaxed);
+        atomic_store_explicit(&pool->deques[i].bottom, 0, memory_order_relaxed);
+    }
+    for (j = 0; j < njobs; j++)
+        deque_push(&pool->deques[j % pool->nthreads], j);
+
+    pool->fn = fn;
+    pool->ctx = ctx;
+    atomic_store_explicit(&pool->remaining, njobs, memory_order_release);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->running = pool->nthreads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start_cv);
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_work(pool, 0);
+
+    // Wait for helpers to leave pool_work before the deques are reused
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0)
+        pthread_cond_wait(&pool->done_cv, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
@@ -0,0 +1,52 @@
+/* work_steal.h - Work-stealing thread pool for the host tools */
+/* Jobs are plain integer indices. Each worker owns a Chase-Lev */
+/* deque; idle workers steal from the top of the others.        */
+
+#ifndef HOST_WORK_STEAL_H
+#define HOST_WORK_STEAL_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define WS_EMPTY (-1)
+
+/* Fixed-capacity Chase-Lev deque (capacity is a power of two) */
+typedef struct ws_deque_t {
+    _Atomic int64_t top;
+    _Atomic int64_t bottom;
+    _Atomic int32_t* buffer;
+    int64_t mask;
+} ws_deque_t;
+
+/* Job callback: ctx is shared, worker is the calling worker index */
+typedef void (*ws_job_fn)(void* ctx, int32_t job, int worker);
+
+typedef struct ws_pool_t {
+    int nthreads;                /* Workers including the calling thread */
+    int32_t max_jobs;            /* Jobs one deque can hold */
+    pthread_t* threads;
+    ws_deque_t* deques;
+    pthread_mutex_t lock;
+    pthread_cond_t start_cv;
+    pthread_cond_t done_cv;
+    uint32_t generation;         /* Bumped once per ws_pool_run */
+    int running;                 /* Helper threads still in the current run */
+    int quit;
+    _Atomic int32_t remaining;   /* Jobs not yet completed */
+    _Atomic uint64_t steals;     /* Successful steals since creation */
+    ws_job_fn fn;
+    void* ctx;
+} ws_pool_t;
+
+/* Create a pool of nthreads workers able to hold max_jobs per run */
+ws_pool_t* ws_pool_create(int nthreads, int32_t max_jobs);
+void ws_pool_destroy(ws_pool_t* pool);
+
+/* Run jobs 0..njobs-1 across the pool, return 0 when all are done.
+ * Jobs are dealt round-robin, so a job's result must only depend on
+ * its index for the outcome to be deterministic. Returns -1 without
+ * running any job if a deque would get more than max_jobs of them. */
+int ws_pool_run(ws_pool_t* pool, int32_t njobs, ws_job_fn fn, void* ctx);
+
+#endif /* HOST_WORK_STEAL_H */
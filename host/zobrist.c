@@ -0,0 +1,148 @@
+/* zobrist.c - Incremental 64-bit Zobrist hashing of game_state_t */
+
+#include <string.h>
+
+#include "zobrist.h"
+
+static uint64_t cell_keys[PLAYFIELD_WIDTH][8];   /* [x][content], content 0 hashes to 0 */
+static uint64_t piece_keys[NB_PIECES];
+static uint64_t next_keys[NB_PIECES];
+static uint64_t rotation_keys[4];
+
+static uint64_t splitmix64(uint64_t* s)
+{
+    uint64_t z = (*s += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Fixed keys, so hashes are stable between runs and machines
+__attribute__((constructor))
+static void zobrist_init_keys(void)
+{
+    uint64_t s = 0x7E7121CEull;
+    uint8_t x, c;
+
+    for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+        cell_keys[x][CELL_EMPTY] = 0;
+        for (c = CELL_PIECE_1; c < 8; c++)
+            cell_keys[x][c] = splitmix64(&s);
+    }
+    for (c = 0; c < NB_PIECES; c++) {
+        piece_keys[c] = splitmix64(&s);
+        next_keys[c] = splitmix64(&s);
+    }
+    for (c = 0; c < 4; c++)
+        rotation_keys[c] = splitmix64(&s);
+}
+
+static inline uint64_t rotl64(uint64_t v, uint8_t n)
+{
+    return n ? (v << n) | (v >> (64 - n)) : v;
+}
+
+static uint64_t pieces_hash(uint8_t piece, uint8_t next_piece, uint8_t rotation)
+{
+    return piece_keys[piece % NB_PIECES] ^ next_keys[next_piece % NB_PIECES] ^ rotation_keys[rotation & 3];
+}
+
+/************************************************************/
+/* Full computation                                         */
+/************************************************************/
+
+void zobrist_reset(zobrist_t* z, const game_state_t* state)
+{
+    uint8_t x, y, content;
+
+    z->board = 0;
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        z->rows[y] = 0;
+        z->counts[y] = 0;
+        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+            content = GET_CELL_CONTENT(state->playfield[y][x]);
+            z->rows[y] ^= cell_keys[x][content];
+            z->counts[y] += (content != CELL_EMPTY);
+        }
+        z->board ^= rotl64(z->rows[y], y);
+    }
+    z->pieces = pieces_hash(state->piece, state->next_piece, state->rotation);
+}
+
+uint64_t zobrist_compute(const game_state_t* state)
+{
+    zobrist_t z;
+
+    zobrist_reset(&z, state);
+    return zobrist_hash(&z);
+}
+
+/************************************************************/
+/* Incremental updates                                      */
+/************************************************************/
+
+static void update_cells(zobrist_t* z, game_state_t* state, uint8_t piece, uint8_t x, uint8_t y,
+                         uint8_t rotation, uint8_t content)
+{
+    packed_tetromino* tetromino = GET_TETROMINO(piece, rotation);
+    uint8_t i, px, py, old;
+    uint64_t delta;
+
+    for (i = 0; i < 4; i++) {
+        px = x + GET_BLOCK_X((*tetromino)[i]);
+        py = y + GET_BLOCK_Y((*tetromino)[i]);
+        if (px >= PLAYFIELD_WIDTH || py >= PLAYFIELD_HEIGHT)
+            continue;   // playfield_set_cell ignores it too
+
+        old = GET_CELL_CONTENT(state->playfield[py][px]);
+        delta = cell_keys[px][old] ^ cell_keys[px][content];
+        z->rows[py] ^= delta;
+        z->board ^= rotl64(delta, py);
+        z->counts[py] += (content != CELL_EMPTY) - (old != CELL_EMPTY);
+    }
+}
+
+void zobrist_place_piece(zobrist_t* z, game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation)
+{
+    update_cells(z, state, piece, x, y, rotation, CELL_PIECE_1 + piece);
+    playfield_place_piece(state, piece, x, y, rotation);
+}
+
+void zobrist_remove_piece(zobrist_t* z, game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation)
+{
+    update_cells(z, state, piece, x, y, rotation, CELL_EMPTY);
+    playfield_remove_piece(state, piece, x, y, rotation);
+}
+
+uint8_t zobrist_check_full_lines(zobrist_t* z, game_state_t* state)
+{
+    uint64_t band;
+    uint8_t y, above;
+
+    // Same top-down order as check_full_lines
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        if (z->counts[y] != PLAYFIELD_WIDTH)
+            continue;
+
+        // Rows above y move down one line: their contribution rotates by one
+        band = 0;
+        for (above = 0; above < y; above++)
+            band ^= rotl64(z->rows[above], above);
+        z->board ^= rotl64(z->rows[y], y) ^ band ^ rotl64(band, 1);
+
+        memmove(&z->rows[1], &z->rows[0], y * sizeof(z->rows[0]));
+        memmove(&z->counts[1], &z->counts[0], y * sizeof(z->counts[0]));
+        z->rows[0] = 0;
+        z->counts[0] = 0;
+    }
+
+    return check_full_lines(state);
+}
+
+void zobrist_set_pieces(zobrist_t* z, game_state_t* state, uint8_t piece, uint8_t next_piece, uint8_t rotation)
+{
+    state->piece = piece;
+    state->next_piece = next_piece;
+    state->rotation = rotation;
+    z->pieces = pieces_hash(piece, next_piece, rotation);
+}
@@ -0,0 +1,36 @@
+/* zobrist.h - Incremental 64-bit Zobrist hashing of game_state_t */
+/* Cell (x, y, content) hashes to rotl(K[x][content], y), so a row  */
+/* moving down one line just rotates its contribution: line clears */
+/* update the hash from per-row hashes instead of rehashing cells.  */
+
+#ifndef HOST_ZOBRIST_H
+#define HOST_ZOBRIST_H
+
+#include <stdint.h>
+
+#include "engine.h"
+
+typedef struct zobrist_t {
+    uint64_t board;                     /* Playfield cells */
+    uint64_t pieces;                    /* piece, next_piece and rotation */
+    uint64_t rows[PLAYFIELD_HEIGHT];    /* Unrotated XOR of each row's cell keys */
+    uint8_t counts[PLAYFIELD_HEIGHT];   /* Filled cells per row */
+} zobrist_t;
+
+/* Full hash of a position */
+static inline uint64_t zobrist_hash(const zobrist_t* z)
+{
+    return z->board ^ z->pieces;
+}
+
+/* Hash a state from scratch, for start positions and verification */
+void zobrist_reset(zobrist_t* z, const game_state_t* state);
+uint64_t zobrist_compute(const game_state_t* state);
+
+/* Engine operations that keep z in step with state */
+void zobrist_place_piece(zobrist_t* z, game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation);
+void zobrist_remove_piece(zobrist_t* z, game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation);
+uint8_t zobrist_check_full_lines(zobrist_t* z, game_state_t* state);
+void zobrist_set_pieces(zobrist_t* z, game_state_t* state, uint8_t piece, uint8_t next_piece, uint8_t rotation);
+
+#endif /* HOST_ZOBRIST_H */
@@ -0,0 +1,394 @@
+/* zx0.c - ZX0 compressor and decompressor */
+/* The decoder follows the reference one by Einar Saukas, with bounds */
+/* checks. The encoder is a shortest-path parse over the bit costs of */
+/* the format, taking for each match length the nearest offset.       */
+
+#include <stdlib.h>
+
+#include "zx0.h"
+
+#define ZX0_MAX_OFFSET 32640        /* Offset MSB 255, 256 ends the stream */
+#define ZX0_MAX_CHAIN 1024          /* Earlier positions tried per position */
+#define ZX0_MAX_LITERALS 1024       /* Longest literal run considered */
+#define ZX0_LONG_MATCH 256          /* Past this length only the full match is tried */
+#define ZX0_INFINITE 0xFFFFFFFFu
+
+typedef struct zx0_reader_t {
+    const uint8_t* in;
+    size_t size;
+    size_t pos;
+    uint8_t last_byte;
+    uint8_t bit_mask;
+    uint8_t bit_value;
+    uint8_t backtrack;          /* Next bit is the low bit of the last byte */
+    uint8_t error;
+} zx0_reader_t;
+
+static uint8_t read_byte(zx0_reader_t* r)
+{
+    if (r->pos >= r->size) {
+        r->error = 1;
+        return 0;
+    }
+    r->last_byte = r->in[r->pos++];
+    return r->last_byte;
+}
+
+static uint8_t read_bit(zx0_reader_t* r)
+{
+    if (r->backtrack) {
+        r->backtrack = 0;
+        return r->last_byte & 1;
+    }
+    r->bit_mask >>= 1;
+    if (r->bit_mask == 0) {
+        r->bit_mask = 0x80;
+        r->bit_value = read_byte(r);
+    }
+    return (r->bit_value & r->bit_mask) ? 1 : 0;
+}
+
+// Interlaced Elias gamma, the offset MSB is stored inverted
+static uint32_t read_elias(zx0_reader_t* r, uint8_t inverted)
+{
+    uint32_t value = 1;
+
+    while (!read_bit(r) && !r->error) {
+        value = (value << 1) | (read_bit(r) ^ inverted);
+        if (value > 0xFFFFFF)
+            r->error = 1;
+    }
+    return value;
+}
+
+// The output may run ahead of the stream by written - r.pos
+#define ZX0_AHEAD() \
+    do { \
+        if ((long)written - (long)r.pos > worst) \
+            worst = (long)written - (long)r.pos; \
+    } while (0)
+
+long zx0_decompress_ahead(const uint8_t* in, size_t in_size, uint8_t* out, size_t capacity, long* ahead)
+{
+    zx0_reader_t r;
+    size_t written = 0;
+    uint32_t offset = 1, length, i;
+    long worst = 0;
+
+    r.in = in;
+    r.size = in_size;
+    r.pos = 0;
+    r.last_byte = 0;
+    r.bit_mask = 0;
+    r.bit_value = 0;
+    r.backtrack = 0;
+    r.error = 0;
+
+    while (1) {
+        // Literals
+        length = read_elias(&r, 0);
+        if (r.error || length > capacity - written)
+            return -1;
+        for (i = 0; i < length; i++) {
+            out[written++] = read_byte(&r);
+            ZX0_AHEAD();
+        }
+
+        if (!read_bit(&r)) {
+            // Copy from the last offset
+            length = read_elias(&r, 0);
+            if (r.error || offset > written || length > capacity - written)
+                return -1;
+            for (i = 0; i < length; i++, written++)
+                out[written] = out[written - offset];
+            ZX0_AHEAD();
+            if (!read_bit(&r))
+                continue;
+        }
+
+        // Copy from new offsets until the next literals
+        do {
+            offset = read_elias(&r, 1);
+            if (offset == 256) {
+                *ahead = worst;
+                return r.error ? -1 : (long)written;
+            }
+            offset = offset * 128 - (read_byte(&r) >> 1);
+            r.backtrack = 1;
+            length = read_elias(&r, 0) + 1;
+            if (r.error || offset == 0 || offset > written || length > capacity - written)
+                return -1;
+            for (i = 0; i < length; i++, written++)
+                out[written] = out[written - offset];
+            ZX0_AHEAD();
+        } while (read_bit(&r));
+    }
+}
+
+long zx0_decompress(const uint8_t* in, size_t in_size, uint8_t* out, size_t capacity)
+{
+    long ahead;
+
+    return zx0_decompress_ahead(in, in_size, out, capacity, &ahead);
+}
+
+/************************************************************/
+/* Compressor                                               */
+/************************************************************/
+
+enum { ZX0_LITERALS, ZX0_REPEAT, ZX0_NEW_OFFSET };
+
+// Cheapest way found to encode the input up to a position, ending
+// with a literal run or with a match
+typedef struct zx0_node_t {
+    uint32_t literal_cost;
+    uint32_t literal_from;          /* Start of the run */
+    uint32_t match_cost;
+    uint32_t match_from;
+    uint16_t literal_offset;        /* Offset a repeat match would reuse */
+    uint16_t match_offset;
+    uint8_t match_kind;
+    uint8_t match_after_literals;   /* Else after another match */
+} zx0_node_t;
+
+typedef struct zx0_block_t {
+    uint8_t kind;
+    uint32_t start;
+    uint32_t length;
+    uint16_t offset;
+} zx0_block_t;
+
+typedef struct zx0_writer_t {
+    uint8_t* out;
+    size_t capacity;
+    size_t pos;
+    size_t bit_index;
+    uint8_t bit_mask;
+    uint8_t backtrack;              /* Next bit is the low bit of the last byte */
+    uint8_t error;
+} zx0_writer_t;
+
+static uint32_t elias_bits(uint32_t value)
+{
+    uint32_t bits = 1;
+
+    while (value > 1) {
+        bits += 2;
+        value >>= 1;
+    }
+    return bits;
+}
+
+static void write_byte(zx0_writer_t* w, uint8_t value)
+{
+    if (w->pos >= w->capacity) {
+        w->error = 1;
+        return;
+    }
+    w->out[w->pos++] = value;
+}
+
+static void write_bit(zx0_writer_t* w, uint8_t bit)
+{
+    if (w->backtrack) {
+        if (bit && w->pos > 0)
+            w->out[w->pos - 1] |= 1;
+        w->backtrack = 0;
+        return;
+    }
+    if (!w->bit_mask) {
+        w->bit_mask = 0x80;
+        w->bit_index = w->pos;
+        write_byte(w, 0);
+    }
+    if (bit && !w->error)
+        w->out[w->bit_index] |= w->bit_mask;
+    w->bit_mask >>= 1;
+}
+
+static void write_elias(zx0_writer_t* w, uint32_t value, uint8_t inverted)
+{
+    uint32_t bit = 1;
+
+    while (bit <= value >> 1)
+        bit <<= 1;
+    while (bit >>= 1) {
+        write_bit(w, 0);
+        write_bit(w, ((value & bit) != 0) ^ inverted);
+    }
+    write_bit(w, 1);
+}
+
+static uint32_t match_length(const uint8_t* in, size_t size, size_t pos, size_t offset)
+{
+    size_t length = 0;
+
+    while (pos + length < size && in[pos + length] == in[pos + length - offset])
+        length++;
+    return (uint32_t)length;
+}
+
+static void relax_match(zx0_node_t* node, uint32_t cost, uint32_t from, uint16_t offset, uint8_t kind,
+                        uint8_t after_literals)
+{
+    if (cost < node->match_cost) {
+        node->match_cost = cost;
+        node->match_from = from;
+        node->match_offset = offset;
+        node->match_kind = kind;
+        node->match_after_literals = after_literals;
+    }
+}
+
+// Bit costs of the forward parse, ending with literals or a match at
+// each position
+static void parse(const uint8_t* in, size_t size, zx0_node_t* nodes, int32_t* head, int32_t* chain)
+{
+    size_t i, j;
+    uint32_t l, hash;
+
+    for (i = 0; i <= size; i++)
+        nodes[i].literal_cost = nodes[i].match_cost = ZX0_INFINITE;
+
+    for (i = 0; i <= size; i++) {
+        zx0_node_t* node = &nodes[i];
+
+        // Literal runs ending here, the first one has no indicator bit
+        for (j = i; j-- > 0 && i - j <= ZX0_MAX_LITERALS;) {
+            uint32_t length = (uint32_t)(i - j), cost;
+
+            if (j == 0)
+                cost = elias_bits(length) + 8 * length;
+            else if (nodes[j].match_cost != ZX0_INFINITE)
+                cost = nodes[j].match_cost + 1 + elias_bits(length) + 8 * length;
+            else
+                continue;
+            if (cost < node->literal_cost) {
+                node->literal_cost = cost;
+                node->literal_from = (uint32_t)j;
+                node->literal_offset = j == 0 ? 1 : nodes[j].match_offset;
+            }
+        }
+        if (i + 1 >= size)
+            continue;
+
+        // Matches starting here: the last offset after literals...
+        if (i > 0 && node->literal_cost != ZX0_INFINITE && node->literal_offset <= i) {
+            uint32_t length = match_length(in, size, i, node->literal_offset);
+
+            for (l = 1; l <= length; l = l < ZX0_LONG_MATCH || l == length ? l + 1 : length)
+                relax_match(&nodes[i + l], node->literal_cost + 1 + elias_bits(l), (uint32_t)i,
+                            node->literal_offset, ZX0_REPEAT, 1);
+        }
+
+        // ...and new offsets, nearest first: a farther one only helps
+        // for lengths the nearer ones do not reach
+        hash = in[i] | in[i + 1] << 8;
+        if (i > 0 && (node->literal_cost != ZX0_INFINITE || node->match_cost != ZX0_INFINITE)) {
+            uint8_t after_literals = node->literal_cost <= node->match_cost;
+            uint32_t base = after_literals ? node->literal_cost : node->match_cost;
+            uint32_t best = 1, tries = 0;
+            int32_t p;
+
+            for (p = head[hash]; p >= 0 && tries < ZX0_MAX_CHAIN; p = chain[p], tries++) {
+                size_t offset = i - (size_t)p;
+                uint32_t length, offset_cost;
+
+                if (offset > ZX0_MAX_OFFSET)
+                    break;
+                length = match_length(in, size, i, offset);
+                if (length <= best)
+                    continue;
+                offset_cost = base + 1 + elias_bits((uint32_t)((offset - 1) / 128 + 1)) + 7;
+                for (l = best + 1; l <= length; l = l < ZX0_LONG_MATCH || l == length ? l + 1 : length)
+                    relax_match(&nodes[i + l], offset_cost + elias_bits(l - 1), (uint32_t)i, (uint16_t)offset,
+                                ZX0_NEW_OFFSET, after_literals);
+                best = length;
+                if (best >= ZX0_LONG_MATCH)
+                    break;
+            }
+        }
+        chain[i] = head[hash];
+        head[hash] = (int32_t)i;
+    }
+}
+
+long zx0_compress(const uint8_t* in, size_t size, uint8_t* out, size_t capacity)
+{
+    zx0_node_t* nodes;
+    zx0_block_t* blocks;
+    int32_t *head, *chain;
+    zx0_writer_t w = { out, capacity, 0, 0, 0, 0, 0 };
+    size_t count = 0, pos, b, i;
+    uint8_t literals;
+
+    if (size == 0)
+        return -1;
+    nodes = malloc((size + 1) * sizeof(*nodes));
+    blocks = malloc(size * sizeof(*blocks));
+    head = malloc(65536 * sizeof(*head));
+    chain = malloc(size * sizeof(*chain));
+    if (!nodes || !blocks || !head || !chain) {
+        free(nodes);
+        free(blocks);
+        free(head);
+        free(chain);
+        return -1;
+    }
+    for (i = 0; i < 65536; i++)
+        head[i] = -1;
+    parse(in, size, nodes, head, chain);
+
+    // Back from the end, alternating literal runs and matches
+    pos = size;
+    literals = nodes[size].literal_cost <= nodes[size].match_cost;
+    while (pos > 0) {
+        zx0_block_t* block = &blocks[count++];
+
+        if (literals) {
+            block->kind = ZX0_LITERALS;
+            block->start = nodes[pos].literal_from;
+            literals = 0;
+        } else {
+            block->kind = nodes[pos].match_kind;
+            block->start = nodes[pos].match_from;
+            block->offset = nodes[pos].match_offset;
+            literals = nodes[pos].match_after_literals;
+        }
+        block->length = (uint32_t)pos - block->start;
+        pos = block->start;
+    }
+
+    for (b = count; b-- > 0;) {
+        zx0_block_t* block = &blocks[b];
+
+        switch (block->kind) {
+        case ZX0_LITERALS:
+            if (b != count - 1)
+                write_bit(&w, 0);
+            write_elias(&w, block->length, 0);
+            for (i = 0; i < block->length; i++)
+                write_byte(&w, in[block->start + i]);
+            break;
+        case ZX0_REPEAT:
+            write_bit(&w, 0);
+            write_elias(&w, block->length, 0);
+            break;
+        default:
+            write_bit(&w, 1);
+            write_elias(&w, (block->offset - 1) / 128 + 1, 1);
+            write_byte(&w, (uint8_t)((127 - ((block->offset - 1) & 127)) << 1));
+            w.backtrack = 1;
+            write_elias(&w, block->length - 1, 0);
+            break;
+        }
+    }
+    write_bit(&w, 1);
+    write_elias(&w, 256, 1);
+
+    free(nodes);
+    free(blocks);
+    free(head);
+    free(chain);
+    return w.error ? -1 : (long)w.pos;
+}
@@ -0,0 +1,25 @@
+/* zx0.h - ZX0 compressor and decompressor                       */
+/* The format of the PHC-25 UI assets and of the packed Alice     */
+/* tape image: same stream as dzx0_standard in phc25_lib.asm and  */
+/* alice_unzx0.s (ZX0 v2, forward).                               */
+
+#ifndef HOST_ZX0_H
+#define HOST_ZX0_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Decompress into out, returns the decompressed size or -1 if the
+ * stream is corrupt or does not fit in capacity */
+long zx0_decompress(const uint8_t* in, size_t in_size, uint8_t* out, size_t capacity);
+
+/* Same, and *ahead is the most the output ran ahead of the stream
+ * (bytes written minus bytes read): decompressed in place, the
+ * stream must start at least that far past the start of the output */
+long zx0_decompress_ahead(const uint8_t* in, size_t in_size, uint8_t* out, size_t capacity, long* ahead);
+
+/* Compress size bytes (at least 1) into out, returns the compressed
+ * size or -1 if it does not fit in capacity or memory runs out */
+long zx0_compress(const uint8_t* in, size_t size, uint8_t* out, size_t capacity);
+
+#endif /* HOST_ZX0_H */
@@ -0,0 +1,46 @@
+#ifndef HUD_H
+#define HUD_H
+
+/************************************************************/
+/* Frame HUD (build with -DHUD)                             */
+/* After each gameloop frame, a screen corner outside the   */
+/* playfield shows what that frame cost: its time when the  */
+/* platform has a clock (HUD_CLOCK), the dirty cells        */
+/* redrawn and the video memory bytes written. Values are   */
+/* in hex and only the digits that changed are redrawn.     */
+/* Without HUD every macro is empty.                        */
+/************************************************************/
+
+#ifdef HUD
+
+#include <stdint.h>
+
+/* Counts of the frame in progress, in tetrice.c */
+extern uint16_t hud_cells;
+extern uint16_t hud_bytes;
+
+/* Draws the counts; the HUD's own drawing is not counted */
+void display_hud(uint16_t time, uint16_t cells, uint16_t bytes);
+
+#ifdef HUD_CLOCK
+extern uint16_t hud_start;
+#define HUD_FRAME_BEGIN() (hud_start = HUD_CLOCK(), hud_cells = 0, hud_bytes = 0)
+#define HUD_FRAME_END() display_hud(HUD_CLOCK() - hud_start, hud_cells, hud_bytes)
+#else
+#define HUD_FRAME_BEGIN() (hud_cells = 0, hud_bytes = 0)
+#define HUD_FRAME_END() display_hud(0, hud_cells, hud_bytes)
+#endif
+
+#define HUD_CELL() (hud_cells++)
+#define HUD_BYTES(count) (hud_bytes += (count))
+
+#else
+
+#define HUD_FRAME_BEGIN()
+#define HUD_FRAME_END()
+#define HUD_CELL()
+#define HUD_BYTES(count)
+
+#endif // HUD
+
+#endif // HUD_H
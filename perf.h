@@ -0,0 +1,91 @@
+#ifndef PERF_H
+#define PERF_H
+
+/************************************************************/
+/* Frame counters (build with -DPERF)                       */
+/* Each gameloop frame stores how long its input, logic and */
+/* render phases took, in PERF_CLOCK units, in a ring at    */
+/* the fixed address PERF_RING_ADDR, where a debugger or a  */
+/* memory dump reads it back (tools/perf_ring.py). Without  */
+/* PERF every macro is empty and nothing is compiled in.    */
+/*                                                          */
+/* Ring layout, 16-bit fields in the CPU's byte order:      */
+/*   +0  "PERF"                                             */
+/*   +4  version, slot count                                */
+/*   +6  head: next slot written, wraps at 256              */
+/*   +7  tail: oldest unread slot; a reader that keeps up   */
+/*       advances it, otherwise the writer does when full   */
+/*   +8  frames recorded, wraps at 65536                    */
+/*   +10 frames whose logic + render went over the budget   */
+/*   +12 frames pushed out of the ring before being read    */
+/*   +14 budget: PERF_BUDGET at start, a debugger may poke  */
+/*   +16 slots: input, logic, render                        */
+/* Render time is the per-frame hooks: sync_playfield,      */
+/* sync_ui and preview_piece.                               */
+/************************************************************/
+
+#ifdef PERF
+
+#include <stdint.h>
+
+#if !defined(PERF_CLOCK) || !defined(PERF_RING_ADDR)
+#error "PERF needs PERF_CLOCK and PERF_RING_ADDR from the platform header"
+#endif
+
+#define PERF_VERSION 1
+#define PERF_SLOTS 32               /* Power of two, at most 128 */
+
+/* Logic and render time allowed per frame, in clock units */
+#ifndef PERF_BUDGET
+#define PERF_BUDGET 17898           /* 1/50 s of the Alice E clock */
+#endif
+
+typedef struct perf_slot_t {
+    uint16_t input;                 /* Includes waiting for a key, wraps */
+    uint16_t logic;
+    uint16_t render;
+} perf_slot_t;
+
+typedef struct perf_ring_t {
+    char magic[4];
+    uint8_t version;
+    uint8_t slots;
+    uint8_t head;
+    uint8_t tail;
+    uint16_t frames;
+    uint16_t over_budget;
+    uint16_t overwritten;
+    uint16_t budget;
+    perf_slot_t slot[PERF_SLOTS];
+} perf_ring_t;
+
+#define PERF_RING ((perf_ring_t*)(PERF_RING_ADDR))
+
+/* Clock readings of the frame in progress, in tetrice.c */
+extern uint16_t perf_frame_start;
+extern uint16_t perf_input_end;
+extern uint16_t perf_render_start;
+extern uint16_t perf_render;
+
+void perf_init(void);
+void perf_frame_end(void);
+
+#define PERF_INIT() perf_init()
+#define PERF_FRAME_BEGIN() (perf_frame_start = PERF_CLOCK(), perf_render = 0)
+#define PERF_INPUT_END() (perf_input_end = PERF_CLOCK())
+#define PERF_RENDER_BEGIN() (perf_render_start = PERF_CLOCK())
+#define PERF_RENDER_END() (perf_render += PERF_CLOCK() - perf_render_start)
+#define PERF_FRAME_END() perf_frame_end()
+
+#else
+
+#define PERF_INIT()
+#define PERF_FRAME_BEGIN()
+#define PERF_INPUT_END()
+#define PERF_RENDER_BEGIN()
+#define PERF_RENDER_END()
+#define PERF_FRAME_END()
+
+#endif // PERF
+
+#endif // PERF_H
@@ -8,14 +8,33 @@
 /* Based on successful POC using Mode 12 (256x192 mono)    */
 /************************************************************/
 
-/* Memory access macros */
+/* Memory access macros, counted by the host mock in TEST_MODE */
+#ifdef TEST_MODE
+#include "tests/test_mock.h"
+#else
 #define POKE(addr, value) (*((volatile uint8_t *)(addr)) = (value))
 #define PEEK(addr) (*((volatile uint8_t *)(addr)))
+#endif
 
 /* PHC-25 Hardware Definitions */
 #define VRAM_START  0x6000    /* Screen page 1 start address */
-#define VRAM2_START 0xE000   /* Screen page 2 start address */
+#define PHC25_SCRATCH_ADDR 0xE000 /* Screen page 2, where bitmaps narrower than the screen are decompressed */
+#ifdef TEST_MODE
+#define VRAM2_START MOCK_RAM(PHC25_SCRATCH_ADDR) /* Read through a pointer */
+#else
+#define VRAM2_START PHC25_SCRATCH_ADDR
+#endif
 #define VRAM_SIZE   6144      /* 6KB video memory */
+
+/* The UI asset block, laid out by host/tetrice_pack -a (host/tape.h) */
+/* and linked into the program by phc25_lib.asm; the mock copies it  */
+/* into its RAM                                                       */
+#ifdef TEST_MODE
+#define PHC25_ASSETS_ADDR MOCK_ASSETS_ADDR
+#else
+extern const uint8_t asset_block[];
+#define PHC25_ASSETS_ADDR ((uint16_t)asset_block)
+#endif
 #define PORT_40     0x40      /* Graphics control port */
 
 /* MC6847 Mode 12 settings (256x192 monochrome) */
@@ -75,21 +94,36 @@
 #define INPUT_LATERAL_SKIP 1           /* Frames to skip for lateral movement (left/right) */
 #define INPUT_ROTATION_SKIP 2          /* Frames to skip for rotation (CW/CCW) */
 
-/* I/O port access functions for Z80 */
-void out_port(uint8_t port, uint8_t value);
-uint8_t in_port(uint8_t port);
+/* z88dk calling conventions of the assembly helpers in_port,       */
+/* out_port and decompress_asset: fastcall passes a single argument  */
+/* in HL, callee pops the arguments once in the function instead of  */
+/* after every call. The host mock keeps the standard convention.    */
+/* tools/call_cost.py models the difference.                         */
+#ifndef TEST_MODE
+#define PLATFORM_FASTCALL __z88dk_fastcall
+#define PLATFORM_CALLEE __z88dk_callee
+#else
+#define PLATFORM_FASTCALL
+#define PLATFORM_CALLEE
+#endif
+
+/* I/O port access functions for Z80, in phc25_lib.asm */
+void out_port(uint8_t port, uint8_t value) PLATFORM_CALLEE;
+uint8_t in_port(uint8_t port) PLATFORM_FASTCALL;
 
 /* Low-level graphics functions */
 void init_graphics_mode12(void);
 void clear_screen(void);
 void draw_tetris_block_pattern(uint8_t block_x, uint8_t block_y, uint8_t color);
 void erase_tetris_block(uint8_t block_x, uint8_t block_y);
-void draw_horizontal_line(uint8_t x1, uint8_t x2, uint8_t y);
-void draw_vertical_line(uint8_t x, uint8_t y1, uint8_t y2);
+
+/* UI assets, by their ASSET_ id in gfx/assets.h */
+void draw_asset(uint8_t asset, uint8_t x, uint8_t y);
 
 /* Debug functions */
 void debug_print(uint8_t x, uint8_t y, char* text);
 void debug_print_hex(uint8_t x, uint8_t y, uint8_t value);
 void debug_draw_char(uint8_t x, uint8_t y, char c);
+void debug_draw_pair(uint8_t column, uint8_t y, char left, char right);
 
 #endif // PHC25_H
@@ -1,55 +1,47 @@
 SECTION code_compiler
 
 ; -----------------------------------------------------------------------------
-; Decompress bitmaps for the UI
+; Decompress a UI bitmap
+; The streams are in the asset block below; platform_phc25.c passes
+; their address and either VRAM or the page 2 buffer
 ; -----------------------------------------------------------------------------
 
-PUBLIC _decompress_ui_left
+PUBLIC _asset_block
+PUBLIC _decompress_asset
 
-_decompress_ui_left:
-        ld hl, ui_left
-        ld de, 0xe000
-        call dzx0_standard
-        ret
-
-PUBLIC _decompress_ui_right
-
-_decompress_ui_right:
-        ld hl, ui_right
-        ld de, 0xe000
-        call dzx0_standard
-        ret
-
-PUBLIC _decompress_ui_title
-
-_decompress_ui_title:
-        ld hl, ui_title
-        ld de, 0xe000
-        call dzx0_standard
-        ret
-
-PUBLIC _decompress_ui_bottom
+; void decompress_asset(uint16_t stream, uint16_t destination) __z88dk_callee
+_decompress_asset:
+        pop bc          ; return address
+        pop de          ; destination
+        pop hl          ; stream
+        push bc
+        jp dzx0_standard
 
-_decompress_ui_bottom:
-        ld hl, ui_bottom
-        ld de, 0xe000
-        call dzx0_standard
-        ret
+; -----------------------------------------------------------------------------
+; I/O ports
+; sccz80 pushes the arguments left to right: the last one is on top
+; -----------------------------------------------------------------------------
 
-PUBLIC _decompress_splash
+PUBLIC _out_port
 
-_decompress_splash:
-        ld hl, splash
-        ld de, 0xe000
-        call dzx0_standard
+; void out_port(uint8_t port, uint8_t value) __z88dk_callee
+_out_port:
+        pop hl          ; return address
+        pop de          ; value in E
+        pop bc          ; port in C, B = 0
+        push hl
+        out (c), e
         ret
 
-PUBLIC _decompress_gameover
+PUBLIC _in_port
 
-_decompress_gameover:
-        ld hl, gameover
-        ld de, 0xe000
-        call dzx0_standard
+; uint8_t in_port(uint8_t port) __z88dk_fastcall
+; The port comes in L, the value goes back in HL
+_in_port:
+        ld c, l
+        ld b, 0
+        in l, (c)
+        ld h, b
         ret
 
 ; -----------------------------------------------------------------------------
@@ -116,23 +108,8 @@ dzx0s_elias_backtrack:
         jr      dzx0s_elias_loop
 
 ; -----------------------------------------------------------------------------
-; Compressed bitmaps
+; UI asset block: the index and the ZX0 streams, from host/tetrice_pack -a
 ; -----------------------------------------------------------------------------
 
-ui_left:
-        incbin "gfx/ui_left.bin.zx0"
-
-ui_right:
-        incbin "gfx/ui_right.bin.zx0"
-
-ui_title:
-        incbin "gfx/ui_title.bin.zx0"
-
-ui_bottom:
-        incbin "gfx/ui_bottom.bin.zx0"
-
-splash:
-        incbin "gfx/splash.bin.zx0"
-
-gameover:
-        incbin "gfx/gameover.bin.zx0"
+_asset_block:
+        incbin "gfx/assets.zx0"
@@ -0,0 +1,124 @@
+; Loader stub of the packed PHC-25 image
+;
+; tetrice.phc loads this stub at PHC25_STUB_ADDR, below the game, with
+; the ZX0 stream of the game right after it, and runs it. The stub
+; moves the stream up so that it ends a few bytes past the end of the
+; game, undoing the XOR that keeps two zero bytes in a row off the
+; tape, decompresses it forward to PHC25_ADDR (the output overwrites
+; the stream only once it has been read) and jumps to the game.
+;
+; host/tetrice_pack -p fills the header after the first jump. Same
+; layout as alice_unzx0.s; tests/tetrice_unzx0_phc25 runs this file on
+; a Z80 model against host/zx0.c.
+
+        org     $C009                   ; PHC25_STUB_ADDR in the Makefile
+
+unzx0:
+        jr      unzx0_start
+stream_size:
+        defw    0                       ; ZX0 stream size
+moved_end:
+        defw    0                       ; end of the stream once moved
+output:
+        defw    0                       ; PHC25_ADDR, the game's entry point
+mask:
+        defb    0                       ; XOR of the stream bytes on tape
+
+unzx0_start:
+        di
+        ld      a, (mask)
+        ld      (move_mask + 1), a
+        ld      bc, (stream_size)
+        ld      hl, stream - 1
+        add     hl, bc
+        ld      de, (moved_end)
+        dec     de
+
+; Backwards, the destination is above the source; most streams need
+; no mask
+        or      a
+        jr      nz, move_byte
+        lddr
+        jr      moved
+move_byte:
+        ld      a, (hl)
+move_mask:
+        xor     0
+        ld      (de), a
+        dec     hl
+        dec     de
+        dec     bc
+        ld      a, b
+        or      c
+        jr      nz, move_byte
+moved:
+
+; The end marker returns to the game
+        inc     de
+        ex      de, hl
+        ld      de, (output)
+        push    de
+
+; -----------------------------------------------------------------------------
+; ZX0 decoder by Einar Saukas & Urusergi
+; "Standard" version (68 bytes only), as in phc25_lib.asm
+; -----------------------------------------------------------------------------
+; Parameters:
+;   HL: source address (compressed data)
+;   DE: destination address (decompressing)
+; -----------------------------------------------------------------------------
+
+dzx0_standard:
+        ld      bc, $ffff               ; preserve default offset 1
+        push    bc
+        inc     bc
+        ld      a, $80
+dzx0s_literals:
+        call    dzx0s_elias             ; obtain length
+        ldir                            ; copy literals
+        add     a, a                    ; copy from last offset or new offset?
+        jr      c, dzx0s_new_offset
+        call    dzx0s_elias             ; obtain length
+dzx0s_copy:
+        ex      (sp), hl                ; preserve source, restore offset
+        push    hl                      ; preserve offset
+        add     hl, de                  ; calculate destination - offset
+        ldir                            ; copy from offset
+        pop     hl                      ; restore offset
+        ex      (sp), hl                ; preserve offset, restore source
+        add     a, a                    ; copy from literals or new offset?
+        jr      nc, dzx0s_literals
+dzx0s_new_offset:
+        pop     bc                      ; discard last offset
+        ld      c, $fe                  ; prepare negative offset
+        call    dzx0s_elias_loop        ; obtain offset MSB
+        inc     c
+        ret     z                       ; check end marker
+        ld      b, c
+        ld      c, (hl)                 ; obtain offset LSB
+        inc     hl
+        rr      b                       ; last offset bit becomes first length bit
+        rr      c
+        push    bc                      ; preserve new offset
+        ld      bc, 1                   ; obtain length
+        call    nc, dzx0s_elias_backtrack
+        inc     bc
+        jr      dzx0s_copy
+dzx0s_elias:
+        inc     c                       ; interlaced Elias gamma coding
+dzx0s_elias_loop:
+        add     a, a
+        jr      nz, dzx0s_elias_skip
+        ld      a, (hl)                 ; load another group of 8 bits
+        inc     hl
+        rla
+dzx0s_elias_skip:
+        ret     c
+dzx0s_elias_backtrack:
+        add     a, a
+        rl      c
+        rl      b
+        jr      dzx0s_elias_loop
+
+; The stream follows the stub
+stream:
@@ -9,6 +9,18 @@
 #ifdef PHC25
 #include "phc25.h"
 #endif
+#ifdef HOST
+#include "host.h"
+#endif
+
+/* Engine globals are per thread on hosts running several games */
+#ifndef PLATFORM_TLS
+#define PLATFORM_TLS
+#endif
+
+/* Frame counters and HUD, empty unless built with -DPERF or -DHUD */
+#include "perf.h"
+#include "hud.h"
 
 /* Forward declaration for game_state_t */
 struct game_state_t;
@@ -18,7 +30,9 @@ void sleep(uint8_t seconds);
 void ticks(uint8_t ticks);
 
 /* Input functions */
-extern uint8_t timeout_ticks;
+#ifndef timeout_ticks                  /* Or a fixed address, see alice.h */
+extern PLATFORM_TLS uint8_t timeout_ticks;
+#endif
 uint8_t wait_key();
 
 uint8_t platform_random();
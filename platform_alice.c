@@ -2,20 +2,8 @@
 
 #ifdef ALICE
 #include "game_state.h"
-
-/* Tetromino data structures - external declarations to avoid duplicate definitions */
-typedef uint8_t packed_tetromino[4];
-extern packed_tetromino all_tetrominos[];
-extern uint8_t tetromino_offsets[];
-extern uint8_t tetrominos_nb_shapes[];
-
-/* Bit manipulation macros for packed format */
-#define GET_BLOCK_X(block) ((block) & 0x03)
-#define GET_BLOCK_Y(block) (((block) >> 2) & 0x03)
-#define GET_BLOCK_SIDES(block) (((block) >> 4) & 0x07)
-
-/* Macro to access a specific tetromino rotation */
-#define GET_TETROMINO(piece, rotation) (&all_tetrominos[tetromino_offsets[piece] + (rotation)])
+#include "tetromino_format.h"
+#include "gfx/alice_screen.h"
 
 // Colors for each tetromino - Alice specific mapping
 char tetrominos_colors[] = {
@@ -41,6 +29,8 @@ uint8_t all_key_columns[8] = {0xFE, 0xFD, 0xFB, 0xF7, 0xEF, 0xDF, 0xBF, 0x7F};
 /************************************************************/
 
 /* Low-level graphics primitives for internal use by platform layer */
+/* Each character written is a 24-bit EF9345 cell: code and two     */
+/* attribute bytes, which is what the HUD counts.                   */
 
 void posxy(unsigned char column, unsigned char line)
 {
@@ -78,6 +68,7 @@ void prints(unsigned char x, unsigned char y, unsigned char *text)
         POKE(R1, *c);
         POKE(R0EXEC, 1);
         BUSY();
+        HUD_BYTES(3);
     }
 }
 
@@ -91,6 +82,7 @@ void printsg(unsigned char x, unsigned char y, unsigned char *text)
         POKE(R2, 0x20);
         POKE(R0EXEC, 1);
         BUSY();
+        HUD_BYTES(3);
     }
 }
 
@@ -100,6 +92,7 @@ void printc(unsigned char x, unsigned char y, unsigned char c)
     POKE(R1, c);
     POKE(R0EXEC, 1);
     BUSY();
+    HUD_BYTES(3);
 }
 
 void printcg(unsigned char x, unsigned char y, unsigned char c)
@@ -109,6 +102,7 @@ void printcg(unsigned char x, unsigned char y, unsigned char c)
     POKE(R2, 0x20);
     POKE(R0EXEC, 1);
     BUSY();
+    HUD_BYTES(3);
 }
 
 /************************************************************/
@@ -224,6 +218,16 @@ uint8_t wait_key()
     }
 }
 
+#if defined(PERF) || defined(HUD)
+// Reading the high byte latches the low one until it is read
+uint16_t perf_clock(void)
+{
+    uint16_t high = PEEK(0x0009);
+
+    return (high << 8) | PEEK(0x000A);
+}
+#endif
+
 uint8_t platform_random()
 {
     // 0x0009-0x000A contains the clock value in μs
@@ -259,15 +263,19 @@ input_action_t platform_get_input()
 void display_sync_playfield(game_state_t* state)
 {
     uint8_t x, y, cell_data, cell_content;
-    
+    uint8_t* cell = &state->playfield[0][0];
+
+    // Cells are visited in memory order, one pointer step each
+    PERF_RENDER_BEGIN();
     for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
-        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
-            cell_data = state->playfield[y][x];
-            
+        for (x = 0; x < PLAYFIELD_WIDTH; x++, cell++) {
+            cell_data = *cell;
+
             // Only redraw cells that are marked dirty
             if (GET_CELL_DIRTY(cell_data)) {
                 cell_content = GET_CELL_CONTENT(cell_data);
-                
+                HUD_CELL();
+
                 if (cell_content != CELL_EMPTY) {
                     color(tetrominos_colors[cell_content - CELL_PIECE_1], black);
                     printc(PLAYFIELD_START_X + x, PLAYFIELD_START_Y + y, '\x7F');
@@ -277,10 +285,11 @@ void display_sync_playfield(game_state_t* state)
                 }
                 
                 // Clear dirty flag after redraw
-                CLEAR_CELL_DIRTY(state->playfield[y][x]);
+                CLEAR_CELL_DIRTY(*cell);
             }
         }
     }
+    PERF_RENDER_END();
 }
 
 
@@ -293,96 +302,259 @@ void int_to_string(uint8_t score, char *str)
     str[3] = '\0';
 }
 
+// Characters on screen; a new screen clears them, so they all differ
+static char score_shown[3];
+static char level_shown[3];
+
+static void forget_ui(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < 3; i++) {
+        score_shown[i] = '\0';
+        level_shown[i] = '\0';
+    }
+}
+
+// One run of writes from the first changed digit to the last, the
+// attribute set once by the first line that needs it
+static uint8_t print_changes(uint8_t y, uint8_t value, char* shown, uint8_t colored)
+{
+    char text[4];
+    uint8_t first, last;
+
+    int_to_string(value, text);
+    for (first = 0; first < 3 && text[first] == shown[first]; first++) {}
+    if (first == 3)
+        return colored;
+    for (last = 2; text[last] == shown[last]; last--) {}
+
+    if (!colored)
+        color(white, black);
+    posxy(UI_START_X + first, y);
+    for (; first <= last; first++) {
+        POKE(R1, text[first]);
+        POKE(R0EXEC, 1);
+        BUSY();
+        HUD_BYTES(3);
+        shown[first] = text[first];
+    }
+    return 1;
+}
+
 void display_sync_ui(game_state_t* state)
 {
-    char print_str[4];
+    uint8_t colored;
 
-    color(white, black);
+    PERF_RENDER_BEGIN();
 
     // Display score
-    int_to_string(state->score, print_str);
-    prints(UI_START_X, 3, print_str);
+    colored = print_changes(3, GAME_HOT(state)->score, score_shown, 0);
 
     // Display level
-    int_to_string(state->level, print_str);
-    prints(UI_START_X, 6, print_str);
+    print_changes(6, GAME_HOT(state)->level, level_shown, colored);
+    PERF_RENDER_END();
+}
+
+#define PREVIEW_X UI_START_X
+#define PREVIEW_Y 9
+
+// Cells of the preview on screen, bit (y * 4 + x), and the piece whose
+// colour they have; a new screen makes them all stale
+static uint16_t preview_cells;
+static uint8_t preview_shown;
+
+static void forget_preview(void)
+{
+    preview_cells = 0xFFFF;
+    preview_shown = 0xFF;
 }
 
+// One pass over the cells that changed, one run per row from the first
+// to the last; blanks are spaces, so the piece colour serves them too
 void display_preview_piece(uint8_t piece)
 {
     packed_tetromino *tetromino;
-    uint8_t i, px, py;
-    uint8_t preview_x = UI_START_X;
-    uint8_t preview_y = 9;
+    uint16_t cells = 0, changed;
+    uint8_t i, row, first, last, py;
 
-    // Clear preview area (4x4 grid)
-    color(black, black);
+    PERF_RENDER_BEGIN();
+
+    // The piece (rotation 0)
+    tetromino = GET_TETROMINO(piece, 0);
+    for (i = 0; i < 4; i++)
+        cells |= 1 << ((GET_BLOCK_Y((*tetromino)[i]) << 2) + GET_BLOCK_X((*tetromino)[i]));
+
+    // Cells filled or emptied, and every block on a colour change
+    changed = preview_cells ^ cells;
+    if (piece != preview_shown)
+        changed |= cells;
+
+    if (changed)
+        color(tetrominos_colors[piece], black);
     for (py = 0; py < 4; py++) {
-        for (px = 0; px < 4; px++) {
-            printc(preview_x + px, preview_y + py, ' ');
+        row = (changed >> (py << 2)) & 0x0F;
+        if (row == 0)
+            continue;
+
+        for (first = 0; (row & (1 << first)) == 0; first++) {}
+        for (last = 3; (row & (1 << last)) == 0; last--) {}
+
+        posxy(PREVIEW_X + first, PREVIEW_Y + py);
+        for (; first <= last; first++) {
+            POKE(R1, (cells >> ((py << 2) + first)) & 1 ? '\x7F' : ' ');
+            POKE(R0EXEC, 1);
+            BUSY();
+            HUD_BYTES(3);
         }
     }
+    preview_cells = cells;
+    preview_shown = piece;
+    PERF_RENDER_END();
+}
 
-    // Draw the piece (rotation 0)
-    tetromino = GET_TETROMINO(piece, 0);
-    color(tetrominos_colors[piece], black);
+// The static screen (gfx/alice_screen.h) is drawn once: between games
+// only the playfield, the digits, the preview and the HUD have changed
+static uint8_t screen_drawn;
 
-    for (i = 0; i < 4; i++) {
-        px = GET_BLOCK_X((*tetromino)[i]);
-        py = GET_BLOCK_Y((*tetromino)[i]);
-        printc(preview_x + px, preview_y + py, '\x7F');
+// Spaces from (x, y), one pointer setup for the run
+static void blank_run(uint8_t x, uint8_t y, uint8_t length)
+{
+    posxy(x, y);
+    for (; length > 0; length--)
+    {
+        POKE(R1, ' ');
+        POKE(R0EXEC, 1);
+        BUSY();
+        HUD_BYTES(3);
     }
 }
 
 void display_clear_screen()
 {
-    unsigned char x, y;
+    unsigned char y;
     color(white, black);
-    for (y = 0; y < 25; y++)
+    if (screen_drawn)
     {
-        for (x = 0; x < 40; x++)
-        {
-            printc(x, y, ' ');
+        for (y = PLAYFIELD_START_Y; y < PLAYFIELD_START_Y + PLAYFIELD_HEIGHT; y++)
+            blank_run(PLAYFIELD_START_X, y, PLAYFIELD_WIDTH);
+        blank_run(UI_START_X, 3, 3);
+        blank_run(UI_START_X, 6, 3);
+        for (y = PREVIEW_Y; y < PREVIEW_Y + 4; y++)
+            blank_run(PREVIEW_X, y, 4);
+    }
+    else
+    {
+        for (y = 0; y < 25; y++)
+            blank_run(0, y, 40);
+    }
+    forget_ui();
+    forget_preview();
+}
+
+#ifdef HUD
+/************************************************************/
+/* Frame HUD (hud.h)                                        */
+/************************************************************/
+
+#define HUD_X (UI_START_X + 2)      /* Four hex digits, labels two columns left */
+#define HUD_Y 20
+#define HUD_LINES 3
+
+static const char hud_hex[] = "0123456789ABCDEF";
+
+/* Values on screen; the borders make every digit stale */
+static uint16_t hud_shown[HUD_LINES];
+static uint8_t hud_stale;
+
+static void hud_labels(void)
+{
+    uint8_t line;
+
+    color(cyan, black);
+    prints(UI_START_X, HUD_Y, "T");
+    prints(UI_START_X, HUD_Y + 1, "C");
+    prints(UI_START_X, HUD_Y + 2, "B");
+    for (line = 0; line < HUD_LINES; line++)
+        blank_run(HUD_X, HUD_Y + line, 4);
+    hud_stale = 1;
+}
+
+// One attribute change, then one run of writes per line that changed,
+// from its first changed digit to its last
+void display_hud(uint16_t time, uint16_t cells, uint16_t bytes)
+{
+    uint16_t value[HUD_LINES];
+    uint16_t changed;
+    uint8_t line, first, last, shift;
+    uint8_t colored = 0;
+
+    value[0] = time;
+    value[1] = cells;
+    value[2] = bytes;
+
+    for (line = 0; line < HUD_LINES; line++) {
+        changed = hud_stale ? 0xFFFF : value[line] ^ hud_shown[line];
+        if (changed == 0)
+            continue;
+
+        for (first = 0; (changed & (0xF000 >> (first << 2))) == 0; first++) {}
+        for (last = 3; (changed & (0x000F << ((3 - last) << 2))) == 0; last--) {}
+
+        if (!colored) {
+            color(cyan, black);
+            colored = 1;
+        }
+        posxy(HUD_X + first, HUD_Y + line);
+        for (; first <= last; first++) {
+            shift = (3 - first) << 2;
+            POKE(R1, hud_hex[(value[line] >> shift) & 0x0F]);
+            POKE(R0EXEC, 1);
+            BUSY();
         }
+        hud_shown[line] = value[line];
     }
+    hud_stale = 0;
 }
+#endif // HUD
 
 void display_draw_borders()
 {
-    unsigned char y;
+    const uint8_t* run;
+    uint8_t length;
 
-    // Print title
-    color(yellow, black);
-    prints(9, 0, "Tetris + Alice = TETRICE");
-
-    // Title graphics
-    color(yellow, black);
-    printsg(0, 2, "\x6b\x41\x77\x41\x6b\x41\x66\x55\x55\x57\x41\x77\x41");
-    printsg(0, 3, "\x4a\x40\x4d\x44\x4a\x40\x45\x45\x45\x4d\x44\x4d\x44");
-
-    // Instructions
-    color(pink, black);
-    prints(2, 11, "O: LEFT");
-    prints(2, 12, "P: RIGHT");
-    prints(2, 13, "Z: ROTATE");
-    prints(2, 14, "A: UNROTATE");
-    prints(2, 15, "SPACE: DROP");
-
-    // Draw playfield borders
-    color(magenta, black);
-    for (y = 0; y < 23; y++)
+    // Title, logo, instructions, borders and labels, built from
+    // gfx/alice_screen.txt: per run, the pointer and the attribute
+    // when it changes, then only character writes
+    if (!screen_drawn)
     {
-        printcg(PLAYFIELD_START_X - 1, 2+y, '\x6A');
-        printcg(PLAYFIELD_END_X + 1, 2+y, '\x55');
+        for (run = alice_screen; *run != ALICE_SCREEN_END;)
+        {
+            POKE(R6, run[0] & ~ALICE_SCREEN_ATTRIBUTES);
+            POKE(R7, run[1]);
+            length = run[2];
+            if (run[0] & ALICE_SCREEN_ATTRIBUTES)
+            {
+                POKE(R2, run[3]);
+                POKE(R3, run[4]);
+                run += 2;
+            }
+            for (run += 3; length > 0; length--)
+            {
+                POKE(R1, *run++);
+                POKE(R0EXEC, 1);
+                BUSY();
+                HUD_BYTES(3);
+            }
+        }
+        screen_drawn = 1;
     }
-    prints(PLAYFIELD_START_X - 1, 24, "\x42\x43\x43\x43\x43\x43\x43\x43\x43\x43\x43\x43\x43\x41");
-    prints(PLAYFIELD_START_X - 1, 1, "\x60\x70\x70\x70\x70\x70\x70\x70\x70\x70\x70\x70\x70\x50");
+    forget_ui();
+    forget_preview();
 
-    // UI labels
-    color(white, black);
-    prints(UI_START_X, 2, "SCORE");
-    prints(UI_START_X, 5, "LEVEL");
-    prints(UI_START_X, 8, "NEXT");
+#ifdef HUD
+    hud_labels();
+#endif
 
     // Welcome message and wait to start game
     // color(white, black);
@@ -0,0 +1,117 @@
+#include "platform.h"
+
+#ifdef HOST
+#include "game_state.h"
+
+// Colors for each tetromino - same mapping as Alice
+char tetrominos_colors[] = {
+    yellow, cyan, pink, green, red, blue, orange};
+
+/************************************************************/
+/* Random numbers                                           */
+/************************************************************/
+
+static host_rng_t host_default_rng = { 0x2545F491u };
+static __thread host_rng_t* host_current_rng = &host_default_rng;
+
+void host_rng_bind(host_rng_t* rng)
+{
+    host_current_rng = rng ? rng : &host_default_rng;
+}
+
+uint8_t platform_random()
+{
+    return host_rng_next(host_current_rng);
+}
+
+/************************************************************/
+/* Keyboard and clock                                       */
+/************************************************************/
+
+const host_display_ops_t* host_display = 0;
+uint8_t (*host_input)(void) = 0;
+
+void sleep(uint8_t seconds)
+{
+    (void)seconds;
+}
+
+void ticks(uint8_t ticks)
+{
+    (void)ticks;
+}
+
+uint8_t scankey()
+{
+    return 0;
+}
+
+uint8_t wait()
+{
+    return 0;
+}
+
+uint8_t wait_key()
+{
+    return ' ';
+}
+
+input_action_t platform_get_input()
+{
+    if (host_input)
+        return (input_action_t)host_input();
+    return INPUT_TIMEOUT;
+}
+
+/************************************************************/
+/* Display Sync API Implementation                         */
+/************************************************************/
+
+void display_sync_playfield(game_state_t* state)
+{
+    uint8_t x, y;
+
+    if (host_display && host_display->sync_playfield) {
+        host_display->sync_playfield(state);
+        return;
+    }
+
+    // Headless: nothing to draw, just acknowledge the dirty cells
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+            CLEAR_CELL_DIRTY(state->playfield[y][x]);
+        }
+    }
+}
+
+void display_sync_ui(game_state_t* state)
+{
+    if (host_display && host_display->sync_ui)
+        host_display->sync_ui(state);
+}
+
+void display_preview_piece(uint8_t piece)
+{
+    if (host_display && host_display->preview_piece)
+        host_display->preview_piece(piece);
+}
+
+void display_clear_screen()
+{
+    if (host_display && host_display->clear_screen)
+        host_display->clear_screen();
+}
+
+void display_draw_borders()
+{
+    if (host_display && host_display->draw_borders)
+        host_display->draw_borders();
+}
+
+void display_game_over()
+{
+    if (host_display && host_display->game_over)
+        host_display->game_over();
+}
+
+#endif // HOST
@@ -2,82 +2,26 @@
 
 #ifdef PHC25
 #include "game_state.h"
+#include "tetromino_format.h"
 #include "game_font.h"
+#include "block_patterns.h"
+#include "gfx/assets.h"
+#ifdef HUD
+#include "debug_font.h"
+#endif
 
-/* Tetromino data structures - external declarations to avoid duplicate definitions */
-typedef uint8_t packed_tetromino[4];
-extern packed_tetromino all_tetrominos[];
-extern uint8_t tetromino_offsets[];
-extern uint8_t tetrominos_nb_shapes[];
-
-/* Bit manipulation macros for packed format */
-#define GET_BLOCK_X(block) ((block) & 0x03)
-#define GET_BLOCK_Y(block) (((block) >> 2) & 0x03)
-#define GET_BLOCK_SIDES(block) (((block) >> 4) & 0x07)
-
-/* Macro to access a specific tetromino rotation */
-#define GET_TETROMINO(piece, rotation) (&all_tetrominos[tetromino_offsets[piece] + (rotation)])
-
-extern void decompress_ui_left(void);
-extern void decompress_ui_right(void);
-extern void decompress_ui_title(void);
-extern void decompress_ui_bottom(void);
-extern void decompress_splash(void);
-extern void decompress_gameover(void);
+/* Decompress a ZX0 stream of the asset block, in phc25_lib.asm */
+extern void decompress_asset(uint16_t stream, uint16_t destination) PLATFORM_CALLEE;
 
 /************************************************************/
 /* PHC-25 Mode 12 Graphics Implementation                   */
 /* Based on successful POC using 256x192 monochrome        */
 /************************************************************/
 
-/* Block patterns for each tetromino type (8x8 pixels) */
-/* Generated from gfx/blocks.png */
-const uint8_t block_patterns[7][8] = {
-    {0xFE, 0xAA, 0xD6, 0xAA, 0xD6, 0xAA, 0xFE, 0x00},  /* I */
-    {0xFE, 0x82, 0x82, 0x92, 0x82, 0x82, 0xFE, 0x00},  /* O */
-    {0xFE, 0x82, 0x86, 0x8E, 0x9E, 0xBE, 0xFE, 0x00},  /* T */
-    {0xFE, 0x82, 0xBA, 0xAA, 0xBA, 0x82, 0xFE, 0x00},  /* S */
-    {0xFE, 0xC6, 0x82, 0x82, 0x82, 0xC6, 0xFE, 0x00},  /* Z */
-    {0xFE, 0xD6, 0x92, 0xFE, 0x92, 0xD6, 0xFE, 0x00},  /* J */
-    {0xFE, 0xAA, 0xEE, 0x82, 0xEE, 0xAA, 0xFE, 0x00}   /* L */
-};
-
 /* Timeout for input functions - defined in tetrice.c */
 extern uint8_t timeout_ticks;
 
-/* I/O port access functions using inline assembly */
-void out_port(uint8_t port, uint8_t value)
-{
-    port; value; /* suppress unused parameter warnings */
-    __asm
-        pop hl      ; return address
-        pop bc      ; value (in C)
-        pop de      ; port (in E)
-        push de     ; restore stack
-        push bc
-        push hl
-
-        ld  a, c    ; value to A
-        ld  c, e    ; port to C
-        out (c), a  ; output to port
-    __endasm;
-}
-
-uint8_t in_port(uint8_t port)
-{
-    port; /* suppress unused parameter warning */
-    __asm
-        pop hl      ; return address
-        pop bc      ; port (in C)
-        push bc     ; restore stack
-        push hl
-
-        ld  c, c    ; port already in C
-        in  a, (c)  ; input from port
-        ld  l, a    ; return value in L
-        ld  h, 0    ; clear H for 16-bit return
-    __endasm;
-}
+/* I/O port access (out_port, in_port) is in phc25_lib.asm, mocked in TEST_MODE */
 
 /* Initialize MC6847 for Mode 12 (256x192 monochrome graphics) */
 void init_graphics_mode12(void)
@@ -99,6 +43,7 @@ void clear_screen(void)
     for (i = 0; i < VRAM_SIZE; i++) {
         POKE(VRAM_START + i, 0x00);  /* All pixels off (black) */
     }
+    HUD_BYTES(VRAM_SIZE);
 }
 
 
@@ -116,6 +61,7 @@ void draw_tetris_block_pattern(uint8_t pixel_x, uint8_t pixel_y, uint8_t color)
         start_addr = VRAM_START + ((pixel_y + row) << 5) + (pixel_x >> 3);
         POKE(start_addr, block_patterns[color-1][row]);
     }
+    HUD_BYTES(BLOCK_SIZE);
 }
 
 /* Erase a tetris block (set to background) at pixel coordinates */
@@ -129,6 +75,7 @@ void erase_tetris_block(uint8_t pixel_x, uint8_t pixel_y)
         start_addr = VRAM_START + ((pixel_y + row) << 5) + (pixel_x >> 3);
         POKE(start_addr, 0x00);  /* All pixels off */
     }
+    HUD_BYTES(BLOCK_SIZE);
 }
 
 /************************************************************/
@@ -365,6 +312,7 @@ void display_sync_playfield(game_state_t* state)
             /* Only redraw cells that are marked dirty */
             if (GET_CELL_DIRTY(cell_data)) {
                 cell_content = GET_CELL_CONTENT(cell_data);
+                HUD_CELL();
 
                 /* Convert playfield coordinates to pixel coordinates */
                 pixel_x = PLAYFIELD_START_X + (x << 3);
@@ -385,55 +333,80 @@ void display_sync_playfield(game_state_t* state)
     }
 }
 
+/* Digits on screen, left to right; a new screen makes them unknown */
+static uint8_t score_shown[3];
+static uint8_t level_shown[3];
+
+static void forget_ui(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < 3; i++) {
+        score_shown[i] = FONT_DIGIT_UNKNOWN;
+        level_shown[i] = FONT_DIGIT_UNKNOWN;
+    }
+}
+
 void display_sync_ui(game_state_t* state)
 {
     /* Display score at (216, 134) - 3 digits with leading zeros */
-    draw_number(216, 134, state->score, 3, 1);
+    update_number(216, 134, GAME_HOT(state)->score, 3, score_shown);
 
     /* Display level at (216, 174) - 3 digits with leading zeros */
-    draw_number(216, 174, state->level, 3, 1);
+    update_number(216, 174, GAME_HOT(state)->level, 3, level_shown);
 }
 
 #define PREVIEW_X 202
 #define PREVIEW_Y 80
 
+/* Cells of the preview on screen, bit (y * 4 + x), and the piece */
+/* whose pattern they have; a new screen makes them all stale      */
+static uint16_t preview_cells;
+static uint8_t preview_shown;
+
+static void forget_preview(void)
+{
+    preview_cells = 0xFFFF;
+    preview_shown = 0xFF;
+}
+
 void display_preview_piece(uint8_t piece)
 {
     packed_tetromino *tetromino;
+    uint16_t cells = 0, erase, draw, bit;
     uint8_t i, px, py;
 
-    /* Clear preview area (4x4 blocks = 32x32 pixels) */
+    /* The piece (rotation 0) */
+    tetromino = GET_TETROMINO(piece, 0);
+    for (i = 0; i < 4; i++)
+        cells |= 1 << ((GET_BLOCK_Y((*tetromino)[i]) << 2) + GET_BLOCK_X((*tetromino)[i]));
+
+    /* Erase the cells it leaves, draw the ones it takes, or all of */
+    /* them for another pattern, in one pass over the 4x4 blocks    */
+    erase = preview_cells & ~cells;
+    draw = piece != preview_shown ? cells : cells & ~preview_cells;
+    bit = 1;
     for (py = 0; py < 4; py++) {
         for (px = 0; px < 4; px++) {
-            erase_tetris_block(PREVIEW_X + (px << 3), PREVIEW_Y + (py << 3));
+            if (erase & bit)
+                erase_tetris_block(PREVIEW_X + (px << 3), PREVIEW_Y + (py << 3));
+            else if (draw & bit)
+                draw_tetris_block_pattern(PREVIEW_X + (px << 3), PREVIEW_Y + (py << 3), piece + 1);
+            bit <<= 1;
         }
     }
-
-    /* Draw the piece (rotation 0) */
-    tetromino = GET_TETROMINO(piece, 0);
-
-    for (i = 0; i < 4; i++) {
-        px = GET_BLOCK_X((*tetromino)[i]);
-        py = GET_BLOCK_Y((*tetromino)[i]);
-        draw_tetris_block_pattern(PREVIEW_X + (px << 3), PREVIEW_Y + (py << 3), piece + 1);
-    }
+    preview_cells = cells;
+    preview_shown = piece;
 }
 
 void display_clear_screen()
 {
     /* Initialize graphics mode and clear screen */
     init_graphics_mode12();
+    forget_ui();
+    forget_preview();
 }
 
-#define GFX_TITLE_HEIGHT 8
-#define GFX_TITLE_BYTES_PER_ROW 32
-#define GFX_LEFT_UI_HEIGHT 184
-#define GFX_LEFT_UI_BYTES_PER_ROW 11
-#define GFX_RIGHT_UI_HEIGHT 184
-#define GFX_RIGHT_UI_BYTES_PER_ROW 11
-#define GFX_BOTTOM_HEIGHT 8
-#define GFX_BOTTOM_BYTES_PER_ROW 10
-
 /* Copy bitmap data to VRAM */
 void copy_bitmap(uint8_t x, uint8_t y, const uint8_t* source_data,
                  uint16_t height, uint8_t bytes_per_row)
@@ -453,35 +426,105 @@ void copy_bitmap(uint8_t x, uint8_t y, const uint8_t* source_data,
             POKE(vram_addr + col, *src_ptr++);
         }
     }
+    HUD_BYTES(height * bytes_per_row);
 }
 
-void display_draw_borders()
+#ifdef HUD
+/************************************************************/
+/* Frame HUD (hud.h)                                        */
+/* Bottom of the right panel, under the level box. There is */
+/* no timer to read with interrupts off, so the frame time  */
+/* is left out: "C nn B nnnn", two 4x4 characters per byte. */
+/************************************************************/
+
+#define HUD_COLUMN 23               /* VRAM byte column, x = 184 */
+#define HUD_Y 185
+#define HUD_PAIRS 3                 /* Cells, bytes high, bytes low */
+
+static const char hud_hex[] = "0123456789ABCDEF";
+
+/* Pairs on screen; the borders make every one stale */
+static uint8_t hud_shown[HUD_PAIRS];
+static uint8_t hud_stale;
+
+static void hud_labels(void)
 {
-    /* Draw title at top (full width) - zx0 compressed */
-    decompress_ui_title();
-    copy_bitmap(0, 0, VRAM2_START, GFX_TITLE_HEIGHT, GFX_TITLE_BYTES_PER_ROW);
+    debug_draw_pair(HUD_COLUMN, HUD_Y, 'C', ' ');
+    debug_draw_pair(HUD_COLUMN + 2, HUD_Y, 'B', ' ');
+    hud_stale = 1;
+}
 
-    /* Draw left UI panel - zx0 compressed */
-    decompress_ui_left();
-    copy_bitmap(0, 8, VRAM2_START, GFX_LEFT_UI_HEIGHT, GFX_LEFT_UI_BYTES_PER_ROW);
+void display_hud(uint16_t time, uint16_t cells, uint16_t bytes)
+{
+    static const uint8_t columns[HUD_PAIRS] = { HUD_COLUMN + 1, HUD_COLUMN + 3, HUD_COLUMN + 4 };
+    uint8_t value[HUD_PAIRS];
+    uint8_t i;
 
-    /* Draw right UI panel - zx0 compressed */
-    decompress_ui_right();
-    copy_bitmap(168, 8, VRAM2_START, GFX_RIGHT_UI_HEIGHT, GFX_RIGHT_UI_BYTES_PER_ROW);
+    (void)time; /* No clock on this machine */
 
-    /* Draw bottom decoration (centered at bottom) - zx0 compressed */
-    decompress_ui_bottom();
-    copy_bitmap(88, 184, VRAM2_START, GFX_BOTTOM_HEIGHT, GFX_BOTTOM_BYTES_PER_ROW);
+    value[0] = cells > 0xFF ? 0xFF : cells;
+    value[1] = bytes >> 8;
+    value[2] = bytes & 0xFF;
 
-    // Draw splash screen in the playfield area
-    decompress_splash();
-    copy_bitmap(88, 8, VRAM2_START, 176, 10);
+    /* Only the pairs whose byte changed are rewritten */
+    for (i = 0; i < HUD_PAIRS; i++) {
+        if (hud_stale || value[i] != hud_shown[i]) {
+            debug_draw_pair(columns[i], HUD_Y, hud_hex[value[i] >> 4], hud_hex[value[i] & 0x0F]);
+            hud_shown[i] = value[i];
+        }
+    }
+    hud_stale = 0;
 }
+#endif // HUD
+
+/************************************************************/
+/* UI assets                                                */
+/* The compressed bitmaps are linked into the program as    */
+/* one block. Its index gives the stream and the size of    */
+/* each asset of the manifest (gfx/assets.txt), so drawing  */
+/* one needs only its id.                                   */
+/************************************************************/
+
+#define ASSET_ENTRY 4               /* Stream offset, bytes per row, height */
+
+/* Draw an asset at x (a multiple of 8), y. Full-width assets are */
+/* decompressed straight to the screen, the others go through     */
+/* page 2.                                                        */
+void draw_asset(uint8_t asset, uint8_t x, uint8_t y)
+{
+    uint16_t entry = PHC25_ASSETS_ADDR + asset * ASSET_ENTRY;
+    uint16_t stream;
+    uint8_t bytes_per_row;
+
+    stream = PHC25_ASSETS_ADDR + (PEEK(entry) | (PEEK(entry + 1) << 8));
+    bytes_per_row = PEEK(entry + 2);
+    if (bytes_per_row == BYTES_PER_ROW) {
+        decompress_asset(stream, VRAM_START + ((uint16_t)y << 5));
+        HUD_BYTES(PEEK(entry + 3) << 5);
+        return;
+    }
+    decompress_asset(stream, PHC25_SCRATCH_ADDR);
+    copy_bitmap(x, y, VRAM2_START, PEEK(entry + 3), bytes_per_row);
+}
+
+void display_draw_borders()
+{
+    /* Title, side panels, bottom decoration and the splash in the */
+    /* playfield: the whole screen, in one pass                    */
+    draw_asset(ASSET_SCREEN, 0, 0);
+    forget_ui();
+    forget_preview();
+
+#ifdef HUD
+    hud_labels();
+#endif
+}
+
+#define GAMEOVER_Y 80
 
 void display_game_over()
 {
-    decompress_gameover();
-    copy_bitmap(88, 80, VRAM2_START, 40, 10);
+    draw_asset(ASSET_GAMEOVER, PLAYFIELD_START_X, GAMEOVER_Y);
 }
 
 #endif // PHC25
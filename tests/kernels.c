@@ -0,0 +1,206 @@
+/* kernels.c - alice_kernels.s against the C piece functions       */
+/* Assembles the kernels on the 6803 model (m6803.h) in the mock's  */
+/* memory, runs them there and compares every result with tetrice.c */
+/* built for the Alice with DIRECT_PAGE: all 19 rotations, every    */
+/* position in and around the playfield, over a corpus of boards.   */
+/* Also prints the cycles per kernel call.                          */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASM_KERNELS                 /* The argument block layout, alice.h */
+#include "../host/engine.h"
+#include "test_mock.h"
+#include "m6803.h"
+
+#define CODE_ADDR 0x4000
+#define TABLES_ADDR 0x4800
+#define FIELD_ADDR 0x5000
+#define STACK_ADDR 0x3FFF
+#define MAX_STEPS 100000
+
+#define KERNEL(offset) (DP_BASE + KERNEL_ARGS_OFFSET + (offset))
+
+void playfield_rows_init(void);
+
+typedef struct kernel_stats_t {
+    const char* name;
+    uint16_t address;
+    uint64_t calls;
+    uint64_t cycles;
+    uint64_t max;
+    uint64_t mismatches;
+} kernel_stats_t;
+
+enum { K_COLLISION, K_ROTATION, K_PLACE, KERNELS };
+
+static kernel_stats_t kernels[KERNELS] = {
+    { "kernel_collision" }, { "kernel_rotation" }, { "kernel_place" }
+};
+static m6803_t cpu = { mock_ram };
+static uint32_t rng_state;
+
+static uint32_t next_random(void)
+{
+    rng_state = rng_state * 1103515245u + 12345u;
+    return rng_state >> 16;
+}
+
+// The kernel's view of the board and its arguments, then the call
+static uint8_t run(int k, const game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation,
+                   uint8_t side, int8_t dx, int8_t dy)
+{
+    kernel_stats_t* s = &kernels[k];
+
+    memcpy(&mock_ram[FIELD_ADDR], state->playfield, sizeof(state->playfield));
+    m6803_write16(mock_ram, KERNEL(0), FIELD_ADDR);
+    mock_ram[KERNEL(2)] = piece;
+    mock_ram[KERNEL(3)] = x;
+    mock_ram[KERNEL(4)] = y;
+    mock_ram[KERNEL(5)] = rotation;
+    mock_ram[KERNEL(6)] = side;
+    mock_ram[KERNEL(7)] = (uint8_t)dx;
+    mock_ram[KERNEL(8)] = (uint8_t)dy;
+    mock_ram[KERNEL(9)] = 0xA5;
+    if (m6803_call(&cpu, s->address, STACK_ADDR, MAX_STEPS))
+        exit(1);
+    s->calls++;
+    s->cycles += cpu.cycles;
+    if (cpu.cycles > s->max)
+        s->max = cpu.cycles;
+    return mock_ram[KERNEL(9)];
+}
+
+static void mismatch(int k, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t side, int expected,
+                     int got)
+{
+    if (kernels[k].mismatches++ < 10)
+        printf("%s: piece %u x %u y %u rotation %u arg %u: C %d, assembly %d\n", kernels[k].name, piece, x, y,
+               rotation, side, expected, got);
+}
+
+static void check_board(game_state_t* state)
+{
+    static const int8_t moves[3][3] = {
+        { SIDE_LEFT, -1, 0 }, { SIDE_RIGHT, 1, 0 }, { SIDE_BOTTOM, 0, 1 }
+    };
+    game_state_t placed;
+    uint8_t piece, rotation, x, y, i, got, expected;
+
+    for (piece = 0; piece < NB_PIECES; piece++) {
+        for (rotation = 0; rotation < tetrominos_nb_shapes[piece]; rotation++) {
+            // Past both edges too: x + dx wraps below 0, as in game_step
+            for (y = 0; y <= PLAYFIELD_HEIGHT; y++) {
+                for (x = 0; x <= PLAYFIELD_WIDTH; x++) {
+                    for (i = 0; i < 3; i++) {
+                        expected = check_collision(state, piece, x, y, rotation, moves[i][0], moves[i][1],
+                                                   moves[i][2]);
+                        got = run(K_COLLISION, state, piece, x, y, rotation, moves[i][0], moves[i][1], moves[i][2]);
+                        if (got != expected)
+                            mismatch(K_COLLISION, piece, x, y, rotation, moves[i][0], expected, got);
+                    }
+                    for (i = 0; i < 2; i++) {
+                        expected = check_rotation(state, piece, x, y, rotation, i);
+                        got = run(K_ROTATION, state, piece, x, y, rotation, i, 0, 0);
+                        if (got != expected)
+                            mismatch(K_ROTATION, piece, x, y, rotation, i, expected, got);
+                    }
+
+                    placed = *state;
+                    if (x & 1)
+                        playfield_remove_piece(&placed, piece, x, y, rotation);
+                    else
+                        playfield_place_piece(&placed, piece, x, y, rotation);
+                    run(K_PLACE, state, piece, x, y, rotation, x & 1 ? CELL_EMPTY : CELL_PIECE_1 + piece, 0, 0);
+                    if (memcmp(&mock_ram[FIELD_ADDR], placed.playfield, sizeof(placed.playfield)))
+                        mismatch(K_PLACE, piece, x, y, rotation, x & 1, 0, 1);
+                }
+            }
+        }
+    }
+}
+
+static void fill_board(game_state_t* state, int kind)
+{
+    uint8_t x, y, cell;
+
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        for (x = 0; x < PLAYFIELD_WIDTH; x++) {
+            switch (kind) {
+            case 0: cell = CELL_EMPTY; break;
+            case 1: cell = CELL_PIECE_1 + (x + y) % 7; break;
+            case 2: cell = y >= PLAYFIELD_HEIGHT / 2 && x != y % PLAYFIELD_WIDTH ? CELL_PIECE_2 : CELL_EMPTY; break;
+            case 3: cell = (x + y) & 1 ? CELL_PIECE_3 : CELL_EMPTY; break;
+            default:
+                // Denser towards the bottom, some cells with the dirty flag
+                cell = next_random() % PLAYFIELD_HEIGHT < y ? 1 + next_random() % 7 : CELL_EMPTY;
+                if (next_random() & 1)
+                    cell |= CELL_DIRTY_FLAG;
+                break;
+            }
+            state->playfield[y][x] = cell;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = argc > 1 ? argv[1] : "alice_kernels.s";
+    game_state_t state;
+    uint32_t boards = 36, b;
+    uint64_t failures = 0;
+    int size, k;
+
+    if (argc > 2)
+        boards = (uint32_t)strtoul(argv[2], NULL, 0);
+    if (argc > 3 || (argc > 1 && argv[1][0] == '-')) {
+        printf("Usage: tetrice_kernels [alice_kernels.s [BOARDS]]\n");
+        return 1;
+    }
+
+    // The tables the kernels read, where the linker would put them
+    memset(mock_ram, 0, sizeof(mock_ram));
+    memcpy(&mock_ram[TABLES_ADDR], all_tetrominos, 19 * sizeof(packed_tetromino));
+    memcpy(&mock_ram[TABLES_ADDR + 0x80], tetromino_offsets, NB_PIECES);
+    memcpy(&mock_ram[TABLES_ADDR + 0x90], tetrominos_nb_shapes, NB_PIECES);
+    m6803_define("_all_tetrominos", TABLES_ADDR);
+    m6803_define("_tetromino_offsets", TABLES_ADDR + 0x80);
+    m6803_define("_tetrominos_nb_shapes", TABLES_ADDR + 0x90);
+    playfield_rows_init();
+
+    size = m6803_assemble(mock_ram, path, CODE_ADDR);
+    if (size < 0)
+        return 1;
+    if (size > TABLES_ADDR - CODE_ADDR) {
+        fprintf(stderr, "kernels: %s does not fit below the tables\n", path);
+        return 1;
+    }
+    for (k = 0; k < KERNELS; k++) {
+        char name[40];
+
+        snprintf(name, sizeof(name), "_%s", kernels[k].name);
+        if (!m6803_lookup(name, &kernels[k].address)) {
+            fprintf(stderr, "kernels: %s does not define %s\n", path, name);
+            return 1;
+        }
+    }
+
+    rng_state = 1;
+    for (b = 0; b < boards; b++) {
+        fill_board(&state, b < 4 ? (int)b : 4);
+        check_board(&state);
+    }
+
+    printf("%s: %d bytes, %u boards\n", path, size, boards);
+    printf("%-18s %9s %9s %7s %5s\n", "kernel", "calls", "mismatch", "cycles", "max");
+    for (k = 0; k < KERNELS; k++) {
+        kernel_stats_t* s = &kernels[k];
+
+        printf("%-18s %9llu %9llu %7.1f %5llu\n", s->name, (unsigned long long)s->calls,
+               (unsigned long long)s->mismatches, s->calls ? (double)s->cycles / s->calls : 0.0,
+               (unsigned long long)s->max);
+        failures += s->mismatches;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,625 @@
+/* m6803.c - 6803 model for the assembly tests */
+/* The instructions alice_kernels.s and alice_unzx0.s use, with the */
+/* 6803 cycle counts; labels are 16-bit, numbers below 0x100 are    */
+/* direct page addresses as in as68.                                */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "m6803.h"
+
+#define MAX_SYMBOLS 128
+#define MAX_LINES 512
+
+/************************************************************/
+/* Instruction set                                          */
+/************************************************************/
+
+enum { M_INH, M_IMM, M_DIR, M_IDX, M_EXT, M_REL, M_MODES };
+
+typedef enum {
+    OP_LDAA, OP_LDAB, OP_LDD, OP_LDX, OP_STAA, OP_STAB, OP_STD, OP_STX,
+    OP_ADDA, OP_ADDB, OP_ADDD, OP_SUBA, OP_SUBB, OP_SUBD, OP_ANDA, OP_ANDB, OP_ORAA, OP_ORAB, OP_EORA, OP_EORB,
+    OP_CMPA, OP_CMPB, OP_CPX, OP_TST, OP_DEC, OP_INC, OP_CLR, OP_ASL, OP_LSR, OP_ROL, OP_ROR,
+    OP_ABX, OP_MUL, OP_TAB, OP_TBA, OP_CBA, OP_LSRA, OP_LSRB, OP_ASLA, OP_ASLB, OP_ROLA, OP_ROLB,
+    OP_RORA, OP_RORB, OP_LSRD, OP_ASLD, OP_NEGA, OP_NEGB, OP_SEC, OP_CLC, OP_SEI, OP_CLI, OP_TPA, OP_TAP,
+    OP_INCA, OP_INCB, OP_DECA, OP_DECB, OP_TSTA, OP_TSTB, OP_CLRA, OP_CLRB,
+    OP_INX, OP_DEX, OP_INS, OP_DES, OP_LDS, OP_STS, OP_PSHA, OP_PSHB, OP_PULA, OP_PULB, OP_PSHX, OP_PULX, OP_RTS,
+    OP_JSR, OP_JMP, OP_BSR, OP_BRA, OP_BHI, OP_BLS, OP_BHS, OP_BLO, OP_BNE, OP_BEQ, OP_BPL, OP_BMI,
+    OP_COUNT
+} op_t;
+
+typedef struct insn_t {
+    const char* name;
+    int16_t opcode[M_MODES];        /* -1 where the mode does not exist */
+    uint8_t cycles[M_MODES];
+    uint8_t wide;                   /* 16-bit immediate */
+} insn_t;
+
+#define NO -1
+static const insn_t insns[OP_COUNT] = {
+    { "ldaa", { NO, 0x86, 0x96, 0xA6, 0xB6, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "ldab", { NO, 0xC6, 0xD6, 0xE6, 0xF6, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "ldd",  { NO, 0xCC, 0xDC, 0xEC, 0xFC, NO }, { 0, 3, 4, 5, 5, 0 }, 1 },
+    { "ldx",  { NO, 0xCE, 0xDE, 0xEE, 0xFE, NO }, { 0, 3, 4, 5, 5, 0 }, 1 },
+    { "staa", { NO, NO, 0x97, 0xA7, 0xB7, NO }, { 0, 0, 3, 4, 4, 0 }, 0 },
+    { "stab", { NO, NO, 0xD7, 0xE7, 0xF7, NO }, { 0, 0, 3, 4, 4, 0 }, 0 },
+    { "std",  { NO, NO, 0xDD, 0xED, 0xFD, NO }, { 0, 0, 4, 5, 5, 0 }, 0 },
+    { "stx",  { NO, NO, 0xDF, 0xEF, 0xFF, NO }, { 0, 0, 4, 5, 5, 0 }, 0 },
+    { "adda", { NO, 0x8B, 0x9B, 0xAB, 0xBB, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "addb", { NO, 0xCB, 0xDB, 0xEB, 0xFB, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "addd", { NO, 0xC3, 0xD3, 0xE3, 0xF3, NO }, { 0, 4, 5, 6, 6, 0 }, 1 },
+    { "suba", { NO, 0x80, 0x90, 0xA0, 0xB0, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "subb", { NO, 0xC0, 0xD0, 0xE0, 0xF0, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "subd", { NO, 0x83, 0x93, 0xA3, 0xB3, NO }, { 0, 4, 5, 6, 6, 0 }, 1 },
+    { "anda", { NO, 0x84, 0x94, 0xA4, 0xB4, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "andb", { NO, 0xC4, 0xD4, 0xE4, 0xF4, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "oraa", { NO, 0x8A, 0x9A, 0xAA, 0xBA, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "orab", { NO, 0xCA, 0xDA, 0xEA, 0xFA, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "eora", { NO, 0x88, 0x98, 0xA8, 0xB8, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "eorb", { NO, 0xC8, 0xD8, 0xE8, 0xF8, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "cmpa", { NO, 0x81, 0x91, 0xA1, 0xB1, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "cmpb", { NO, 0xC1, 0xD1, 0xE1, 0xF1, NO }, { 0, 2, 3, 4, 4, 0 }, 0 },
+    { "cpx",  { NO, 0x8C, 0x9C, 0xAC, 0xBC, NO }, { 0, 4, 5, 6, 6, 0 }, 1 },
+    { "tst",  { NO, NO, NO, 0x6D, 0x7D, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "dec",  { NO, NO, NO, 0x6A, 0x7A, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "inc",  { NO, NO, NO, 0x6C, 0x7C, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "clr",  { NO, NO, NO, 0x6F, 0x7F, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "asl",  { NO, NO, NO, 0x68, 0x78, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "lsr",  { NO, NO, NO, 0x64, 0x74, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "rol",  { NO, NO, NO, 0x69, 0x79, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "ror",  { NO, NO, NO, 0x66, 0x76, NO }, { 0, 0, 0, 6, 6, 0 }, 0 },
+    { "abx",  { 0x3A, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "mul",  { 0x3D, NO, NO, NO, NO, NO }, { 10 }, 0 },
+    { "tab",  { 0x16, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "tba",  { 0x17, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "cba",  { 0x11, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "lsra", { 0x44, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "lsrb", { 0x54, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "asla", { 0x48, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "aslb", { 0x58, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "rola", { 0x49, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "rolb", { 0x59, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "rora", { 0x46, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "rorb", { 0x56, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "lsrd", { 0x04, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "asld", { 0x05, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "nega", { 0x40, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "negb", { 0x50, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "sec",  { 0x0D, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "clc",  { 0x0C, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "sei",  { 0x0F, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "cli",  { 0x0E, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "tpa",  { 0x07, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "tap",  { 0x06, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "inca", { 0x4C, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "incb", { 0x5C, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "deca", { 0x4A, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "decb", { 0x5A, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "tsta", { 0x4D, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "tstb", { 0x5D, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "clra", { 0x4F, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "clrb", { 0x5F, NO, NO, NO, NO, NO }, { 2 }, 0 },
+    { "inx",  { 0x08, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "dex",  { 0x09, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "ins",  { 0x31, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "des",  { 0x34, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "lds",  { NO, 0x8E, 0x9E, 0xAE, 0xBE, NO }, { 0, 3, 4, 5, 5, 0 }, 1 },
+    { "sts",  { NO, NO, 0x9F, 0xAF, 0xBF, NO }, { 0, 0, 4, 5, 5, 0 }, 0 },
+    { "psha", { 0x36, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "pshb", { 0x37, NO, NO, NO, NO, NO }, { 3 }, 0 },
+    { "pula", { 0x32, NO, NO, NO, NO, NO }, { 4 }, 0 },
+    { "pulb", { 0x33, NO, NO, NO, NO, NO }, { 4 }, 0 },
+    { "pshx", { 0x3C, NO, NO, NO, NO, NO }, { 4 }, 0 },
+    { "pulx", { 0x38, NO, NO, NO, NO, NO }, { 5 }, 0 },
+    { "rts",  { 0x39, NO, NO, NO, NO, NO }, { 5 }, 0 },
+    { "jsr",  { NO, NO, 0x9D, 0xAD, 0xBD, NO }, { 0, 0, 5, 6, 6, 0 }, 0 },
+    { "jmp",  { NO, NO, NO, 0x6E, 0x7E, NO }, { 0, 0, 0, 3, 3, 0 }, 0 },
+    { "bsr",  { NO, NO, NO, NO, NO, 0x8D }, { 0, 0, 0, 0, 0, 6 }, 0 },
+    { "bra",  { NO, NO, NO, NO, NO, 0x20 }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "bhi",  { NO, NO, NO, NO, NO, 0x22 }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "bls",  { NO, NO, NO, NO, NO, 0x23 }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "bhs",  { NO, NO, NO, NO, NO, 0x24 }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "blo",  { NO, NO, NO, NO, NO, 0x25 }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "bne",  { NO, NO, NO, NO, NO, 0x26 }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "beq",  { NO, NO, NO, NO, NO, 0x27 }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "bpl",  { NO, NO, NO, NO, NO, 0x2A }, { 0, 0, 0, 0, 0, 3 }, 0 },
+    { "bmi",  { NO, NO, NO, NO, NO, 0x2B }, { 0, 0, 0, 0, 0, 3 }, 0 },
+};
+
+/* Other names of the same opcodes */
+static const char* const aliases[][2] = {
+    { "bcc", "bhs" }, { "bcs", "blo" }, { "lsla", "asla" }, { "lslb", "aslb" }, { "lsld", "asld" },
+};
+
+/* Opcode to instruction and mode, filled from insns */
+static struct { int16_t op; uint8_t mode; } decode[256];
+static int decode_ready = 0;
+
+static void decode_init(void)
+{
+    int k, mode;
+
+    for (k = 0; k < 256; k++)
+        decode[k].op = -1;
+    for (k = 0; k < OP_COUNT; k++)
+        for (mode = 0; mode < M_MODES; mode++)
+            if (insns[k].opcode[mode] >= 0) {
+                decode[insns[k].opcode[mode]].op = (int16_t)k;
+                decode[insns[k].opcode[mode]].mode = (uint8_t)mode;
+            }
+    decode_ready = 1;
+}
+
+uint16_t m6803_read16(const uint8_t* memory, uint16_t address)
+{
+    return (uint16_t)(memory[address] << 8 | memory[(uint16_t)(address + 1)]);
+}
+
+void m6803_write16(uint8_t* memory, uint16_t address, uint16_t value)
+{
+    memory[address] = (uint8_t)(value >> 8);
+    memory[(uint16_t)(address + 1)] = (uint8_t)value;
+}
+
+/************************************************************/
+/* Assembler                                                */
+/************************************************************/
+
+typedef struct symbol_t {
+    char name[32];
+    uint16_t value;
+} symbol_t;
+
+static symbol_t symbols[MAX_SYMBOLS];
+static int symbol_count = 0;
+
+void m6803_define(const char* name, uint16_t value)
+{
+    int i;
+
+    for (i = 0; i < symbol_count; i++) {
+        if (!strcmp(symbols[i].name, name)) {
+            symbols[i].value = value;
+            return;
+        }
+    }
+    if (symbol_count == MAX_SYMBOLS || strlen(name) >= sizeof(symbols[0].name)) {
+        fprintf(stderr, "m6803: cannot define %s\n", name);
+        exit(1);
+    }
+    strcpy(symbols[symbol_count].name, name);
+    symbols[symbol_count++].value = value;
+}
+
+int m6803_lookup(const char* name, uint16_t* value)
+{
+    int i;
+
+    for (i = 0; i < symbol_count; i++) {
+        if (!strcmp(symbols[i].name, name)) {
+            *value = symbols[i].value;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// A number ($hex or decimal) or a symbol, plus or minus a number;
+// symbols are 16-bit addresses
+static int evaluate(const char* text, int final, uint16_t* value, int* numeric)
+{
+    char term[64];
+    const char* sign = strpbrk(text + 1, "+-");
+    char* end;
+
+    *numeric = 0;
+    if (sign && *text != '$' && !isdigit((unsigned char)*text)) {
+        uint16_t base, offset;
+        int unused;
+
+        if ((size_t)(sign - text) >= sizeof(term))
+            return 0;
+        memcpy(term, text, sign - text);
+        term[sign - text] = '\0';
+        if (!evaluate(term, final, &base, &unused) || !evaluate(sign + 1, final, &offset, &unused))
+            return 0;
+        *value = (uint16_t)(*sign == '+' ? base + offset : base - offset);
+        return 1;
+    }
+    if (*text == '$') {
+        *value = (uint16_t)strtoul(text + 1, &end, 16);
+        *numeric = 1;
+        return *end == '\0';
+    }
+    if (isdigit((unsigned char)*text)) {
+        *value = (uint16_t)strtoul(text, &end, 0);
+        *numeric = 1;
+        return *end == '\0';
+    }
+    if (m6803_lookup(text, value))
+        return 1;
+    *value = 0;
+    return !final;
+}
+
+// Two passes over the source; the second writes the code at origin
+static int assemble(uint8_t* memory, char lines[][128], int count, uint16_t origin, int final)
+{
+    uint16_t pc = origin;
+    int n;
+
+    for (n = 0; n < count; n++) {
+        char text[128], label[32], name[16], operand[64];
+        char* p;
+        uint16_t value = 0;
+        int op, mode, numeric = 0, opcode, size, i;
+
+        strcpy(text, lines[n]);
+        if ((p = strchr(text, ';')))
+            *p = '\0';
+        label[0] = name[0] = operand[0] = '\0';
+        p = text;
+        if (*p && !isspace((unsigned char)*p)) {
+            for (i = 0; *p && *p != ':' && !isspace((unsigned char)*p) && i < 31; i++)
+                label[i] = *p++;
+            label[i] = '\0';
+            if (*p == ':')
+                p++;
+            if (!final)
+                m6803_define(label, pc);
+        }
+        if (sscanf(p, "%15s %63s", name, operand) < 1)
+            continue;
+
+        // Data; the other directives (segments, exports) change nothing here
+        if (!strcmp(name, ".word") || !strcmp(name, ".byte")) {
+            if (!evaluate(operand, final, &value, &numeric)) {
+                fprintf(stderr, "m6803: line %d: undefined %s\n", n + 1, operand);
+                return -1;
+            }
+            if (name[1] == 'w') {
+                if (final)
+                    m6803_write16(memory, pc, value);
+                pc += 2;
+            } else {
+                if (final)
+                    memory[pc] = (uint8_t)value;
+                pc++;
+            }
+            continue;
+        }
+        if (name[0] == '.')
+            continue;
+
+        for (i = 0; i < (int)(sizeof(aliases) / sizeof(aliases[0])); i++)
+            if (!strcmp(name, aliases[i][0]))
+                strcpy(name, aliases[i][1]);
+        for (op = 0; op < OP_COUNT && strcmp(insns[op].name, name); op++)
+            ;
+        if (op == OP_COUNT) {
+            fprintf(stderr, "m6803: line %d: unknown instruction %s\n", n + 1, name);
+            return -1;
+        }
+
+        if (!operand[0]) {
+            mode = M_INH;
+        } else if (insns[op].opcode[M_REL] >= 0) {
+            mode = M_REL;
+        } else if (operand[0] == '#') {
+            mode = M_IMM;
+            memmove(operand, operand + 1, strlen(operand));
+        } else if ((p = strstr(operand, ",x"))) {
+            mode = M_IDX;
+            *p = '\0';
+        } else {
+            mode = M_EXT;
+        }
+        if (!evaluate(mode == M_INH ? "0" : operand, final, &value, &numeric)) {
+            fprintf(stderr, "m6803: line %d: undefined %s\n", n + 1, operand);
+            return -1;
+        }
+        // Numbers below 0x100 are direct page addresses, as in as68
+        if (mode == M_EXT && numeric && value < 0x100 && insns[op].opcode[M_DIR] >= 0)
+            mode = M_DIR;
+        opcode = insns[op].opcode[mode];
+        if (opcode < 0) {
+            fprintf(stderr, "m6803: line %d: %s has no such addressing mode\n", n + 1, name);
+            return -1;
+        }
+
+        size = mode == M_INH ? 1 : mode == M_EXT || (mode == M_IMM && insns[op].wide) ? 3 : 2;
+        if (final) {
+            memory[pc] = (uint8_t)opcode;
+            if (mode == M_REL) {
+                int offset = (int)value - (pc + 2);
+
+                if (offset < -128 || offset > 127) {
+                    fprintf(stderr, "m6803: line %d: branch out of range\n", n + 1);
+                    return -1;
+                }
+                memory[pc + 1] = (uint8_t)offset;
+            } else if (size == 3) {
+                m6803_write16(memory, pc + 1, value);
+            } else if (size == 2) {
+                memory[pc + 1] = (uint8_t)value;
+            }
+        }
+        pc += size;
+    }
+    return pc - origin;
+}
+
+int m6803_assemble(uint8_t* memory, const char* path, uint16_t origin)
+{
+    static char lines[MAX_LINES][128];
+    FILE* f = fopen(path, "r");
+    int count = 0;
+
+    if (!f) {
+        fprintf(stderr, "m6803: cannot read %s\n", path);
+        return -1;
+    }
+    while (count < MAX_LINES && fgets(lines[count], sizeof(lines[0]), f)) {
+        lines[count][strcspn(lines[count], "\r\n")] = '\0';
+        count++;
+    }
+    fclose(f);
+
+    if (assemble(memory, lines, count, origin, 0) < 0)
+        return -1;
+    return assemble(memory, lines, count, origin, 1);
+}
+
+/************************************************************/
+/* 6803                                                     */
+/************************************************************/
+
+static void flags8(m6803_t* cpu, uint8_t value)
+{
+    cpu->n = value >> 7;
+    cpu->z = value == 0;
+    cpu->v = 0;
+}
+
+static void flags16(m6803_t* cpu, uint16_t value)
+{
+    cpu->n = value >> 15;
+    cpu->z = value == 0;
+    cpu->v = 0;
+}
+
+static uint8_t add8(m6803_t* cpu, uint8_t a, uint8_t m)
+{
+    uint16_t r = (uint16_t)(a + m);
+
+    cpu->c = r > 0xFF;
+    cpu->v = ((a ^ r) & (m ^ r) & 0x80) != 0;
+    cpu->n = (r >> 7) & 1;
+    cpu->z = (uint8_t)r == 0;
+    return (uint8_t)r;
+}
+
+static uint8_t sub8(m6803_t* cpu, uint8_t a, uint8_t m)
+{
+    uint8_t r = (uint8_t)(a - m);
+
+    cpu->c = a < m;
+    cpu->v = ((a ^ m) & (a ^ r) & 0x80) != 0;
+    cpu->n = r >> 7;
+    cpu->z = r == 0;
+    return r;
+}
+
+static uint16_t sub16(m6803_t* cpu, uint16_t a, uint16_t m)
+{
+    uint16_t r = (uint16_t)(a - m);
+
+    cpu->c = a < m;
+    cpu->v = ((a ^ m) & (a ^ r) & 0x8000) != 0;
+    cpu->n = r >> 15;
+    cpu->z = r == 0;
+    return r;
+}
+
+// Shifts and rotates: V is N xor C after the operation
+static uint8_t shift8(m6803_t* cpu, int op, uint8_t m)
+{
+    uint8_t carry = cpu->c;
+
+    switch (op) {
+    case OP_ASL: case OP_ASLA: case OP_ASLB: cpu->c = m >> 7; m = (uint8_t)(m << 1); break;
+    case OP_LSR: case OP_LSRA: case OP_LSRB: cpu->c = m & 1; m >>= 1; break;
+    case OP_ROL: case OP_ROLA: case OP_ROLB: cpu->c = m >> 7; m = (uint8_t)(m << 1 | carry); break;
+    default: cpu->c = m & 1; m = (uint8_t)(m >> 1 | carry << 7); break;
+    }
+    cpu->n = m >> 7;
+    cpu->z = m == 0;
+    cpu->v = cpu->n ^ cpu->c;
+    return m;
+}
+
+int m6803_run(m6803_t* cpu, uint16_t address, uint16_t stop, uint32_t max_steps)
+{
+    uint8_t* ram = cpu->memory;
+    uint32_t steps;
+
+    if (!decode_ready)
+        decode_init();
+    cpu->pc = address;
+
+    for (steps = 0; steps < max_steps; steps++) {
+        uint8_t opcode;
+        int op, mode;
+        uint16_t ea = 0, d;
+        uint8_t m = 0;
+
+        if (cpu->pc == stop)
+            return 0;
+        opcode = ram[cpu->pc];
+        op = decode[opcode].op;
+        mode = decode[opcode].mode;
+        if (op < 0) {
+            fprintf(stderr, "m6803: illegal opcode %02X at %04X\n", opcode, cpu->pc);
+            return -1;
+        }
+        cpu->cycles += insns[op].cycles[mode];
+        cpu->pc++;
+
+        switch (mode) {
+        case M_IMM:
+            ea = cpu->pc;
+            cpu->pc += insns[op].wide ? 2 : 1;
+            break;
+        case M_DIR: ea = ram[cpu->pc++]; break;
+        case M_IDX: ea = (uint16_t)(cpu->x + ram[cpu->pc++]); break;
+        case M_EXT: ea = m6803_read16(ram, cpu->pc); cpu->pc += 2; break;
+        case M_REL: ea = (uint16_t)(cpu->pc + 1 + (int8_t)ram[cpu->pc]); cpu->pc++; break;
+        default: break;
+        }
+        if (mode != M_INH && mode != M_REL)
+            m = ram[ea];
+        d = (uint16_t)(cpu->a << 8 | cpu->b);
+
+        switch (op) {
+        case OP_LDAA: cpu->a = m; flags8(cpu, m); break;
+        case OP_LDAB: cpu->b = m; flags8(cpu, m); break;
+        case OP_LDD:
+            d = m6803_read16(ram, ea);
+            cpu->a = (uint8_t)(d >> 8);
+            cpu->b = (uint8_t)d;
+            flags16(cpu, d);
+            break;
+        case OP_LDX: cpu->x = m6803_read16(ram, ea); flags16(cpu, cpu->x); break;
+        case OP_STAA: ram[ea] = cpu->a; flags8(cpu, cpu->a); break;
+        case OP_STAB: ram[ea] = cpu->b; flags8(cpu, cpu->b); break;
+        case OP_STD: m6803_write16(ram, ea, d); flags16(cpu, d); break;
+        case OP_STX: m6803_write16(ram, ea, cpu->x); flags16(cpu, cpu->x); break;
+        case OP_ADDA: cpu->a = add8(cpu, cpu->a, m); break;
+        case OP_ADDB: cpu->b = add8(cpu, cpu->b, m); break;
+        case OP_ADDD: {
+            uint32_t r = (uint32_t)d + m6803_read16(ram, ea);
+
+            cpu->c = r > 0xFFFF;
+            cpu->a = (uint8_t)(r >> 8);
+            cpu->b = (uint8_t)r;
+            cpu->n = (r >> 15) & 1;
+            cpu->z = (uint16_t)r == 0;
+            break;
+        }
+        case OP_SUBA: cpu->a = sub8(cpu, cpu->a, m); break;
+        case OP_SUBB: cpu->b = sub8(cpu, cpu->b, m); break;
+        case OP_SUBD:
+            d = sub16(cpu, d, m6803_read16(ram, ea));
+            cpu->a = (uint8_t)(d >> 8);
+            cpu->b = (uint8_t)d;
+            break;
+        case OP_ANDA: cpu->a &= m; flags8(cpu, cpu->a); break;
+        case OP_ANDB: cpu->b &= m; flags8(cpu, cpu->b); break;
+        case OP_ORAA: cpu->a |= m; flags8(cpu, cpu->a); break;
+        case OP_ORAB: cpu->b |= m; flags8(cpu, cpu->b); break;
+        case OP_EORA: cpu->a ^= m; flags8(cpu, cpu->a); break;
+        case OP_EORB: cpu->b ^= m; flags8(cpu, cpu->b); break;
+        case OP_CMPA: sub8(cpu, cpu->a, m); break;
+        case OP_CMPB: sub8(cpu, cpu->b, m); break;
+        case OP_CPX: sub16(cpu, cpu->x, m6803_read16(ram, ea)); break;
+        case OP_TST: flags8(cpu, m); cpu->c = 0; break;
+        case OP_DEC: ram[ea] = --m; cpu->n = m >> 7; cpu->z = m == 0; break;
+        case OP_INC: ram[ea] = ++m; cpu->n = m >> 7; cpu->z = m == 0; break;
+        case OP_CLR: ram[ea] = 0; flags8(cpu, 0); cpu->c = 0; break;
+        case OP_ASL: case OP_LSR: case OP_ROL: case OP_ROR: ram[ea] = shift8(cpu, op, m); break;
+        case OP_ABX: cpu->x = (uint16_t)(cpu->x + cpu->b); break;
+        case OP_MUL:
+            d = (uint16_t)(cpu->a * cpu->b);
+            cpu->a = (uint8_t)(d >> 8);
+            cpu->b = (uint8_t)d;
+            cpu->c = (cpu->b >> 7) & 1;
+            break;
+        case OP_TAB: cpu->b = cpu->a; flags8(cpu, cpu->b); break;
+        case OP_TBA: cpu->a = cpu->b; flags8(cpu, cpu->a); break;
+        case OP_CBA: sub8(cpu, cpu->a, cpu->b); break;
+        case OP_LSRA: case OP_ASLA: case OP_ROLA: case OP_RORA: cpu->a = shift8(cpu, op, cpu->a); break;
+        case OP_LSRB: case OP_ASLB: case OP_ROLB: case OP_RORB: cpu->b = shift8(cpu, op, cpu->b); break;
+        case OP_LSRD:
+        case OP_ASLD:
+            cpu->c = op == OP_LSRD ? d & 1 : d >> 15;
+            d = op == OP_LSRD ? d >> 1 : (uint16_t)(d << 1);
+            cpu->a = (uint8_t)(d >> 8);
+            cpu->b = (uint8_t)d;
+            cpu->n = d >> 15;
+            cpu->z = d == 0;
+            cpu->v = cpu->n ^ cpu->c;
+            break;
+        case OP_NEGA: cpu->a = sub8(cpu, 0, cpu->a); break;
+        case OP_NEGB: cpu->b = sub8(cpu, 0, cpu->b); break;
+        case OP_SEC: cpu->c = 1; break;
+        case OP_CLC: cpu->c = 0; break;
+        case OP_SEI: cpu->i = 1; break;
+        case OP_CLI: cpu->i = 0; break;
+        case OP_TPA:
+            cpu->a = (uint8_t)(0xC0 | cpu->i << 4 | cpu->n << 3 | cpu->z << 2 | cpu->v << 1 | cpu->c);
+            break;
+        case OP_TAP:
+            cpu->i = (cpu->a >> 4) & 1;
+            cpu->n = (cpu->a >> 3) & 1;
+            cpu->z = (cpu->a >> 2) & 1;
+            cpu->v = (cpu->a >> 1) & 1;
+            cpu->c = cpu->a & 1;
+            break;
+        case OP_INCA: cpu->a++; cpu->n = cpu->a >> 7; cpu->z = cpu->a == 0; break;
+        case OP_INCB: cpu->b++; cpu->n = cpu->b >> 7; cpu->z = cpu->b == 0; break;
+        case OP_DECA: cpu->a--; cpu->n = cpu->a >> 7; cpu->z = cpu->a == 0; break;
+        case OP_DECB: cpu->b--; cpu->n = cpu->b >> 7; cpu->z = cpu->b == 0; break;
+        case OP_TSTA: flags8(cpu, cpu->a); cpu->c = 0; break;
+        case OP_TSTB: flags8(cpu, cpu->b); cpu->c = 0; break;
+        case OP_CLRA: cpu->a = 0; flags8(cpu, 0); cpu->c = 0; break;
+        case OP_CLRB: cpu->b = 0; flags8(cpu, 0); cpu->c = 0; break;
+        case OP_INX: cpu->x++; cpu->z = cpu->x == 0; break;
+        case OP_DEX: cpu->x--; cpu->z = cpu->x == 0; break;
+        case OP_INS: cpu->sp++; break;
+        case OP_DES: cpu->sp--; break;
+        case OP_LDS: cpu->sp = m6803_read16(ram, ea); flags16(cpu, cpu->sp); break;
+        case OP_STS: m6803_write16(ram, ea, cpu->sp); flags16(cpu, cpu->sp); break;
+        case OP_PSHA: ram[cpu->sp--] = cpu->a; break;
+        case OP_PSHB: ram[cpu->sp--] = cpu->b; break;
+        case OP_PULA: cpu->a = ram[++cpu->sp]; break;
+        case OP_PULB: cpu->b = ram[++cpu->sp]; break;
+        case OP_PSHX: m6803_write16(ram, cpu->sp - 1, cpu->x); cpu->sp -= 2; break;
+        case OP_PULX: cpu->x = m6803_read16(ram, cpu->sp + 1); cpu->sp += 2; break;
+        case OP_RTS: cpu->pc = m6803_read16(ram, cpu->sp + 1); cpu->sp += 2; break;
+        case OP_JSR:
+        case OP_BSR:
+            m6803_write16(ram, cpu->sp - 1, cpu->pc);
+            cpu->sp -= 2;
+            cpu->pc = ea;
+            break;
+        case OP_JMP: cpu->pc = ea; break;
+        case OP_BRA: cpu->pc = ea; break;
+        case OP_BHI: if (!cpu->c && !cpu->z) cpu->pc = ea; break;
+        case OP_BLS: if (cpu->c || cpu->z) cpu->pc = ea; break;
+        case OP_BHS: if (!cpu->c) cpu->pc = ea; break;
+        case OP_BLO: if (cpu->c) cpu->pc = ea; break;
+        case OP_BNE: if (!cpu->z) cpu->pc = ea; break;
+        case OP_BEQ: if (cpu->z) cpu->pc = ea; break;
+        case OP_BPL: if (!cpu->n) cpu->pc = ea; break;
+        case OP_BMI: if (cpu->n) cpu->pc = ea; break;
+        default: break;
+        }
+    }
+    fprintf(stderr, "m6803: %04X not reached from %04X after %u steps\n", stop, address, max_steps);
+    return -1;
+}
+
+// The return address is one no code uses
+#define RETURN_ADDR 0xFFFF
+
+int m6803_call(m6803_t* cpu, uint16_t address, uint16_t stack, uint32_t max_steps)
+{
+    cpu->sp = stack;
+    m6803_write16(cpu->memory, cpu->sp - 1, RETURN_ADDR);
+    cpu->sp -= 2;
+    cpu->cycles = 0;
+    return m6803_run(cpu, address, RETURN_ADDR, max_steps);
+}
@@ -0,0 +1,38 @@
+/* m6803.h - 6803 model for the assembly tests                     */
+/* A two-pass assembler for the subset of as68 the hand-written     */
+/* .s files use, and an interpreter with the 6803 cycle counts.    */
+/* Both work on a 64K memory the caller owns.                       */
+
+#ifndef TESTS_M6803_H
+#define TESTS_M6803_H
+
+#include <stdint.h>
+
+typedef struct m6803_t {
+    uint8_t* memory;                /* 64K */
+    uint8_t a, b;
+    uint16_t x, sp, pc;
+    uint8_t i, n, z, v, c;          /* Condition codes */
+    uint64_t cycles;
+} m6803_t;
+
+/* Symbols the source uses without defining them (tables, externs) */
+void m6803_define(const char* name, uint16_t value);
+int m6803_lookup(const char* name, uint16_t* value);
+
+/* Assembles path into memory at origin, labels become symbols;
+ * returns the code size or -1 (errors on stderr) */
+int m6803_assemble(uint8_t* memory, const char* path, uint16_t origin);
+
+/* Runs from address until the program counter reaches stop, returns
+ * 0 or -1 on an illegal opcode or after max_steps instructions */
+int m6803_run(m6803_t* cpu, uint16_t address, uint16_t stop, uint32_t max_steps);
+
+/* Calls the subroutine at address with the stack at stack, until its
+ * RTS; cpu->cycles counts from the call */
+int m6803_call(m6803_t* cpu, uint16_t address, uint16_t stack, uint32_t max_steps);
+
+uint16_t m6803_read16(const uint8_t* memory, uint16_t address);
+void m6803_write16(uint8_t* memory, uint16_t address, uint16_t value);
+
+#endif /* TESTS_M6803_H */
@@ -0,0 +1,441 @@
+/* test_mock.c - Counting mock of the Alice and PHC-25 hardware */
+/* Built with -finstrument-functions: entering one of the display  */
+/* hooks is how an access gets attributed to it, so the platform   */
+/* code needs no markers.                                           */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../platform.h"
+#include "../host/engine.h"
+#include "../host/histogram.h"
+#include "../host/ef9345.h"
+#include "../host/zx0.h"
+#include "../host/tape.h"
+
+#define MOCK_NO_INSTRUMENT __attribute__((no_instrument_function))
+
+#define MOCK_OUTSIDE 6              /* Not inside any display hook */
+#define MOCK_HOOKS 7
+#define MOCK_SITES 64
+
+/* Alice memory map beyond the EF9345 */
+#define ALICE_CLOCK 0x0008
+#define ALICE_COUNTER 0x0009        /* Free-running, high byte then low */
+#define ALICE_COUNTER_LOW 0x000A
+#define ALICE_CYCLES_PER_ACCESS 5   /* The load or store and its share of the code around it */
+#define ALICE_KEYBOARD 0xBFFF
+#define ALICE_TICK_READS 8          /* Clock reads per tick */
+
+/* PHC-25 Mode 12 screen */
+#define PHC25_VRAM_END (VRAM_START + 6144)
+
+typedef struct mock_counters_t {
+    uint64_t writes;
+    uint64_t reads;
+    uint64_t busy_polls;            /* EF9345 status reads */
+    uint64_t ports;                 /* PHC-25 port accesses */
+    uint64_t touched;               /* Distinct VRAM bytes (PHC-25) or screen cells (Alice) per frame */
+} mock_counters_t;
+
+typedef struct mock_site_t {
+    const char* function;
+    uint8_t hook;
+    mock_counters_t total;
+} mock_site_t;
+
+typedef struct mock_hook_t {
+    const char* name;
+    void (*address)(void);
+    uint64_t calls;
+    uint64_t frames;
+    uint32_t frame_calls;
+    mock_counters_t total;
+    mock_counters_t frame;
+    histogram_t writes;             /* Per frame the hook ran in */
+    histogram_t touched;
+    histogram_t busy_polls;
+} mock_hook_t;
+
+typedef struct mock_call_t {
+    const char* name;
+    void (*address)(void);
+    uint64_t calls;
+    uint32_t frame_calls;
+    histogram_t per_frame;
+} mock_call_t;
+
+uint8_t mock_ram[65536];
+
+static mock_hook_t hooks[MOCK_HOOKS] = {
+    { "display_sync_playfield", (void (*)(void))display_sync_playfield },
+    { "display_sync_ui", (void (*)(void))display_sync_ui },
+    { "display_preview_piece", (void (*)(void))display_preview_piece },
+    { "display_clear_screen", (void (*)(void))display_clear_screen },
+    { "display_draw_borders", (void (*)(void))display_draw_borders },
+    { "display_game_over", (void (*)(void))display_game_over },
+    { "(outside the hooks)", NULL }
+};
+static uint8_t active = MOCK_OUTSIDE;
+
+/* The per-frame helpers, counted wherever they are called */
+static mock_call_t counted[] = {
+    { "playfield_set_cell", (void (*)(void))playfield_set_cell },
+    { "playfield_get_cell", (void (*)(void))playfield_get_cell },
+    { "playfield_is_empty_cell", (void (*)(void))playfield_is_empty_cell },
+#ifdef PHC25
+    { "draw_tetris_block_pattern", (void (*)(void))draw_tetris_block_pattern },
+    { "erase_tetris_block", (void (*)(void))erase_tetris_block },
+#endif
+};
+#define MOCK_COUNTED (sizeof(counted) / sizeof(counted[0]))
+
+static mock_site_t sites[MOCK_SITES];
+static uint32_t site_count = 0;
+static mock_site_t* last_site = NULL;
+
+static uint32_t frame_id = 1;
+static uint64_t frames = 0;
+
+static uint32_t clock_reads = 0;
+#ifdef ALICE
+static uint16_t counter;            /* E cycles, advanced by every bus access */
+static uint8_t counter_latch;
+static uint8_t counter_latched;
+#endif
+static ef9345_t vdp;
+
+/* Frame in which each hook last touched a screen cell or a VRAM byte */
+#ifdef ALICE
+static uint32_t touched_at[MOCK_HOOKS][EF9345_LINES * EF9345_COLUMNS];
+#else
+static uint32_t touched_at[MOCK_HOOKS][65536];
+#endif
+
+/************************************************************/
+/* Attribution                                              */
+/************************************************************/
+
+MOCK_NO_INSTRUMENT void __cyg_profile_func_enter(void* function, void* call_site);
+MOCK_NO_INSTRUMENT void __cyg_profile_func_exit(void* function, void* call_site);
+
+// The outermost display hook owns everything below it
+void __cyg_profile_func_enter(void* function, void* call_site)
+{
+    uint8_t i;
+
+    (void)call_site;
+    for (i = 0; i < MOCK_COUNTED; i++) {
+        if ((void*)counted[i].address == function) {
+            counted[i].calls++;
+            counted[i].frame_calls++;
+            break;
+        }
+    }
+    if (active != MOCK_OUTSIDE)
+        return;
+    for (i = 0; i < MOCK_OUTSIDE; i++) {
+        if ((void*)hooks[i].address == function) {
+            active = i;
+            hooks[i].calls++;
+            hooks[i].frame_calls++;
+            return;
+        }
+    }
+}
+
+void __cyg_profile_func_exit(void* function, void* call_site)
+{
+    (void)call_site;
+    if (active != MOCK_OUTSIDE && (void*)hooks[active].address == function)
+        active = MOCK_OUTSIDE;
+}
+
+// __func__ strings are unique per function, compare the pointers
+MOCK_NO_INSTRUMENT static mock_site_t* site(const char* function)
+{
+    uint32_t i;
+
+    if (last_site && last_site->function == function && last_site->hook == active)
+        return last_site;
+    for (i = 0; i < site_count; i++)
+        if (sites[i].function == function && sites[i].hook == active)
+            return last_site = &sites[i];
+    if (site_count == MOCK_SITES) {
+        fprintf(stderr, "mock: more than %d call sites\n", MOCK_SITES);
+        exit(1);
+    }
+    sites[site_count].function = function;
+    sites[site_count].hook = active;
+    return last_site = &sites[site_count++];
+}
+
+MOCK_NO_INSTRUMENT static void count_touch(mock_site_t* s, uint32_t* stamp)
+{
+    if (*stamp == frame_id)
+        return;
+    *stamp = frame_id;
+    s->total.touched++;
+    hooks[active].frame.touched++;
+}
+
+/************************************************************/
+/* Bus                                                      */
+/************************************************************/
+
+MOCK_NO_INSTRUMENT void mock_poke(uint16_t address, uint8_t value, const char* caller)
+{
+    mock_site_t* s = site(caller);
+
+    s->total.writes++;
+    hooks[active].frame.writes++;
+
+#ifdef ALICE
+    counter += ALICE_CYCLES_PER_ACCESS;
+    if (address >= R0 && address <= R0EXEC) {
+        // A character write lands at the main pointer before it moves
+        if (address == R0EXEC && vdp.r[7] < EF9345_COLUMNS)
+            count_touch(s, &touched_at[active][(vdp.r[6] & 31) * EF9345_COLUMNS + vdp.r[7]]);
+        ef9345_poke(&vdp, address, value);
+        return;
+    }
+#else
+    if (address >= VRAM_START && address < PHC25_VRAM_END)
+        count_touch(s, &touched_at[active][address]);
+#endif
+    mock_ram[address] = value;
+}
+
+MOCK_NO_INSTRUMENT uint8_t mock_peek(uint16_t address, const char* caller)
+{
+    mock_site_t* s = site(caller);
+
+#ifdef ALICE
+    counter += ALICE_CYCLES_PER_ACCESS;
+
+    // Never busy, but every poll is a bus cycle on the machine
+    if (address == R0) {
+        s->total.busy_polls++;
+        hooks[active].frame.busy_polls++;
+        return 0;
+    }
+    s->total.reads++;
+    hooks[active].frame.reads++;
+    switch (address) {
+    case ALICE_CLOCK:
+        return ++clock_reads % ALICE_TICK_READS ? 0 : 0x20;
+    case ALICE_COUNTER:
+        // Holds the low byte for the next read of it, as the 6803 does
+        counter_latch = (uint8_t)counter;
+        counter_latched = 1;
+        return (uint8_t)(counter >> 8);
+    case ALICE_COUNTER_LOW:
+        if (counter_latched) {
+            counter_latched = 0;
+            return counter_latch;
+        }
+        return (uint8_t)counter;
+    case ALICE_KEYBOARD:
+        return 0xFF;
+    }
+#else
+    s->total.reads++;
+    hooks[active].frame.reads++;
+    if (address >= VRAM_START && address < PHC25_VRAM_END)
+        count_touch(s, &touched_at[active][address]);
+#endif
+    return mock_ram[address];
+}
+
+#ifdef PHC25
+MOCK_NO_INSTRUMENT void out_port(uint8_t port, uint8_t value)
+{
+    mock_site_t* s = site(__func__);
+
+    (void)port;
+    (void)value;
+    s->total.ports++;
+    hooks[active].frame.ports++;
+}
+
+// No key pressed: every matrix line reads high
+MOCK_NO_INSTRUMENT uint8_t in_port(uint8_t port)
+{
+    mock_site_t* s = site(__func__);
+
+    (void)port;
+    s->total.ports++;
+    hooks[active].frame.ports++;
+    return 0xFF;
+}
+
+// The decompressor writes a byte at a time; the stream is read from
+// the block in mock RAM
+MOCK_NO_INSTRUMENT void decompress_asset(uint16_t stream, uint16_t destination)
+{
+    static uint8_t bitmap[VRAM_SIZE];
+    long size, i;
+
+    size = zx0_decompress(&mock_ram[stream], sizeof(mock_ram) - stream, bitmap, sizeof(bitmap));
+    if (size < 0) {
+        fprintf(stderr, "mock: no ZX0 stream at 0x%04X\n", stream);
+        exit(1);
+    }
+    for (i = 0; i < size; i++)
+        mock_poke((uint16_t)(destination + i), bitmap[i], __func__);
+}
+#endif
+
+/************************************************************/
+/* Runs and reports                                         */
+/************************************************************/
+
+MOCK_NO_INSTRUMENT int mock_open(uint32_t seed, const char* gfx_dir)
+{
+    uint8_t i;
+#ifdef PHC25
+    static assets_t bank;
+    const char* error;
+    char path[512];
+    long size;
+#else
+    (void)gfx_dir;
+#endif
+
+    memset(mock_ram, 0, sizeof(mock_ram));
+#ifdef PHC25
+    // The block tetrice_pack -a writes, where the program would link it
+    snprintf(path, sizeof(path), "%s/assets.bin", gfx_dir);
+    if (assets_load(path, &bank))
+        return -1;
+    size = tape_pack_assets(&bank, &mock_ram[MOCK_ASSETS_ADDR], PHC25_SCRATCH_ADDR - MOCK_ASSETS_ADDR, &error);
+    if (size < 0) {
+        fprintf(stderr, "mock: %s\n", error);
+        return -1;
+    }
+#endif
+    ef9345_reset(&vdp);
+    clock_reads = 0;
+#ifdef ALICE
+    counter = (uint16_t)((seed * 2654435761u) >> 16);
+    counter_latched = 0;
+#else
+    (void)seed;
+#endif
+    for (i = 0; i < MOCK_HOOKS; i++) {
+        memset(&hooks[i].total, 0, sizeof(hooks[i].total));
+        memset(&hooks[i].frame, 0, sizeof(hooks[i].frame));
+        hooks[i].calls = hooks[i].frames = 0;
+        hooks[i].frame_calls = 0;
+        histogram_reset(&hooks[i].writes);
+        histogram_reset(&hooks[i].touched);
+        histogram_reset(&hooks[i].busy_polls);
+    }
+    for (i = 0; i < MOCK_COUNTED; i++) {
+        counted[i].calls = 0;
+        counted[i].frame_calls = 0;
+        histogram_reset(&counted[i].per_frame);
+    }
+    site_count = 0;
+    last_site = NULL;
+    frames = 0;
+    active = MOCK_OUTSIDE;
+    return 0;
+}
+
+MOCK_NO_INSTRUMENT const ef9345_t* mock_vdp(void)
+{
+    return &vdp;
+}
+
+MOCK_NO_INSTRUMENT void mock_frame_begin(void)
+{
+    uint8_t i;
+
+    frame_id++;
+    for (i = 0; i < MOCK_HOOKS; i++) {
+        memset(&hooks[i].frame, 0, sizeof(hooks[i].frame));
+        hooks[i].frame_calls = 0;
+    }
+    for (i = 0; i < MOCK_COUNTED; i++)
+        counted[i].frame_calls = 0;
+}
+
+MOCK_NO_INSTRUMENT void mock_frame_end(void)
+{
+    mock_hook_t* h;
+    uint8_t i;
+
+    frames++;
+    for (i = 0; i < MOCK_HOOKS; i++) {
+        h = &hooks[i];
+        if (!h->frame_calls && !h->frame.writes && !h->frame.reads && !h->frame.busy_polls && !h->frame.ports)
+            continue;
+        h->frames++;
+        h->total.writes += h->frame.writes;
+        h->total.reads += h->frame.reads;
+        h->total.busy_polls += h->frame.busy_polls;
+        h->total.ports += h->frame.ports;
+        h->total.touched += h->frame.touched;
+        histogram_add(&h->writes, h->frame.writes);
+        histogram_add(&h->touched, h->frame.touched);
+        histogram_add(&h->busy_polls, h->frame.busy_polls);
+    }
+    for (i = 0; i < MOCK_COUNTED; i++)
+        histogram_add(&counted[i].per_frame, counted[i].frame_calls);
+}
+
+MOCK_NO_INSTRUMENT void mock_report(FILE* out)
+{
+    const mock_hook_t* h;
+    const mock_site_t* s;
+    uint8_t i;
+    uint32_t j;
+
+#ifdef ALICE
+    fprintf(out, "%llu frames on the Alice mock, touched = EF9345 screen cells written\n",
+            (unsigned long long)frames);
+#else
+    fprintf(out, "%llu frames on the PHC-25 mock, touched = distinct VRAM bytes\n", (unsigned long long)frames);
+#endif
+    fprintf(out, "%-24s %7s %7s %9s %9s %9s %6s %8s | %-22s | %-22s\n", "hook", "calls", "frames", "writes",
+            "reads", "busy", "ports", "touched", "writes/frame p50 p99 max", "touched/frame p50 p99 max");
+    for (i = 0; i < MOCK_HOOKS; i++) {
+        h = &hooks[i];
+        if (!h->frames)
+            continue;
+        fprintf(out, "%-24s %7llu %7llu %9llu %9llu %9llu %6llu %8llu | %6llu %6llu %8llu | %6llu %6llu %8llu\n",
+                h->name, (unsigned long long)h->calls, (unsigned long long)h->frames,
+                (unsigned long long)h->total.writes, (unsigned long long)h->total.reads,
+                (unsigned long long)h->total.busy_polls, (unsigned long long)h->total.ports,
+                (unsigned long long)h->total.touched, (unsigned long long)histogram_percentile(&h->writes, 50),
+                (unsigned long long)histogram_percentile(&h->writes, 99), (unsigned long long)h->writes.max,
+                (unsigned long long)histogram_percentile(&h->touched, 50),
+                (unsigned long long)histogram_percentile(&h->touched, 99), (unsigned long long)h->touched.max);
+    }
+
+    fprintf(out, "\n%-24s %-24s %9s %9s %9s %6s %8s\n", "hook", "function", "writes", "reads", "busy", "ports",
+            "touched");
+    for (i = 0; i < MOCK_HOOKS; i++) {
+        for (j = 0; j < site_count; j++) {
+            s = &sites[j];
+            if (s->hook != i)
+                continue;
+            fprintf(out, "%-24s %-24s %9llu %9llu %9llu %6llu %8llu\n", hooks[i].name, s->function,
+                    (unsigned long long)s->total.writes, (unsigned long long)s->total.reads,
+                    (unsigned long long)s->total.busy_polls, (unsigned long long)s->total.ports,
+                    (unsigned long long)s->total.touched);
+        }
+    }
+
+    // Read by tools/call_cost.py
+    fprintf(out, "\n%-26s %9s %9s %6s %6s %6s\n", "hot helper", "calls", "per frame", "p50", "p99", "max");
+    for (i = 0; i < MOCK_COUNTED; i++) {
+        const mock_call_t* c = &counted[i];
+
+        fprintf(out, "%-26s %9llu %9.2f %6llu %6llu %6llu\n", c->name, (unsigned long long)c->calls,
+                histogram_mean(&c->per_frame), (unsigned long long)histogram_percentile(&c->per_frame, 50),
+                (unsigned long long)histogram_percentile(&c->per_frame, 99), (unsigned long long)c->per_frame.max);
+    }
+}
@@ -0,0 +1,51 @@
+/* test_mock.h - Counting mock of the Alice and PHC-25 hardware */
+/* With TEST_MODE, alice.h and phc25.h take POKE and PEEK from    */
+/* here, so platform_alice.c and platform_phc25.c run unchanged   */
+/* on the host. Every access lands in a 64K mock address space    */
+/* (the EF9345 registers drive host/ef9345.c) and is counted      */
+/* against the display hook being run and the function making it. */
+
+#ifndef TEST_MOCK_H
+#define TEST_MOCK_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../host/ef9345.h"
+
+extern uint8_t mock_ram[65536];
+
+/* Where mock_open copies the PHC-25 asset block, which the program
+ * links in */
+#define MOCK_ASSETS_ADDR 0xC000
+
+/* Memory the target code reads through plain pointers */
+#define MOCK_RAM(addr) ((const uint8_t*)&mock_ram[(addr)])
+
+void mock_poke(uint16_t address, uint8_t value, const char* caller);
+uint8_t mock_peek(uint16_t address, const char* caller);
+
+#define POKE(addr, value) mock_poke((uint16_t)(addr), (uint8_t)(value), __func__)
+#define PEEK(addr) mock_peek((uint16_t)(addr), __func__)
+
+/* Start a run: clear the machine, seed the clock and random reads,
+ * gfx_dir holds the PHC-25 asset bank (assets.bin) */
+int mock_open(uint32_t seed, const char* gfx_dir);
+
+/* The EF9345 the Alice code drives, for drawing what it shows */
+const ef9345_t* mock_vdp(void);
+
+/* Everything between these two is one frame of the report */
+void mock_frame_begin(void);
+void mock_frame_end(void);
+
+/* Totals and per-frame percentiles per display hook, then the
+ * functions that made the accesses */
+void mock_report(FILE* out);
+
+#endif /* TEST_MOCK_H */
+
+/* debug_font.c includes the mock in place of phc25.h */
+#if !defined(ALICE) && !defined(PHC25_H)
+#include "../phc25.h"
+#endif
@@ -0,0 +1,143 @@
+/* traffic.c - Per-frame video traffic of a platform's display code */
+/* Links platform_alice.c or platform_phc25.c against the counting  */
+/* mock (test_mock.c) and plays scripted games through the engine:  */
+/* clear and borders, then one frame per game_step, as main() and  */
+/* gameloop() do. Prints what each display hook cost per frame.     */
+/* Built with PERF=1, the Alice frames also fill the perf.h ring,  */
+/* timed by the mock's bus-cycle counter; -d dumps the address     */
+/* space for tools/perf_ring.py. With HUD=1 the HUD is drawn after */
+/* each frame, outside the hooks.                                  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../host/engine.h"
+#include "test_mock.h"
+
+typedef struct traffic_options_t {
+    uint32_t seed;
+    uint32_t frames;
+    const char* gfx_dir;
+    const char* dump_path;
+    uint8_t verbose;
+} traffic_options_t;
+
+static uint32_t script_state;
+
+// Mostly gravity, like a player who is thinking
+static input_action_t script_input(void)
+{
+    static const input_action_t inputs[8] = {
+        INPUT_TIMEOUT, INPUT_TIMEOUT, INPUT_TIMEOUT, INPUT_MOVE_LEFT,
+        INPUT_MOVE_RIGHT, INPUT_ROTATE_CW, INPUT_ROTATE_CCW, INPUT_DROP
+    };
+
+    script_state = script_state * 1103515245u + 12345u;
+    return inputs[(script_state >> 16) & 7];
+}
+
+static void usage(void)
+{
+    printf("Usage: tetrice_traffic_<platform> [options]\n");
+    printf("  -s SEED     seed of the scripted inputs and the random reads (default 1)\n");
+    printf("  -n FRAMES   frames to play, over as many games as it takes (default 10000)\n");
+    printf("  -g DIR      PHC-25 UI bitmaps (default gfx)\n");
+    printf("  -d FILE     write the 64K mock address space to FILE at the end\n");
+    printf("  -v          one line per frame\n");
+}
+
+int main(int argc, char** argv)
+{
+    traffic_options_t options;
+    game_state_t state;
+    input_action_t input;
+    uint32_t frame = 0, games = 0;
+    uint8_t over;
+    int i;
+
+    options.seed = 1;
+    options.frames = 10000;
+    options.gfx_dir = "gfx";
+    options.dump_path = NULL;
+    options.verbose = 0;
+
+    for (i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!strcmp(argv[i], "-v")) {
+            options.verbose = 1;
+            continue;
+        }
+        if (argv[i][0] != '-' || !value || argv[i][2] != '\0') {
+            usage();
+            return 1;
+        }
+        switch (argv[i][1]) {
+        case 's': options.seed = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'n': options.frames = (uint32_t)strtoul(value, NULL, 0); break;
+        case 'g': options.gfx_dir = value; break;
+        case 'd': options.dump_path = value; break;
+        default:
+            usage();
+            return 1;
+        }
+        i++;
+    }
+
+    if (mock_open(options.seed, options.gfx_dir))
+        return 1;
+    script_state = options.seed;
+    PERF_INIT();
+
+    while (frame < options.frames) {
+        // The title screen, then the first sync of a new game
+        mock_frame_begin();
+        display_clear_screen();
+        display_draw_borders();
+        mock_frame_end();
+
+        mock_frame_begin();
+        game_start(&state);
+        display_sync_ui(&state);
+        display_preview_piece(GAME_HOT(&state)->next_piece);
+        display_sync_playfield(&state);
+        mock_frame_end();
+        games++;
+
+        over = 0;
+        while (!over && frame < options.frames) {
+            PERF_FRAME_BEGIN();
+            input = script_input();
+            PERF_INPUT_END();
+            HUD_FRAME_BEGIN();
+            mock_frame_begin();
+            over = game_step(&state, input);
+            PERF_FRAME_END();
+            HUD_FRAME_END();
+            if (over)
+                display_game_over();
+            mock_frame_end();
+            frame++;
+            if (options.verbose)
+                printf("game %u frame %u input %d score %u%s\n", games, frame, input, GAME_HOT(&state)->score,
+                       over ? " game over" : "");
+        }
+    }
+
+    printf("%u games, seed %u\n", games, options.seed);
+    mock_report(stdout);
+
+    if (options.dump_path) {
+        FILE* f = fopen(options.dump_path, "wb");
+
+        if (!f || fwrite(mock_ram, 1, sizeof(mock_ram), f) != sizeof(mock_ram)) {
+            fprintf(stderr, "traffic: cannot write %s\n", options.dump_path);
+            if (f)
+                fclose(f);
+            return 1;
+        }
+        fclose(f);
+    }
+    return 0;
+}
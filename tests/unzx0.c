@@ -0,0 +1,139 @@
+/* unzx0.c - alice_unzx0.s against host/zx0.c                      */
+/* Assembles the loader stub on the 6803 model (m6803.h) at the     */
+/* Makefile's ALICE_STUB_ADDR, packs each payload behind it with    */
+/* tape_pack as tetrice_pack does, loads the image into a memory    */
+/* filled with garbage and runs the stub until it jumps to          */
+/* ALICE_ADDR, then compares what it left there with the payload.   */
+/* Prints the cycles and the time at the Alice clock.              */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../host/tape.h"
+#include "m6803.h"
+
+#ifndef ALICE_ADDR
+#define ALICE_ADDR 14150
+#endif
+#ifndef ALICE_STUB_ADDR
+#define ALICE_STUB_ADDR 13824
+#endif
+
+#define UNZX0_CLOCK 894886          /* Alice 6803 E clock, Hz */
+#define UNZX0_STACK 0x3000          /* Below the stub, where BASIC leaves it */
+#define UNZX0_MAX_STEPS 50000000
+#define UNZX0_MAX_PAYLOAD 32768
+
+static uint8_t memory[65536];
+static uint8_t stub[65536];
+static uint8_t image[65536];
+
+// Incompressible, all zeros, and a short run, besides the files
+enum { SYNTHETIC_RANDOM, SYNTHETIC_ZEROS, SYNTHETIC_TINY, SYNTHETIC_COUNT };
+
+static size_t synthetic(int kind, uint8_t* payload)
+{
+    uint32_t rng = 1;
+    size_t i;
+
+    switch (kind) {
+    case SYNTHETIC_RANDOM:
+        for (i = 0; i < 4096; i++) {
+            rng = rng * 1103515245u + 12345u;
+            payload[i] = (uint8_t)(rng >> 16);
+        }
+        return 4096;
+    case SYNTHETIC_ZEROS:
+        memset(payload, 0, 9000);
+        return 9000;
+    default:
+        payload[0] = 0x7E;
+        return 1;
+    }
+}
+
+// Packs the payload, runs the stub, returns 0 if it rebuilt the payload
+static int check(const char* name, const uint8_t* payload, size_t size, int stub_size)
+{
+    m6803_t cpu = { memory };
+    tape_layout_t layout;
+    const char* error;
+    long image_size;
+
+    image_size = tape_pack(payload, size, ALICE_ADDR, stub, (size_t)stub_size, ALICE_STUB_ADDR, image, sizeof(image),
+                           &layout, &error);
+    if (image_size < 0) {
+        printf("%-24s %s\n", name, error);
+        return 1;
+    }
+
+    memset(memory, 0xA5, sizeof(memory));
+    memcpy(&memory[ALICE_STUB_ADDR], image, (size_t)image_size);
+    cpu.sp = UNZX0_STACK;
+    if (m6803_run(&cpu, ALICE_STUB_ADDR, ALICE_ADDR, UNZX0_MAX_STEPS))
+        return 1;
+    if (memcmp(&memory[ALICE_ADDR], payload, size)) {
+        printf("%-24s %6zu bytes: decompressed image differs\n", name, size);
+        return 1;
+    }
+    printf("%-24s %6zu %6u %7.1f %9llu %6.1f %6.2f\n", name, size, layout.stream_size, 100.0 * layout.stream_size / size,
+           (unsigned long long)cpu.cycles, (double)cpu.cycles / size, (double)cpu.cycles / UNZX0_CLOCK);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    static const char* const defaults[] = {
+        "tetrice.c", "platform_alice.c", "game_font.c", "gfx/assets.bin"
+    };
+    static uint8_t payload[UNZX0_MAX_PAYLOAD];
+    const char* path = "alice_unzx0.s";
+    const char* const* files = defaults;
+    int count = (int)(sizeof(defaults) / sizeof(defaults[0]));
+    int stub_size, failures = 0, i;
+
+    if (argc > 1 && argv[1][0] == '-') {
+        printf("Usage: tetrice_unzx0 [alice_unzx0.s [FILE...]]\n");
+        return 1;
+    }
+    if (argc > 1)
+        path = argv[1];
+    if (argc > 2) {
+        files = (const char* const*)argv + 2;
+        count = argc - 2;
+    }
+
+    stub_size = m6803_assemble(memory, path, ALICE_STUB_ADDR);
+    if (stub_size < 0)
+        return 1;
+    if (ALICE_STUB_ADDR + stub_size > ALICE_ADDR) {
+        fprintf(stderr, "unzx0: %s does not fit below %u\n", path, ALICE_ADDR);
+        return 1;
+    }
+    memcpy(stub, &memory[ALICE_STUB_ADDR], (size_t)stub_size);
+
+    printf("%s: %d bytes at %u, game at %u\n", path, stub_size, ALICE_STUB_ADDR, ALICE_ADDR);
+    printf("%-24s %6s %6s %7s %9s %6s %6s\n", "payload", "bytes", "zx0", "%", "cycles", "/byte", "s");
+    for (i = 0; i < count; i++) {
+        FILE* f = fopen(files[i], "rb");
+        size_t size;
+
+        if (!f) {
+            fprintf(stderr, "unzx0: cannot read %s\n", files[i]);
+            return 1;
+        }
+        size = fread(payload, 1, sizeof(payload), f);
+        fclose(f);
+        if (size == 0)
+            continue;
+        failures += check(files[i], payload, size, stub_size);
+    }
+    for (i = 0; i < SYNTHETIC_COUNT; i++) {
+        static const char* const names[SYNTHETIC_COUNT] = { "(random)", "(zeros)", "(one byte)" };
+        size_t size = synthetic(i, payload);
+
+        failures += check(names[i], payload, size, stub_size);
+    }
+    return failures ? 1 : 0;
+}
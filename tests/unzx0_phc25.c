@@ -0,0 +1,148 @@
+/* unzx0_phc25.c - phc25_unzx0.asm against host/zx0.c             */
+/* Assembles the loader stub on the Z80 model (z80.h), packs each   */
+/* payload behind it with tape_pack_phc25 as tetrice_pack -p does,  */
+/* checks that the image has no two zero bytes in a row, loads it   */
+/* into a memory filled with garbage and runs the stub until it     */
+/* jumps to PHC25_ADDR, then compares what it left there with the   */
+/* payload. Prints the T-states and the time at the PHC-25 clock.   */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../host/tape.h"
+#include "z80.h"
+
+#ifndef PHC25_ADDR
+#define PHC25_ADDR 49296
+#endif
+#ifndef PHC25_STUB_ADDR
+#define PHC25_STUB_ADDR 49161
+#endif
+
+#define UNZX0_CLOCK 3579545         /* PHC-25 Z80 clock, Hz */
+#define UNZX0_STACK 0xFF00          /* Above the game, where BASIC leaves it */
+#define UNZX0_MAX_STEPS 50000000
+#define UNZX0_MAX_PAYLOAD 12288     /* What fits between the game and the stack */
+
+static uint8_t memory[65536];
+static uint8_t stub[65536];
+static uint8_t image[65536];
+
+// Incompressible, all zeros, and a short run, besides the files
+enum { SYNTHETIC_RANDOM, SYNTHETIC_ZEROS, SYNTHETIC_TINY, SYNTHETIC_COUNT };
+
+static size_t synthetic(int kind, uint8_t* payload)
+{
+    uint32_t rng = 1;
+    size_t i;
+
+    switch (kind) {
+    case SYNTHETIC_RANDOM:
+        for (i = 0; i < 4096; i++) {
+            rng = rng * 1103515245u + 12345u;
+            payload[i] = (uint8_t)(rng >> 16);
+        }
+        return 4096;
+    case SYNTHETIC_ZEROS:
+        memset(payload, 0, 9000);
+        return 9000;
+    default:
+        payload[0] = 0xC9;
+        return 1;
+    }
+}
+
+// Packs the payload, runs the stub, returns 0 if it rebuilt the payload
+static int check(const char* name, const uint8_t* payload, size_t size, int stub_size)
+{
+    z80_t cpu = { memory };
+    tape_layout_t layout;
+    const char* error;
+    long image_size, i;
+
+    image_size = tape_pack_phc25(payload, size, PHC25_ADDR, stub, (size_t)stub_size, PHC25_STUB_ADDR, image,
+                                 sizeof(image), &layout, &error);
+    if (image_size < 0) {
+        printf("%-24s %s\n", name, error);
+        return 1;
+    }
+    for (i = 1; i < image_size; i++) {
+        if (image[i] == 0 && image[i - 1] == 0) {
+            printf("%-24s two zero bytes at %ld\n", name, i - 1);
+            return 1;
+        }
+    }
+
+    memset(memory, 0xA5, sizeof(memory));
+    memcpy(&memory[PHC25_STUB_ADDR], image, (size_t)image_size);
+    cpu.sp = UNZX0_STACK;
+    cpu.iff = 1;
+    if (z80_run(&cpu, PHC25_STUB_ADDR, PHC25_ADDR, UNZX0_MAX_STEPS))
+        return 1;
+    if (memcmp(&memory[PHC25_ADDR], payload, size) || cpu.iff || cpu.sp != UNZX0_STACK) {
+        printf("%-24s %6zu bytes: decompressed image, interrupts or stack differ\n", name, size);
+        return 1;
+    }
+    printf("%-24s %6zu %6ld %7.1f   0x%02X %9llu %6.1f %6.2f\n", name, size, image_size, 100.0 * image_size / size,
+           layout.mask, (unsigned long long)cpu.cycles, (double)cpu.cycles / size, (double)cpu.cycles / UNZX0_CLOCK);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    static const char* const defaults[] = {
+        "platform_phc25.c", "game_font.c", "phc25_lib.asm", "gfx/assets.bin"
+    };
+    static uint8_t payload[UNZX0_MAX_PAYLOAD];
+    const char* path = "phc25_unzx0.asm";
+    const char* const* files = defaults;
+    int count = (int)(sizeof(defaults) / sizeof(defaults[0]));
+    int stub_size, failures = 0, i;
+    uint16_t origin;
+
+    if (argc > 1 && argv[1][0] == '-') {
+        printf("Usage: tetrice_unzx0_phc25 [phc25_unzx0.asm [FILE...]]\n");
+        return 1;
+    }
+    if (argc > 1)
+        path = argv[1];
+    if (argc > 2) {
+        files = (const char* const*)argv + 2;
+        count = argc - 2;
+    }
+
+    stub_size = z80_assemble(memory, path, &origin);
+    if (stub_size < 0)
+        return 1;
+    if (origin != PHC25_STUB_ADDR || PHC25_STUB_ADDR + stub_size > PHC25_ADDR) {
+        fprintf(stderr, "unzx0_phc25: %s is not at %u or does not fit below %u\n", path, PHC25_STUB_ADDR, PHC25_ADDR);
+        return 1;
+    }
+    memcpy(stub, &memory[PHC25_STUB_ADDR], (size_t)stub_size);
+
+    printf("%s: %d bytes at %u, game at %u\n", path, stub_size, PHC25_STUB_ADDR, PHC25_ADDR);
+    printf("%-24s %6s %6s %7s %6s %9s %6s %6s\n", "payload", "bytes", "image", "%", "mask", "T-states", "/byte",
+           "s");
+    for (i = 0; i < count; i++) {
+        FILE* f = fopen(files[i], "rb");
+        size_t size;
+
+        if (!f) {
+            fprintf(stderr, "unzx0_phc25: cannot read %s\n", files[i]);
+            return 1;
+        }
+        size = fread(payload, 1, sizeof(payload), f);
+        fclose(f);
+        if (size == 0)
+            continue;
+        failures += check(files[i], payload, size, stub_size);
+    }
+    for (i = 0; i < SYNTHETIC_COUNT; i++) {
+        static const char* const names[SYNTHETIC_COUNT] = { "(random)", "(zeros)", "(one byte)" };
+        size_t size = synthetic(i, payload);
+
+        failures += check(names[i], payload, size, stub_size);
+    }
+    return failures ? 1 : 0;
+}
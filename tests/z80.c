@@ -0,0 +1,592 @@
+/* z80.c - Z80 model for the assembly tests */
+/* The instructions phc25_unzx0.asm uses, with the Z80 T-states.     */
+/* Flags are the ones the stub tests: sign, zero and carry.          */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "z80.h"
+
+#define MAX_SYMBOLS 128
+#define MAX_LINES 512
+
+/************************************************************/
+/* Instruction set                                          */
+/************************************************************/
+
+/* Operands: # a byte, @ a word, % a relative jump target */
+typedef struct insn_t {
+    const char* pattern;
+    uint8_t prefix;                 /* 0xCB, 0xED or 0 */
+    uint8_t opcode;
+} insn_t;
+
+/* Register operands first: (hl) is not an address */
+static const insn_t insns[] = {
+    { "di", 0, 0xF3 },
+    { "ei", 0, 0xFB },
+    { "ld a,(hl)", 0, 0x7E },
+    { "ld c,(hl)", 0, 0x4E },
+    { "ld (de),a", 0, 0x12 },
+    { "ld (hl),a", 0, 0x77 },
+    { "ld a,b", 0, 0x78 },
+    { "ld b,c", 0, 0x41 },
+    { "ld b,h", 0, 0x44 },
+    { "ld c,l", 0, 0x4D },
+    { "ld a,(@)", 0, 0x3A },
+    { "ld (@),a", 0, 0x32 },
+    { "ld hl,(@)", 0, 0x2A },
+    { "ld bc,(@)", 0xED, 0x4B },
+    { "ld de,(@)", 0xED, 0x5B },
+    { "ld bc,@", 0, 0x01 },
+    { "ld de,@", 0, 0x11 },
+    { "ld hl,@", 0, 0x21 },
+    { "ld sp,@", 0, 0x31 },
+    { "ld a,#", 0, 0x3E },
+    { "ld c,#", 0, 0x0E },
+    { "inc bc", 0, 0x03 },
+    { "inc de", 0, 0x13 },
+    { "inc hl", 0, 0x23 },
+    { "dec bc", 0, 0x0B },
+    { "dec de", 0, 0x1B },
+    { "dec hl", 0, 0x2B },
+    { "inc c", 0, 0x0C },
+    { "add a,a", 0, 0x87 },
+    { "add hl,bc", 0, 0x09 },
+    { "add hl,de", 0, 0x19 },
+    { "sbc hl,de", 0xED, 0x52 },
+    { "or a", 0, 0xB7 },
+    { "or c", 0, 0xB1 },
+    { "xor #", 0, 0xEE },
+    { "rla", 0, 0x17 },
+    { "rl b", 0xCB, 0x10 },
+    { "rl c", 0xCB, 0x11 },
+    { "rr b", 0xCB, 0x18 },
+    { "rr c", 0xCB, 0x19 },
+    { "ex de,hl", 0, 0xEB },
+    { "ex (sp),hl", 0, 0xE3 },
+    { "push bc", 0, 0xC5 },
+    { "push de", 0, 0xD5 },
+    { "push hl", 0, 0xE5 },
+    { "pop bc", 0, 0xC1 },
+    { "pop de", 0, 0xD1 },
+    { "pop hl", 0, 0xE1 },
+    { "ldir", 0xED, 0xB0 },
+    { "lddr", 0xED, 0xB8 },
+    { "jr nz,%", 0, 0x20 },
+    { "jr z,%", 0, 0x28 },
+    { "jr nc,%", 0, 0x30 },
+    { "jr c,%", 0, 0x38 },
+    { "jr %", 0, 0x18 },
+    { "jp (hl)", 0, 0xE9 },
+    { "jp @", 0, 0xC3 },
+    { "call nc,@", 0, 0xD4 },
+    { "call @", 0, 0xCD },
+    { "ret z", 0, 0xC8 },
+    { "ret c", 0, 0xD8 },
+    { "ret", 0, 0xC9 },
+};
+#define INSN_COUNT (int)(sizeof(insns) / sizeof(insns[0]))
+
+/* Operands that are never an expression */
+static const char* const registers[] = {
+    "a", "b", "c", "d", "e", "h", "l", "af", "bc", "de", "hl", "sp", "ix", "iy", "nz", "z", "nc", "po", "pe", "p", "m",
+};
+
+/************************************************************/
+/* Assembler                                                */
+/************************************************************/
+
+typedef struct symbol_t {
+    char name[32];
+    uint16_t value;
+} symbol_t;
+
+static symbol_t symbols[MAX_SYMBOLS];
+static int symbol_count = 0;
+
+static void define(const char* name, uint16_t value)
+{
+    int i;
+
+    for (i = 0; i < symbol_count; i++) {
+        if (!strcmp(symbols[i].name, name)) {
+            symbols[i].value = value;
+            return;
+        }
+    }
+    if (symbol_count == MAX_SYMBOLS || strlen(name) >= sizeof(symbols[0].name)) {
+        fprintf(stderr, "z80: cannot define %s\n", name);
+        exit(1);
+    }
+    strcpy(symbols[symbol_count].name, name);
+    symbols[symbol_count++].value = value;
+}
+
+// A number ($hex, 0xhex or decimal) or a symbol, plus or minus a number
+static int evaluate(const char* text, int final, uint16_t* value)
+{
+    char term[64];
+    const char* sign = strpbrk(text + 1, "+-");
+    char* end;
+    int i;
+
+    if (sign && *text != '$' && !isdigit((unsigned char)*text)) {
+        uint16_t base, offset;
+
+        if ((size_t)(sign - text) >= sizeof(term))
+            return 0;
+        memcpy(term, text, sign - text);
+        term[sign - text] = '\0';
+        if (!evaluate(term, final, &base) || !evaluate(sign + 1, final, &offset))
+            return 0;
+        *value = (uint16_t)(*sign == '+' ? base + offset : base - offset);
+        return 1;
+    }
+    if (*text == '$') {
+        *value = (uint16_t)strtoul(text + 1, &end, 16);
+        return *end == '\0';
+    }
+    if (isdigit((unsigned char)*text)) {
+        *value = (uint16_t)strtoul(text, &end, 0);
+        return *end == '\0';
+    }
+    for (i = 0; i < symbol_count; i++) {
+        if (!strcmp(symbols[i].name, text)) {
+            *value = symbols[i].value;
+            return 1;
+        }
+    }
+    *value = 0;
+    return !final;
+}
+
+// Matches the instruction text against a pattern, *operand gets the
+// expression in place of its # @ or %
+static int match(const char* pattern, const char* text, char* operand, size_t size)
+{
+    size_t n, i;
+
+    operand[0] = '\0';
+    while (*pattern && *pattern != '#' && *pattern != '@' && *pattern != '%') {
+        if (*pattern++ != *text++)
+            return 0;
+    }
+    if (!*pattern)
+        return *text == '\0';
+
+    // The expression runs to what follows the placeholder in the pattern
+    n = strlen(pattern + 1);
+    if (strlen(text) <= n || strcmp(text + strlen(text) - n, pattern + 1))
+        return 0;
+    n = strlen(text) - n;
+    if (n >= size || text[0] == '(')
+        return 0;
+    memcpy(operand, text, n);
+    operand[n] = '\0';
+    for (i = 0; i < sizeof(registers) / sizeof(registers[0]); i++)
+        if (!strcmp(operand, registers[i]))
+            return 0;
+    return 1;
+}
+
+// Two passes over the source; the second writes the code
+static int assemble(uint8_t* memory, char lines[][128], int count, uint16_t* origin, int final)
+{
+    uint16_t pc = 0, start = 0;
+    int started = 0, n;
+
+    for (n = 0; n < count; n++) {
+        char text[128], label[32], name[16], operands[64], operand[64];
+        char* p;
+        uint16_t value = 0;
+        int k, i, size;
+
+        strcpy(text, lines[n]);
+        if ((p = strchr(text, ';')))
+            *p = '\0';
+        for (p = text; *p; p++)
+            *p = (char)tolower((unsigned char)*p);
+        label[0] = name[0] = '\0';
+        p = text;
+        if (*p && !isspace((unsigned char)*p)) {
+            for (i = 0; *p && *p != ':' && !isspace((unsigned char)*p) && i < 31; i++)
+                label[i] = *p++;
+            label[i] = '\0';
+            if (*p == ':')
+                p++;
+        }
+        if (sscanf(p, "%15s", name) < 1) {
+            if (label[0] && !final)
+                define(label, pc);
+            continue;
+        }
+        p = strstr(p, name) + strlen(name);
+        for (i = 0; *p && i < 63; p++)
+            if (!isspace((unsigned char)*p))
+                operands[i++] = *p;
+        operands[i] = '\0';
+
+        if (!strcmp(name, "org")) {
+            if (!evaluate(operands, 1, &pc)) {
+                fprintf(stderr, "z80: line %d: bad org %s\n", n + 1, operands);
+                return -1;
+            }
+            if (!started)
+                start = pc;
+            started = 1;
+            continue;
+        }
+        if (!strcmp(name, "equ")) {
+            if (!evaluate(operands, final, &value)) {
+                fprintf(stderr, "z80: line %d: undefined %s\n", n + 1, operands);
+                return -1;
+            }
+            define(label, value);
+            continue;
+        }
+        if (label[0] && !final)
+            define(label, pc);
+        if (!started) {
+            fprintf(stderr, "z80: line %d: code before org\n", n + 1);
+            return -1;
+        }
+
+        if (!strcmp(name, "defw") || !strcmp(name, "defb")) {
+            if (!evaluate(operands, final, &value)) {
+                fprintf(stderr, "z80: line %d: undefined %s\n", n + 1, operands);
+                return -1;
+            }
+            if (final) {
+                memory[pc] = (uint8_t)value;
+                if (name[3] == 'w')
+                    memory[(uint16_t)(pc + 1)] = (uint8_t)(value >> 8);
+            }
+            pc += name[3] == 'w' ? 2 : 1;
+            continue;
+        }
+        // Sections and symbol exports change nothing here
+        if (!strcmp(name, "section") || !strcmp(name, "public") || !strcmp(name, "extern"))
+            continue;
+
+        snprintf(text, sizeof(text), operands[0] ? "%s %s" : "%s", name, operands);
+        for (k = 0; k < INSN_COUNT && !match(insns[k].pattern, text, operand, sizeof(operand)); k++)
+            ;
+        if (k == INSN_COUNT) {
+            fprintf(stderr, "z80: line %d: unknown instruction %s\n", n + 1, text);
+            return -1;
+        }
+        if (operand[0] && !evaluate(operand, final, &value)) {
+            fprintf(stderr, "z80: line %d: undefined %s\n", n + 1, operand);
+            return -1;
+        }
+
+        size = (insns[k].prefix ? 2 : 1) + (strchr(insns[k].pattern, '@') ? 2 : operand[0] ? 1 : 0);
+        if (final) {
+            uint16_t at = pc;
+
+            if (insns[k].prefix)
+                memory[at++] = insns[k].prefix;
+            memory[at++] = insns[k].opcode;
+            if (strchr(insns[k].pattern, '%')) {
+                int offset = (int)value - (pc + size);
+
+                if (offset < -128 || offset > 127) {
+                    fprintf(stderr, "z80: line %d: jump out of range\n", n + 1);
+                    return -1;
+                }
+                memory[at] = (uint8_t)offset;
+            } else if (strchr(insns[k].pattern, '@')) {
+                memory[at] = (uint8_t)value;
+                memory[(uint16_t)(at + 1)] = (uint8_t)(value >> 8);
+            } else if (operand[0]) {
+                memory[at] = (uint8_t)value;
+            }
+        }
+        pc += size;
+    }
+    *origin = start;
+    return pc - start;
+}
+
+int z80_assemble(uint8_t* memory, const char* path, uint16_t* origin)
+{
+    static char lines[MAX_LINES][128];
+    FILE* f = fopen(path, "r");
+    int count = 0;
+
+    if (!f) {
+        fprintf(stderr, "z80: cannot read %s\n", path);
+        return -1;
+    }
+    while (count < MAX_LINES && fgets(lines[count], sizeof(lines[0]), f)) {
+        lines[count][strcspn(lines[count], "\r\n")] = '\0';
+        count++;
+    }
+    fclose(f);
+
+    if (assemble(memory, lines, count, origin, 0) < 0)
+        return -1;
+    return assemble(memory, lines, count, origin, 1);
+}
+
+/************************************************************/
+/* Z80                                                      */
+/************************************************************/
+
+#define BC(cpu) ((uint16_t)((cpu)->b << 8 | (cpu)->c))
+#define DE(cpu) ((uint16_t)((cpu)->d << 8 | (cpu)->e))
+#define HL(cpu) ((uint16_t)((cpu)->h << 8 | (cpu)->l))
+
+static void pair(uint8_t* high, uint8_t* low, uint32_t value)
+{
+    *high = (uint8_t)(value >> 8);
+    *low = (uint8_t)value;
+}
+#define SET_BC(cpu, v) pair(&(cpu)->b, &(cpu)->c, (v))
+#define SET_DE(cpu, v) pair(&(cpu)->d, &(cpu)->e, (v))
+#define SET_HL(cpu, v) pair(&(cpu)->h, &(cpu)->l, (v))
+
+static uint8_t fetch(z80_t* cpu)
+{
+    return cpu->memory[cpu->pc++];
+}
+
+static uint16_t fetch16(z80_t* cpu)
+{
+    uint16_t low = fetch(cpu);
+
+    return (uint16_t)(low | fetch(cpu) << 8);
+}
+
+static uint16_t read16(const z80_t* cpu, uint16_t address)
+{
+    return (uint16_t)(cpu->memory[address] | cpu->memory[(uint16_t)(address + 1)] << 8);
+}
+
+static void write16(z80_t* cpu, uint16_t address, uint16_t value)
+{
+    cpu->memory[address] = (uint8_t)value;
+    cpu->memory[(uint16_t)(address + 1)] = (uint8_t)(value >> 8);
+}
+
+static void push(z80_t* cpu, uint16_t value)
+{
+    cpu->sp -= 2;
+    write16(cpu, cpu->sp, value);
+}
+
+static uint16_t pop(z80_t* cpu)
+{
+    uint16_t value = read16(cpu, cpu->sp);
+
+    cpu->sp += 2;
+    return value;
+}
+
+static void flags8(z80_t* cpu, uint8_t value)
+{
+    cpu->s = value >> 7;
+    cpu->z = value == 0;
+}
+
+// RL and RR of a register through the carry
+static uint8_t rotate(z80_t* cpu, uint8_t value, int left)
+{
+    uint8_t carry = left ? value >> 7 : value & 1;
+
+    value = left ? (uint8_t)(value << 1 | cpu->cf) : (uint8_t)(value >> 1 | cpu->cf << 7);
+    cpu->cf = carry;
+    flags8(cpu, value);
+    return value;
+}
+
+// A relative jump, taken or not
+static void jump(z80_t* cpu, int taken)
+{
+    int8_t offset = (int8_t)fetch(cpu);
+
+    if (taken)
+        cpu->pc = (uint16_t)(cpu->pc + offset);
+    cpu->cycles += taken ? 12 : 7;
+}
+
+static int step_cb(z80_t* cpu)
+{
+    uint8_t opcode = fetch(cpu);
+
+    cpu->cycles += 8;
+    switch (opcode) {
+    case 0x10: cpu->b = rotate(cpu, cpu->b, 1); break;
+    case 0x11: cpu->c = rotate(cpu, cpu->c, 1); break;
+    case 0x18: cpu->b = rotate(cpu, cpu->b, 0); break;
+    case 0x19: cpu->c = rotate(cpu, cpu->c, 0); break;
+    default:
+        fprintf(stderr, "z80: illegal opcode CB %02X at %04X\n", opcode, (uint16_t)(cpu->pc - 2));
+        return -1;
+    }
+    return 0;
+}
+
+static int step_ed(z80_t* cpu)
+{
+    uint8_t opcode = fetch(cpu);
+    uint32_t r;
+
+    switch (opcode) {
+    case 0x4B: SET_BC(cpu, read16(cpu, fetch16(cpu))); cpu->cycles += 20; break;
+    case 0x5B: SET_DE(cpu, read16(cpu, fetch16(cpu))); cpu->cycles += 20; break;
+    case 0x52:
+        r = (uint32_t)HL(cpu) - DE(cpu) - cpu->cf;
+        cpu->cf = r > 0xFFFF;
+        SET_HL(cpu, r);
+        cpu->s = (uint8_t)(r >> 15 & 1);
+        cpu->z = HL(cpu) == 0;
+        cpu->cycles += 15;
+        break;
+    case 0xB0:  // LDIR and LDDR, one byte per step as on the chip
+    case 0xB8:
+        cpu->memory[DE(cpu)] = cpu->memory[HL(cpu)];
+        SET_HL(cpu, HL(cpu) + (opcode == 0xB0 ? 1 : -1));
+        SET_DE(cpu, DE(cpu) + (opcode == 0xB0 ? 1 : -1));
+        SET_BC(cpu, BC(cpu) - 1);
+        if (BC(cpu)) {
+            cpu->pc -= 2;
+            cpu->cycles += 21;
+        } else {
+            cpu->cycles += 16;
+        }
+        break;
+    default:
+        fprintf(stderr, "z80: illegal opcode ED %02X at %04X\n", opcode, (uint16_t)(cpu->pc - 2));
+        return -1;
+    }
+    return 0;
+}
+
+static int step(z80_t* cpu)
+{
+    uint8_t opcode = fetch(cpu);
+    uint16_t address, value;
+    uint32_t r;
+
+    switch (opcode) {
+    case 0xF3: cpu->iff = 0; cpu->cycles += 4; break;
+    case 0xFB: cpu->iff = 1; cpu->cycles += 4; break;
+    case 0x7E: cpu->a = cpu->memory[HL(cpu)]; cpu->cycles += 7; break;
+    case 0x4E: cpu->c = cpu->memory[HL(cpu)]; cpu->cycles += 7; break;
+    case 0x12: cpu->memory[DE(cpu)] = cpu->a; cpu->cycles += 7; break;
+    case 0x77: cpu->memory[HL(cpu)] = cpu->a; cpu->cycles += 7; break;
+    case 0x78: cpu->a = cpu->b; cpu->cycles += 4; break;
+    case 0x41: cpu->b = cpu->c; cpu->cycles += 4; break;
+    case 0x44: cpu->b = cpu->h; cpu->cycles += 4; break;
+    case 0x4D: cpu->c = cpu->l; cpu->cycles += 4; break;
+    case 0x3A: cpu->a = cpu->memory[fetch16(cpu)]; cpu->cycles += 13; break;
+    case 0x32: cpu->memory[fetch16(cpu)] = cpu->a; cpu->cycles += 13; break;
+    case 0x2A: SET_HL(cpu, read16(cpu, fetch16(cpu))); cpu->cycles += 16; break;
+    case 0x01: SET_BC(cpu, fetch16(cpu)); cpu->cycles += 10; break;
+    case 0x11: SET_DE(cpu, fetch16(cpu)); cpu->cycles += 10; break;
+    case 0x21: SET_HL(cpu, fetch16(cpu)); cpu->cycles += 10; break;
+    case 0x31: cpu->sp = fetch16(cpu); cpu->cycles += 10; break;
+    case 0x3E: cpu->a = fetch(cpu); cpu->cycles += 7; break;
+    case 0x0E: cpu->c = fetch(cpu); cpu->cycles += 7; break;
+    case 0x03: SET_BC(cpu, BC(cpu) + 1); cpu->cycles += 6; break;
+    case 0x13: SET_DE(cpu, DE(cpu) + 1); cpu->cycles += 6; break;
+    case 0x23: SET_HL(cpu, HL(cpu) + 1); cpu->cycles += 6; break;
+    case 0x0B: SET_BC(cpu, BC(cpu) - 1); cpu->cycles += 6; break;
+    case 0x1B: SET_DE(cpu, DE(cpu) - 1); cpu->cycles += 6; break;
+    case 0x2B: SET_HL(cpu, HL(cpu) - 1); cpu->cycles += 6; break;
+    case 0x0C: cpu->c++; flags8(cpu, cpu->c); cpu->cycles += 4; break;
+    case 0x87:
+        cpu->cf = cpu->a >> 7;
+        cpu->a = (uint8_t)(cpu->a << 1);
+        flags8(cpu, cpu->a);
+        cpu->cycles += 4;
+        break;
+    case 0x09:
+    case 0x19:
+        r = (uint32_t)HL(cpu) + (opcode == 0x09 ? BC(cpu) : DE(cpu));
+        cpu->cf = r > 0xFFFF;
+        SET_HL(cpu, r);
+        cpu->cycles += 11;
+        break;
+    case 0xB7: cpu->cf = 0; flags8(cpu, cpu->a); cpu->cycles += 4; break;
+    case 0xB1: cpu->a |= cpu->c; cpu->cf = 0; flags8(cpu, cpu->a); cpu->cycles += 4; break;
+    case 0xEE: cpu->a ^= fetch(cpu); cpu->cf = 0; flags8(cpu, cpu->a); cpu->cycles += 7; break;
+    case 0x17:
+        value = cpu->a >> 7;
+        cpu->a = (uint8_t)(cpu->a << 1 | cpu->cf);
+        cpu->cf = (uint8_t)value;
+        cpu->cycles += 4;
+        break;
+    case 0xEB:
+        value = DE(cpu);
+        SET_DE(cpu, HL(cpu));
+        SET_HL(cpu, value);
+        cpu->cycles += 4;
+        break;
+    case 0xE3:
+        value = read16(cpu, cpu->sp);
+        write16(cpu, cpu->sp, HL(cpu));
+        SET_HL(cpu, value);
+        cpu->cycles += 19;
+        break;
+    case 0xC5: push(cpu, BC(cpu)); cpu->cycles += 11; break;
+    case 0xD5: push(cpu, DE(cpu)); cpu->cycles += 11; break;
+    case 0xE5: push(cpu, HL(cpu)); cpu->cycles += 11; break;
+    case 0xC1: SET_BC(cpu, pop(cpu)); cpu->cycles += 10; break;
+    case 0xD1: SET_DE(cpu, pop(cpu)); cpu->cycles += 10; break;
+    case 0xE1: SET_HL(cpu, pop(cpu)); cpu->cycles += 10; break;
+    case 0x18: jump(cpu, 1); break;
+    case 0x20: jump(cpu, !cpu->z); break;
+    case 0x28: jump(cpu, cpu->z); break;
+    case 0x30: jump(cpu, !cpu->cf); break;
+    case 0x38: jump(cpu, cpu->cf); break;
+    case 0xE9: cpu->pc = HL(cpu); cpu->cycles += 4; break;
+    case 0xC3: cpu->pc = fetch16(cpu); cpu->cycles += 10; break;
+    case 0xCD:
+    case 0xD4:
+        address = fetch16(cpu);
+        if (opcode == 0xD4 && cpu->cf) {
+            cpu->cycles += 10;
+            break;
+        }
+        push(cpu, cpu->pc);
+        cpu->pc = address;
+        cpu->cycles += 17;
+        break;
+    case 0xC8:
+    case 0xD8:
+        if (opcode == 0xC8 ? !cpu->z : !cpu->cf) {
+            cpu->cycles += 5;
+            break;
+        }
+        cpu->pc = pop(cpu);
+        cpu->cycles += 11;
+        break;
+    case 0xC9: cpu->pc = pop(cpu); cpu->cycles += 10; break;
+    case 0xCB: return step_cb(cpu);
+    case 0xED: return step_ed(cpu);
+    default:
+        fprintf(stderr, "z80: illegal opcode %02X at %04X\n", opcode, (uint16_t)(cpu->pc - 1));
+        return -1;
+    }
+    return 0;
+}
+
+int z80_run(z80_t* cpu, uint16_t address, uint16_t stop, uint32_t max_steps)
+{
+    uint32_t steps;
+
+    cpu->pc = address;
+    for (steps = 0; steps < max_steps; steps++) {
+        if (cpu->pc == stop)
+            return 0;
+        if (step(cpu))
+            return -1;
+    }
+    fprintf(stderr, "z80: no stop after %u instructions\n", max_steps);
+    return -1;
+}
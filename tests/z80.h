@@ -0,0 +1,28 @@
+/* z80.h - Z80 model for the assembly tests                        */
+/* A two-pass assembler for the subset of z88dk-z80asm the         */
+/* hand-written PHC-25 stub uses, and an interpreter with the Z80  */
+/* T-states. Both work on a 64K memory the caller owns.             */
+
+#ifndef TESTS_Z80_H
+#define TESTS_Z80_H
+
+#include <stdint.h>
+
+typedef struct z80_t {
+    uint8_t* memory;                /* 64K */
+    uint8_t a, b, c, d, e, h, l;
+    uint16_t sp, pc;
+    uint8_t s, z, cf;               /* Flags */
+    uint8_t iff;                    /* Interrupts enabled */
+    uint64_t cycles;                /* T-states */
+} z80_t;
+
+/* Assembles path into memory at its org, labels become symbols;
+ * returns the code size or -1 (errors on stderr), *origin the org */
+int z80_assemble(uint8_t* memory, const char* path, uint16_t* origin);
+
+/* Runs from address until the program counter reaches stop, returns
+ * 0 or -1 on an illegal opcode or after max_steps instructions */
+int z80_run(z80_t* cpu, uint16_t address, uint16_t stop, uint32_t max_steps);
+
+#endif /* TESTS_Z80_H */
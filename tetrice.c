@@ -19,6 +19,8 @@ uint8_t collision_bottom(game_state_t* state, uint8_t piece, uint8_t x, uint8_t
 uint8_t check_rotation(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t direction);
 uint8_t check_full_lines(game_state_t* state);
 void init_game_state(game_state_t* state);
+void game_start(game_state_t* state);
+uint8_t game_step(game_state_t* state, input_action_t input);
 
 // External reference to platform-specific color mapping
 extern char tetrominos_colors[];
@@ -28,12 +30,113 @@ extern char tetrominos_colors[];
 /* Platform specific functions are implemented elsewhere     */
 /************************************************************/
 
-uint8_t timeout_ticks = 0;
+#ifndef timeout_ticks
+PLATFORM_TLS uint8_t timeout_ticks = 0;
+#endif
+
+#ifdef PERF
+/************************************************************/
+/* Frame counters (perf.h)                                  */
+/************************************************************/
+
+uint16_t perf_frame_start;
+uint16_t perf_input_end;
+uint16_t perf_render_start;
+uint16_t perf_render;
+
+void perf_init(void)
+{
+    perf_ring_t* ring = PERF_RING;
+    uint8_t* p = (uint8_t*)ring;
+    uint16_t i;
+
+    for (i = 0; i < sizeof(perf_ring_t); i++)
+        p[i] = 0;
+    ring->magic[0] = 'P';
+    ring->magic[1] = 'E';
+    ring->magic[2] = 'R';
+    ring->magic[3] = 'F';
+    ring->version = PERF_VERSION;
+    ring->slots = PERF_SLOTS;
+    ring->budget = PERF_BUDGET;
+}
+
+// Called after game_step: logic is the step minus its display hooks
+void perf_frame_end(void)
+{
+    perf_ring_t* ring = PERF_RING;
+    perf_slot_t* slot;
+    uint16_t step = PERF_CLOCK() - perf_input_end;
+
+    // Full: nobody is reading, drop the oldest frame
+    if ((uint8_t)(ring->head - ring->tail) >= PERF_SLOTS) {
+        ring->tail++;
+        ring->overwritten++;
+    }
+    slot = &ring->slot[ring->head & (PERF_SLOTS - 1)];
+    slot->input = perf_input_end - perf_frame_start;
+    slot->logic = step - perf_render;
+    slot->render = perf_render;
+    ring->head++;
+    ring->frames++;
+    if (step > ring->budget)
+        ring->over_budget++;
+}
+#endif // PERF
+
+#ifdef HUD
+/* Counts of the frame in progress (hud.h) */
+uint16_t hud_cells;
+uint16_t hud_bytes;
+#ifdef HUD_CLOCK
+uint16_t hud_start;
+#endif
+#endif
 
 /************************************************************/
 /* Pieces                                                   */
 /************************************************************/
 
+#ifdef ASM_KERNELS
+// The block loops run in alice_kernels.s, the arguments go through the
+// direct page (alice.h)
+#define KERNEL_LOAD(state, piece_, x_, y_, rotation_) \
+    (KERNEL_ARGS->field = (uint8_t*)(state)->playfield, KERNEL_ARGS->piece = (piece_), \
+     KERNEL_ARGS->x = (x_), KERNEL_ARGS->y = (y_), KERNEL_ARGS->rotation = (rotation_))
+
+void playfield_place_piece(game_state_t* state, unsigned char piece, unsigned char x, unsigned char y, unsigned char rotation)
+{
+    KERNEL_LOAD(state, piece, x, y, rotation);
+    KERNEL_ARGS->side = CELL_PIECE_1 + piece;
+    kernel_place();
+}
+
+void playfield_remove_piece(game_state_t* state, unsigned char piece, unsigned char x, unsigned char y, unsigned char rotation)
+{
+    KERNEL_LOAD(state, piece, x, y, rotation);
+    KERNEL_ARGS->side = CELL_EMPTY;
+    kernel_place();
+}
+
+uint8_t check_collision(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t side_flag, int8_t dx, int8_t dy)
+{
+    KERNEL_LOAD(state, piece, x, y, rotation);
+    KERNEL_ARGS->side = side_flag;
+    KERNEL_ARGS->dx = dx;
+    KERNEL_ARGS->dy = dy;
+    kernel_collision();
+    return KERNEL_ARGS->result;
+}
+
+uint8_t check_rotation(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t direction)
+{
+    KERNEL_LOAD(state, piece, x, y, rotation);
+    KERNEL_ARGS->side = direction;
+    kernel_rotation();
+    return KERNEL_ARGS->result;
+}
+
+#else
 // Place a piece in the playfield
 void playfield_place_piece(game_state_t* state, unsigned char piece, unsigned char x, unsigned char y, unsigned char rotation)
 {
@@ -87,6 +190,7 @@ uint8_t check_collision(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y
 
     return 0;
 }
+#endif // ASM_KERNELS
 
 // Detect collision left
 uint8_t collision_left(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation)
@@ -106,6 +210,7 @@ uint8_t collision_bottom(game_state_t* state, uint8_t piece, uint8_t x, uint8_t
     return check_collision(state, piece, x, y, rotation, SIDE_BOTTOM, 0, 1);
 }
 
+#ifndef ASM_KERNELS
 // Check if a piece can rotate by checking collisions
 uint8_t check_rotation(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y, uint8_t rotation, uint8_t direction)
 {
@@ -138,6 +243,7 @@ uint8_t check_rotation(game_state_t* state, uint8_t piece, uint8_t x, uint8_t y,
     // No collision
     return new_rotation;
 }
+#endif
 
 // Check full lines and return score
 uint8_t check_full_lines(game_state_t* state)
@@ -212,13 +318,13 @@ uint8_t check_full_lines(game_state_t* state)
 void playfield_set_cell(game_state_t* state, uint8_t x, uint8_t y, uint8_t color)
 {
     if (x < PLAYFIELD_WIDTH && y < PLAYFIELD_HEIGHT)
-        SET_CELL_CONTENT_AND_DIRTY(state->playfield[y][x], color);
+        SET_CELL_CONTENT_AND_DIRTY(PLAYFIELD_CELL(state, x, y), color);
 }
 
 uint8_t playfield_get_cell(game_state_t* state, uint8_t x, uint8_t y)
 {
     if (x < PLAYFIELD_WIDTH && y < PLAYFIELD_HEIGHT)
-        return GET_CELL_CONTENT(state->playfield[y][x]);
+        return GET_CELL_CONTENT(PLAYFIELD_CELL(state, x, y));
     return 0;
 }
 
@@ -237,24 +343,159 @@ void playfield_clear(game_state_t* state)
     }
 }
 
+#ifdef PLAYFIELD_ROWS_ADDR
+// Offset of each row in the playfield, so a cell costs no multiply
+void playfield_rows_init(void)
+{
+    uint8_t y, offset = 0;
+
+    for (y = 0; y < PLAYFIELD_HEIGHT; y++) {
+        PLAYFIELD_ROWS[y] = offset;
+        offset += PLAYFIELD_WIDTH;
+    }
+}
+#endif
+
 /************************************************************/
 /* Game state initialization                                */
 /************************************************************/
 
+// The per-frame fields: in the state, or at a fixed address (GAME_HOT)
+#define HOT GAME_HOT(state)
+
 void init_game_state(game_state_t* state)
 {
     // Clear playfield
+#ifdef PLAYFIELD_ROWS_ADDR
+    playfield_rows_init();
+#endif
     playfield_clear(state);
 
     // Initialize game variables
-    state->score = 0;
-    state->level = 1;
-    state->speed = 15;
-    state->piece = platform_random() % 7;
-    state->next_piece = platform_random() % 7;
-    state->x = PIECE_START_X;
-    state->y = PIECE_START_Y;
-    state->rotation = 0;
+    HOT->score = 0;
+    HOT->level = 1;
+    HOT->speed = 15;
+    HOT->piece = platform_random() % NB_PIECES;
+    HOT->next_piece = platform_random() % NB_PIECES;
+    HOT->x = PIECE_START_X;
+    HOT->y = PIECE_START_Y;
+    HOT->rotation = 0;
+}
+
+/************************************************************/
+/* Game step                                                */
+/************************************************************/
+
+// Start a new game: fresh state, first piece in the playfield
+void game_start(game_state_t* state)
+{
+    // Initialize game state
+    init_game_state(state);
+
+    // Place initial piece in playfield
+    playfield_place_piece(state, HOT->piece, HOT->x, HOT->y, HOT->rotation);
+
+    // Set initial timer
+    timeout_ticks = HOT->speed;
+}
+
+// Advance the game by one input action, return 1 on game over
+uint8_t game_step(game_state_t* state, input_action_t input)
+{
+    uint8_t line_score;
+
+    // Remove piece from playfield before any movement checks
+    playfield_remove_piece(state, HOT->piece, HOT->x, HOT->y, HOT->rotation);
+
+    // Handle player input first (movement and rotation)
+    if (input != INPUT_TIMEOUT && input != INPUT_NONE)
+    {
+        // Process the valid player input
+        switch (input)
+        {
+        case INPUT_MOVE_LEFT:
+            if (collision_left(state, HOT->piece, HOT->x, HOT->y, HOT->rotation) == 0)
+                HOT->x--;
+            break;
+        case INPUT_MOVE_RIGHT:
+            if (collision_right(state, HOT->piece, HOT->x, HOT->y, HOT->rotation) == 0)
+                HOT->x++;
+            break;
+        case INPUT_ROTATE_CW:
+            HOT->rotation = check_rotation(state, HOT->piece, HOT->x, HOT->y, HOT->rotation, 0);
+            break;
+        case INPUT_ROTATE_CCW:
+            HOT->rotation = check_rotation(state, HOT->piece, HOT->x, HOT->y, HOT->rotation, 1);
+            break;
+        case INPUT_DROP:
+            // No fall in the first lines
+            if (HOT->y < 3) {
+                input = INPUT_NONE; // Cancel drop
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Now, handle gravity (timeout) or a drop action
+    if (input == INPUT_TIMEOUT || input == INPUT_DROP)
+    {
+        // Piece has reached the bottom or another piece
+        if (collision_bottom(state, HOT->piece, HOT->x, HOT->y, HOT->rotation))
+        {
+            // Piece has landed - restore it in current position
+            playfield_place_piece(state, HOT->piece, HOT->x, HOT->y, HOT->rotation);
+            // Check for full lines
+            line_score = check_full_lines(state);
+            if (line_score > 0)
+            {
+                // Accelerate speed every 10 points
+                if ((HOT->score / 10) != ((HOT->score + line_score) / 10))
+                {
+                    HOT->level++;
+                    if (HOT->speed > 1)
+                        HOT->speed -= 1;
+                }
+
+                // Update score
+                HOT->score += line_score;
+
+                // Sync UI and playfield display after line clearing
+                display_sync_playfield(state);
+                display_sync_ui(state);
+            }
+
+            // Reset position for new piece
+            HOT->x = PIECE_START_X;
+            HOT->y = PIECE_START_Y;
+            HOT->rotation = 0;
+
+            // Use next piece and generate new next piece
+            HOT->piece = HOT->next_piece;
+            HOT->next_piece = platform_random() % NB_PIECES;
+
+            // Update preview display with new next piece
+            display_preview_piece(HOT->next_piece);
+
+            // Check for game over (before placing new piece)
+            if (collision_bottom(state, HOT->piece, HOT->x, HOT->y, HOT->rotation))
+                return 1;
+        } else {
+            // Move piece down
+            HOT->y++;
+        }
+        // Reset gravity timer after a fall
+        timeout_ticks = HOT->speed;
+    }
+
+    // Place piece in new position after all movements
+    playfield_place_piece(state, HOT->piece, HOT->x, HOT->y, HOT->rotation);
+
+    // Sync entire display (includes the piece)
+    display_sync_playfield(state);
+
+    return 0;
 }
 
 /************************************************************/
@@ -265,32 +506,14 @@ void gameloop()
 {
     // All variable declarations must be at the top for C89 compatibility
     game_state_t state;
-    unsigned char px, py, protation;
-    unsigned char line_score;
     input_action_t input;
 
     #ifdef PHC25
     //debug_print(10, 20, "INIT");
     #endif
 
-    // Initialize game state
-    init_game_state(&state);
-
-    #ifdef PHC25
-    //debug_print(10, 25, "PLACE");
-    #endif
-
-    // Place initial piece in playfield
-    playfield_place_piece(&state, state.piece, state.x, state.y, state.rotation);
-
-    // Initialize other variables
-    px = state.x;
-    py = state.y;
-    protation = 0;
-    line_score = 0;
-
-    // Set initial timer
-    timeout_ticks = state.speed;
+    // Initialize game state and place the first piece
+    game_start(&state);
 
     #ifdef PHC25
     //debug_print(10, 30, "SYNC");
@@ -298,7 +521,7 @@ void gameloop()
 
     // Initial display sync
     display_sync_ui(&state);
-    display_preview_piece(state.next_piece);
+    display_preview_piece(GAME_HOT(&state)->next_piece);
     display_sync_playfield(&state);
 
     #ifdef PHC25
@@ -308,111 +531,27 @@ void gameloop()
     // Loop until game over
     while (1)
     {
-        // Keep previous position
-        px = state.x;
-        py = state.y;
-        protation = state.rotation;
-
-        // Remove piece from playfield before any movement checks
-        playfield_remove_piece(&state, state.piece, state.x, state.y, state.rotation);
+        PERF_FRAME_BEGIN();
 
         // Get input action
         input = platform_get_input();
+        PERF_INPUT_END();
+        HUD_FRAME_BEGIN();
 
-        // Handle player input first (movement and rotation)
-        if (input != INPUT_TIMEOUT && input != INPUT_NONE)
-        {
-            // Process the valid player input
-            switch (input)
-            {
-            case INPUT_MOVE_LEFT:
-                if (collision_left(&state, state.piece, state.x, state.y, state.rotation) == 0)
-                    state.x--;
-                break;
-            case INPUT_MOVE_RIGHT:
-                if (collision_right(&state, state.piece, state.x, state.y, state.rotation) == 0)
-                    state.x++;
-                break;
-            case INPUT_ROTATE_CW:
-                state.rotation = check_rotation(&state, state.piece, state.x, state.y, state.rotation, 0);
-                break;
-            case INPUT_ROTATE_CCW:
-                state.rotation = check_rotation(&state, state.piece, state.x, state.y, state.rotation, 1);
-                break;
-            case INPUT_DROP:
-                // No fall in the first lines
-                if (state.y < 3) {
-                    input = INPUT_NONE; // Cancel drop
-                }
-                break;
-            default:
-                break;
-            }
-        }
-
-        // Now, handle gravity (timeout) or a drop action
-        if (input == INPUT_TIMEOUT || input == INPUT_DROP)
+        if (game_step(&state, input))
         {
-            // Piece has reached the bottom or another piece
-            if (collision_bottom(&state, state.piece, state.x, state.y, state.rotation))
-            {
-                // Piece has landed - restore it in current position
-                playfield_place_piece(&state, state.piece, state.x, state.y, state.rotation);
-                // Check for full lines
-                line_score = check_full_lines(&state);
-                if (line_score > 0)
-                {
-                    // Accelerate speed every 10 points
-                    if ((state.score / 10) != ((state.score + line_score) / 10))
-                    {
-                        state.level++;
-                        if (state.speed > 1)
-                            state.speed -= 1;
-                    }
-
-                    // Update score
-                    state.score += line_score;
-
-                    // Sync UI and playfield display after line clearing
-                    display_sync_playfield(&state);
-                    display_sync_ui(&state);
-                }
-
-                // Reset position for new piece
-                state.x = PIECE_START_X;
-                state.y = PIECE_START_Y;
-                state.rotation = 0;
-
-                // Use next piece and generate new next piece
-                state.piece = state.next_piece;
-                state.next_piece = platform_random() % 7;
-
-                // Update preview display with new next piece
-                display_preview_piece(state.next_piece);
-
-                // Check for game over (before placing new piece)
-                if (collision_bottom(&state, state.piece, state.x, state.y, state.rotation))
-                {
-                    // Game over
-                    display_game_over();
-                    ticks(30);
-                    wait_key();
-                    ticks(10);
-                    return;
-                }
-            } else {
-                // Move piece down
-                state.y++;
-            }
-            // Reset gravity timer after a fall
-            timeout_ticks = state.speed;
+            PERF_FRAME_END();
+            HUD_FRAME_END();
+
+            // Game over
+            display_game_over();
+            ticks(30);
+            wait_key();
+            ticks(10);
+            return;
         }
-
-        // Place piece in new position after all movements
-        playfield_place_piece(&state, state.piece, state.x, state.y, state.rotation);
-
-        // Sync entire display (includes the piece)
-        display_sync_playfield(&state);
+        PERF_FRAME_END();
+        HUD_FRAME_END();
     }
 }
 
@@ -420,8 +559,11 @@ void gameloop()
 /* Main loop                                                */
 /************************************************************/
 
+#ifndef ENGINE_ONLY
 void main()
 {
+    PERF_INIT();
+
     while (1)
     {
         // Clear screen and draw borders
@@ -445,3 +587,4 @@ void main()
         gameloop();
     }
 }
+#endif // ENGINE_ONLY
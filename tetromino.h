@@ -7,17 +7,9 @@
 /* All rotations stored consecutively, accessed by offset.  */
 /************************************************************/
 
-#define SIDE_LEFT 0x01
-#define SIDE_RIGHT 0x02
-#define SIDE_BOTTOM 0x04
+// Side flags, packed type and accessors
+#include "tetromino_format.h"
 
-// Bit-packed tetromino format (4 bytes per shape vs 12 bytes)
-typedef uint8_t packed_tetromino[4];
-
-// Bit manipulation macros for packed format
-#define GET_BLOCK_X(block) ((block) & 0x03)
-#define GET_BLOCK_Y(block) (((block) >> 2) & 0x03)
-#define GET_BLOCK_SIDES(block) (((block) >> 4) & 0x07)
 #define PACK_BLOCK(x,y,sides) ((x) | ((y)<<2) | ((sides)<<4))
 
 // All tetromino rotations stored consecutively
@@ -155,6 +147,3 @@ uint8_t tetromino_offsets[] = {0, 1, 3, 7, 9, 11, 15};
 
 // Number of rotations per tetromino
 uint8_t tetrominos_nb_shapes[] = {1, 2, 4, 2, 2, 4, 4};
-
-// Macro to access a specific tetromino rotation
-#define GET_TETROMINO(piece, rotation) (&all_tetrominos[tetromino_offsets[piece] + (rotation)])
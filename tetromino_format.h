@@ -0,0 +1,33 @@
+/* tetromino_format.h - Packed tetromino format, shared by the game, */
+/* the platform display code and the host tools. The shapes are      */
+/* defined once, in tetromino.h, which only tetrice.c includes.      */
+
+#ifndef TETROMINO_FORMAT_H
+#define TETROMINO_FORMAT_H
+
+#include <stdint.h>
+
+#define NB_PIECES 7
+
+// Side flags of a packed block
+#define SIDE_LEFT 0x01
+#define SIDE_RIGHT 0x02
+#define SIDE_BOTTOM 0x04
+
+// Bit-packed tetromino format (4 bytes per shape vs 12 bytes)
+typedef uint8_t packed_tetromino[4];
+
+// All rotations stored consecutively, an offset and a count per piece
+extern packed_tetromino all_tetrominos[];
+extern uint8_t tetromino_offsets[];
+extern uint8_t tetrominos_nb_shapes[];
+
+// Bit manipulation macros for packed format
+#define GET_BLOCK_X(block) ((block) & 0x03)
+#define GET_BLOCK_Y(block) (((block) >> 2) & 0x03)
+#define GET_BLOCK_SIDES(block) (((block) >> 4) & 0x07)
+
+// Macro to access a specific tetromino rotation
+#define GET_TETROMINO(piece, rotation) (&all_tetrominos[tetromino_offsets[piece] + (rotation)])
+
+#endif /* TETROMINO_FORMAT_H */
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Cost of the PHC-25 calling conventions per gameloop iteration.
+The shipped ones are in_port (fastcall), out_port and decompress_asset
+(callee): T-states per call come from the sccz80 call sequences below,
+and code sizes from the z88dk map files (zcc -m) of a build before and
+after. --helpers adds what callee would cost on the per-frame helpers,
+with their calls per frame from the tetrice_traffic_phc25 report; they
+keep the standard convention. The results are a model, over the mock's
+sample games for the helpers, not measurements.
+Usage: python call_cost.py [--map tetrice.map] [--before old.map] [--ticks 15] [--helpers report.txt]
+"""
+
+import argparse
+import re
+import sys
+
+# Z80 T-states
+PUSH, POP, RET, JP_HL = 11, 10, 10, 4
+CLOCK = 3579545                 # PHC-25 Z80 clock, Hz
+
+# Standard sccz80 call: the caller pushes each argument as a word and
+# pops them all after the call (one POP and one byte per word).
+# __z88dk_callee: the same pops move into the function, which then
+# returns through the saved address: pop hl, pops, jp (hl).
+# __z88dk_fastcall: the single argument stays in HL, no push or pop.
+CALLEE_EXTRA = POP + JP_HL - RET
+
+# in_port before: the caller pushed and popped the port, the function
+# popped and pushed its frame back to read it, then ld c,c / in a,(c) /
+# ld l,a / ld h,0. Now: ld c,l / ld b,0 / in l,(c) / ld h,b.
+# scankey() reads the 8 matrix ports 5 times per tick.
+IN_PORT_SAVED = (PUSH + POP) + (2 * POP + 2 * PUSH) + (4 + 4 + 7) - (4 + 7 + 4)
+IN_PORT_PER_TICK = 5 * 8
+
+# out_port before: the caller popped both words, the function popped
+# and pushed its frame back, then ld a,c / ld c,e / out (c),a. Now it
+# pops the words for good and does out (c),e.
+OUT_PORT_SAVED = 2 * POP + 2 * PUSH + (4 + 4)
+
+# decompress_asset, against a standard entry that pops and pushes its
+# frame back before it jumps to the decoder
+DECOMPRESS_SAVED = 2 * POP + 2 * PUSH
+
+# Shipped conventions: saving per call, and calls per iteration as a
+# function of the wait() ticks. out_port is called once, when the
+# graphics mode is set; decompress_asset twice per game.
+SHIPPED = [
+    ('in_port', 'fastcall', IN_PORT_SAVED, lambda ticks: IN_PORT_PER_TICK * ticks),
+    ('out_port', 'callee', OUT_PORT_SAVED, lambda ticks: 0),
+    ('decompress_asset', 'callee', DECOMPRESS_SAVED, lambda ticks: 0),
+]
+
+# The shipped helpers and their callers, for the code sizes
+CALLERS = ['in_port', 'out_port', 'decompress_asset', 'scankey', 'init_graphics_mode12', 'draw_asset']
+
+# Argument words of the per-frame helpers, as the report names them.
+# They take more than one argument, so fastcall is out, and callee
+# would cost CALLEE_EXTRA per call: they keep the standard convention.
+HOT = {
+    'playfield_set_cell': 4,
+    'playfield_get_cell': 3,
+    'playfield_is_empty_cell': 3,
+    'draw_tetris_block_pattern': 3,
+    'erase_tetris_block': 2,
+}
+
+MAP_LINE = re.compile(r'^(\S+)\s*=\s*\$([0-9A-Fa-f]+)\s*;\s*(\w+)')
+
+
+def read_report(path):
+    """Calls per frame of each helper, from the report's last table."""
+    calls = {}
+    with open(path) as f:
+        lines = f.read().splitlines()
+    try:
+        start = next(i for i, line in enumerate(lines) if line.startswith('hot helper'))
+    except StopIteration:
+        raise ValueError("%s has no hot helper table" % path)
+    for line in lines[start + 1:]:
+        fields = line.split()
+        if len(fields) != 6:
+            break
+        calls[fields[0]] = float(fields[2])
+    return calls
+
+
+def read_map(path):
+    """Function sizes from the gaps between code addresses, and the code size."""
+    addresses = {}
+    code_size = None
+    with open(path) as f:
+        for line in f:
+            m = MAP_LINE.match(line)
+            if not m:
+                continue
+            name, value, kind = m.group(1), int(m.group(2), 16), m.group(3)
+            if name == '__code_compiler_size':
+                code_size = value
+            elif kind == 'addr' and name.startswith('_'):
+                addresses[name[1:]] = value
+    ordered = sorted(addresses.items(), key=lambda item: item[1])
+    sizes = {}
+    for (name, address), (_, following) in zip(ordered, ordered[1:]):
+        sizes[name] = following - address
+    return sizes, code_size
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Cost of the PHC-25 calling conventions per gameloop iteration")
+    parser.add_argument('--map', help="z88dk map file of the current build")
+    parser.add_argument('--before', help="z88dk map file of a build with the standard convention")
+    parser.add_argument('--ticks', type=int, default=15,
+                        help="wait() ticks per iteration, the level speed (default 15, level 1)")
+    parser.add_argument('--helpers', metavar='REPORT',
+                        help="tetrice_traffic_phc25 output: also model callee on the per-frame helpers")
+    args = parser.parse_args()
+
+    print("%-26s %9s %10s %9s %12s" % ("shipped", "convention", "per iter.", "T/call", "T/iteration"))
+    total = 0
+    for name, convention, saved, per_iteration in SHIPPED:
+        calls = per_iteration(args.ticks)
+        total += calls * saved
+        print("%-26s %9s %10d %9d %12d" % (name, convention, calls, saved, calls * saved))
+    print("saved: %d T-states per iteration without a key, %.0f us over %d ticks" % (
+        total, total * 1e6 / CLOCK, args.ticks))
+
+    if args.map:
+        try:
+            after, after_size = read_map(args.map)
+            before, before_size = read_map(args.before) if args.before else ({}, None)
+        except OSError as e:
+            print("call_cost: %s" % e, file=sys.stderr)
+            return 1
+
+        print()
+        print("%-26s %7s %7s %7s" % ("code size", "before", "after", "delta"))
+        delta = 0
+        for name in CALLERS:
+            if name not in after:
+                continue
+            if name in before:
+                delta += after[name] - before[name]
+                print("%-26s %7d %7d %+7d" % (name, before[name], after[name], after[name] - before[name]))
+            else:
+                print("%-26s %7s %7d" % (name, '', after[name]))
+        if before:
+            print("%-26s %7s %7s %+7d" % ("helpers and callers", '', '', delta))
+        if after_size is not None and before_size is not None:
+            print("%-26s %7d %7d %+7d" % ("code_compiler", before_size, after_size, after_size - before_size))
+
+    if not args.helpers:
+        return 0
+    try:
+        calls = read_report(args.helpers)
+    except (OSError, ValueError) as e:
+        print("call_cost: %s" % e, file=sys.stderr)
+        return 1
+
+    # Not shipped: what callee would add to the per-frame helpers
+    print()
+    print("%-26s %6s %9s %9s %12s" % ("not shipped: callee", "words", "per frame", "T/call", "T/iteration"))
+    logic = 0.0
+    for name, words in HOT.items():
+        per_frame = calls.get(name, 0.0)
+        logic += per_frame * CALLEE_EXTRA
+        print("%-26s %6d %9.2f %+9d %+12.1f" % (name, words, per_frame, CALLEE_EXTRA, per_frame * CALLEE_EXTRA))
+    print("callee on the helpers would cost %.0f T-states per iteration (%.1f us)" % (logic, logic * 1e6 / CLOCK))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
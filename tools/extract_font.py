@@ -2,6 +2,8 @@
 """
 Extract bitmap font from image and generate C header file.
 Font is 4x8 pixels per digit, digits are ordered 1-9,0 in the source image.
+The header holds the font twice, in the upper and in the lower nibble,
+for game_font.c (make TARGET=phc25 phc25_gfx).
 """
 
 from PIL import Image
@@ -41,53 +43,44 @@ def extract_digit(img, digit_index):
     return digit_bytes
 
 def generate_header(font_data, output_file):
-    """Generate C header file with font data."""
-    with open(output_file, 'w') as f:
-        f.write("/* game_font.h - Bitmap font for score/level display */\n")
-        f.write("/* Generated from digit sprite sheet */\n")
-        f.write("/* Each digit is 4x8 pixels, stored as 8 bytes */\n")
-        f.write("/* Bits are packed MSB first (leftmost pixel = bit 7) */\n\n")
-        f.write("#ifndef GAME_FONT_H\n")
-        f.write("#define GAME_FONT_H\n\n")
-        f.write("#include <stdint.h>\n\n")
-        f.write("/* Font data: 10 digits (0-9), each 8 bytes */\n")
-        f.write("/* Indexed by digit value (0-9) */\n")
-        f.write("const uint8_t game_font[10][8] = {\n")
-
-        # Font data is in order 1-9,0 in image, but we want 0-9 in array
-        # So we need to remap: image[9] -> array[0], image[0] -> array[1], etc.
-        digit_names = ['0', '1', '2', '3', '4', '5', '6', '7', '8', '9']
-
-        for digit in range(10):
-            # Map array index to image index
-            if digit == 0:
-                image_index = 9  # '0' is last in image
-            else:
-                image_index = digit - 1  # '1'-'9' are first in image
-
-            digit_bytes = font_data[image_index]
+    """Generate the C header with both nibble-aligned copies of the font."""
+    # Font data is in order 1-9,0 in image, but we want 0-9 in array
+    # So we need to remap: image[9] -> array[0], image[0] -> array[1], etc.
+    digits = [font_data[9]] + font_data[:9]
 
-            f.write(f"    {{ ")
-            hex_bytes = ', '.join(f"0x{b:02X}" for b in digit_bytes)
-            f.write(hex_bytes)
-            f.write(f" }}")
-
-            if digit < 9:
+    with open(output_file, 'w') as f:
+        f.write("/* Generated from the digit sprite sheet by tools/extract_font.py */\n")
+        f.write("/* Each digit is 4x8 pixels, stored as 8 bytes, MSB = leftmost pixel. */\n")
+        f.write("/* game_font[0] has them in the upper nibble, game_font[1] in the lower */\n")
+        f.write("/* one: draw_digit takes game_font[(x >> 2) & 1] and only masks and ORs. */\n\n")
+        f.write("#ifndef GFX_FONT_H\n")
+        f.write("#define GFX_FONT_H\n\n")
+        f.write("const uint8_t game_font[2][10][8] = {\n")
+
+        for side, shift in enumerate((0, 4)):
+            f.write("    {\n")
+            for digit in range(10):
+                hex_bytes = ', '.join(f"0x{b >> shift:02X}" for b in digits[digit])
+                f.write(f"        {{ {hex_bytes} }}")
+                if digit < 9:
+                    f.write(",")
+                f.write(f"  /* '{digit}' */\n")
+            f.write("    }")
+            if side == 0:
                 f.write(",")
-
-            f.write(f"  /* '{digit_names[digit]}' */\n")
+            f.write("\n")
 
         f.write("};\n\n")
-        f.write("#endif /* GAME_FONT_H */\n")
+        f.write("#endif /* GFX_FONT_H */\n")
 
 def main():
     if len(sys.argv) < 2:
         print("Usage: python extract_font.py <input_image> [output_header]")
-        print("Example: python extract_font.py digits.png game_font.h")
+        print("Example: python extract_font.py digits.png gfx/font.h")
         sys.exit(1)
 
     input_image = sys.argv[1]
-    output_header = sys.argv[2] if len(sys.argv) > 2 else "game_font.h"
+    output_header = sys.argv[2] if len(sys.argv) > 2 else "gfx/font.h"
 
     # Load the image
     try:
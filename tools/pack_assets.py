@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+Build the PHC-25 asset bank from a manifest of PNG images.
+
+Each manifest line names an asset and its PNG (relative to the
+manifest), blank lines and # comments are skipped. Lines that share a
+name and give a pixel position (X a multiple of 8) compose one asset
+from several images, later lines on top. The bank holds every asset
+as a Mode 12 bitmap (1 bpp, MSB = leftmost pixel), in the order the
+names first appear:
+
+    count
+    count x (bytes per row, height)
+    the bitmaps, one after the other
+
+host/tetrice_pack -a compresses each bitmap with ZX0 into the asset
+block that platform_phc25.c draws with draw_asset(id, x, y). The
+header gets one ASSET_<NAME> id per name, so adding an image is a
+manifest line and a draw_asset call.
+"""
+
+from PIL import Image
+import argparse
+import os
+
+from png_to_c_array import convert_png_to_bytes
+
+
+def read_manifest(path):
+    """(name, [(png path, x, y), ...]) per asset of the manifest."""
+    base = os.path.dirname(path)
+    assets = {}
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if len(fields) not in (2, 4) or (len(fields) == 4 and int(fields[2]) % 8 != 0):
+                raise ValueError(f"{path}:{number}: expected NAME IMAGE [X Y], X a multiple of 8")
+            x, y = (int(fields[2]), int(fields[3])) if len(fields) == 4 else (0, 0)
+            assets.setdefault(fields[0].upper(), []).append((os.path.join(base, fields[1]), x, y))
+    if not 0 < len(assets) < 256:
+        raise ValueError(f"{path}: 1 to 255 assets")
+    return list(assets.items())
+
+
+def compose(parts):
+    """Width, height and bitmap of the images placed in one box."""
+    images = [(Image.open(image), x, y) for image, x, y in parts]
+    left = min(x for _, x, _ in images)
+    top = min(y for _, _, y in images)
+    width = max(x + img.size[0] for img, x, _ in images) - left
+    height = max(y + img.size[1] for img, _, y in images) - top
+    if width % 8 != 0 or width > 256 or height > 192:
+        raise ValueError(f"{parts[0][0]}: {width}x{height} is not byte-aligned or larger than the screen")
+
+    bytes_per_row = width // 8
+    bitmap = bytearray(bytes_per_row * height)
+    for img, x, y in images:
+        data = convert_png_to_bytes(img)
+        row_bytes = img.size[0] // 8
+        for row in range(img.size[1]):
+            start = (y - top + row) * bytes_per_row + (x - left) // 8
+            bitmap[start:start + row_bytes] = bytes(data[row * row_bytes:(row + 1) * row_bytes])
+    return width, height, bitmap
+
+
+def generate_header(assets, manifest):
+    """The ids of the assets, in bank order."""
+    lines = [f"/* Generated from {os.path.basename(manifest)} by tools/pack_assets.py */",
+             "",
+             "#ifndef GFX_ASSETS_H",
+             "#define GFX_ASSETS_H",
+             ""]
+    for index, (name, _) in enumerate(assets):
+        lines.append(f"#define ASSET_{name} {index}")
+    lines.append(f"#define ASSET_COUNT {len(assets)}")
+    lines.append("")
+    lines.append("#endif /* GFX_ASSETS_H */")
+    lines.append("")
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build the PHC-25 asset bank from a manifest of PNG images')
+    parser.add_argument('manifest', help='Manifest, one NAME IMAGE per line')
+    parser.add_argument('output_bin', help='Output asset bank')
+    parser.add_argument('output_h', help='Output C header with the asset ids')
+    args = parser.parse_args()
+
+    assets = read_manifest(args.manifest)
+    sizes = bytearray([len(assets)])
+    bitmaps = bytearray()
+
+    for name, parts in assets:
+        width, height, bitmap = compose(parts)
+        sizes += bytes([width // 8, height])
+        bitmaps += bitmap
+        print(f"ASSET_{name:<10} {width:3}x{height:<3} " + ", ".join(image for image, _, _ in parts))
+
+    with open(args.output_bin, 'wb') as f:
+        f.write(sizes + bitmaps)
+    with open(args.output_h, 'w') as f:
+        f.write(generate_header(assets, args.manifest))
+    print(f"{len(assets)} assets, {len(sizes) + len(bitmaps)} bytes in {args.output_bin}")
+
+
+if __name__ == '__main__':
+    main()
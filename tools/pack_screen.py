@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+Build the Alice static screen from a manifest of EF9345 writes.
+
+The manifest (gfx/alice_screen.txt) lists what display_draw_borders
+shows: COLOR, TEXT, GRAPH and COLUMN lines, with colours and positions
+that may use the constants of alice.h. The writes are played on a
+cleared 40x25 screen, with the R2/R3 attribute registers as the Alice
+code leaves them, and every cell that differs from the cleared screen
+goes into the header as runs:
+
+    R6 (line), R7 (column), length, [R2, R3,] then length codes
+
+one run per row and attribute, ended by ALICE_SCREEN_END. The runs
+are grouped by attribute: the first of each group has the
+ALICE_SCREEN_ATTRIBUTES bit set in its R6 byte and carries R2 and R3.
+platform_alice.c replays them with one pointer setup per run and
+nothing but the character writes in between.
+"""
+
+import argparse
+import ast
+import os
+import re
+
+COLUMNS = 40
+ROWS = 25
+SEMIGRAPHIC = 0x20
+PINK = 7
+ATTRIBUTES = 0x80                   # In the R6 byte: R2 and R3 follow the length
+END = 0xFF
+
+
+def read_defines(path):
+    """The integer constants of a C header, derived ones included."""
+    expressions = {}
+    with open(path) as f:
+        for line in f:
+            line = re.sub(r'//.*|/\*.*?\*/', '', line)
+            match = re.match(r'\s*#define\s+([A-Za-z_]\w*)\s+(.+)', line)
+            if match:
+                expressions[match.group(1)] = match.group(2).strip()
+    defines = {}
+    for name, expression in expressions.items():
+        try:
+            defines[name] = int(eval(expression, {}, _Lazy(expressions)))
+        except Exception:
+            pass
+    return defines
+
+
+class _Lazy(dict):
+    """Names of read_defines, evaluated when an expression uses them."""
+
+    def __init__(self, expressions):
+        super().__init__()
+        self.expressions = expressions
+
+    def __missing__(self, name):
+        return int(eval(self.expressions[name], {}, self))
+
+
+def color(defines, foreground, background):
+    """R2 and R3 as color() in platform_alice.c sets them."""
+    foreground, background = defines[foreground], defines[background]
+    bright = 0
+    if foreground > PINK:
+        bright, foreground = 1, foreground - 8
+    if background > PINK:
+        bright, background = 1, background - 8
+    return bright, background + foreground * 16
+
+
+def play(manifest, defines):
+    """The screen after the manifest's writes, a (code, R2, R3) per cell."""
+    cleared = (ord(' '),) + color(defines, 'white', 'black')
+    screen = [[cleared] * COLUMNS for _ in range(ROWS)]
+    r2, r3 = cleared[1], cleared[2]
+
+    with open(manifest) as f:
+        for number, line in enumerate(f, 1):
+            fields = line.split('#', 1)[0].split(None, 3)
+            if not fields:
+                continue
+            try:
+                kind = fields[0].upper()
+                if kind == 'COLOR':
+                    r2, r3 = color(defines, fields[1], fields[2])
+                    continue
+                x = int(eval(fields[1], {}, dict(defines)))
+                y = int(eval(fields[2], {}, dict(defines)))
+                if kind == 'COLUMN':
+                    count, text = fields[3].split(None, 1)
+                    codes = ast.literal_eval(text) * int(count)
+                    step = (0, 1)
+                elif kind in ('TEXT', 'GRAPH'):
+                    codes = ast.literal_eval(fields[3])
+                    step = (1, 0)
+                else:
+                    raise ValueError(kind)
+                if kind != 'TEXT':
+                    r2 = SEMIGRAPHIC
+                for code in codes:
+                    screen[y][x] = (ord(code), r2, r3)
+                    x, y = x + step[0], y + step[1]
+            except (IndexError, KeyError, ValueError, SyntaxError) as error:
+                raise ValueError(f"{manifest}:{number}: {error}") from None
+    return screen, cleared
+
+
+def runs(screen, cleared):
+    """Runs of changed cells that share their attributes, grouped by
+    attributes so that each pair of them is sent once."""
+    found = []
+    for y, row in enumerate(screen):
+        x = 0
+        while x < COLUMNS:
+            if row[x] == cleared:
+                x += 1
+                continue
+            start, attributes = x, row[x][1:]
+            while x < COLUMNS and row[x] != cleared and row[x][1:] == attributes:
+                x += 1
+            found.append((attributes, y, start, bytes(code for code, _, _ in row[start:x])))
+
+    stream = bytearray()
+    current = None
+    for attributes, y, x, codes in sorted(found):
+        line = y + 7 if y else 0
+        if attributes != current:
+            stream += bytes([line | ATTRIBUTES, x, len(codes), attributes[0], attributes[1]])
+            current = attributes
+        else:
+            stream += bytes([line, x, len(codes)])
+        stream += codes
+    stream.append(END)
+    return stream, len(found)
+
+
+def generate_header(stream, manifest):
+    """The runs as a C array."""
+    lines = [f"/* Generated from {os.path.basename(manifest)} by tools/pack_screen.py */",
+             "/* Runs: R6, R7, length, then R2 and R3 if R6 has ALICE_SCREEN_ATTRIBUTES, */",
+             "/* then length codes; ALICE_SCREEN_END ends them */",
+             "",
+             "#ifndef GFX_ALICE_SCREEN_H",
+             "#define GFX_ALICE_SCREEN_H",
+             "",
+             f"#define ALICE_SCREEN_ATTRIBUTES 0x{ATTRIBUTES:02X}",
+             f"#define ALICE_SCREEN_END 0x{END:02X}",
+             "",
+             "static const uint8_t alice_screen[] = {"]
+    for start in range(0, len(stream), 12):
+        lines.append("    " + ", ".join(f"0x{b:02X}" for b in stream[start:start + 12]) + ",")
+    lines[-1] = lines[-1].rstrip(',')
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif /* GFX_ALICE_SCREEN_H */")
+    lines.append("")
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build the Alice static screen from a manifest of EF9345 writes')
+    parser.add_argument('manifest', help='Manifest, one COLOR, TEXT, GRAPH or COLUMN per line')
+    parser.add_argument('constants', help='alice.h, for the colours and the layout constants')
+    parser.add_argument('output_h', help='Output C header with the runs')
+    args = parser.parse_args()
+
+    screen, cleared = play(args.manifest, read_defines(args.constants))
+    stream, count = runs(screen, cleared)
+    cells = sum(cell != cleared for row in screen for cell in row)
+
+    with open(args.output_h, 'w') as f:
+        f.write(generate_header(stream, args.manifest))
+    print(f"{cells} cells in {count} runs, {len(stream)} bytes in {args.output_h}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Decode the perf.h frame counter ring from a memory dump.
+The dump is a raw image of the address space (an emulator's memory
+save, or tetrice_traffic_alice -d); the ring sits at PERF_RING_ADDR.
+Usage: python perf_ring.py memory.bin [--base 0x3600] [--little] [--clock 894886]
+"""
+
+import argparse
+import struct
+import sys
+
+HEADER_SIZE = 16
+SLOT_SIZE = 6
+PHASES = ('input', 'logic', 'render')
+
+
+def read_ring(memory, base, order):
+    """Return the header fields and the unread slots, oldest first."""
+    header = memory[base:base + HEADER_SIZE]
+    if len(header) < HEADER_SIZE or header[0:4] != b'PERF':
+        raise ValueError("no PERF ring at 0x%04X" % base)
+
+    version, slots, head, tail = header[4], header[5], header[6], header[7]
+    frames, over_budget, overwritten, budget = struct.unpack(order + 'HHHH', header[8:16])
+    if version != 1:
+        raise ValueError("ring version %d, expected 1" % version)
+
+    held = (head - tail) & 0xFF
+    if held > slots:
+        raise ValueError("head %d and tail %d are %d slots apart, the ring has %d" % (head, tail, held, slots))
+
+    frames_held = []
+    for i in range(held):
+        index = (tail + i) % slots
+        offset = base + HEADER_SIZE + index * SLOT_SIZE
+        frames_held.append(struct.unpack(order + 'HHH', memory[offset:offset + SLOT_SIZE]))
+
+    return {
+        'slots': slots, 'head': head, 'tail': tail, 'frames': frames,
+        'over_budget': over_budget, 'overwritten': overwritten, 'budget': budget,
+    }, frames_held
+
+
+def percentile(values, p):
+    """Nearest-rank percentile of a sorted list."""
+    if not values:
+        return 0
+    rank = max(0, min(len(values) - 1, (len(values) * p + 99) // 100 - 1))
+    return values[rank]
+
+
+def print_histogram(name, values, clock, width=40, buckets=8):
+    """One summary line per phase, then a bar per bucket."""
+    values = sorted(values)
+    to_us = 1e6 / clock
+    print("%-7s p50 %6d (%7.1f us)  p90 %6d  p99 %6d  max %6d (%7.1f us)" % (
+        name, percentile(values, 50), percentile(values, 50) * to_us, percentile(values, 90),
+        percentile(values, 99), values[-1], values[-1] * to_us))
+
+    low, high = values[0], values[-1]
+    step = max(1, (high - low + buckets) // buckets)
+    counts = [0] * buckets
+    for v in values:
+        counts[min(buckets - 1, (v - low) // step)] += 1
+    peak = max(counts)
+    for i, count in enumerate(counts):
+        if count:
+            bar = '#' * max(1, count * width // peak)
+            print("  %6d-%-6d %5d %s" % (low + i * step, low + (i + 1) * step - 1, count, bar))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the perf.h frame counter ring")
+    parser.add_argument('dump', help="raw memory image")
+    parser.add_argument('--base', type=lambda s: int(s, 0), default=0x3600,
+                        help="ring address in the image (default 0x3600)")
+    parser.add_argument('--little', action='store_true',
+                        help="little-endian fields (host mock dumps); the 6803 is big-endian")
+    parser.add_argument('--clock', type=float, default=894886.0,
+                        help="clock units per second (default the Alice E clock)")
+    args = parser.parse_args()
+
+    with open(args.dump, 'rb') as f:
+        memory = f.read()
+
+    try:
+        header, frames = read_ring(memory, args.base, '<' if args.little else '>')
+    except ValueError as e:
+        print("perf_ring: %s" % e, file=sys.stderr)
+        return 1
+
+    print("%d frames recorded, %d over the budget of %d (%.1f ms), %d overwritten before being read" % (
+        header['frames'], header['over_budget'], header['budget'], header['budget'] * 1e3 / args.clock,
+        header['overwritten']))
+    print("%d of %d slots unread (head %d, tail %d)" % (len(frames), header['slots'], header['head'],
+                                                       header['tail']))
+    if not frames:
+        return 0
+
+    for i, name in enumerate(PHASES):
+        print_histogram(name, [f[i] for f in frames], args.clock)
+
+    over = [(i, f) for i, f in enumerate(frames) if f[1] + f[2] > header['budget']]
+    if over:
+        print("over budget, oldest first:")
+        for i, f in over:
+            print("  slot %2d  input %6d  logic %6d  render %6d" % ((header['tail'] + i) % header['slots'],
+                                                                    f[0], f[1], f[2]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())